@@ -0,0 +1,79 @@
+/**
+ * @file allocation_counter.hpp
+ * @brief Replacement global operator new and delete that count heap allocations, for the benchmark and the tests.
+ *
+ * The operators are defined here, not declared, so a program includes this header in exactly one
+ * translation unit. allocationCount is the number of allocations made so far by any thread.
+ */
+
+#ifndef LOGIC_ALLOCATION_COUNTER_HPP
+#define LOGIC_ALLOCATION_COUNTER_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+
+// Global allocation counter, every operator new of the process, aligned or not, goes through here
+inline std::atomic<uint64_t> allocationCount(0);
+
+void* operator new(std::size_t size) {
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    return std::malloc(size ? size : 1);
+}
+
+// Not inlined, otherwise GCC sees the pointer of operator new reach free and warns about a mismatch
+#if defined(__GNUC__)
+__attribute__((noinline))
+#endif
+static void releaseAllocation(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p) noexcept { releaseAllocation(p); }
+void operator delete(void* p, std::size_t) noexcept { releaseAllocation(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { releaseAllocation(p); }
+
+// Types aligned beyond the default, such as SIMD lane vectors, allocate through these instead
+static void* allocateAligned(std::size_t size, std::align_val_t alignment) noexcept {
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    const std::size_t align = static_cast<std::size_t>(alignment);
+#if defined(_MSC_VER)
+    return _aligned_malloc(size ? size : 1, align);
+#else
+    return std::aligned_alloc(align, (std::max<std::size_t>(size, 1) + align - 1) / align * align); // A multiple of align
+#endif
+}
+
+#if defined(__GNUC__)
+__attribute__((noinline))
+#endif
+static void releaseAligned(void* p) noexcept {
+#if defined(_MSC_VER)
+    _aligned_free(p);
+#else
+    std::free(p);
+#endif
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment) {
+    if (void* p = allocateAligned(size, alignment)) return p;
+    throw std::bad_alloc();
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    return allocateAligned(size, alignment);
+}
+
+void operator delete(void* p, std::align_val_t) noexcept { releaseAligned(p); }
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept { releaseAligned(p); }
+void operator delete(void* p, std::align_val_t, const std::nothrow_t&) noexcept { releaseAligned(p); }
+
+#endif // LOGIC_ALLOCATION_COUNTER_HPP
@@ -0,0 +1,252 @@
+/**
+ * @file analysis_planner.hpp
+ * @brief Planner that picks analysis engines for an argument and falls back between them.
+ */
+
+#ifndef LOGIC_ANALYSIS_PLANNER_HPP
+#define LOGIC_ANALYSIS_PLANNER_HPP
+
+#include "common.hpp"
+#include "expression.hpp"
+#include "problem.hpp"
+#include "evaluation.hpp"
+#include "fragment_solver.hpp"
+#include "truth_table_generator.hpp"
+
+/**
+ * @class AnalysisPlanner
+ * @brief Picks engines for an argument from its shape and runs them in turn, each under a time budget.
+ *
+ * The argument is inspected first: variable count, DAG size, how many premises rewrite to clauses and how it
+ * splits into independent components. A sweep, of the whole table or per component, is estimated from
+ * its words times the DAG nodes and goes first when it fits the budget, since it also gives exact row
+ * counts and the lowest counterexample. The polynomial fragment solvers come next, or first when the
+ * sweep does not fit, and step aside when the argument is not Horn, 2-CNF or a parity system. BDDs
+ * come next unless nearly every premise rewrites to clauses, and the SAT solver, which always finishes, is
+ * last. Every engine but the last runs under the budget and is abandoned for the next one
+ * when it runs out; the last one runs to completion. Every decision and attempt is logged.
+ */
+class AnalysisPlanner {
+public:
+    enum class Engine {
+        FRAGMENT,   // Horn, 2-SAT or parity fast path
+        SWEEP,      // Bit-parallel sweep of the whole table
+        COMPONENTS, // Bit-parallel sweep of every independent component
+        BDD,
+        SAT
+    };
+
+    /**
+     * @brief What the planner looks at
+     */
+    struct Features {
+        size_t variables = 0;
+        size_t dagNodes = 0; // Nodes of the shared DAG of the premises and conclusion
+        size_t premises = 0;
+        size_t clausePremises = 0; // Premises that rewrite to a few clauses without new variables
+        std::vector<TruthTableGenerator::Component> components;
+    };
+
+    /**
+     * @brief An engine of the plan, or one the planner decided against
+     */
+    struct Step {
+        Engine engine;
+        bool planned; // False if the engine was ruled out
+        std::string reason;
+        double estimate = -1; // Estimated seconds, negative if there is no estimate
+        bool ran = false;
+        double seconds = 0;
+        std::string outcome; // "done", "out of budget" or the error
+
+        Step(Engine e, bool isPlanned, std::string why) : engine(e), planned(isPlanned), reason(std::move(why)) {}
+    };
+
+    static constexpr double WORD_OPERATIONS_PER_SECOND = 1e9; // Per worker, conservatively for the scalar kernel
+
+    static const char* engineName(Engine engine) {
+        switch (engine) {
+            case Engine::FRAGMENT:   return "fragment";
+            case Engine::SWEEP:      return "sweep";
+            case Engine::COMPONENTS: return "components";
+            case Engine::BDD:        return "bdd";
+            default:                 return "sat";
+        }
+    }
+
+private:
+    const TruthTableGenerator& generator;
+    WorkStealingPool& pool;
+    double budgetSeconds; // Per engine, except the last
+    bool stopEarly; // Sweeps may stop once the verdicts are known
+    BitSlicedEvaluator::Isa isa;
+    Features features;
+    std::vector<Step> steps;
+    FragmentSolver::Fragment fragment = FragmentSolver::Fragment::NONE; // Fast path that decided the argument
+
+    void inspect() {
+        Instrumentation::Scope timer(Instrumentation::Phase::NONE, "plan");
+        features.variables = generator.variableCount();
+        ExpressionDag dag;
+        FragmentSolver::Clauses clauses;
+        for (const auto& premise : generator.premisePrograms()) {
+            dag.add(premise);
+            clauses.clear();
+            features.clausePremises += FragmentSolver::toClauses(premise, clauses);
+        }
+        dag.add(generator.conclusionProgram());
+        features.dagNodes = dag.size();
+        features.premises = generator.premisePrograms().size();
+        features.components = generator.components();
+    }
+
+    void plan() {
+        // Sweep: feasible if every component can be enumerated, worth it if the estimate fits the budget
+        const bool split = features.components.size() > 1;
+        size_t largest = 0;
+        double rows = 0;
+        double words = 0; // A component of fewer than 64 rows still takes a whole word
+        for (const auto& part : features.components) {
+            largest = std::max(largest, part.slots.size());
+            rows += std::ldexp(1.0, static_cast<int>(part.slots.size()));
+            words += part.slots.size() <= 6 ? 1 : std::ldexp(1.0, static_cast<int>(part.slots.size()) - 6);
+        }
+        Step sweep(split ? Engine::COMPONENTS : Engine::SWEEP, false, "");
+        if (largest > BitSlicedEvaluator::MAX_VARIABLES) {
+            sweep.reason = std::to_string(largest) + " variables are too many to enumerate";
+        } else {
+            sweep.estimate = words * features.dagNodes / (WORD_OPERATIONS_PER_SECOND * pool.size());
+            sweep.planned = sweep.estimate <= budgetSeconds;
+            std::ostringstream reason;
+            reason << std::defaultfloat << std::setprecision(3) << rows << " rows";
+            if (split) reason << " in " << features.components.size() << " components";
+            reason << (sweep.planned ? ", fits the budget" : ", over the budget");
+            sweep.reason = reason.str();
+        }
+
+        // The fast paths neither count rows nor always find the lowest counterexample, so a sweep that fits
+        // the budget goes first and they only lead when the table cannot be enumerated in time
+        if (sweep.planned) {
+            steps.push_back(sweep);
+            steps.emplace_back(Engine::FRAGMENT, true, "polynomial if the argument is Horn, 2-CNF or parity");
+        } else {
+            steps.emplace_back(Engine::FRAGMENT, true, "polynomial if the argument is Horn, 2-CNF or parity");
+            steps.push_back(sweep);
+        }
+
+        // BDDs count exactly and handle structured formulas well; for clauses the SAT solver is the better tool
+        const bool clausal = features.premises > 0 && features.clausePremises * 10 >= features.premises * 9;
+        steps.emplace_back(Engine::BDD, !clausal,
+                           clausal ? "premises rewrite to clauses, which suit SAT better"
+                                   : "counts rows exactly, under 90% of premises rewrite to clauses");
+
+        steps.emplace_back(Engine::SAT, true, "always finishes, no row counts");
+    }
+
+    AnalysisResult runEngine(Engine engine, const Budget& budget) {
+        switch (engine) {
+            case Engine::FRAGMENT: {
+                AnalysisResult result;
+                if (!generator.analyzeFragment(result, fragment)) throw std::runtime_error("not in a fragment");
+                return result;
+            }
+            case Engine::SWEEP:      return generator.analyzeParallel(pool, stopEarly, isa, budget);
+            case Engine::COMPONENTS: return generator.analyzeComponents(pool, features.components, isa, budget);
+            case Engine::BDD:
+                return generator.analyzeBdd(TruthTableGenerator::BddOrder::APPEARANCE, false, nullptr, budget);
+            default:                 return generator.analyzeSat(nullptr, budget);
+        }
+    }
+
+public:
+    /**
+     * @brief Inspects the argument and plans the engines
+     * @param g The argument.
+     * @param workers The pool of the sweeps.
+     * @param budget Seconds each engine but the last may take.
+     * @param early Let sweeps stop once the verdicts are known.
+     * @param instructionSet Instruction set of the sweeps.
+     */
+    AnalysisPlanner(const TruthTableGenerator& g, WorkStealingPool& workers, double budget, bool early = true,
+                    BitSlicedEvaluator::Isa instructionSet = BitSlicedEvaluator::detectIsa())
+        : generator(g), pool(workers), budgetSeconds(budget), stopEarly(early), isa(instructionSet) {
+        inspect();
+        plan();
+    }
+
+    /**
+     * @brief Runs the planned engines until one finishes
+     * @return The analysis of the engine that finished.
+     * @throws std::runtime_error If the last engine fails.
+     */
+    AnalysisResult run() {
+        size_t last = 0;
+        for (size_t i = 0; i < steps.size(); ++i) {
+            if (steps[i].planned) last = i;
+        }
+        for (size_t i = 0; i <= last; ++i) {
+            Step& step = steps[i];
+            if (!step.planned) continue;
+            step.ran = true;
+            auto start = std::chrono::steady_clock::now();
+            try {
+                const Budget limit(i == last ? std::numeric_limits<double>::infinity() : budgetSeconds);
+                AnalysisResult result = runEngine(step.engine, limit);
+                step.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+                step.outcome = step.engine == Engine::FRAGMENT
+                    ? std::string("done with ") + FragmentSolver::fragmentName(fragment) : "done";
+                return result;
+            } catch (const Budget::Exceeded&) {
+                step.outcome = "out of budget";
+            } catch (const std::exception& e) {
+                if (i == last) throw;
+                step.outcome = e.what();
+            }
+            step.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        }
+        throw std::runtime_error("No engine could analyze the argument");
+    }
+
+    const Features& argumentFeatures() const {
+        return features;
+    }
+
+    const std::vector<Step>& log() const {
+        return steps;
+    }
+
+    /**
+     * @brief The fast path that decided the argument, NONE if another engine did
+     */
+    FragmentSolver::Fragment usedFragment() const {
+        return fragment;
+    }
+
+    /**
+     * @brief Prints the features, every decision and the cost of every attempt
+     */
+    void printLog() const {
+        std::cout << Colors::YELLOW << Colors::BOLD << "Plan:" << Colors::RESET << " "
+                  << features.variables << " variables, " << features.dagNodes << " DAG nodes, "
+                  << features.clausePremises << " of " << features.premises << " premises rewrite to clauses, "
+                  << features.components.size() << (features.components.size() == 1 ? " component" : " components")
+                  << ", budget " << budgetSeconds << " s per engine\n";
+        for (const Step& step : steps) {
+            std::cout << "  " << std::left << std::setw(11) << engineName(step.engine) << std::right;
+            if (!step.planned) {
+                std::cout << "skipped";
+            } else if (!step.ran) {
+                std::cout << "not needed";
+            } else {
+                std::cout << step.outcome << " after " << std::fixed << std::setprecision(3) << step.seconds
+                          << std::defaultfloat << " s";
+            }
+            if (step.estimate >= 0) {
+                std::cout << " (estimated " << std::setprecision(3) << step.estimate << std::setprecision(6) << " s)";
+            }
+            std::cout << ": " << step.reason << "\n";
+        }
+    }
+};
+
+#endif // LOGIC_ANALYSIS_PLANNER_HPP
@@ -0,0 +1,290 @@
+/**
+ * @file analysis_session.hpp
+ * @brief Incremental analysis of an argument edited one expression at a time.
+ */
+
+#ifndef LOGIC_ANALYSIS_SESSION_HPP
+#define LOGIC_ANALYSIS_SESSION_HPP
+
+#include "common.hpp"
+#include "expression.hpp"
+#include "evaluation.hpp"
+
+/**
+ * @class AnalysisSession
+ * @brief An argument that is edited one expression at a time, re-evaluating only what changed.
+ *
+ * Every premise and the conclusion keeps its packed truth vector, bit r of word w holding its value in
+ * row w * 64 + r. The conjunction of the premises is kept in a segment tree over the premise slots:
+ * each inner node holds the AND of the vectors below it and the root holds the conjunction. Adding or
+ * editing a premise evaluates only that premise and re-ANDs the nodes on its path to the root; removing
+ * one evaluates nothing. Either way that is O(log k) bitwise passes for k premises.
+ *
+ * Variables are numbered in order of first appearance, so a new variable is always the highest one and
+ * the rows of the old table are exactly the rows of the new table where it is false. Cached vectors are
+ * therefore widened by copying them, never recomputed. Variables stay in the session once seen; the
+ * reported counts and counterexample are over the variables the current argument uses.
+ */
+class AnalysisSession {
+public:
+    static constexpr size_t MAX_VARIABLES = 26; // Each cached vector takes 2^n bits
+
+    /**
+     * @brief An expression of the session and its cached truth vector
+     */
+    struct Entry {
+        std::string text;
+        CompiledExpression program;
+        std::vector<uint64_t> truth; // Empty for a free premise slot
+    };
+
+private:
+    ExpressionCompiler compiler;
+    SymbolTable symbols;
+    std::vector<Entry> slots; // Premises by slot; a removed premise leaves its slot free for the next one
+    std::vector<uint32_t> order; // Slot of each premise, in the order the user sees
+    Entry conclusion;
+    // Segment tree of conjunctions: node i has children 2i and 2i + 1, node capacity + s is slot s.
+    // An empty vector stands for all ones, the conjunction of no premises.
+    std::vector<std::vector<uint64_t>> tree;
+    size_t capacity = 2; // Leaves of the tree, a power of two
+    size_t tableVariables = 0; // Number of variables the cached vectors cover
+
+    static uint64_t wordsFor(size_t variables) {
+        return variables <= 6 ? 1 : uint64_t{1} << (variables - 6);
+    }
+
+    /**
+     * @brief Widens a truth vector to more variables by repeating it
+     *
+     * Below six variables the bit-sliced patterns already repeat within the word, so only whole words
+     * need copying. Empty vectors (all ones) stay empty.
+     */
+    static void widen(std::vector<uint64_t>& truth, size_t variables) {
+        if (truth.empty()) return;
+        const uint64_t words = wordsFor(variables);
+        truth.reserve(words);
+        while (truth.size() < words) {
+            const size_t old = truth.size(); // Inserting a vector's own range into it is undefined
+            truth.resize(2 * old);
+            std::copy_n(truth.begin(), old, truth.begin() + old);
+        }
+    }
+
+    /**
+     * @brief Widens every cached vector to the variables interned so far
+     * @throws std::runtime_error If there are too many variables.
+     */
+    void widenAll() {
+        if (symbols.size() > MAX_VARIABLES) {
+            throw std::runtime_error("Too many variables for a session (" + std::to_string(symbols.size()) +
+                                     ", at most " + std::to_string(MAX_VARIABLES) + ")");
+        }
+        if (symbols.size() == tableVariables) return;
+        tableVariables = symbols.size();
+        for (Entry& slot : slots) widen(slot.truth, tableVariables);
+        for (auto& node : tree) widen(node, tableVariables);
+        widen(conclusion.truth, tableVariables);
+    }
+
+    /**
+     * @brief Compiles an expression and evaluates its truth vector over the current variables
+     * @throws std::runtime_error If the expression is malformed or brings too many variables.
+     */
+    Entry evaluate(std::string_view text) {
+        Entry entry;
+        entry.text = std::string(text);
+        const size_t known = symbols.size();
+        try {
+            entry.program = compiler.compile(text, symbols);
+            widenAll();
+        } catch (...) {
+            symbols.truncate(known); // Leave the session as it was
+            throw;
+        }
+
+        Instrumentation::Scope timer(Instrumentation::Phase::EVALUATE, "session evaluate");
+        std::vector<uint32_t> loaded; // Only the variables of this expression change between words
+        for (const auto& ins : entry.program.code) {
+            if (ins.op == CompiledExpression::OpCode::LOAD &&
+                std::find(loaded.begin(), loaded.end(), ins.slot) == loaded.end()) {
+                loaded.push_back(ins.slot);
+            }
+        }
+        // The vector repeats above the highest variable the expression uses, so evaluate up to it and widen
+        const size_t width = loaded.empty() ? 0 : *std::max_element(loaded.begin(), loaded.end()) + size_t{1};
+        const uint64_t words = wordsFor(width);
+        entry.truth.resize(words);
+        std::vector<uint64_t> values(tableVariables);
+        std::vector<uint64_t> stack(entry.program.maxStackDepth + 1);
+        for (uint64_t w = 0; w < words; ++w) {
+            for (uint32_t j : loaded) values[j] = BitSlicedEvaluator::variableWord(j, w);
+            entry.program.execute(values.data(), stack.data());
+            entry.truth[w] = stack[0];
+        }
+        widen(entry.truth, tableVariables);
+        if (Instrumentation::enabled()) {
+            Instrumentation::add(Instrumentation::Counter::ROWS_EVALUATED, words * 64);
+            Instrumentation::add(Instrumentation::Counter::OPERATORS_APPLIED, words * entry.program.operatorCount());
+        }
+        return entry;
+    }
+
+    const std::vector<uint64_t>& node(size_t index) const {
+        if (index < capacity) return tree[index];
+        size_t slot = index - capacity;
+        static const std::vector<uint64_t> allOnes;
+        return slot < slots.size() ? slots[slot].truth : allOnes;
+    }
+
+    /**
+     * @brief Recomputes an inner node from its children
+     */
+    void combine(size_t index) {
+        const std::vector<uint64_t>& left = node(2 * index);
+        const std::vector<uint64_t>& right = node(2 * index + 1);
+        std::vector<uint64_t>& out = tree[index];
+        if (left.empty() || right.empty()) {
+            out = left.empty() ? right : left;
+            return;
+        }
+        out.resize(left.size());
+        for (size_t w = 0; w < out.size(); ++w) out[w] = left[w] & right[w];
+    }
+
+    /**
+     * @brief Recomputes the path from a slot to the root
+     */
+    void update(size_t slot) {
+        for (size_t index = (capacity + slot) / 2; index >= 1; index /= 2) combine(index);
+    }
+
+    /**
+     * @brief Puts an entry into a free slot, growing the tree when every slot is taken
+     */
+    void place(Entry entry) {
+        size_t slot = 0;
+        while (slot < slots.size() && !slots[slot].truth.empty()) ++slot;
+        if (slot == slots.size()) slots.emplace_back();
+        slots[slot] = std::move(entry);
+        order.push_back(static_cast<uint32_t>(slot));
+        if (slots.size() > capacity) {
+            capacity *= 2;
+            tree.assign(capacity, {});
+            for (size_t index = capacity - 1; index >= 1; --index) combine(index);
+        } else {
+            update(slot);
+        }
+    }
+
+    uint32_t slotOf(size_t index) const {
+        if (index >= order.size()) {
+            throw std::runtime_error("No premise " + std::to_string(index + 1) + " (there are " +
+                                     std::to_string(order.size()) + ")");
+        }
+        return order[index];
+    }
+
+public:
+    /**
+     * @brief Starts an empty session, with the conclusion true until one is set
+     */
+    AnalysisSession() : tree(2) {
+        conclusion.text = "(none)";
+        conclusion.program = CompiledExpression::constant(true);
+        conclusion.truth.assign(1, ~0ull);
+    }
+
+    /**
+     * @brief Adds a premise, evaluating only that premise
+     * @return Index of the new premise.
+     * @throws std::runtime_error If the expression is malformed; the session is then unchanged.
+     */
+    size_t addPremise(std::string_view text) {
+        place(evaluate(text));
+        return order.size() - 1;
+    }
+
+    /**
+     * @brief Replaces a premise, evaluating only the new text
+     * @throws std::runtime_error If there is no such premise or the expression is malformed.
+     */
+    void editPremise(size_t index, std::string_view text) {
+        uint32_t slot = slotOf(index);
+        Entry entry = evaluate(text);
+        slots[slot] = std::move(entry);
+        update(slot);
+    }
+
+    /**
+     * @brief Removes a premise, evaluating nothing
+     * @throws std::runtime_error If there is no such premise.
+     */
+    void removePremise(size_t index) {
+        uint32_t slot = slotOf(index);
+        slots[slot] = Entry();
+        order.erase(order.begin() + static_cast<std::ptrdiff_t>(index));
+        update(slot);
+    }
+
+    /**
+     * @brief Sets or replaces the conclusion, evaluating only the conclusion
+     * @throws std::runtime_error If the expression is malformed.
+     */
+    void setConclusion(std::string_view text) {
+        conclusion = evaluate(text);
+    }
+
+    size_t premiseCount() const { return order.size(); }
+    const Entry& premise(size_t index) const { return slots[slotOf(index)]; }
+    const Entry& conclusionEntry() const { return conclusion; }
+
+    /**
+     * @brief Variables the current premises and conclusion use, in session order
+     */
+    std::vector<uint32_t> usedVariables() const {
+        std::vector<bool> used(symbols.size(), false);
+        auto mark = [&](const CompiledExpression& program) {
+            for (const auto& ins : program.code) {
+                if (ins.op == CompiledExpression::OpCode::LOAD) used[ins.slot] = true;
+            }
+        };
+        for (uint32_t slot : order) mark(slots[slot].program);
+        mark(conclusion.program);
+        std::vector<uint32_t> result;
+        for (uint32_t id = 0; id < used.size(); ++id) {
+            if (used[id]) result.push_back(id);
+        }
+        return result;
+    }
+
+    std::string_view variableName(uint32_t id) const {
+        return symbols.name(id);
+    }
+
+    /**
+     * @brief Analyzes the current argument from the cached vectors, a bitwise pass without evaluation
+     *
+     * Row counts are over the variables the argument uses; a variable that no expression uses any more
+     * only doubles every count, so it is divided out. The counterexample is given by variable id.
+     */
+    AnalysisResult analyze() const {
+        AnalysisResult result;
+        const std::vector<uint64_t>& allPremises = tree[1];
+        const uint64_t mask = tableVariables >= 6 ? ~0ull : (uint64_t{1} << (uint64_t{1} << tableVariables)) - 1;
+        for (uint64_t w = 0; w < wordsFor(tableVariables); ++w) {
+            uint64_t critical = (allPremises.empty() ? ~0ull : allPremises[w]) & mask;
+            result.addWord(w, critical, critical & ~conclusion.truth[w]);
+        }
+        const size_t unused = tableVariables - usedVariables().size();
+        result.criticalRows >>= unused;
+        result.counterexampleRows >>= unused;
+        if (result.firstCounterexample != AnalysisResult::NO_ROW) {
+            result.counterexample.resize(tableVariables);
+            for (size_t j = 0; j < tableVariables; ++j) result.counterexample[j] = (result.firstCounterexample >> j) & 1;
+        }
+        return result;
+    }
+};
+
+#endif // LOGIC_ANALYSIS_SESSION_HPP
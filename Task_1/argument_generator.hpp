@@ -0,0 +1,256 @@
+/**
+ * @file argument_generator.hpp
+ * @brief Seeded random arguments in the syntax of Task_1 or Task_2, shared by logic_generate and the tests.
+ */
+
+#ifndef LOGIC_ARGUMENT_GENERATOR_HPP
+#define LOGIC_ARGUMENT_GENERATOR_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+/**
+ * @brief SplitMix64, a small generator whose sequence is fixed by its seed
+ */
+class Random {
+private:
+    uint64_t state;
+
+public:
+    explicit Random(uint64_t seed) : state(seed) {}
+
+    uint64_t next() {
+        uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    }
+
+    /**
+     * @brief A number in [0, bound); the bias of the modulo is negligible for the bounds used here
+     */
+    uint64_t below(uint64_t bound) {
+        return next() % bound;
+    }
+
+    /**
+     * @brief True with the given probability
+     */
+    bool chance(double probability) {
+        return static_cast<double>(next() >> 11) * 0x1.0p-53 < probability;
+    }
+};
+
+struct GeneratorOptions {
+    enum class Syntax { TASK1, TASK2 };
+    enum class Shape { TREE, CNF };
+
+    Syntax syntax = Syntax::TASK1;
+    Shape shape = Shape::TREE;
+    uint64_t seed = 1;
+    size_t variables = 10;
+    size_t premises = 10;
+    size_t depth = 4;
+    size_t clauseSize = 3;
+    double density = 4.26;
+    double shared = 0;
+    bool conclusion = true;
+    std::string outputPath;
+};
+
+/**
+ * @brief Block buffer that is flushed once it holds a megabyte, keeping track of how much was written
+ *
+ * Unlike the OutputBuffer of table_sink.hpp, text that is still in the buffer can be read back, which
+ * is how subformulas are copied into the pool of shared ones.
+ */
+class ReadBackBuffer {
+private:
+    static constexpr size_t BLOCK = size_t{1} << 20;
+
+    std::FILE* file;
+    std::string buffer;
+    uint64_t flushed = 0; // Bytes written before the start of the buffer
+
+public:
+    explicit ReadBackBuffer(std::FILE* file) : file(file) { buffer.reserve(BLOCK + 256); }
+
+    ~ReadBackBuffer() {
+        if (!buffer.empty()) std::fwrite(buffer.data(), 1, buffer.size(), file);
+    }
+
+    void append(const char* text) { buffer += text; }
+    void append(const std::string& text) { buffer += text; }
+
+    /**
+     * @brief Writes the buffer out if it is full; text before the current position can no longer be read back
+     */
+    void maybeFlush() {
+        if (buffer.size() < BLOCK) return;
+        flush();
+    }
+
+    void flush() {
+        if (std::fwrite(buffer.data(), 1, buffer.size(), file) != buffer.size()) {
+            throw std::runtime_error("Cannot write the output");
+        }
+        flushed += buffer.size();
+        buffer.clear();
+    }
+
+    uint64_t position() const { return flushed + buffer.size(); }
+
+    /**
+     * @brief Copies the text between two positions into text
+     * @return False if part of it was already flushed.
+     */
+    bool copy(uint64_t from, uint64_t to, std::string& text) const {
+        if (from < flushed) return false;
+        text.assign(buffer, static_cast<size_t>(from - flushed), static_cast<size_t>(to - from));
+        return true;
+    }
+};
+
+/**
+ * @class ArgumentGenerator
+ * @brief Writes random formulas in the syntax of one of the tasks.
+ *
+ * Subformulas of up to MAX_SHARED_LENGTH characters are kept in a pool of POOL_SIZE entries, each
+ * replacing a random older one, and operands are drawn from the pool with the shared probability.
+ */
+class ArgumentGenerator {
+private:
+    static constexpr size_t POOL_SIZE = 256;
+    static constexpr size_t MAX_SHARED_LENGTH = 4096;
+
+    struct SharedFormula {
+        std::string text;
+        size_t depth;
+    };
+
+    const GeneratorOptions& options;
+    Random random;
+    ReadBackBuffer& out;
+    std::vector<std::string> names;
+    std::vector<SharedFormula> pool;
+    std::string scratch;
+
+    bool task1() const { return options.syntax == GeneratorOptions::Syntax::TASK1; }
+
+    void writeLiteral(size_t variable, bool negated) {
+        if (negated) out.append(task1() ? "~" : "NOT ");
+        out.append(names[variable]);
+    }
+
+    void remember(uint64_t start, size_t depth) {
+        uint64_t end = out.position();
+        if (end - start > MAX_SHARED_LENGTH || !out.copy(start, end, scratch)) return;
+        if (pool.size() < POOL_SIZE) {
+            pool.push_back({scratch, depth});
+        } else {
+            SharedFormula& slot = pool[random.below(POOL_SIZE)];
+            slot.text.swap(scratch);
+            slot.depth = depth;
+        }
+    }
+
+    /**
+     * @brief Writes a formula with operators nested at most depth levels deep
+     * @param top Whether the formula is a whole premise, which is not parenthesized.
+     */
+    void writeFormula(size_t depth, bool top) {
+        // Below the top a quarter of the operands end early, so formulas are not all complete trees
+        if (depth == 0 || (!top && random.chance(0.25))) {
+            writeLiteral(random.below(options.variables), random.chance(0.5));
+            return;
+        }
+        if (!top && !pool.empty() && random.chance(options.shared)) {
+            const SharedFormula& shared = pool[random.below(pool.size())];
+            if (shared.depth <= depth) {
+                out.append(shared.text);
+                return;
+            }
+        }
+
+        static const char* const task1Operators[] = {" & ", " | ", " -> ", " <-> "};
+        static const char* const task2Operators[] = {" AND ", " OR "};
+        const char* op = task1() ? task1Operators[random.below(4)] : task2Operators[random.below(2)];
+        bool negated = random.chance(0.2);
+        uint64_t start = out.position();
+        if (negated) out.append(task1() ? "~" : "NOT ");
+        if (!top || negated) out.append(task1() ? "(" : "( ");
+        writeFormula(depth - 1, false);
+        out.append(op);
+        writeFormula(depth - 1, false);
+        if (!top || negated) out.append(task1() ? ")" : " )");
+        out.maybeFlush();
+        if (!top) remember(start, depth);
+    }
+
+    void writeClause() {
+        size_t chosen[64];
+        for (size_t i = 0; i < options.clauseSize; ++i) {
+            size_t variable;
+            bool repeated;
+            do { // Rejection keeps the variables distinct; clauses are small next to the variable count
+                variable = random.below(options.variables);
+                repeated = std::find(chosen, chosen + i, variable) != chosen + i;
+            } while (repeated);
+            chosen[i] = variable;
+            if (i > 0) out.append(task1() ? " | " : " OR ");
+            writeLiteral(variable, random.chance(0.5));
+        }
+    }
+
+public:
+    ArgumentGenerator(const GeneratorOptions& options, ReadBackBuffer& out)
+        : options(options), random(options.seed), out(out) {
+        for (size_t j = 0; j < options.variables; ++j) names.push_back("x" + std::to_string(j));
+    }
+
+    void generate() {
+        bool cnf = options.shape == GeneratorOptions::Shape::CNF;
+        size_t clauses = static_cast<size_t>(std::llround(options.density * static_cast<double>(options.variables)));
+
+        if (task1()) {
+            size_t premises = cnf ? clauses : options.premises;
+            for (size_t i = 0; i < premises; ++i) {
+                if (cnf) {
+                    writeClause();
+                } else {
+                    writeFormula(options.depth, true);
+                }
+                out.append("\n");
+                out.maybeFlush();
+            }
+            if (options.conclusion) {
+                out.append("=> ");
+                writeFormula(options.depth, true);
+                out.append("\n");
+            }
+            return;
+        }
+
+        for (size_t i = 0; i < options.premises; ++i) {
+            if (cnf) {
+                for (size_t c = 0; c < clauses; ++c) {
+                    out.append(c > 0 ? " AND ( " : "( ");
+                    writeClause();
+                    out.append(" )");
+                    out.maybeFlush();
+                }
+            } else {
+                writeFormula(options.depth, true);
+            }
+            out.append("\n");
+            out.maybeFlush();
+        }
+    }
+};
+
+#endif // LOGIC_ARGUMENT_GENERATOR_HPP
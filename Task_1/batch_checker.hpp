@@ -0,0 +1,271 @@
+/**
+ * @file batch_checker.hpp
+ * @brief Batch checking of argument streams in per-worker arenas.
+ */
+
+#ifndef LOGIC_BATCH_CHECKER_HPP
+#define LOGIC_BATCH_CHECKER_HPP
+
+#include "common.hpp"
+#include "expression.hpp"
+#include "evaluation.hpp"
+#include "table_sink.hpp"
+
+/**
+ * @class BatchChecker
+ * @brief Checks a stream of small arguments, one compact result line per record.
+ *
+ * A record is an argument on one line (or one length-prefixed payload): premises separated by ';'
+ * or newlines, then "=>" and the conclusion. Without a conclusion only satisfiability is asked, as in
+ * problem files. Records are split off the input as it arrives, checked in blocks on a thread pool and
+ * written in input order, one line per record:
+ *
+ *     <record> valid|invalid satisfiable|unsatisfiable <critical rows> [counterexample=p:1,q:0]
+ *     <record> error <message>
+ *
+ * Each worker parses and evaluates its records in a monotonic arena that is released after every
+ * record, and output goes to buffers that keep their capacity, so the steady state does no heap
+ * allocation however many records go through. A record may be at most 16 MiB, a longer one (or a
+ * forged length prefix) ends the run with an error instead of growing the read buffer without limit.
+ */
+class BatchChecker {
+public:
+    /**
+     * @brief How records are delimited in the input
+     */
+    enum class Framing {
+        LINES,         // One record per line, blank lines are skipped
+        LENGTH_PREFIX  // A 4-byte little-endian length, then the record
+    };
+
+private:
+    static constexpr size_t ARENA_BYTES = size_t{64} << 10; // Enough for any small argument without touching the heap
+    static constexpr size_t MAX_VARIABLES = 30; // Batch records are enumerated on one worker
+    static constexpr size_t MAX_RECORD_BYTES = size_t{16} << 20; // Bounds the read buffer against forged lengths and endless lines
+
+    /**
+     * @brief Per-worker state, reused for every record
+     */
+    struct Worker {
+        std::vector<std::byte> initialBuffer;
+        std::pmr::monotonic_buffer_resource arena;
+        ExpressionCompiler compiler;
+        std::string output; // Result lines of the current block
+
+        Worker() : initialBuffer(ARENA_BYTES), arena(initialBuffer.data(), initialBuffer.size()) {}
+    };
+
+    /**
+     * @brief Where the result line of a record was written
+     */
+    struct Slot {
+        uint32_t worker;
+        size_t offset;
+        size_t length;
+    };
+
+    Framing framing;
+    WorkStealingPool& pool;
+    std::vector<std::unique_ptr<Worker>> workers;
+
+    static void appendNumber(std::string& out, uint64_t value) {
+        char digits[24];
+        auto end = std::to_chars(digits, digits + sizeof(digits), value).ptr;
+        out.append(digits, static_cast<size_t>(end - digits));
+    }
+
+    /**
+     * @brief Checks one record and appends its result line
+     */
+    static void checkRecord(std::string_view record, uint64_t number, Worker& worker) {
+        Instrumentation::Scope timer(Instrumentation::Phase::NONE, "record");
+        std::string& out = worker.output;
+        appendNumber(out, number);
+        try {
+            std::pmr::memory_resource* arena = &worker.arena;
+            SymbolTable symbols(arena);
+            std::pmr::vector<CompiledExpression> premises(arena);
+
+            size_t arrow = record.find("=>");
+            std::string_view premiseText = record.substr(0, arrow);
+            while (!premiseText.empty()) {
+                size_t end = premiseText.find_first_of(";\n");
+                std::string_view premise = premiseText.substr(0, end);
+                premiseText = end == std::string_view::npos ? std::string_view() : premiseText.substr(end + 1);
+                if (premise.find_first_not_of(" \t\r") == std::string_view::npos) continue;
+                premises.push_back(worker.compiler.compile(premise, symbols, arena));
+            }
+            CompiledExpression conclusion = arrow == std::string_view::npos
+                ? CompiledExpression::constant(true, arena)
+                : worker.compiler.compile(record.substr(arrow + 2), symbols, arena);
+
+            const size_t n = symbols.size();
+            if (n > MAX_VARIABLES) {
+                throw std::runtime_error("Too many variables for batch mode (at most " + std::to_string(MAX_VARIABLES) + ")");
+            }
+
+            // Number the variables alphabetically, as the truth table columns would be
+            std::pmr::vector<uint32_t> sorted(n, arena);
+            for (uint32_t id = 0; id < n; ++id) sorted[id] = id;
+            std::sort(sorted.begin(), sorted.end(), [&](uint32_t a, uint32_t b) { return symbols.name(a) < symbols.name(b); });
+            std::pmr::vector<uint32_t> newSlot(n, arena);
+            for (uint32_t slot = 0; slot < n; ++slot) newSlot[sorted[slot]] = slot;
+            size_t depth = conclusion.maxStackDepth;
+            for (auto& premise : premises) {
+                premise.remapSlots(newSlot);
+                depth = std::max(depth, premise.maxStackDepth);
+            }
+            conclusion.remapSlots(newSlot);
+
+            // Bit-sliced sweep, 64 rows per pass over the programs
+            Instrumentation::Scope sweepTimer(Instrumentation::Phase::EVALUATE);
+            std::pmr::vector<uint64_t> values(n, arena);
+            std::pmr::vector<uint64_t> stack(depth + 1, arena);
+            const uint64_t words = n <= 6 ? 1 : uint64_t{1} << (n - 6);
+            const uint64_t mask = n >= 6 ? ~0ull : (uint64_t{1} << (uint64_t{1} << n)) - 1;
+            AnalysisResult result;
+            for (uint64_t w = 0; w < words; ++w) {
+                for (size_t j = 0; j < n; ++j) values[j] = BitSlicedEvaluator::variableWord(j, w);
+                uint64_t critical = mask;
+                for (const auto& premise : premises) {
+                    premise.execute(values.data(), stack.data());
+                    critical &= stack[0];
+                }
+                conclusion.execute(values.data(), stack.data());
+                result.addWord(w, critical, critical & ~stack[0]);
+            }
+            if (Instrumentation::enabled()) {
+                size_t operators = conclusion.operatorCount();
+                for (const auto& premise : premises) operators += premise.operatorCount();
+                Instrumentation::add(Instrumentation::Counter::ROWS_EVALUATED, words * BitOps::popcount(mask));
+                Instrumentation::add(Instrumentation::Counter::OPERATORS_APPLIED, words * operators);
+            }
+
+            out += result.isValid ? " valid" : " invalid";
+            out += result.isSatisfiable ? " satisfiable " : " unsatisfiable ";
+            appendNumber(out, result.criticalRows);
+            if (!result.isValid) {
+                out += " counterexample=";
+                for (uint32_t slot = 0; slot < n; ++slot) {
+                    if (slot) out += ',';
+                    out += symbols.name(sorted[slot]);
+                    out += ((result.firstCounterexample >> slot) & 1) ? ":1" : ":0";
+                }
+            }
+        } catch (const std::exception& e) {
+            out += " error ";
+            for (const char* c = e.what(); *c; ++c) out += (*c == '\n' ? ' ' : *c); // Keep one line per record
+        }
+        out += '\n';
+        worker.arena.release(); // Back to the initial buffer for the next record
+    }
+
+    /**
+     * @brief Reads whatever input is available, returns 0 at the end of the input
+     */
+    static size_t readSome(FILE* in, char* data, size_t size) {
+#ifndef _WIN32
+        for (;;) {
+            ssize_t count = ::read(fileno(in), data, size); // Returns early on pipes, so answers are not held back
+            if (count >= 0) return static_cast<size_t>(count);
+            if (errno != EINTR) throw std::runtime_error("Cannot read the batch input");
+        }
+#else
+        return std::fread(data, 1, size, in);
+#endif
+    }
+
+    /**
+     * @brief Splits the complete records off the front of the input
+     * @param atEnd No more input will come, so an unterminated last line is a record.
+     * @return Number of bytes consumed.
+     */
+    size_t splitRecords(std::string_view input, bool atEnd, std::vector<std::string_view>& records) const {
+        size_t pos = 0;
+        if (framing == Framing::LINES) {
+            while (pos < input.size()) {
+                size_t end = input.find('\n', pos);
+                if ((end == std::string_view::npos ? input.size() : end) - pos > MAX_RECORD_BYTES) {
+                    throw std::runtime_error("Record longer than " + std::to_string(MAX_RECORD_BYTES) + " bytes");
+                }
+                if (end == std::string_view::npos) {
+                    if (!atEnd) break;
+                    end = input.size();
+                }
+                std::string_view line = input.substr(pos, end - pos);
+                pos = std::min(end + 1, input.size());
+                if (!line.empty() && line.back() == '\r') line.remove_suffix(1);
+                if (line.find_first_not_of(" \t") != std::string_view::npos) records.push_back(line);
+            }
+            return pos;
+        }
+        while (input.size() - pos >= 4) {
+            const unsigned char* header = reinterpret_cast<const unsigned char*>(input.data() + pos);
+            size_t length = size_t{header[0]} | size_t{header[1]} << 8 | size_t{header[2]} << 16 | size_t{header[3]} << 24;
+            if (length > MAX_RECORD_BYTES) {
+                throw std::runtime_error("Length-prefixed record of " + std::to_string(length) + " bytes, at most " +
+                                         std::to_string(MAX_RECORD_BYTES) + " are allowed");
+            }
+            if (input.size() - pos - 4 < length) break;
+            records.push_back(input.substr(pos + 4, length));
+            pos += 4 + length;
+        }
+        if (atEnd && pos < input.size()) throw std::runtime_error("Truncated length-prefixed record at the end of the input");
+        return pos;
+    }
+
+public:
+    /**
+     * @param f How records are delimited.
+     * @param p The workers to check records on.
+     */
+    BatchChecker(Framing f, WorkStealingPool& p) : framing(f), pool(p) {
+        for (size_t i = 0; i < pool.size(); ++i) workers.push_back(std::make_unique<Worker>());
+    }
+
+    /**
+     * @brief Checks every record of the input until it ends
+     * @return Number of records checked.
+     */
+    uint64_t run(FILE* in, FILE* out) {
+        OutputBuffer output(out);
+        std::vector<char> buffer(size_t{1} << 20);
+        size_t filled = 0;
+        std::vector<std::string_view> records;
+        std::vector<Slot> slots;
+        uint64_t checked = 0;
+
+        for (bool atEnd = false; !atEnd;) {
+            if (filled == buffer.size()) { // A record larger than the buffer, splitRecords bounds its size
+                buffer.resize(buffer.size() * 2);
+            }
+            size_t count = readSome(in, buffer.data() + filled, buffer.size() - filled);
+            atEnd = count == 0;
+            filled += count;
+
+            records.clear();
+            size_t consumed = splitRecords(std::string_view(buffer.data(), filled), atEnd, records);
+            if (!records.empty()) {
+                for (auto& worker : workers) worker->output.clear();
+                slots.resize(records.size());
+                const uint64_t first = checked + 1;
+                pool.run(records.size(), [&](size_t index, size_t w) {
+                    Worker& worker = *workers[w];
+                    size_t offset = worker.output.size();
+                    checkRecord(records[index], first + index, worker);
+                    slots[index] = {static_cast<uint32_t>(w), offset, worker.output.size() - offset};
+                });
+                for (const Slot& slot : slots) {
+                    output.write(workers[slot.worker]->output.data() + slot.offset, slot.length);
+                }
+                output.flush(); // Answer every block as soon as it is done
+                checked += records.size();
+            }
+            std::memmove(buffer.data(), buffer.data() + consumed, filled - consumed);
+            filled -= consumed;
+        }
+        return checked;
+    }
+};
+
+#endif // LOGIC_BATCH_CHECKER_HPP
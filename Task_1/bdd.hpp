@@ -0,0 +1,420 @@
+/**
+ * @file bdd.hpp
+ * @brief Reduced ordered binary decision diagrams with sifting.
+ */
+
+#ifndef LOGIC_BDD_HPP
+#define LOGIC_BDD_HPP
+
+#include "common.hpp"
+#include "expression.hpp"
+#include "evaluation.hpp"
+#include "big_unsigned.hpp"
+
+/**
+ * @class BddManager
+ * @brief A reduced ordered binary decision diagram (ROBDD) package.
+ *
+ * Nodes are hash-consed in one unique table per variable, so equal functions are the same node and
+ * equivalence is a comparison of node ids. All operations go through ITE (if-then-else) with a
+ * direct-mapped computed cache. Callers protect the nodes they keep with ref()/deref(); everything
+ * else is reclaimed by collectGarbage(), which must only run between top-level operations.
+ *
+ * The variable order can be given up front and improved afterwards by sifting: every variable is
+ * moved through all levels by in-place swaps of adjacent levels and left where the diagrams were
+ * smallest. A swap rewrites nodes in place, so node ids keep denoting the same functions.
+ */
+class BddManager {
+public:
+    static constexpr uint32_t FALSE_NODE = 0;
+    static constexpr uint32_t TRUE_NODE = 1;
+
+private:
+    static constexpr uint32_t TERMINAL = std::numeric_limits<uint32_t>::max(); // Variable of the terminals
+    static constexpr uint32_t FREE = TERMINAL - 1; // Variable of reclaimed nodes
+
+    struct Node {
+        uint32_t variable;
+        uint32_t low; // Cofactor for variable = false
+        uint32_t high; // Cofactor for variable = true
+    };
+
+    struct CacheEntry {
+        uint32_t f = TERMINAL;
+        uint32_t g = 0;
+        uint32_t h = 0;
+        uint32_t result = 0;
+    };
+
+    std::vector<Node> nodes;
+    std::vector<uint32_t> freeNodes;
+    std::vector<uint32_t> references; // External references of each node
+    std::vector<std::unordered_map<uint64_t, uint32_t>> uniqueTables; // Per variable: (low, high) -> node
+    std::vector<uint32_t> levelOf; // Level of each variable, level 0 is the root
+    std::vector<uint32_t> variableAt; // Variable at each level
+    std::vector<CacheEntry> cache;
+
+    size_t liveNodes = 0; // Internal nodes currently allocated, including garbage
+    size_t peakNodes = 0;
+    size_t collectThreshold = size_t{1} << 16; // Live nodes that trigger a collection in build()
+    size_t siftThreshold = size_t{1} << 12; // Live nodes after a collection that trigger sifting in build()
+    bool autoSift = false;
+    const Budget* timeBudget = &Budget::unlimited();
+    uint64_t cacheLookups = 0;
+    uint64_t cacheHits = 0;
+
+    static uint64_t childKey(uint32_t low, uint32_t high) {
+        return (uint64_t{low} << 32) | high;
+    }
+
+    uint32_t levelOfNode(uint32_t node) const {
+        uint32_t variable = nodes[node].variable;
+        return variable == TERMINAL ? static_cast<uint32_t>(variableAt.size()) : levelOf[variable];
+    }
+
+    /**
+     * @brief Returns the unique node (variable, low, high), creating it if needed
+     */
+    uint32_t makeNode(uint32_t variable, uint32_t low, uint32_t high) {
+        if (low == high) return low;
+        auto& table = uniqueTables[variable];
+        auto found = table.find(childKey(low, high));
+        if (found != table.end()) return found->second;
+
+        uint32_t index;
+        if (!freeNodes.empty()) {
+            index = freeNodes.back();
+            freeNodes.pop_back();
+            nodes[index] = {variable, low, high};
+        } else {
+            index = static_cast<uint32_t>(nodes.size());
+            nodes.push_back({variable, low, high});
+            references.push_back(0);
+        }
+        table.emplace(childKey(low, high), index);
+        peakNodes = std::max(peakNodes, ++liveNodes);
+        if ((liveNodes & 4095) == 0) timeBudget->check();
+        return index;
+    }
+
+    /**
+     * @brief Marks every node reachable from a referenced node
+     */
+    std::vector<uint8_t> markReachable() const {
+        std::vector<uint8_t> marked(nodes.size(), 0);
+        std::vector<uint32_t> pending;
+        for (uint32_t i = 2; i < nodes.size(); ++i) {
+            if (references[i] > 0 && nodes[i].variable != FREE) pending.push_back(i);
+        }
+        while (!pending.empty()) {
+            uint32_t node = pending.back();
+            pending.pop_back();
+            if (node < 2 || marked[node]) continue;
+            marked[node] = 1;
+            pending.push_back(nodes[node].low);
+            pending.push_back(nodes[node].high);
+        }
+        return marked;
+    }
+
+    /**
+     * @brief Swaps the variables at levels level and level + 1
+     */
+    void swapLevels(uint32_t level) {
+        uint32_t x = variableAt[level];
+        uint32_t y = variableAt[level + 1];
+
+        std::vector<uint32_t> xNodes;
+        xNodes.reserve(uniqueTables[x].size());
+        for (const auto& entry : uniqueTables[x]) xNodes.push_back(entry.second);
+
+        for (uint32_t f : xNodes) {
+            uint32_t f0 = nodes[f].low;
+            uint32_t f1 = nodes[f].high;
+            bool low0IsY = nodes[f0].variable == y;
+            bool high1IsY = nodes[f1].variable == y;
+            if (!low0IsY && !high1IsY) continue; // Does not depend on y, only its level changes
+
+            uint32_t f00 = low0IsY ? nodes[f0].low : f0;
+            uint32_t f01 = low0IsY ? nodes[f0].high : f0;
+            uint32_t f10 = high1IsY ? nodes[f1].low : f1;
+            uint32_t f11 = high1IsY ? nodes[f1].high : f1;
+
+            uniqueTables[x].erase(childKey(f0, f1));
+            uint32_t g0 = makeNode(x, f00, f10);
+            uint32_t g1 = makeNode(x, f01, f11);
+            nodes[f] = {y, g0, g1};
+            uniqueTables[y].emplace(childKey(g0, g1), f);
+        }
+
+        std::swap(variableAt[level], variableAt[level + 1]);
+        levelOf[x] = level + 1;
+        levelOf[y] = level;
+    }
+
+public:
+    /**
+     * @brief Constructor
+     * @param variableCount Number of variables.
+     * @param order Variables from the root level down, the identity order if empty.
+     */
+    explicit BddManager(size_t variableCount, const std::vector<uint32_t>& order = {})
+        : uniqueTables(variableCount), levelOf(variableCount), variableAt(variableCount), cache(size_t{1} << 18) {
+        nodes.push_back({TERMINAL, FALSE_NODE, FALSE_NODE});
+        nodes.push_back({TERMINAL, TRUE_NODE, TRUE_NODE});
+        references.assign(2, 0);
+        for (uint32_t level = 0; level < variableCount; ++level) {
+            variableAt[level] = order.empty() ? level : order[level];
+            levelOf[variableAt[level]] = level;
+        }
+    }
+
+    /**
+     * @brief The function that is true exactly when the variable is true
+     */
+    uint32_t variable(uint32_t var) {
+        return makeNode(var, FALSE_NODE, TRUE_NODE);
+    }
+
+    /**
+     * @brief If f then g else h
+     */
+    uint32_t ite(uint32_t f, uint32_t g, uint32_t h) {
+        if (f == TRUE_NODE) return g;
+        if (f == FALSE_NODE) return h;
+        if (g == h) return g;
+        if (g == TRUE_NODE && h == FALSE_NODE) return f;
+
+        const size_t slot = (f * 0x9E3779B1u ^ g * 0x85EBCA77u ^ h * 0xC2B2AE3Du) & (cache.size() - 1);
+        ++cacheLookups;
+        if (cache[slot].f == f && cache[slot].g == g && cache[slot].h == h) {
+            ++cacheHits;
+            return cache[slot].result;
+        }
+
+        uint32_t top = std::min(levelOfNode(f), std::min(levelOfNode(g), levelOfNode(h)));
+        uint32_t var = variableAt[top];
+        uint32_t f0 = levelOfNode(f) == top ? nodes[f].low : f, f1 = levelOfNode(f) == top ? nodes[f].high : f;
+        uint32_t g0 = levelOfNode(g) == top ? nodes[g].low : g, g1 = levelOfNode(g) == top ? nodes[g].high : g;
+        uint32_t h0 = levelOfNode(h) == top ? nodes[h].low : h, h1 = levelOfNode(h) == top ? nodes[h].high : h;
+
+        uint32_t high = ite(f1, g1, h1);
+        uint32_t low = ite(f0, g0, h0);
+        uint32_t result = makeNode(var, low, high);
+        cache[slot] = {f, g, h, result};
+        return result;
+    }
+
+    uint32_t negate(uint32_t f) { return ite(f, FALSE_NODE, TRUE_NODE); }
+    uint32_t conjoin(uint32_t f, uint32_t g) { return ite(f, g, FALSE_NODE); }
+    uint32_t disjoin(uint32_t f, uint32_t g) { return ite(f, TRUE_NODE, g); }
+    uint32_t implies(uint32_t f, uint32_t g) { return ite(f, g, TRUE_NODE); }
+    uint32_t equivalent(uint32_t f, uint32_t g) { return ite(f, g, negate(g)); }
+
+    void ref(uint32_t node) { ++references[node]; }
+    void deref(uint32_t node) { --references[node]; }
+
+    /**
+     * @brief Reclaims every node not reachable from a referenced node and clears the computed cache
+     */
+    void collectGarbage() {
+        std::vector<uint8_t> marked = markReachable();
+        for (uint32_t var = 0; var < uniqueTables.size(); ++var) {
+            auto& table = uniqueTables[var];
+            for (auto it = table.begin(); it != table.end();) {
+                if (!marked[it->second]) {
+                    nodes[it->second].variable = FREE;
+                    freeNodes.push_back(it->second);
+                    --liveNodes;
+                    it = table.erase(it);
+                } else {
+                    ++it;
+                }
+            }
+        }
+        std::fill(cache.begin(), cache.end(), CacheEntry());
+    }
+
+    /**
+     * @brief Number of internal nodes reachable from referenced nodes
+     */
+    size_t reachableNodes() const {
+        std::vector<uint8_t> marked = markReachable();
+        return static_cast<size_t>(std::count(marked.begin(), marked.end(), 1));
+    }
+
+    /**
+     * @brief Reorders the variables by sifting to reduce the size of the referenced diagrams
+     * @param maxGrowth A variable stops moving in one direction once the size exceeds this factor of the best size.
+     */
+    void sift(double maxGrowth = 1.2) {
+        collectGarbage();
+        const uint32_t levels = static_cast<uint32_t>(variableAt.size());
+        if (levels < 2) return;
+
+        // Sift the variables with the most nodes first
+        std::vector<uint32_t> order(levels);
+        for (uint32_t i = 0; i < levels; ++i) order[i] = i;
+        std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+            return uniqueTables[a].size() > uniqueTables[b].size();
+        });
+
+        for (uint32_t var : order) {
+            size_t best = reachableNodes();
+            uint32_t bestLevel = levelOf[var];
+
+            // Move towards the closer end first, then all the way to the other end
+            bool downFirst = levelOf[var] >= levels / 2;
+            for (int pass = 0; pass < 2; ++pass) {
+                bool down = (pass == 0) == downFirst;
+                while (down ? levelOf[var] + 1 < levels : levelOf[var] > 0) {
+                    swapLevels(down ? levelOf[var] : levelOf[var] - 1);
+                    size_t size = reachableNodes();
+                    if (size < best) {
+                        best = size;
+                        bestLevel = levelOf[var];
+                    } else if (size > best * maxGrowth) {
+                        break;
+                    }
+                }
+            }
+            while (levelOf[var] < bestLevel) swapLevels(levelOf[var]);
+            while (levelOf[var] > bestLevel) swapLevels(levelOf[var] - 1);
+            collectGarbage();
+        }
+    }
+
+    /**
+     * @brief Enables sifting whenever the diagrams grow past twice their size after the last sifting
+     */
+    void setAutoSift(bool enabled) {
+        autoSift = enabled;
+    }
+
+    /**
+     * @brief Makes building throw Budget::Exceeded once the time limit has passed; the budget must outlive the manager
+     */
+    void setBudget(const Budget& limit) {
+        timeBudget = &limit;
+    }
+
+    /**
+     * @brief Collects garbage, and sifts if enabled, once enough nodes have been allocated
+     *
+     * Only call this between top-level operations, when every node still needed is referenced.
+     */
+    void maybeCollect() {
+        if (liveNodes < collectThreshold) return;
+        collectGarbage();
+        if (autoSift && liveNodes > siftThreshold) {
+            sift();
+            siftThreshold = 2 * liveNodes;
+        }
+        collectThreshold = std::max(collectThreshold, 2 * liveNodes);
+    }
+
+    /**
+     * @brief Builds the diagram of a compiled expression; variable slot j is BDD variable j
+     */
+    uint32_t build(const CompiledExpression& expression) {
+        std::vector<uint32_t> stack;
+        stack.reserve(expression.maxStackDepth);
+        for (const auto& ins : expression.code) {
+            if (ins.op == CompiledExpression::OpCode::LOAD) {
+                stack.push_back(variable(ins.slot));
+                ref(stack.back());
+                continue;
+            }
+            if (ins.op == CompiledExpression::OpCode::CONSTANT) {
+                stack.push_back(ins.slot ? TRUE_NODE : FALSE_NODE);
+                ref(stack.back());
+                continue;
+            }
+            uint32_t result;
+            if (ins.op == CompiledExpression::OpCode::NOT) {
+                result = negate(stack.back());
+            } else {
+                uint32_t a = stack[stack.size() - 2];
+                uint32_t b = stack.back();
+                switch (ins.op) {
+                case CompiledExpression::OpCode::AND:     result = conjoin(a, b); break;
+                case CompiledExpression::OpCode::OR:      result = disjoin(a, b); break;
+                case CompiledExpression::OpCode::IMPLIES: result = implies(a, b); break;
+                default:                                  result = equivalent(a, b); break;
+                }
+                deref(b);
+                stack.pop_back();
+            }
+            ref(result);
+            deref(stack.back());
+            stack.back() = result;
+            maybeCollect();
+        }
+        deref(stack.back()); // The caller decides whether to keep it
+        return stack.back();
+    }
+
+    /**
+     * @brief Number of assignments of all variables for which f is true
+     */
+    BigUnsigned satCount(uint32_t f) const {
+        const uint32_t levels = static_cast<uint32_t>(variableAt.size());
+        // count[node]: satisfying assignments of the variables from the node's level down
+        std::unordered_map<uint32_t, BigUnsigned> count;
+        std::function<BigUnsigned(uint32_t)> countOf = [&](uint32_t node) -> BigUnsigned {
+            if (node == FALSE_NODE) return BigUnsigned(0);
+            if (node == TRUE_NODE) return BigUnsigned(1);
+            auto found = count.find(node);
+            if (found != count.end()) return found->second;
+            uint32_t level = levelOfNode(node);
+            BigUnsigned low = countOf(nodes[node].low) << (levelOfNode(nodes[node].low) - level - 1);
+            BigUnsigned high = countOf(nodes[node].high) << (levelOfNode(nodes[node].high) - level - 1);
+            return count[node] = low + high;
+        };
+        return countOf(f) << (f < 2 ? levels : levelOfNode(f));
+    }
+
+    /**
+     * @brief Finds the satisfying assignment of f with the lowest row number, variable j being bit j
+     * @return False if f is unsatisfiable.
+     */
+    bool lowestAssignment(uint32_t f, std::vector<bool>& assignment) {
+        if (f == FALSE_NODE) return false;
+        assignment.assign(variableAt.size(), false);
+        // Decide the most significant variable first, preferring false
+        for (size_t var = variableAt.size(); var-- > 0;) {
+            uint32_t restricted = restrict(f, static_cast<uint32_t>(var), false);
+            if (restricted == FALSE_NODE) {
+                restricted = restrict(f, static_cast<uint32_t>(var), true);
+                assignment[var] = true;
+            }
+            f = restricted;
+        }
+        return true;
+    }
+
+    /**
+     * @brief The cofactor of f for var = value
+     */
+    uint32_t restrict(uint32_t f, uint32_t var, bool value) {
+        std::unordered_map<uint32_t, uint32_t> memo;
+        std::function<uint32_t(uint32_t)> walk = [&](uint32_t node) -> uint32_t {
+            if (node < 2 || levelOfNode(node) > levelOf[var]) return node;
+            if (nodes[node].variable == var) return value ? nodes[node].high : nodes[node].low;
+            auto found = memo.find(node);
+            if (found != memo.end()) return found->second;
+            uint32_t low = walk(nodes[node].low);
+            uint32_t high = walk(nodes[node].high);
+            return memo[node] = makeNode(nodes[node].variable, low, high);
+        };
+        return walk(f);
+    }
+
+    size_t peakNodeCount() const { return peakNodes; }
+    size_t liveNodeCount() const { return liveNodes; }
+    uint64_t cacheLookupCount() const { return cacheLookups; }
+    uint64_t cacheHitCount() const { return cacheHits; }
+    const std::vector<uint32_t>& order() const { return variableAt; }
+};
+
+#endif // LOGIC_BDD_HPP
@@ -0,0 +1,364 @@
+/**
+ * @file bench.cpp
+ * @brief Benchmarks of the tokenizers, the reference evaluator and truth table generation.
+ *
+ * Every case runs one workload on a generated formula with a given number of variables and nodes
+ * until a minimum time has passed, and reports rows per second, nanoseconds per row and heap
+ * allocations per row. A row is one truth table row for the evaluate and generate workloads and one
+ * tokenized formula for the tokenize and lex workloads. Before a formula is lexed, the tokens of
+ * FastLexer are checked against the reference tokenizer on every instruction set the CPU supports.
+ *
+ * Usage:
+ *     logic_bench [--quick] [--filter=TEXT] [--min-time=SECONDS] [--output=FILE]
+ *                 [--baseline=FILE] [--tolerance=PERCENT]
+ *
+ * The results are written as JSON to the output file (standard output by default). With a baseline,
+ * which is the JSON of an earlier run, every case is compared by nanoseconds per row and the exit
+ * status is 1 if any case is slower than the tolerance allows.
+ */
+
+#include "expression.hpp"
+#include "evaluation.hpp"
+#include "table_sink.hpp"
+#include "truth_table_generator.hpp"
+#include "allocation_counter.hpp"
+
+#include <chrono>
+#include <sstream>
+
+namespace {
+
+/**
+ * @brief A formula of the benchmark and the names of its variables
+ */
+struct BenchFormula {
+    std::string text;
+    std::vector<std::string> variables;
+    size_t nodes = 0; // Variables, operators and negations
+};
+
+/**
+ * @brief Builds a balanced formula over variables x0..x{n-1} with about the requested number of nodes.
+ *
+ * Leaves use the variables round robin, so every variable appears once there are enough leaves; the
+ * formula grows to 2n - 1 nodes if fewer are requested. Every seventh leaf is negated and the binary
+ * operators cycle through &, |, -> and <->.
+ */
+BenchFormula makeFormula(size_t variableCount, size_t nodes) {
+    BenchFormula formula;
+    for (size_t j = 0; j < variableCount; ++j) formula.variables.push_back("x" + std::to_string(j));
+
+    size_t leaves = std::max((nodes + 1) / 2, variableCount);
+    static const char* const operators[] = {" & ", " | ", " -> ", " <-> "};
+    size_t operatorIndex = 0;
+
+    std::function<void(size_t, size_t)> build = [&](size_t first, size_t last) {
+        if (last - first == 1) {
+            if (first % 7 == 6) {
+                formula.text += '~';
+                ++formula.nodes;
+            }
+            formula.text += formula.variables[first % variableCount];
+            ++formula.nodes;
+            return;
+        }
+        size_t middle = first + (last - first) / 2;
+        formula.text += '(';
+        build(first, middle);
+        formula.text += operators[operatorIndex++ % 4];
+        build(middle, last);
+        formula.text += ')';
+        ++formula.nodes;
+    };
+    build(0, leaves);
+    return formula;
+}
+
+/**
+ * @brief Checks that FastLexer produces the tokens of the reference tokenizer, with every supported instruction set
+ * @throws std::runtime_error On the first difference.
+ */
+void checkLexer(const std::string& text) {
+    ExpressionTokenizer tokenizer;
+    auto expected = tokenizer.tokenize(text);
+    for (FastLexer::Isa isa : {FastLexer::Isa::SCALAR, FastLexer::Isa::AVX2, FastLexer::Isa::AVX512}) {
+        if (isa == FastLexer::Isa::AVX512 && FastLexer::detectIsa() != FastLexer::Isa::AVX512) continue;
+        if (isa == FastLexer::Isa::AVX2 && FastLexer::detectIsa() == FastLexer::Isa::SCALAR) continue;
+        FastLexer::Tokens tokens = FastLexer::lex(text, std::pmr::get_default_resource(), isa);
+        bool same = tokens.size() == expected.size();
+        for (size_t i = 0; same && i < tokens.size(); ++i) {
+            ExpressionTokenizer::Token token = FastLexer::expand(text, tokens[i]);
+            same = token.type == expected[i].type && token.value == expected[i].value &&
+                   token.text.data() == expected[i].text.data() && token.text.size() == expected[i].text.size();
+        }
+        if (!same) throw std::runtime_error("FastLexer differs from the reference tokenizer");
+    }
+}
+
+/**
+ * @brief Table sink that discards every row
+ */
+class NullTableSink : public TableSink {
+public:
+    void begin(const std::vector<std::string>&, size_t, uint64_t) override {}
+    void writeWord(uint64_t, uint64_t, const uint64_t*, uint64_t, uint64_t) override {}
+    void end() override {}
+};
+
+/**
+ * @brief Stream buffer that discards everything, used to silence the printed analysis
+ */
+class NullStreamBuffer : public std::streambuf {
+protected:
+    int overflow(int c) override { return c; }
+    std::streamsize xsputn(const char*, std::streamsize count) override { return count; }
+};
+
+/**
+ * @brief Measurement of one case
+ */
+struct BenchResult {
+    std::string name;
+    std::string workload;
+    size_t variables = 0;
+    size_t nodes = 0;
+    uint64_t rows = 0;
+    uint64_t allocations = 0;
+    double seconds = 0;
+
+    double rowsPerSecond() const { return seconds > 0 ? rows / seconds : 0; }
+    double nsPerRow() const { return rows ? seconds * 1e9 / rows : 0; }
+    double allocationsPerRow() const { return rows ? static_cast<double>(allocations) / rows : 0; }
+};
+
+/**
+ * @brief Runs a step repeatedly until the minimum time has passed.
+ * @param step Runs once and returns the number of rows it processed.
+ */
+template <typename Step>
+void measure(BenchResult& result, double minSeconds, Step step) {
+    step(); // Warm up caches and let the containers reach their steady size
+
+    using Clock = std::chrono::steady_clock;
+    uint64_t allocationsBefore = allocationCount.load(std::memory_order_relaxed);
+    Clock::time_point start = Clock::now();
+    do {
+        result.rows += step();
+        result.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    } while (result.seconds < minSeconds);
+    result.allocations = allocationCount.load(std::memory_order_relaxed) - allocationsBefore;
+}
+
+struct BenchOptions {
+    bool quick = false;
+    std::string filter;
+    double minSeconds = 0.2;
+    std::string outputPath;
+    std::string baselinePath;
+    double tolerancePercent = 10;
+    double maxWork = 2147483648.0; // Largest words * nodes of a generate case
+};
+
+BenchOptions parseBenchOptions(int argc, char* argv[]) {
+    BenchOptions options;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto value = [&](const char* prefix) -> const char* {
+            size_t length = std::strlen(prefix);
+            return arg.compare(0, length, prefix) == 0 ? argv[i] + length : nullptr;
+        };
+        if (arg == "--quick") {
+            options.quick = true;
+            options.minSeconds = 0.05;
+        } else if (const char* v = value("--filter=")) {
+            options.filter = v;
+        } else if (const char* v = value("--min-time=")) {
+            options.minSeconds = std::atof(v);
+        } else if (const char* v = value("--output=")) {
+            options.outputPath = v;
+        } else if (const char* v = value("--baseline=")) {
+            options.baselinePath = v;
+        } else if (const char* v = value("--tolerance=")) {
+            options.tolerancePercent = std::atof(v);
+        } else {
+            throw std::runtime_error("Unknown option '" + arg + "'");
+        }
+    }
+    return options;
+}
+
+std::string escapeJson(const std::string& text) {
+    std::string escaped;
+    for (char c : text) {
+        if (c == '"' || c == '\\') escaped += '\\';
+        escaped += c;
+    }
+    return escaped;
+}
+
+void writeJson(std::ostream& out, const std::vector<BenchResult>& results) {
+    out << "{\n"
+        << "  \"benchmark\": \"logic-analyzer\",\n"
+        << "  \"isa\": \"" << BitSlicedEvaluator::isaName(BitSlicedEvaluator::detectIsa()) << "\",\n"
+#if defined(__VERSION__)
+        << "  \"compiler\": \"" << escapeJson(__VERSION__) << "\",\n"
+#endif
+        << "  \"results\": [\n";
+    out << std::setprecision(6);
+    for (size_t i = 0; i < results.size(); ++i) {
+        const BenchResult& r = results[i];
+        out << "    {\"name\": \"" << r.name << "\", \"workload\": \"" << r.workload
+            << "\", \"variables\": " << r.variables << ", \"nodes\": " << r.nodes
+            << ", \"rows\": " << r.rows << ", \"seconds\": " << r.seconds
+            << ", \"rows_per_sec\": " << r.rowsPerSecond() << ", \"ns_per_row\": " << r.nsPerRow()
+            << ", \"allocations_per_row\": " << r.allocationsPerRow() << "}"
+            << (i + 1 < results.size() ? ",\n" : "\n");
+    }
+    out << "  ]\n}\n";
+}
+
+/**
+ * @brief Reads the nanoseconds per row of every case of an earlier run.
+ *
+ * Only the "name" and "ns_per_row" fields are needed, so this scans for them instead of parsing
+ * general JSON; it reads exactly what writeJson writes.
+ */
+std::map<std::string, double> readBaseline(const std::string& path) {
+    std::ifstream file(path);
+    if (!file) throw std::runtime_error("Cannot open baseline '" + path + "'");
+    std::stringstream content;
+    content << file.rdbuf();
+    const std::string text = content.str();
+
+    std::map<std::string, double> baseline;
+    const std::string nameKey = "\"name\": \"";
+    const std::string timeKey = "\"ns_per_row\": ";
+    for (size_t pos = text.find(nameKey); pos != std::string::npos; pos = text.find(nameKey, pos)) {
+        pos += nameKey.size();
+        size_t nameEnd = text.find('"', pos);
+        size_t next = text.find(nameKey, pos);
+        size_t timePos = text.find(timeKey, pos);
+        if (nameEnd == std::string::npos || timePos == std::string::npos || timePos > next) {
+            throw std::runtime_error("Malformed baseline '" + path + "'");
+        }
+        baseline[text.substr(pos, nameEnd - pos)] = std::atof(text.c_str() + timePos + timeKey.size());
+    }
+    return baseline;
+}
+
+/**
+ * @brief Prints every case next to its baseline and counts the regressions
+ */
+size_t compareWithBaseline(const std::vector<BenchResult>& results, const std::map<std::string, double>& baseline,
+                           double tolerancePercent) {
+    size_t regressions = 0;
+    std::cerr << "\n" << std::left << std::setw(28) << "case" << std::right << std::setw(14) << "ns/row"
+              << std::setw(14) << "baseline" << std::setw(10) << "change" << "\n";
+    for (const BenchResult& r : results) {
+        auto found = baseline.find(r.name);
+        std::cerr << std::left << std::setw(28) << r.name << std::right << std::fixed << std::setprecision(2)
+                  << std::setw(14) << r.nsPerRow();
+        if (found == baseline.end() || found->second <= 0) {
+            std::cerr << std::setw(14) << "-" << "\n";
+            continue;
+        }
+        double change = (r.nsPerRow() / found->second - 1) * 100;
+        bool regressed = change > tolerancePercent;
+        regressions += regressed;
+        std::cerr << std::setw(14) << found->second << std::setw(9) << std::showpos << change << std::noshowpos
+                  << "%" << (regressed ? Colors::RED + "  slower" + Colors::RESET : "") << "\n";
+    }
+    std::cerr << std::defaultfloat;
+    return regressions;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    try {
+        BenchOptions options = parseBenchOptions(argc, argv);
+
+        const std::vector<size_t> variableCounts = options.quick ? std::vector<size_t>{2, 8, 16, 20}
+                                                                 : std::vector<size_t>{2, 4, 8, 12, 16, 20, 24, 30};
+        const std::vector<size_t> nodeCounts = options.quick ? std::vector<size_t>{10, 1000}
+                                                             : std::vector<size_t>{10, 100, 1000, 10000, 100000};
+
+        std::vector<BenchResult> results;
+        auto run = [&](const std::string& workload, const BenchFormula& formula, size_t variables, size_t nodes,
+                       auto step) {
+            BenchResult result;
+            result.name = workload + "/v" + std::to_string(variables) + "/n" + std::to_string(nodes);
+            if (!options.filter.empty() && result.name.find(options.filter) == std::string::npos) return;
+            result.workload = workload;
+            result.variables = variables;
+            result.nodes = formula.nodes;
+            std::cerr << result.name << "..." << std::flush;
+            measure(result, options.minSeconds, step);
+            std::cerr << " " << std::fixed << std::setprecision(2) << result.nsPerRow() << " ns/row\n"
+                      << std::defaultfloat;
+            results.push_back(result);
+        };
+
+        for (size_t nodes : nodeCounts) {
+            for (size_t variables : variableCounts) {
+                BenchFormula formula = makeFormula(variables, nodes);
+
+                ExpressionTokenizer tokenizer;
+                run("tokenize", formula, variables, nodes, [&] {
+                    return tokenizer.tokenize(formula.text).empty() ? 0 : 1;
+                });
+
+                checkLexer(formula.text);
+                run("lex", formula, variables, nodes, [&] {
+                    return FastLexer::lex(formula.text).empty() ? 0 : 1;
+                });
+
+                // The reference evaluator walks the rows in order, setting every variable of the row
+                LogicalEvaluator evaluator;
+                uint64_t row = 0;
+                const uint64_t rowMask = (uint64_t{1} << variables) - 1;
+                run("evaluate", formula, variables, nodes, [&] {
+                    for (size_t j = 0; j < variables; ++j) evaluator.setVariable(formula.variables[j], (row >> j) & 1);
+                    evaluator.evaluate(formula.text);
+                    row = (row + 1) & rowMask;
+                    return 1;
+                });
+
+                // Full table generation costs about one node evaluation per node and word
+                double work = std::ldexp(1.0, static_cast<int>(variables)) / 64 * formula.nodes;
+                if (work > options.maxWork) continue;
+                TruthTableGenerator generator({formula.text}, formula.variables[0]);
+                NullTableSink sink;
+                NullStreamBuffer silence;
+                run("generate", formula, variables, nodes, [&] {
+                    std::streambuf* previous = std::cout.rdbuf(&silence);
+                    generator.generateAndAnalyze(sink);
+                    std::cout.rdbuf(previous);
+                    return uint64_t{1} << variables;
+                });
+            }
+        }
+
+        if (options.outputPath.empty()) {
+            writeJson(std::cout, results);
+        } else {
+            std::ofstream out(options.outputPath);
+            if (!out) throw std::runtime_error("Cannot open '" + options.outputPath + "' for writing");
+            writeJson(out, results);
+        }
+
+        if (!options.baselinePath.empty()) {
+            size_t regressions = compareWithBaseline(results, readBaseline(options.baselinePath),
+                                                     options.tolerancePercent);
+            if (regressions) {
+                std::cerr << regressions << " case(s) slower than the baseline by more than "
+                          << options.tolerancePercent << "%\n";
+                return 1;
+            }
+        }
+    } catch (const std::exception& e) {
+        std::cerr << Colors::RED << "Error: " << e.what() << Colors::RESET << "\n";
+        return 2;
+    }
+    return 0;
+}
@@ -0,0 +1,133 @@
+/**
+ * @file big_unsigned.hpp
+ * @brief Arbitrary-precision unsigned integers for exact row and model counts.
+ */
+
+#ifndef LOGIC_BIG_UNSIGNED_HPP
+#define LOGIC_BIG_UNSIGNED_HPP
+
+#include "common.hpp"
+
+/**
+ * @class BigUnsigned
+ * @brief Arbitrary-precision unsigned integer for exact row and model counts beyond 2^64.
+ */
+class BigUnsigned {
+private:
+    std::vector<uint32_t> limbs; // Little-endian base 2^32 digits, no leading zero limbs
+
+    void trim() {
+        while (!limbs.empty() && limbs.back() == 0) limbs.pop_back();
+    }
+
+public:
+    BigUnsigned(uint64_t value = 0) {
+        while (value) {
+            limbs.push_back(static_cast<uint32_t>(value));
+            value >>= 32;
+        }
+    }
+
+    static BigUnsigned powerOfTwo(size_t exponent) {
+        BigUnsigned result(1);
+        result <<= exponent;
+        return result;
+    }
+
+    bool isZero() const {
+        return limbs.empty();
+    }
+
+    bool fitsUint64() const {
+        return limbs.size() <= 2;
+    }
+
+    uint64_t toUint64() const {
+        uint64_t value = 0;
+        for (size_t i = std::min<size_t>(limbs.size(), 2); i-- > 0;) value = (value << 32) | limbs[i];
+        return value;
+    }
+
+    BigUnsigned& operator+=(const BigUnsigned& other) {
+        if (other.limbs.size() > limbs.size()) limbs.resize(other.limbs.size(), 0);
+        uint64_t carry = 0;
+        for (size_t i = 0; i < limbs.size(); ++i) {
+            uint64_t sum = carry + limbs[i] + (i < other.limbs.size() ? other.limbs[i] : 0);
+            limbs[i] = static_cast<uint32_t>(sum);
+            carry = sum >> 32;
+            if (!carry && i >= other.limbs.size()) break;
+        }
+        if (carry) limbs.push_back(static_cast<uint32_t>(carry));
+        return *this;
+    }
+
+    BigUnsigned& operator<<=(size_t bits) {
+        if (limbs.empty() || bits == 0) return *this;
+        size_t whole = bits / 32;
+        unsigned part = static_cast<unsigned>(bits % 32);
+        if (part) {
+            uint32_t carry = 0;
+            for (uint32_t& limb : limbs) {
+                uint32_t next = limb >> (32 - part);
+                limb = (limb << part) | carry;
+                carry = next;
+            }
+            if (carry) limbs.push_back(carry);
+        }
+        limbs.insert(limbs.begin(), whole, 0);
+        return *this;
+    }
+
+    BigUnsigned& operator*=(const BigUnsigned& other) {
+        if (limbs.empty() || other.limbs.empty()) {
+            limbs.clear();
+            return *this;
+        }
+        std::vector<uint32_t> product(limbs.size() + other.limbs.size(), 0);
+        for (size_t i = 0; i < limbs.size(); ++i) {
+            uint64_t carry = 0;
+            for (size_t j = 0; j < other.limbs.size(); ++j) {
+                uint64_t current = uint64_t{limbs[i]} * other.limbs[j] + product[i + j] + carry;
+                product[i + j] = static_cast<uint32_t>(current);
+                carry = current >> 32;
+            }
+            product[i + other.limbs.size()] = static_cast<uint32_t>(carry);
+        }
+        limbs.swap(product);
+        trim();
+        return *this;
+    }
+
+    friend BigUnsigned operator+(BigUnsigned a, const BigUnsigned& b) { return a += b; }
+    friend BigUnsigned operator*(BigUnsigned a, const BigUnsigned& b) { return a *= b; }
+    friend BigUnsigned operator<<(BigUnsigned a, size_t bits) { return a <<= bits; }
+    friend bool operator==(const BigUnsigned& a, const BigUnsigned& b) { return a.limbs == b.limbs; }
+    friend bool operator!=(const BigUnsigned& a, const BigUnsigned& b) { return a.limbs != b.limbs; }
+
+    /**
+     * @brief Decimal representation
+     */
+    std::string toString() const {
+        if (limbs.empty()) return "0";
+        std::vector<uint32_t> digits = limbs; // Repeatedly divided by 10^9
+        std::vector<uint32_t> chunks; // Base 10^9 digits, least significant first
+        while (!digits.empty()) {
+            uint64_t remainder = 0;
+            for (size_t i = digits.size(); i-- > 0;) {
+                uint64_t current = (remainder << 32) | digits[i];
+                digits[i] = static_cast<uint32_t>(current / 1000000000);
+                remainder = current % 1000000000;
+            }
+            chunks.push_back(static_cast<uint32_t>(remainder));
+            while (!digits.empty() && digits.back() == 0) digits.pop_back();
+        }
+        std::string text = std::to_string(chunks.back());
+        for (size_t i = chunks.size() - 1; i-- > 0;) {
+            std::string chunk = std::to_string(chunks[i]);
+            text += std::string(9 - chunk.size(), '0') + chunk;
+        }
+        return text;
+    }
+};
+
+#endif // LOGIC_BIG_UNSIGNED_HPP
@@ -0,0 +1,294 @@
+/**
+ * @file common.hpp
+ * @brief Standard headers, build macros, terminal colors, instrumentation and bit helpers shared by every part of the analyzer.
+ */
+
+#ifndef LOGIC_COMMON_HPP
+#define LOGIC_COMMON_HPP
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <string_view>
+#include <map>
+#include <stack>
+#include <bitset> 
+#include <unordered_set> // For unique variables
+#include <algorithm> // For std::sort
+#include <iomanip> // For std::setw
+#include <array>
+#include <cstdint>
+#include <stdexcept>
+#include <cstring> // For std::memcpy
+#include <limits>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <chrono> // For the phase timers
+#include <functional>
+#include <iterator> // For the row generator
+#include <memory>
+#include <unordered_map>
+#include <deque>
+#include <memory_resource> // For the arenas of the batch mode
+#include <charconv>
+#include <cerrno>
+#include <cmath> // For std::pow
+#include <cstdio> // For the buffered table output
+#include <fstream>
+#include <sstream>
+#include <random> // For the hash constraints of the approximate counter
+
+#ifndef _WIN32
+#include <fcntl.h> // For memory-mapping problem files
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/file.h> // For flock on the cache file
+#include <unistd.h>
+#endif
+
+// Forces inlining of the interpreter into the ISA-specific sweep kernels
+#if defined(__GNUC__)
+#define LOGIC_ALWAYS_INLINE inline __attribute__((always_inline))
+#elif defined(_MSC_VER)
+#define LOGIC_ALWAYS_INLINE __forceinline
+#else
+#define LOGIC_ALWAYS_INLINE inline
+#endif
+
+// AVX2/AVX-512 kernels use GCC/Clang vector extensions and are selected at run time
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define LOGIC_X86_SIMD 1
+#endif
+
+#if LOGIC_X86_SIMD
+#include <immintrin.h> // For the classification stage of the lexer
+#endif
+
+// Constants for terminal colors
+namespace Colors {
+    const std::string RESET = "\033[0m";
+    const std::string RED = "\033[31m";
+    const std::string GREEN = "\033[32m";
+    const std::string YELLOW = "\033[33m";
+    const std::string BLUE = "\033[34m";
+    const std::string MAGENTA = "\033[35m";
+    const std::string BOLD = "\033[1m";
+}
+
+/**
+ * @class Instrumentation
+ * @brief Phase timers, counters and an optional Chrome trace of a run, enabled by --stats and --trace.
+ *
+ * Instrumented code checks enabled() once per call or per chunk of rows, never per row: hot loops keep
+ * their counts in locals and publish them when they finish. Everything is process-wide and thread-safe,
+ * so pool workers record into the same totals and appear as separate threads in the trace.
+ */
+class Instrumentation {
+public:
+    /**
+     * @brief Timed phases; phases nest, e.g. compile includes the tokenizing of its expressions
+     */
+    enum class Phase {
+        READ,      // Reading and compiling a problem file
+        TOKENIZE,
+        COMPILE,   // Parsing expressions into programs
+        VARIABLES, // Extracting and ordering the variables
+        EVALUATE,  // Evaluating rows or running a solver engine
+        OUTPUT,    // Printing rows and the analysis
+        NONE       // A trace event that adds to no phase
+    };
+
+    enum class Counter {
+        ROWS_EVALUATED,
+        OPERATORS_APPLIED, // Word operations for the bit-sliced engines
+        TOKENS_PRODUCED,
+        PEAK_STACK_DEPTH   // Kept as a maximum, not a sum
+    };
+
+private:
+    using Clock = std::chrono::steady_clock;
+    static constexpr size_t PHASES = static_cast<size_t>(Phase::NONE);
+    static constexpr size_t COUNTERS = static_cast<size_t>(Counter::PEAK_STACK_DEPTH) + 1;
+    static constexpr size_t MAX_TRACE_EVENTS = size_t{1} << 20; // Later events are dropped
+
+    struct TraceEvent {
+        const char* name;
+        Phase phase;
+        uint32_t thread;
+        uint64_t start; // Nanoseconds since the instrumentation was enabled
+        uint64_t duration;
+    };
+
+    static inline std::atomic<bool> statsEnabled{false};
+    static inline std::atomic<bool> traceEnabled{false};
+    static inline Clock::time_point origin;
+    static inline std::array<std::atomic<uint64_t>, PHASES> phaseNanoseconds{};
+    static inline std::array<std::atomic<uint64_t>, PHASES> phaseCalls{};
+    static inline std::array<std::atomic<uint64_t>, COUNTERS> counters{};
+    static inline std::mutex traceMutex;
+    static inline std::vector<TraceEvent> traceEvents;
+    static inline std::atomic<uint32_t> threadsSeen{0};
+
+    /**
+     * @brief Small dense number of the calling thread, in order of first use
+     */
+    static uint32_t threadNumber() {
+        thread_local uint32_t number = threadsSeen.fetch_add(1);
+        return number;
+    }
+
+    static const char* phaseName(size_t phase) {
+        static const char* const names[] = {"read", "tokenize", "compile", "variables", "evaluate", "output"};
+        return names[phase];
+    }
+
+    static uint64_t sinceOrigin(Clock::time_point time) {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(time - origin).count());
+    }
+
+public:
+    /**
+     * @brief Turns on the counters and timers, and optionally the trace, before the run starts
+     */
+    static void enable(bool trace) {
+        origin = Clock::now();
+        threadNumber(); // The calling thread is thread 0 of the trace
+        traceEnabled.store(trace);
+        statsEnabled.store(true);
+    }
+
+    static bool enabled() {
+        return statsEnabled.load(std::memory_order_relaxed);
+    }
+
+    static void add(Counter counter, uint64_t amount) {
+        counters[static_cast<size_t>(counter)].fetch_add(amount, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Raises the peak stack depth to at least depth
+     */
+    static void peakStackDepth(uint64_t depth) {
+        auto& peak = counters[static_cast<size_t>(Counter::PEAK_STACK_DEPTH)];
+        uint64_t current = peak.load(std::memory_order_relaxed);
+        while (depth > current && !peak.compare_exchange_weak(current, depth, std::memory_order_relaxed)) {
+        }
+    }
+
+    /**
+     * @brief Adds time measured by the caller to a phase, for loops that alternate between phases
+     */
+    static void addTime(Phase phase, uint64_t nanoseconds, uint64_t calls = 1) {
+        phaseNanoseconds[static_cast<size_t>(phase)].fetch_add(nanoseconds, std::memory_order_relaxed);
+        phaseCalls[static_cast<size_t>(phase)].fetch_add(calls, std::memory_order_relaxed);
+    }
+
+    static uint64_t now() {
+        return sinceOrigin(Clock::now());
+    }
+
+    /**
+     * @class Scope
+     * @brief Times the enclosing block into a phase and, if it has a name and tracing is on, the trace
+     */
+    class Scope {
+    private:
+        Phase phase;
+        const char* name;
+        bool active;
+        Clock::time_point start;
+
+    public:
+        explicit Scope(Phase p, const char* eventName = nullptr) : phase(p), name(eventName), active(enabled()) {
+            if (active) start = Clock::now();
+        }
+
+        ~Scope() {
+            if (!active) return;
+            Clock::time_point end = Clock::now();
+            uint64_t duration = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count());
+            if (phase != Phase::NONE) addTime(phase, duration);
+            if (name && traceEnabled.load(std::memory_order_relaxed)) {
+                std::lock_guard<std::mutex> lock(traceMutex);
+                if (traceEvents.size() < MAX_TRACE_EVENTS) {
+                    traceEvents.push_back({name, phase, threadNumber(), sinceOrigin(start), duration});
+                }
+            }
+        }
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+    };
+
+    /**
+     * @brief Writes the phase times and counters as JSON
+     */
+    static void writeStats(std::ostream& out) {
+        out << "{\n  \"phases\": {\n";
+        for (size_t i = 0; i < PHASES; ++i) {
+            out << "    \"" << phaseName(i) << "\": {\"seconds\": "
+                << std::fixed << std::setprecision(6) << phaseNanoseconds[i].load() / 1e9 << std::defaultfloat
+                << ", \"calls\": " << phaseCalls[i].load() << "}" << (i + 1 < PHASES ? ",\n" : "\n");
+        }
+        out << "  },\n  \"counters\": {\n"
+            << "    \"rows_evaluated\": " << counters[static_cast<size_t>(Counter::ROWS_EVALUATED)].load() << ",\n"
+            << "    \"operators_applied\": " << counters[static_cast<size_t>(Counter::OPERATORS_APPLIED)].load() << ",\n"
+            << "    \"tokens_produced\": " << counters[static_cast<size_t>(Counter::TOKENS_PRODUCED)].load() << ",\n"
+            << "    \"peak_stack_depth\": " << counters[static_cast<size_t>(Counter::PEAK_STACK_DEPTH)].load() << "\n"
+            << "  },\n  \"threads\": " << threadsSeen.load() << ",\n"
+            << "  \"wall_seconds\": " << std::fixed << std::setprecision(6) << now() / 1e9 << std::defaultfloat << "\n}\n";
+    }
+
+    /**
+     * @brief Writes the trace in the Chrome trace-event format, for chrome://tracing or Perfetto
+     * @throws std::runtime_error If the file cannot be written.
+     */
+    static void writeTrace(const std::string& path) {
+        std::ofstream out(path);
+        if (!out) throw std::runtime_error("Cannot open '" + path + "' for writing");
+        std::lock_guard<std::mutex> lock(traceMutex);
+        out << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [";
+        const char* separator = "\n"; // Between entries only, JSON allows no comma after the last one
+        for (uint32_t thread = 0; thread < threadsSeen.load(); ++thread) {
+            out << separator << "{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": " << thread
+                << ", \"args\": {\"name\": \"" << (thread == 0 ? "main" : "thread " + std::to_string(thread)) << "\"}}";
+            separator = ",\n";
+        }
+        out << std::fixed << std::setprecision(3);
+        for (const TraceEvent& event : traceEvents) {
+            out << separator << "{\"name\": \"" << event.name << "\", \"cat\": \""
+                << (event.phase == Phase::NONE ? "task" : phaseName(static_cast<size_t>(event.phase)))
+                << "\", \"ph\": \"X\", \"pid\": 1, \"tid\": " << event.thread
+                << ", \"ts\": " << event.start / 1e3 << ", \"dur\": " << event.duration / 1e3 << "}";
+            separator = ",\n";
+        }
+        out << "\n]}\n";
+    }
+};
+
+/**
+ * @brief Helpers for counting bits of 64-bit pattern words
+ */
+namespace BitOps {
+    inline int popcount(uint64_t x) {
+#if defined(__GNUC__)
+        return __builtin_popcountll(x);
+#else
+        return static_cast<int>(std::bitset<64>(x).count());
+#endif
+    }
+
+    inline int countTrailingZeros(uint64_t x) { // x must not be 0
+#if defined(__GNUC__)
+        return __builtin_ctzll(x);
+#else
+        int n = 0;
+        while (!(x & 1)) { x >>= 1; ++n; }
+        return n;
+#endif
+    }
+}
+
+#endif // LOGIC_COMMON_HPP
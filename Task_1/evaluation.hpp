@@ -0,0 +1,952 @@
+/**
+ * @file evaluation.hpp
+ * @brief Analysis results, budgets, the work-stealing pool and the evaluators that sweep the truth table.
+ */
+
+#ifndef LOGIC_EVALUATION_HPP
+#define LOGIC_EVALUATION_HPP
+
+#include "common.hpp"
+#include "expression.hpp"
+#include "problem.hpp"
+
+/**
+ * @brief Validity and satisfiability of an argument over a range of truth-table rows.
+ *
+ * Results for disjoint ranges can be merged, so a sweep may be split into any number of pieces.
+ */
+struct AnalysisResult {
+    static constexpr uint64_t NO_ROW = std::numeric_limits<uint64_t>::max();
+
+    bool isValid = true; // No critical row has a false conclusion
+    bool isSatisfiable = false; // Some critical row has a true conclusion
+    uint64_t criticalRows = 0; // Rows where all premises are true
+    uint64_t counterexampleRows = 0; // Critical rows where the conclusion is false
+    uint64_t firstCounterexample = NO_ROW; // Lowest counterexample row, NO_ROW if there is none
+    bool isComplete = true; // False if the sweep stopped early, the row counts are then lower bounds
+    bool hasRowCounts = true; // False for engines that decide the argument without counting rows
+    bool satisfiabilityChecked = true; // False if only validity was decided
+    std::vector<bool> counterexample; // Counterexample by variable slot, from engines that do not number rows
+
+    /**
+     * @brief Combines the result of another, disjoint range of rows into this one
+     */
+    void merge(const AnalysisResult& other) {
+        isComplete &= other.isComplete;
+        isValid &= other.isValid;
+        isSatisfiable |= other.isSatisfiable;
+        criticalRows += other.criticalRows;
+        counterexampleRows += other.counterexampleRows;
+        firstCounterexample = std::min(firstCounterexample, other.firstCounterexample);
+    }
+
+    /**
+     * @brief Adds one word of 64 rows; bits outside the table must already be masked off
+     * @param word Index of the word, row r of the word is row word * 64 + r of the table.
+     * @param critical Rows where all premises are true.
+     * @param counterexamples Critical rows where the conclusion is false.
+     */
+    void addWord(uint64_t word, uint64_t critical, uint64_t counterexamples) {
+        criticalRows += BitOps::popcount(critical);
+        if (critical & ~counterexamples) {
+            isSatisfiable = true;
+        }
+        if (counterexamples) {
+            isValid = false;
+            counterexampleRows += BitOps::popcount(counterexamples);
+            firstCounterexample = std::min(firstCounterexample,
+                                           word * 64 + BitOps::countTrailingZeros(counterexamples));
+        }
+    }
+};
+
+/**
+ * @class Budget
+ * @brief Time limit of one engine run, checked cooperatively by its long loops.
+ *
+ * The caller makes a Budget per run and hands it to the engine, which passes it on to its pool tasks.
+ * Engines call check() at coarse points: per sweep chunk, per few hundred SAT conflicts or decisions,
+ * per few thousand BDD nodes. Once the limit has passed, check() throws Budget::Exceeded from whichever
+ * thread sees it, which unwinds the engine. A budget is fixed once made, so any number of runs and
+ * workers can check their own at once, and without a limit a check is one comparison.
+ */
+class Budget {
+public:
+    /**
+     * @brief Thrown by check() once the time limit has passed
+     */
+    class Exceeded : public std::runtime_error {
+    public:
+        Exceeded() : std::runtime_error("Time budget exceeded") {}
+    };
+
+private:
+    using Clock = std::chrono::steady_clock;
+    static constexpr int64_t UNLIMITED = std::numeric_limits<int64_t>::max();
+    int64_t deadline = UNLIMITED; // Clock ticks since the clock's epoch
+
+public:
+    /**
+     * @brief A budget without a limit
+     */
+    Budget() = default;
+
+    /**
+     * @param seconds Time from now until check() throws, infinite for no limit.
+     */
+    explicit Budget(double seconds) {
+        if (std::isfinite(seconds)) {
+            auto duration = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(seconds));
+            deadline = (Clock::now() + duration).time_since_epoch().count();
+        }
+    }
+
+    /**
+     * @brief The budget of engines run without a limit
+     */
+    static const Budget& unlimited() {
+        static const Budget none;
+        return none;
+    }
+
+    /**
+     * @brief Throws Exceeded if the time limit has passed
+     */
+    void check() const {
+        if (deadline != UNLIMITED && Clock::now().time_since_epoch().count() > deadline) throw Exceeded();
+    }
+};
+
+/**
+ * @class WorkStealingPool
+ * @brief A fixed set of worker threads that run indexed tasks with work stealing.
+ *
+ * run() deals the task indices out to the workers in contiguous ranges. A worker takes its own
+ * indices from the front of its range, in increasing order, and when it runs out it steals from
+ * the back of another worker's range. The calling thread takes part as worker 0, so a pool of
+ * size 1 runs everything on the caller. run() is not reentrant.
+ */
+class WorkStealingPool {
+private:
+    /**
+     * @brief The indices a worker still has to run
+     */
+    struct Range {
+        std::mutex mutex;
+        size_t begin = 0;
+        size_t end = 0;
+    };
+
+    std::vector<std::thread> threads;
+    std::vector<std::unique_ptr<Range>> ranges; // One per worker, including the caller
+    const std::function<void(size_t, size_t)>* job = nullptr; // Task of the current run
+
+    std::mutex mutex; // Guards everything below
+    std::condition_variable wake; // Signals a new run or shutdown to the workers
+    std::condition_variable done; // Signals the caller that a worker finished the run
+    uint64_t generation = 0; // Incremented for every run
+    size_t busyWorkers = 0; // Background workers still working on the current run
+    bool stopping = false;
+    std::exception_ptr failure; // First exception thrown by a task
+
+    /**
+     * @brief Takes the next index of a worker's own range
+     */
+    bool takeOwn(size_t worker, size_t& index) {
+        Range& range = *ranges[worker];
+        std::lock_guard<std::mutex> lock(range.mutex);
+        if (range.begin == range.end) return false;
+        index = range.begin++;
+        return true;
+    }
+
+    /**
+     * @brief Steals the last index of the first other worker that still has work
+     */
+    bool steal(size_t worker, size_t& index) {
+        for (size_t offset = 1; offset < ranges.size(); ++offset) {
+            Range& range = *ranges[(worker + offset) % ranges.size()];
+            std::lock_guard<std::mutex> lock(range.mutex);
+            if (range.begin != range.end) {
+                index = --range.end;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /**
+     * @brief Runs tasks until no worker has any left
+     */
+    void work(size_t worker) {
+        size_t index;
+        while (takeOwn(worker, index) || steal(worker, index)) {
+            try {
+                (*job)(index, worker);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (!failure) failure = std::current_exception();
+            }
+        }
+    }
+
+    void workerLoop(size_t worker) {
+        uint64_t seen = 0;
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true) {
+            wake.wait(lock, [&] { return stopping || generation != seen; });
+            if (stopping) return;
+            seen = generation;
+            lock.unlock();
+            work(worker);
+            lock.lock();
+            if (--busyWorkers == 0) done.notify_one();
+        }
+    }
+
+public:
+    /**
+     * @brief Starts the workers
+     * @param size Number of workers including the caller, 0 for one per hardware thread.
+     */
+    explicit WorkStealingPool(size_t size = 0) {
+        if (size == 0) size = std::max(1u, std::thread::hardware_concurrency());
+        for (size_t i = 0; i < size; ++i) {
+            ranges.push_back(std::make_unique<Range>());
+        }
+        for (size_t i = 1; i < size; ++i) {
+            threads.emplace_back(&WorkStealingPool::workerLoop, this, i);
+        }
+    }
+
+    ~WorkStealingPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (auto& thread : threads) thread.join();
+    }
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    /**
+     * @brief Number of workers including the caller
+     */
+    size_t size() const {
+        return ranges.size();
+    }
+
+    /**
+     * @brief Runs task(index, worker) for every index in [0, count) and waits for all of them.
+     * @throws The first exception thrown by a task, after every task has finished.
+     */
+    void run(size_t count, const std::function<void(size_t index, size_t worker)>& task) {
+        for (size_t i = 0; i < ranges.size(); ++i) {
+            ranges[i]->begin = count * i / ranges.size();
+            ranges[i]->end = count * (i + 1) / ranges.size();
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            job = &task;
+            failure = nullptr;
+            busyWorkers = threads.size();
+            ++generation;
+        }
+        wake.notify_all();
+        work(0);
+
+        std::unique_lock<std::mutex> lock(mutex);
+        done.wait(lock, [&] { return busyWorkers == 0; });
+        job = nullptr;
+        if (failure) std::rethrow_exception(failure);
+    }
+};
+
+/**
+ * @class BitSlicedEvaluator
+ * @brief Evaluates compiled premises and conclusion for 64 truth-table rows per instruction.
+ *
+ * Row i of the truth table assigns bit j of i to variable j. Bit r of word w therefore stands for row
+ * w * 64 + r: the first six variables have the same pattern in every word (0xAAAA..., 0xCCCC..., ...)
+ * and every other variable is either all ones or all zeros within a word. The AVX2 and AVX-512 kernels
+ * process 4 or 8 consecutive words per instruction; the widest kernel the CPU supports is chosen at
+ * run time and the scalar kernel is always available. The premises and conclusion are merged into
+ * one ExpressionDag, so a subformula they share is evaluated once per word.
+ */
+class BitSlicedEvaluator {
+public:
+    /**
+     * @brief Instruction sets the sweep can run on
+     */
+    enum class Isa {
+        SCALAR,
+        AVX2,
+        AVX512
+    };
+
+    static constexpr size_t MAX_VARIABLES = 63; // 2^n rows must fit in a 64-bit row index
+
+private:
+    size_t variableCount;
+    Isa isa;
+    ExpressionDag dag; // Premises and conclusion with shared subexpressions
+    DagProgram program; // Evaluates every node of the DAG once per word
+
+    // Values of the first six variables, identical in every word
+    static constexpr uint64_t LOW_VARIABLE_PATTERNS[6] = {
+        0xAAAAAAAAAAAAAAAAull, 0xCCCCCCCCCCCCCCCCull, 0xF0F0F0F0F0F0F0F0ull,
+        0xFF00FF00FF00FF00ull, 0xFFFF0000FFFF0000ull, 0xFFFFFFFF00000000ull
+    };
+
+    /**
+     * @brief Fills every lane of a word vector from the given lane values
+     */
+    template <typename Word, size_t Lanes>
+    static LOGIC_ALWAYS_INLINE void load(Word& out, const uint64_t (&lanes)[Lanes]) {
+        static_assert(sizeof(Word) == sizeof(lanes), "Word must hold exactly Lanes 64-bit words");
+        std::memcpy(&out, lanes, sizeof(Word));
+    }
+
+    /**
+     * @brief Sweeps Lanes consecutive words per iteration; firstWord and count must be multiples of Lanes.
+     *
+     * Variables 6 .. 6 + log2(Lanes) - 1 differ between the lanes of an iteration but not between
+     * iterations, so they are set once. Higher variables are the same in every lane and only the ones
+     * whose bit changed since the previous iteration are rewritten.
+     */
+    template <typename Word, size_t Lanes>
+    LOGIC_ALWAYS_INLINE AnalysisResult sweepKernel(uint64_t firstWord, uint64_t count) const {
+        AnalysisResult result;
+        const size_t n = variableCount;
+        const uint64_t mask = rowMask();
+
+        // Word-aligned register file: the variables, the constants and the temporaries of the program
+        std::vector<uint64_t> storage(program.registerCount * Lanes + 8);
+        uintptr_t address = reinterpret_cast<uintptr_t>(storage.data());
+        Word* values = reinterpret_cast<Word*>((address + 63) & ~uintptr_t{63});
+
+        uint64_t lanes[Lanes];
+        for (size_t j = 0; j < n; ++j) {
+            for (size_t k = 0; k < Lanes; ++k) lanes[k] = variableWord(j, firstWord + k);
+            load<Word, Lanes>(values[j], lanes);
+        }
+
+        Word allOnes;
+        for (size_t k = 0; k < Lanes; ++k) lanes[k] = ~0ull;
+        load<Word, Lanes>(allOnes, lanes);
+        values[n] = allOnes ^ allOnes;
+        values[n + 1] = allOnes;
+
+        size_t laneBits = 0; // log2(Lanes)
+        while ((size_t{1} << laneBits) < Lanes) ++laneBits;
+
+        uint64_t critical[Lanes];
+        uint64_t counterexamples[Lanes];
+        uint64_t previous = firstWord;
+        for (uint64_t w = firstWord; w < firstWord + count; w += Lanes) {
+            // Rewrite the variables whose bit changed since the previous iteration
+            uint64_t changed = (w ^ previous) >> laneBits;
+            while (changed) {
+                size_t j = 6 + laneBits + BitOps::countTrailingZeros(changed);
+                changed &= changed - 1;
+                values[j] = ~values[j];
+            }
+            previous = w;
+
+            program.execute(values);
+            Word allPremises = allOnes;
+            for (uint32_t r : program.premiseRegisters) {
+                allPremises &= values[r];
+            }
+            Word failing = allPremises & ~values[program.conclusionRegister];
+
+            std::memcpy(critical, &allPremises, sizeof(Word));
+            std::memcpy(counterexamples, &failing, sizeof(Word));
+            for (size_t k = 0; k < Lanes; ++k) {
+                result.addWord(w + k, critical[k] & mask, counterexamples[k] & mask);
+            }
+        }
+        return result;
+    }
+
+    AnalysisResult sweepScalar(uint64_t firstWord, uint64_t count) const {
+        return sweepKernel<uint64_t, 1>(firstWord, count);
+    }
+
+#if LOGIC_X86_SIMD
+    typedef uint64_t Lanes4 __attribute__((vector_size(32), may_alias));
+    typedef uint64_t Lanes8 __attribute__((vector_size(64), may_alias));
+
+    __attribute__((target("avx2")))
+    AnalysisResult sweepAvx2(uint64_t firstWord, uint64_t count) const {
+        return sweepKernel<Lanes4, 4>(firstWord, count);
+    }
+
+    __attribute__((target("avx512f")))
+    AnalysisResult sweepAvx512(uint64_t firstWord, uint64_t count) const {
+        return sweepKernel<Lanes8, 8>(firstWord, count);
+    }
+#endif
+
+public:
+    /**
+     * @brief Constructor
+     * @param p The compiled premises.
+     * @param c The compiled conclusion.
+     * @param variables Number of variable slots used by the programs.
+     * @param instructionSet Instruction set of the sweep kernels, must be supported by the CPU.
+     * @throws std::runtime_error If there are too many variables to enumerate.
+     */
+    BitSlicedEvaluator(const std::vector<CompiledExpression>& p, const CompiledExpression& c,
+                       size_t variables, Isa instructionSet = detectIsa())
+        : variableCount(variables), isa(instructionSet) {
+        if (variableCount > MAX_VARIABLES) {
+            throw std::runtime_error("Too many variables to enumerate (" + std::to_string(variableCount) +
+                                     ", at most " + std::to_string(MAX_VARIABLES) + "), use --engine=sat, --engine=bdd or --engine=count");
+        }
+        std::vector<uint32_t> premiseRoots;
+        for (const auto& premise : p) {
+            premiseRoots.push_back(dag.add(premise));
+        }
+        uint32_t conclusionRoot = dag.add(c);
+        program = DagProgram(dag, premiseRoots, conclusionRoot, variableCount);
+    }
+
+    /**
+     * @brief The shared subexpressions of the premises and conclusion
+     */
+    const ExpressionDag& expressionDag() const {
+        return dag;
+    }
+
+    /**
+     * @brief Returns the widest instruction set supported by the CPU
+     */
+    static Isa detectIsa() {
+#if LOGIC_X86_SIMD
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx512f")) return Isa::AVX512;
+        if (__builtin_cpu_supports("avx2")) return Isa::AVX2;
+#endif
+        return Isa::SCALAR;
+    }
+
+    /**
+     * @brief Checks whether the CPU can run the given instruction set
+     */
+    static bool isSupported(Isa instructionSet) {
+        switch (instructionSet) {
+            case Isa::AVX512: return detectIsa() == Isa::AVX512;
+            case Isa::AVX2:   return detectIsa() != Isa::SCALAR;
+            default:          return true;
+        }
+    }
+
+    static const char* isaName(Isa instructionSet) {
+        switch (instructionSet) {
+            case Isa::AVX512: return "avx512";
+            case Isa::AVX2:   return "avx2";
+            default:          return "scalar";
+        }
+    }
+
+    /**
+     * @brief Number of 64-row words in the truth table
+     */
+    uint64_t wordCount() const {
+        return variableCount <= 6 ? 1 : uint64_t{1} << (variableCount - 6);
+    }
+
+    /**
+     * @brief Value of a variable in the given word
+     */
+    static uint64_t variableWord(size_t variable, uint64_t word) {
+        if (variable < 6) return LOW_VARIABLE_PATTERNS[variable];
+        return ((word >> (variable - 6)) & 1) ? ~0ull : 0;
+    }
+
+    /**
+     * @brief Bits of a word that are rows of the table (only less than 64 when there are fewer than 6 variables)
+     */
+    uint64_t rowMask() const {
+        return variableCount >= 6 ? ~0ull : (uint64_t{1} << (uint64_t{1} << variableCount)) - 1;
+    }
+
+    /**
+     * @brief Adds the rows and word operations of evaluating count words to the instrumentation
+     */
+    void countWords(uint64_t count) const {
+        Instrumentation::add(Instrumentation::Counter::ROWS_EVALUATED, count * BitOps::popcount(rowMask()));
+        Instrumentation::add(Instrumentation::Counter::OPERATORS_APPLIED, count * program.code.size());
+    }
+
+    /**
+     * @brief Evaluates every premise and the conclusion for the 64 rows of one word
+     * @param word Index of the word.
+     * @param premiseWords Receives one result word per premise.
+     * @param conclusionWord Receives the result word of the conclusion.
+     * @param scratch Reusable buffer for the register file.
+     */
+    void evaluateWord(uint64_t word, uint64_t* premiseWords, uint64_t& conclusionWord,
+                      std::vector<uint64_t>& scratch) const {
+        scratch.resize(program.registerCount);
+        uint64_t* values = scratch.data();
+        for (size_t j = 0; j < variableCount; ++j) {
+            values[j] = variableWord(j, word);
+        }
+        values[variableCount] = 0;
+        values[variableCount + 1] = ~0ull;
+        program.execute(values);
+        for (size_t i = 0; i < program.premiseRegisters.size(); ++i) {
+            premiseWords[i] = values[program.premiseRegisters[i]];
+        }
+        conclusionWord = values[program.conclusionRegister];
+    }
+
+    /**
+     * @brief Analyzes the rows of the words [firstWord, firstWord + count)
+     *
+     * Words before the first and after the last full vector of the selected instruction set
+     * are handled by the scalar kernel.
+     */
+    AnalysisResult sweep(uint64_t firstWord, uint64_t count) const {
+        if (Instrumentation::enabled()) countWords(count);
+        uint64_t lanes = isa == Isa::AVX512 ? 8 : isa == Isa::AVX2 ? 4 : 1;
+        uint64_t alignedBegin = (firstWord + lanes - 1) / lanes * lanes;
+        uint64_t alignedEnd = (firstWord + count) / lanes * lanes;
+        if (lanes == 1 || alignedBegin >= alignedEnd) {
+            return sweepScalar(firstWord, count);
+        }
+
+        AnalysisResult result = sweepScalar(firstWord, alignedBegin - firstWord);
+#if LOGIC_X86_SIMD
+        if (isa == Isa::AVX512) {
+            result.merge(sweepAvx512(alignedBegin, alignedEnd - alignedBegin));
+        } else {
+            result.merge(sweepAvx2(alignedBegin, alignedEnd - alignedBegin));
+        }
+#endif
+        result.merge(sweepScalar(alignedEnd, firstWord + count - alignedEnd));
+        return result;
+    }
+
+    /**
+     * @brief Analyzes the whole truth table
+     */
+    AnalysisResult sweep() const {
+        return sweep(0, wordCount());
+    }
+};
+
+/**
+ * @class RowGenerator
+ * @brief Pull-style cursor over the rows of a truth table, 64 rows per batch.
+ *
+ * Nothing is evaluated until the next batch is asked for, so a consumer can filter, sample with seek()
+ * or stop at any point, and only one batch exists at a time. A batch keeps the packed words of the
+ * sweep: bit r of every word belongs to row word * 64 + r, whose variable j is bit j of the row number.
+ * The generator owns its evaluator and does not refer to the TruthTableGenerator it came from.
+ *
+ *     RowGenerator rows = generator.rows();
+ *     for (const RowGenerator::Batch& batch : rows) {
+ *         uint64_t failing = batch.counterexamples();
+ *         if (failing) return batch.row(BitOps::countTrailingZeros(failing));
+ *     }
+ */
+class RowGenerator {
+public:
+    /**
+     * @brief 64 consecutive rows of the table
+     */
+    struct Batch {
+        uint64_t word = 0; // Index of the word, the batch starts at row word * 64
+        uint64_t rowMask = 0; // Bits that are rows of the table, all but the first 2^n with fewer than 6 variables
+        const uint64_t* premises = nullptr; // One result word per premise, valid until the next batch
+        size_t premiseCount = 0;
+        uint64_t conclusion = 0;
+        uint64_t critical = 0; // Rows where all premises are true
+
+        /**
+         * @brief Rows where all premises are true and the conclusion is false
+         */
+        uint64_t counterexamples() const { return critical & ~conclusion; }
+
+        /**
+         * @brief Row number of a bit of the batch; bit j of it is the value of variable j
+         */
+        uint64_t row(unsigned bit) const { return word * 64 + bit; }
+
+        bool premise(size_t i, unsigned bit) const { return (premises[i] >> bit) & 1; }
+    };
+
+    /**
+     * @class Iterator
+     * @brief Input iterator over the remaining batches; advancing it evaluates the next one
+     */
+    class Iterator {
+    private:
+        RowGenerator* rows = nullptr; // Null at the end
+        Batch batch;
+
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using value_type = Batch;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const Batch*;
+        using reference = const Batch&;
+
+        Iterator() = default;
+        explicit Iterator(RowGenerator* generator) : rows(generator) { ++*this; }
+
+        const Batch& operator*() const { return batch; }
+        const Batch* operator->() const { return &batch; }
+
+        Iterator& operator++() {
+            if (rows && !rows->next(batch)) rows = nullptr;
+            return *this;
+        }
+
+        bool operator==(const Iterator& other) const { return rows == other.rows; }
+        bool operator!=(const Iterator& other) const { return rows != other.rows; }
+    };
+
+private:
+    BitSlicedEvaluator evaluator;
+    uint64_t position; // Next word to evaluate
+    uint64_t endWord;
+    std::vector<uint64_t> premiseWords;
+    std::vector<uint64_t> scratch;
+
+public:
+    /**
+     * @brief Constructor
+     * @param p The compiled premises.
+     * @param c The compiled conclusion.
+     * @param variables Number of variable slots used by the programs.
+     * @throws std::runtime_error If there are too many variables to enumerate.
+     */
+    RowGenerator(const std::vector<CompiledExpression>& p, const CompiledExpression& c, size_t variables)
+        : evaluator(p, c, variables), position(0), endWord(evaluator.wordCount()), premiseWords(p.size()) {}
+
+    /**
+     * @brief Number of words, and so of batches, in the whole table
+     */
+    uint64_t wordCount() const {
+        return evaluator.wordCount();
+    }
+
+    /**
+     * @brief Restricts the remaining batches to the words [firstWord, lastWord), for sampling or splitting the table
+     */
+    void seek(uint64_t firstWord, uint64_t lastWord = std::numeric_limits<uint64_t>::max()) {
+        endWord = std::min(lastWord, evaluator.wordCount());
+        position = std::min(firstWord, endWord);
+    }
+
+    /**
+     * @brief Evaluates the next batch
+     * @param batch Receives the batch; its premise words stay valid until the next call.
+     * @return False, leaving the batch unchanged, if there are no rows left.
+     */
+    bool next(Batch& batch) {
+        if (position >= endWord) return false;
+        batch.word = position++;
+        batch.rowMask = evaluator.rowMask();
+        evaluator.evaluateWord(batch.word, premiseWords.data(), batch.conclusion, scratch);
+        batch.premises = premiseWords.data();
+        batch.premiseCount = premiseWords.size();
+        batch.critical = batch.rowMask;
+        for (uint64_t premiseWord : premiseWords) batch.critical &= premiseWord;
+        if (Instrumentation::enabled()) evaluator.countWords(1);
+        return true;
+    }
+
+    Iterator begin() { return Iterator(this); }
+    Iterator end() { return Iterator(); }
+};
+
+/**
+ * @class GrayCodeEvaluator
+ * @brief Sweeps the truth table in Gray-code order of the words, re-evaluating only what a flip reaches.
+ *
+ * Words are still bit-sliced as in BitSlicedEvaluator, but visited in the order w ^ (w >> 1), so two
+ * consecutive words differ in exactly one of the variables above the first six. The value of every
+ * node of the shared ExpressionDag is kept from the previous word, and when variable j flips only the nodes on paths
+ * from j to the roots are recomputed, from a dependency list precomputed per variable. High variables
+ * flip exponentially less often than low ones, so for wide formulas where each variable reaches a
+ * small part of the expressions most nodes are evaluated only a handful of times per sweep.
+ */
+class GrayCodeEvaluator {
+private:
+    typedef ExpressionDag::Node Node;
+
+    ExpressionDag dag; // Premises and conclusion with shared subexpressions
+    std::vector<uint32_t> premiseRoots;
+    uint32_t conclusionRoot = 0;
+    std::vector<std::vector<uint32_t>> dependents; // Per variable: the nodes it reaches, in evaluation order
+    size_t variableCount;
+    uint64_t words;
+    uint64_t mask;
+
+    static LOGIC_ALWAYS_INLINE uint64_t evaluate(const Node& node, const uint64_t* values, const uint64_t* variables) {
+        switch (node.op) {
+        case CompiledExpression::OpCode::LOAD:     return variables[node.left];
+        case CompiledExpression::OpCode::CONSTANT: return node.left ? ~0ull : 0;
+        case CompiledExpression::OpCode::NOT:      return ~values[node.left];
+        case CompiledExpression::OpCode::AND:      return values[node.left] & values[node.right];
+        case CompiledExpression::OpCode::OR:       return values[node.left] | values[node.right];
+        case CompiledExpression::OpCode::IMPLIES:  return ~values[node.left] | values[node.right];
+        default:                                   return ~(values[node.left] ^ values[node.right]);
+        }
+    }
+
+public:
+    /**
+     * @brief Constructor, builds the expression nodes and the dependency list of every variable
+     * @throws std::runtime_error If there are too many variables to enumerate.
+     */
+    GrayCodeEvaluator(const std::vector<CompiledExpression>& premises, const CompiledExpression& conclusion,
+                      size_t variables)
+        : variableCount(variables) {
+        BitSlicedEvaluator shape(premises, conclusion, variables, BitSlicedEvaluator::Isa::SCALAR); // Checks the size
+        words = shape.wordCount();
+        mask = shape.rowMask();
+
+        for (const auto& premise : premises) premiseRoots.push_back(dag.add(premise));
+        conclusionRoot = dag.add(conclusion);
+
+        // The first six variables never change between words and need no list
+        const auto& nodes = dag.nodeList();
+        dependents.resize(variableCount);
+        std::vector<uint8_t> reached(nodes.size());
+        for (size_t j = 6; j < variableCount; ++j) {
+            for (uint32_t i = 0; i < nodes.size(); ++i) {
+                const Node& node = nodes[i];
+                switch (node.op) {
+                case CompiledExpression::OpCode::LOAD:     reached[i] = node.left == j; break;
+                case CompiledExpression::OpCode::CONSTANT: reached[i] = 0; break;
+                case CompiledExpression::OpCode::NOT:      reached[i] = reached[node.left]; break;
+                default:                                   reached[i] = reached[node.left] | reached[node.right]; break;
+                }
+                if (reached[i]) dependents[j].push_back(i);
+            }
+        }
+    }
+
+    uint64_t wordCount() const { return words; }
+    size_t nodeCount() const { return dag.size(); }
+    const ExpressionDag& expressionDag() const { return dag; }
+
+    /**
+     * @brief Average number of nodes re-evaluated per word over a whole sweep
+     *
+     * Variable j >= 6 flips on every 2^(j - 5)-th word of the Gray sequence.
+     */
+    double averageNodesPerWord() const {
+        if (words <= 1) return static_cast<double>(dag.size());
+        double total = 0;
+        for (size_t j = 6; j < variableCount; ++j) {
+            total += static_cast<double>(dependents[j].size()) / static_cast<double>(uint64_t{1} << (j - 5));
+        }
+        return total;
+    }
+
+    /**
+     * @brief Sweeps a range of the Gray sequence
+     *
+     * The first word of the range is evaluated completely and every following one incrementally.
+     *
+     * @param first Position in the Gray sequence of the first word.
+     * @param count Number of words.
+     * @return The analysis of the rows of those words.
+     */
+    AnalysisResult sweep(uint64_t first, uint64_t count) const {
+        AnalysisResult result;
+        if (count == 0) return result;
+        const auto& nodes = dag.nodeList();
+        std::vector<uint64_t> values(nodes.size());
+        std::vector<uint64_t> variables(variableCount);
+
+        uint64_t word = first ^ (first >> 1);
+        for (size_t j = 0; j < variableCount; ++j) variables[j] = BitSlicedEvaluator::variableWord(j, word);
+        for (size_t i = 0; i < nodes.size(); ++i) values[i] = evaluate(nodes[i], values.data(), variables.data());
+        uint64_t evaluated = nodes.size(); // Node evaluations, for the instrumentation
+
+        for (uint64_t position = first;;) {
+            uint64_t critical = mask;
+            for (uint32_t root : premiseRoots) critical &= values[root];
+            result.addWord(word, critical, critical & ~values[conclusionRoot]);
+
+            if (++position == first + count) break;
+            size_t flipped = 6 + BitOps::countTrailingZeros(position); // The bit that changes in the Gray code
+            word ^= uint64_t{1} << (flipped - 6);
+            variables[flipped] = ~variables[flipped];
+            for (uint32_t i : dependents[flipped]) values[i] = evaluate(nodes[i], values.data(), variables.data());
+            evaluated += dependents[flipped].size();
+        }
+        if (Instrumentation::enabled()) {
+            Instrumentation::add(Instrumentation::Counter::ROWS_EVALUATED, count * BitOps::popcount(mask));
+            Instrumentation::add(Instrumentation::Counter::OPERATORS_APPLIED, evaluated);
+        }
+        return result;
+    }
+
+    /**
+     * @brief Sweeps the whole table
+     */
+    AnalysisResult sweep() const {
+        return sweep(0, words);
+    }
+};
+
+/**
+ * @class ShortCircuitEvaluator
+ * @brief Searches the truth table for a counterexample, evaluating as little of each word as possible.
+ *
+ * Every premise and the conclusion gets its own register program over the shared ExpressionDag, so each
+ * can be evaluated on its own. A word starts with the conclusion: only rows where it is false can be
+ * counterexamples (and, while satisfiability is still open, rows where it is true can be models). The
+ * premises then narrow those rows one at a time, and the word is dropped at the first premise that
+ * leaves none. Premises are tried in order of observed selectivity, the rows they rule out per
+ * instruction, and re-sorted as the sweep goes, so in arguments with many premises most words cost the
+ * conclusion and one cheap premise. Words are visited in order, so the first counterexample found is
+ * the lowest one and the sweep ends there once satisfiability is settled or not wanted.
+ */
+class ShortCircuitEvaluator {
+public:
+    /**
+     * @brief What a short-circuit sweep did
+     */
+    struct Statistics {
+        uint64_t wordsVisited = 0;
+        uint64_t wordsSkipped = 0; // Words with no candidate row after the conclusion
+        uint64_t premiseEvaluations = 0;
+        uint64_t instructions = 0; // Word operations executed, conclusion included
+        std::vector<uint32_t> order; // Final premise order, most selective first
+    };
+
+private:
+    static constexpr uint64_t REORDER_INTERVAL = 256; // Words between two re-sorts of the premises
+
+    /**
+     * @brief A premise program and what it has ruled out so far
+     */
+    struct Premise {
+        DagProgram program;
+        uint32_t index; // Position among the premises of the argument
+        uint64_t candidatesSeen = 0; // Rows it was evaluated on
+        uint64_t rowsRemoved = 0; // Of those, rows where it was false
+    };
+
+    ExpressionDag dag;
+    std::vector<Premise> premises;
+    DagProgram conclusion;
+    size_t variableCount;
+    size_t registerCount;
+    uint64_t words;
+    uint64_t mask;
+
+    /**
+     * @brief Orders the premises by rows removed per instruction, estimated with a prior of one half
+     */
+    void reorder() {
+        std::stable_sort(premises.begin(), premises.end(), [](const Premise& a, const Premise& b) {
+            double rateA = (a.rowsRemoved + 1.0) / (a.candidatesSeen + 2.0) / (a.program.code.size() + 1.0);
+            double rateB = (b.rowsRemoved + 1.0) / (b.candidatesSeen + 2.0) / (b.program.code.size() + 1.0);
+            return rateA > rateB;
+        });
+    }
+
+public:
+    /**
+     * @brief Constructor, compiles one program per premise and one for the conclusion
+     * @throws std::runtime_error If there are too many variables to enumerate.
+     */
+    ShortCircuitEvaluator(const std::vector<CompiledExpression>& p, const CompiledExpression& c, size_t variables)
+        : variableCount(variables) {
+        BitSlicedEvaluator shape(p, c, variables, BitSlicedEvaluator::Isa::SCALAR); // Checks the size
+        words = shape.wordCount();
+        mask = shape.rowMask();
+
+        const std::vector<uint32_t> noPremises;
+        registerCount = variableCount + 2;
+        for (uint32_t i = 0; i < p.size(); ++i) {
+            premises.push_back({DagProgram(dag, noPremises, dag.add(p[i]), variableCount), i});
+        }
+        conclusion = DagProgram(dag, noPremises, dag.add(c), variableCount);
+        registerCount = std::max(registerCount, conclusion.registerCount);
+        for (const Premise& premise : premises) registerCount = std::max(registerCount, premise.program.registerCount);
+        reorder(); // Cheapest first until there are observations
+    }
+
+    /**
+     * @brief Sweeps the table until the verdicts are known
+     * @param needSatisfiable Also decide satisfiability; otherwise stop at the first counterexample.
+     * @param stats Receives what the sweep did, if not null.
+     * @return The verdicts and the lowest counterexample; rows are not counted.
+     */
+    AnalysisResult sweep(bool needSatisfiable, Statistics* stats = nullptr) {
+        AnalysisResult result;
+        result.hasRowCounts = false;
+        result.satisfiabilityChecked = needSatisfiable;
+        Statistics local;
+
+        std::vector<uint64_t> registers(registerCount);
+        registers[variableCount] = 0;
+        registers[variableCount + 1] = ~0ull;
+        bool searchCounterexample = true;
+        bool searchModel = needSatisfiable;
+
+        for (uint64_t word = 0; word < words && (searchCounterexample || searchModel); ++word) {
+            ++local.wordsVisited;
+            for (size_t j = 0; j < variableCount; ++j) registers[j] = BitSlicedEvaluator::variableWord(j, word);
+
+            conclusion.execute(registers.data());
+            local.instructions += conclusion.code.size();
+            const uint64_t conclusionWord = registers[conclusion.conclusionRegister];
+            uint64_t candidates = ((searchCounterexample ? ~conclusionWord : 0) | (searchModel ? conclusionWord : 0)) & mask;
+            if (!candidates) {
+                ++local.wordsSkipped;
+                continue;
+            }
+
+            for (Premise& premise : premises) {
+                premise.program.execute(registers.data());
+                ++local.premiseEvaluations;
+                local.instructions += premise.program.code.size();
+                const uint64_t premiseWord = registers[premise.program.conclusionRegister];
+                premise.candidatesSeen += BitOps::popcount(candidates);
+                premise.rowsRemoved += BitOps::popcount(candidates & ~premiseWord);
+                candidates &= premiseWord;
+                if (!candidates) break;
+            }
+
+            // What survives every premise is critical
+            if (candidates & conclusionWord) {
+                result.isSatisfiable = true;
+                searchModel = false;
+            }
+            if (candidates & ~conclusionWord) {
+                result.isValid = false;
+                result.firstCounterexample = word * 64 + BitOps::countTrailingZeros(candidates & ~conclusionWord);
+                searchCounterexample = false;
+            }
+            if (word % REORDER_INTERVAL == REORDER_INTERVAL - 1) reorder();
+        }
+        result.isComplete = local.wordsVisited == words;
+
+        if (Instrumentation::enabled()) {
+            Instrumentation::add(Instrumentation::Counter::ROWS_EVALUATED, local.wordsVisited * BitOps::popcount(mask));
+            Instrumentation::add(Instrumentation::Counter::OPERATORS_APPLIED, local.instructions);
+        }
+        if (stats) {
+            for (const Premise& premise : premises) local.order.push_back(premise.index);
+            *stats = std::move(local);
+        }
+        return result;
+    }
+};
+
+#endif // LOGIC_EVALUATION_HPP
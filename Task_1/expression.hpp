@@ -0,0 +1,943 @@
+/**
+ * @file expression.hpp
+ * @brief Tokenizers, the reference evaluator and the compiler of expressions into postfix programs.
+ */
+
+#ifndef LOGIC_EXPRESSION_HPP
+#define LOGIC_EXPRESSION_HPP
+
+#include "common.hpp"
+
+/**
+ * @class ExpressionTokenizer
+ * @brief Handles the tokenization of logical expressions into their component parts
+ */
+class ExpressionTokenizer {
+public:
+    /**
+     * @brief Token types for logical expressions
+     */
+    enum class TokenType {
+        VARIABLE,
+        OPERATOR,
+        PARENTHESIS,
+        INVALID
+    };
+
+    /**
+     * @brief Structure to represent a token in the expression
+     */
+    struct Token {
+        TokenType type;
+        char value; // Operator or parenthesis character, first character of a variable
+        int precedence; // Operator precedence, -1 for non-operators
+        std::string_view text; // The characters of the token in the expression, the name of a variable
+    };
+
+private:
+    // Operator precedence map for tokenization
+    const std::map<char, int> operatorPrecedence = {
+        {'~', 4},  // NOT
+        {'&', 3},  // AND
+        {'|', 2},  // OR
+        {'-', 1},  // IMPLIES
+        {'<', 0}   // BICONDITIONAL
+    };
+
+public:
+    /**
+     * @brief Checks whether a character can start a variable name
+     */
+    static bool isIdentifierStart(char c) {
+        return std::isalpha(static_cast<unsigned char>(c)) || c == '_';
+    }
+
+    /**
+     * @brief Checks whether a character can continue a variable name
+     */
+    static bool isIdentifierChar(char c) {
+        return std::isalnum(static_cast<unsigned char>(c)) || c == '_';
+    }
+
+    /**
+     * @brief Tokenizes an input expression into a vector of tokens
+     *
+     * Variables are identifiers: a letter or '_' followed by letters, digits or '_', such as p or door_open_3.
+     * The text of every token refers to the expression, which must outlive the tokens.
+     *
+     * @param expression The logical expression to tokenize
+     * @param resource Memory for the tokens, such as the arena of a batch record
+     * @return Vector of tokens
+     */
+    std::pmr::vector<Token> tokenize(std::string_view expression,
+                                     std::pmr::memory_resource* resource = std::pmr::get_default_resource()) const {
+        Instrumentation::Scope timer(Instrumentation::Phase::TOKENIZE);
+        std::pmr::vector<Token> tokens(resource);
+        
+        for (size_t i = 0; i < expression.length(); ++i) {
+            char c = expression[i];
+            
+            // Skip whitespace
+            if (std::isspace(static_cast<unsigned char>(c))) continue;
+
+            // Handle special operators 
+            if (c == '-' && i + 1 < expression.length() && expression[i + 1] == '>') {
+                // This line adds a new Token to the 'tokens' vector. The Token is created using an initializer list
+                // with three elements: the type of the token (TokenType::OPERATOR), the character representing the 
+                // operator ('-'), and the precedence of the operator (retrieved from the 'operatorPrecedence' map).
+                tokens.push_back({TokenType::OPERATOR, '-', operatorPrecedence.at('-'), expression.substr(i, 2)}); // Implication '->'
+                ++i;
+                continue;
+            }
+            if (c == '<' && i + 2 < expression.length() && expression[i + 1] == '-' && expression[i + 2] == '>') {
+                // This line adds a new Token to the 'tokens' vector. The Token is created using an initializer list
+                // with three elements: the type of the token (TokenType::OPERATOR), the character representing the
+                // operator ('<'), and the precedence of the operator (retrieved from the 'operatorPrecedence' map).
+                tokens.push_back({TokenType::OPERATOR, '<', operatorPrecedence.at('<'), expression.substr(i, 3)}); // Biconditional '<->'
+                i += 2;
+                continue;
+            }
+
+            // Variable names run until the first character that cannot be part of an identifier
+            if (isIdentifierStart(c)) {
+                size_t end = i + 1;
+                while (end < expression.length() && isIdentifierChar(expression[end])) ++end;
+                tokens.push_back({TokenType::VARIABLE, c, -1, expression.substr(i, end - i)});
+                i = end - 1;
+                continue;
+            }
+
+            // Categorize token
+            Token token;
+            if (c == '(' || c == ')') {
+                token = {TokenType::PARENTHESIS, c, -1, expression.substr(i, 1)};
+            } else if (operatorPrecedence.count(c)) {
+                token = {TokenType::OPERATOR, c, operatorPrecedence.at(c), expression.substr(i, 1)};
+            } else {
+                token = {TokenType::INVALID, c, -1, expression.substr(i, 1)};
+            }
+
+            tokens.push_back(token);
+        }
+
+        if (Instrumentation::enabled()) Instrumentation::add(Instrumentation::Counter::TOKENS_PRODUCED, tokens.size());
+        return tokens;
+    }
+};
+
+/**
+ * @class FastLexer
+ * @brief Tokenizer for large expressions that classifies 64 bytes at a time.
+ *
+ * Produces exactly the tokens of ExpressionTokenizer, which stays the reference, but as compact
+ * (offset, length) pairs into the expression, written into a buffer sized for the worst case up front.
+ * The lexing runs in two stages. The first stage turns each 64-byte block into bitmasks of its character
+ * classes, with AVX-512 or AVX2 compares where the CPU has them. The second stage derives every
+ * token start from the masks with shifts: '->' and '<->' are found from the '-' and '>' masks shifted
+ * by one and two bytes, and the extent of each variable from the runs of identifier bytes. Both
+ * stages are branch-free per byte, so throughput is bound by the bit loop over token starts.
+ */
+class FastLexer {
+public:
+    /**
+     * @brief A token as a span of the expression; its type and value follow from its first character
+     */
+    struct Token {
+        uint32_t offset;
+        uint32_t length;
+    };
+
+    /**
+     * @brief Instruction sets of the classification stage
+     */
+    enum class Isa {
+        SCALAR,
+        AVX2,
+        AVX512
+    };
+
+    /**
+     * @class Tokens
+     * @brief The tokens of one expression, in a buffer allocated once from a memory resource
+     */
+    class Tokens {
+    private:
+        std::pmr::memory_resource* resource;
+        Token* items = nullptr;
+        size_t count = 0;
+        size_t capacity = 0;
+
+        friend class FastLexer;
+
+    public:
+        Tokens(std::pmr::memory_resource* memory, size_t maxTokens) : resource(memory), capacity(maxTokens) {
+            // Only the pages that receive tokens are touched, so the worst-case size costs no memory
+            if (capacity) items = static_cast<Token*>(resource->allocate(capacity * sizeof(Token), alignof(Token)));
+        }
+
+        Tokens(Tokens&& other) noexcept
+            : resource(other.resource), items(other.items), count(other.count), capacity(other.capacity) {
+            other.items = nullptr;
+            other.capacity = 0;
+        }
+
+        Tokens(const Tokens&) = delete;
+        Tokens& operator=(const Tokens&) = delete;
+        Tokens& operator=(Tokens&&) = delete;
+
+        ~Tokens() {
+            if (items) resource->deallocate(items, capacity * sizeof(Token), alignof(Token));
+        }
+
+        size_t size() const { return count; }
+        bool empty() const { return count == 0; }
+        const Token* begin() const { return items; }
+        const Token* end() const { return items + count; }
+        const Token& operator[](size_t i) const { return items[i]; }
+    };
+
+private:
+    /**
+     * @brief Character classes of one 64-byte block, bit i for byte i
+     */
+    struct BlockMasks {
+        uint64_t identifier; // Letters, digits and '_'
+        uint64_t digit;
+        uint64_t space;
+        uint64_t dash;
+        uint64_t less;
+        uint64_t greater;
+    };
+
+    /**
+     * @brief What the second stage carries from one block to the next
+     */
+    struct State {
+        uint64_t identifierCarry = 0; // 1 if the last byte of the previous block was an identifier byte
+        uint64_t covered = 0;         // Bytes at the start of the block that belong to a '->' or '<->' before it
+        size_t open = 0;              // First token that may be a variable still missing its length
+    };
+
+    static constexpr size_t BLOCK = 64;
+    static constexpr size_t CHUNK_BLOCKS = 64; // Blocks classified per call of the first stage
+
+    enum ByteClass : uint8_t {
+        IDENTIFIER = 1,
+        DIGIT = 2,
+        SPACE = 4,
+        DASH = 8,
+        LESS = 16,
+        GREATER = 32
+    };
+
+    static const std::array<uint8_t, 256>& byteClasses() {
+        static const std::array<uint8_t, 256> classes = [] {
+            std::array<uint8_t, 256> table{};
+            for (int c = 0; c < 256; ++c) {
+                if (ExpressionTokenizer::isIdentifierChar(static_cast<char>(c))) table[c] |= IDENTIFIER;
+                if (c >= '0' && c <= '9') table[c] |= DIGIT;
+                if (std::isspace(c)) table[c] |= SPACE;
+            }
+            table['-'] |= DASH;
+            table['<'] |= LESS;
+            table['>'] |= GREATER;
+            return table;
+        }();
+        return classes;
+    }
+
+    static void classifyScalar(const char* text, size_t blocks, BlockMasks* masks) {
+        const std::array<uint8_t, 256>& classes = byteClasses();
+        for (size_t b = 0; b < blocks; ++b, text += BLOCK) {
+            BlockMasks m{};
+            for (size_t i = 0; i < BLOCK; ++i) {
+                uint64_t c = classes[static_cast<unsigned char>(text[i])];
+                m.identifier |= (c & 1) << i;
+                m.digit |= ((c >> 1) & 1) << i;
+                m.space |= ((c >> 2) & 1) << i;
+                m.dash |= ((c >> 3) & 1) << i;
+                m.less |= ((c >> 4) & 1) << i;
+                m.greater |= ((c >> 5) & 1) << i;
+            }
+            masks[b] = m;
+        }
+    }
+
+#if LOGIC_X86_SIMD
+    __attribute__((target("avx2")))
+    static uint64_t maskAvx2(__m256i low, __m256i high) {
+        return static_cast<uint32_t>(_mm256_movemask_epi8(low)) |
+               static_cast<uint64_t>(static_cast<uint32_t>(_mm256_movemask_epi8(high))) << 32;
+    }
+
+    /**
+     * @brief Unsigned x <= limit per byte, as min(x, limit) == x since AVX2 has no unsigned byte compare
+     */
+    __attribute__((target("avx2")))
+    static __m256i atMost(__m256i x, char limit) {
+        return _mm256_cmpeq_epi8(_mm256_min_epu8(x, _mm256_set1_epi8(limit)), x);
+    }
+
+    __attribute__((target("avx2")))
+    static void classifyAvx2(const char* text, size_t blocks, BlockMasks* masks) {
+        for (size_t b = 0; b < blocks; ++b, text += BLOCK) {
+            __m256i halves[2] = {_mm256_loadu_si256(reinterpret_cast<const __m256i*>(text)),
+                                 _mm256_loadu_si256(reinterpret_cast<const __m256i*>(text + 32))};
+            __m256i identifier[2], digit[2], space[2], dash[2], less[2], greater[2];
+            for (int h = 0; h < 2; ++h) {
+                __m256i v = halves[h];
+                __m256i lower = _mm256_or_si256(v, _mm256_set1_epi8(0x20));
+                digit[h] = atMost(_mm256_sub_epi8(v, _mm256_set1_epi8('0')), 9);
+                identifier[h] = _mm256_or_si256(_mm256_or_si256(atMost(_mm256_sub_epi8(lower, _mm256_set1_epi8('a')), 25), digit[h]),
+                                                _mm256_cmpeq_epi8(v, _mm256_set1_epi8('_')));
+                space[h] = _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8(' ')),
+                                           atMost(_mm256_sub_epi8(v, _mm256_set1_epi8('\t')), '\r' - '\t'));
+                dash[h] = _mm256_cmpeq_epi8(v, _mm256_set1_epi8('-'));
+                less[h] = _mm256_cmpeq_epi8(v, _mm256_set1_epi8('<'));
+                greater[h] = _mm256_cmpeq_epi8(v, _mm256_set1_epi8('>'));
+            }
+            masks[b] = {maskAvx2(identifier[0], identifier[1]), maskAvx2(digit[0], digit[1]),
+                        maskAvx2(space[0], space[1]), maskAvx2(dash[0], dash[1]),
+                        maskAvx2(less[0], less[1]), maskAvx2(greater[0], greater[1])};
+        }
+    }
+
+    __attribute__((target("avx512f,avx512bw")))
+    static void classifyAvx512(const char* text, size_t blocks, BlockMasks* masks) {
+        for (size_t b = 0; b < blocks; ++b, text += BLOCK) {
+            __m512i v = _mm512_loadu_si512(text);
+            __m512i lower = _mm512_or_si512(v, _mm512_set1_epi8(0x20));
+            uint64_t digit = _mm512_cmple_epu8_mask(_mm512_sub_epi8(v, _mm512_set1_epi8('0')), _mm512_set1_epi8(9));
+            uint64_t letter = _mm512_cmple_epu8_mask(_mm512_sub_epi8(lower, _mm512_set1_epi8('a')), _mm512_set1_epi8(25));
+            masks[b] = {
+                letter | digit | _mm512_cmpeq_epi8_mask(v, _mm512_set1_epi8('_')),
+                digit,
+                _mm512_cmpeq_epi8_mask(v, _mm512_set1_epi8(' ')) |
+                    _mm512_cmple_epu8_mask(_mm512_sub_epi8(v, _mm512_set1_epi8('\t')), _mm512_set1_epi8('\r' - '\t')),
+                _mm512_cmpeq_epi8_mask(v, _mm512_set1_epi8('-')),
+                _mm512_cmpeq_epi8_mask(v, _mm512_set1_epi8('<')),
+                _mm512_cmpeq_epi8_mask(v, _mm512_set1_epi8('>'))
+            };
+        }
+    }
+#endif
+
+    static void classify(Isa isa, const char* text, size_t blocks, BlockMasks* masks) {
+#if LOGIC_X86_SIMD
+        if (isa == Isa::AVX512) return classifyAvx512(text, blocks, masks);
+        if (isa == Isa::AVX2) return classifyAvx2(text, blocks, masks);
+#endif
+        (void)isa;
+        classifyScalar(text, blocks, masks);
+    }
+
+    /**
+     * @brief Emits the tokens that start in one block.
+     *
+     * Variables are emitted with length 0 and get their length when the block holding their last byte
+     * is processed; every other token is at least one byte long, which tells them apart.
+     *
+     * @param position Offset of the block in the expression.
+     * @param m Character classes of the block; bytes past the end of the expression are spaces.
+     * @return False if an identifier run starts with a digit, which the reference splits differently.
+     */
+    static bool emitBlock(std::string_view text, size_t position, const BlockMasks& m, State& state, Tokens& tokens) {
+        auto byteAt = [&](size_t i) { return i < text.size() ? static_cast<unsigned char>(text[i]) : ' '; };
+        const std::array<uint8_t, 256>& classes = byteClasses();
+        const uint64_t next = classes[byteAt(position + BLOCK)];
+        const uint64_t afterNext = classes[byteAt(position + BLOCK + 1)];
+
+        // Masks of the byte one and two positions ahead, continued into the next block
+        uint64_t identifierNext = (m.identifier >> 1) | (next & IDENTIFIER) << 63;
+        uint64_t dashNext = (m.dash >> 1) | ((next & DASH) ? uint64_t{1} << 63 : 0);
+        uint64_t greaterNext = (m.greater >> 1) | ((next & GREATER) ? uint64_t{1} << 63 : 0);
+        uint64_t greaterNext2 = (m.greater >> 2) | ((next & GREATER) ? uint64_t{1} << 62 : 0) |
+                                ((afterNext & GREATER) ? uint64_t{1} << 63 : 0);
+
+        // A '-' inside '<->' is not the start of '->'; the bytes a token covers start nothing
+        uint64_t biconditional = m.less & dashNext & greaterNext2;
+        uint64_t covered = state.covered | biconditional << 1 | biconditional << 2;
+        uint64_t implication = m.dash & greaterNext & ~covered;
+        covered |= implication << 1;
+        state.covered = (biconditional >> 62) | (biconditional >> 63) | (implication >> 63);
+
+        uint64_t identifierStart = m.identifier & ~((m.identifier << 1) | state.identifierCarry);
+        uint64_t identifierEnd = m.identifier & ~identifierNext;
+        state.identifierCarry = m.identifier >> 63;
+        if (identifierStart & m.digit) return false;
+
+        uint64_t starts = identifierStart | ~(m.space | m.identifier | covered);
+        Token* out = tokens.items + tokens.count;
+        while (starts) {
+            unsigned i = BitOps::countTrailingZeros(starts);
+            starts &= starts - 1;
+            uint32_t length = 1 + ((implication >> i) & 1) + 2 * ((biconditional >> i) & 1);
+            *out++ = {static_cast<uint32_t>(position + i), ((identifierStart >> i) & 1) ? 0 : length};
+        }
+        tokens.count = out - tokens.items;
+
+        while (identifierEnd) {
+            unsigned i = BitOps::countTrailingZeros(identifierEnd);
+            identifierEnd &= identifierEnd - 1;
+            while (tokens.items[state.open].length != 0) ++state.open;
+            Token& variable = tokens.items[state.open++];
+            variable.length = static_cast<uint32_t>(position + i + 1 - variable.offset);
+        }
+        return true;
+    }
+
+    /**
+     * @brief Tokenizes with the reference tokenizer, for the rare inputs the masks do not handle
+     */
+    static void lexReference(std::string_view text, Tokens& tokens) {
+        ExpressionTokenizer tokenizer;
+        tokens.count = 0;
+        for (const auto& token : tokenizer.tokenize(text)) {
+            tokens.items[tokens.count++] = {static_cast<uint32_t>(token.text.data() - text.data()),
+                                            static_cast<uint32_t>(token.text.size())};
+        }
+    }
+
+public:
+    /**
+     * @brief Returns the widest instruction set the classification stage can use on this CPU
+     */
+    static Isa detectIsa() {
+#if LOGIC_X86_SIMD
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx512bw")) return Isa::AVX512;
+        if (__builtin_cpu_supports("avx2")) return Isa::AVX2;
+#endif
+        return Isa::SCALAR;
+    }
+
+    /**
+     * @brief Tokenizes an expression into spans of it.
+     *
+     * @param text The expression, which must outlive the tokens.
+     * @param resource Memory for the token buffer, such as the arena of a batch record.
+     * @param isa Instruction set of the classification stage, must be supported by the CPU.
+     * @return The tokens, the same as ExpressionTokenizer::tokenize returns.
+     * @throws std::runtime_error If the expression is 4 GiB or longer.
+     */
+    static Tokens lex(std::string_view text, std::pmr::memory_resource* resource = std::pmr::get_default_resource(),
+                      Isa isa = detectIsa()) {
+        Instrumentation::Scope timer(Instrumentation::Phase::TOKENIZE);
+        if (text.size() > std::numeric_limits<uint32_t>::max()) {
+            throw std::runtime_error("Expression too long to tokenize (" + std::to_string(text.size()) + " bytes)");
+        }
+        Tokens tokens(resource, text.size()); // Every token is at least one byte
+        State state;
+        BlockMasks masks[CHUNK_BLOCKS];
+        const size_t fullBlocks = text.size() / BLOCK;
+        bool handled = true;
+        for (size_t first = 0; first < fullBlocks && handled; first += CHUNK_BLOCKS) {
+            size_t blocks = std::min(CHUNK_BLOCKS, fullBlocks - first);
+            classify(isa, text.data() + first * BLOCK, blocks, masks);
+            for (size_t b = 0; b < blocks && handled; ++b) {
+                handled = emitBlock(text, (first + b) * BLOCK, masks[b], state, tokens);
+            }
+        }
+        if (handled && text.size() % BLOCK) {
+            char last[BLOCK];
+            std::memset(last, ' ', BLOCK);
+            std::memcpy(last, text.data() + fullBlocks * BLOCK, text.size() % BLOCK);
+            classifyScalar(last, 1, masks);
+            handled = emitBlock(text, fullBlocks * BLOCK, masks[0], state, tokens);
+        }
+        if (!handled) lexReference(text, tokens);
+
+        if (Instrumentation::enabled()) Instrumentation::add(Instrumentation::Counter::TOKENS_PRODUCED, tokens.size());
+        return tokens;
+    }
+
+    /**
+     * @brief Expands a compact token into the token ExpressionTokenizer produces for it
+     */
+    static ExpressionTokenizer::Token expand(std::string_view text, Token token) {
+        using Type = ExpressionTokenizer::TokenType;
+        std::string_view span = text.substr(token.offset, token.length);
+        char c = span[0];
+        switch (c) {
+            case '~': return {Type::OPERATOR, c, 4, span};
+            case '&': return {Type::OPERATOR, c, 3, span};
+            case '|': return {Type::OPERATOR, c, 2, span};
+            case '-': return {Type::OPERATOR, c, 1, span};
+            case '<': return {Type::OPERATOR, c, 0, span};
+            case '(':
+            case ')': return {Type::PARENTHESIS, c, -1, span};
+            default:
+                return {ExpressionTokenizer::isIdentifierStart(c) ? Type::VARIABLE : Type::INVALID, c, -1, span};
+        }
+    }
+};
+
+/**
+ * @class LogicalEvaluator
+ * @brief Handles the evaluation of logical expressions using tokens
+ */
+class LogicalEvaluator {
+private:
+    std::map<std::string, bool, std::less<>> variableValues; // Map to store variable values
+    ExpressionTokenizer tokenizer; // Tokenizer to break down expressions
+
+    /**
+     * @brief Evaluates a single logical operation
+     * @param op The operator character
+     * @param a The first operand
+     * @param b The second operand (optional for unary operators)
+     * @return The result of the logical operation
+     */
+    bool evaluateOperation(char op, bool a, bool b = false) {
+        switch (op) {
+            case '~': return !a;       // NOT operation
+            case '&': return a && b;   // AND operation
+            case '|': return a || b;   // OR operation
+            case '-': return !a || b;  // Implication (a -> b)
+            case '<': return a == b;   // Biconditional (a <-> b)
+            default: return false;     // Invalid operator
+        }
+    }
+
+public:
+    /**
+     * @brief Sets the value of a variable
+     * @param var The variable character
+     * @param value The boolean value to set
+     */
+    void setVariable(char var, bool value) {
+        variableValues[std::string(1, var)] = value;
+    }
+
+    /**
+     * @brief Sets the value of a variable
+     * @param name The variable name
+     * @param value The boolean value to set
+     */
+    void setVariable(const std::string& name, bool value) {
+        variableValues[name] = value;
+    }
+
+    /**
+     * @brief Evaluates a logical expression using infix notation and operator precedence.
+     * 
+     * This function tokenizes the input logical expression and evaluates it using a stack-based
+     * approach to handle operator precedence and parentheses. It supports variables, logical
+     * operators (NOT, AND, OR, IMPLIES, BICONDITIONAL), and parentheses for grouping.
+     * 
+     * The evaluation process involves:
+     * - Tokenizing the expression into variables, operators, and parentheses.
+     * - Using a value stack to store boolean values of variables.
+     * - Using an operator stack to manage operators and parentheses.
+     * - Processing operators based on their precedence and evaluating sub-expressions.
+     * - Handling parentheses by processing until matching '(' is found.
+     * - Returning the final result of the logical expression.
+     * - Throwing a runtime error for invalid tokens or malformed expressions.
+     * 
+     * @param expression The logical expression to evaluate.
+     * @return The boolean result of the evaluation.
+     * @throws std::runtime_error If an invalid token is encountered or the expression is malformed.
+     */
+    bool evaluate(const std::string& expression) {
+        Instrumentation::Scope timer(Instrumentation::Phase::EVALUATE);
+
+        // Tokenize the expression into a vector of tokens
+        auto tokens = tokenizer.tokenize(expression);
+        
+        // Stack to store operand values (true/false)
+        std::stack<bool> valueStack;
+        size_t peakDepth = 0; // Largest size of the value stack, for the instrumentation
+        uint64_t operatorsApplied = 0;
+        
+        // Stack to store operators and parentheses
+        std::stack<ExpressionTokenizer::Token> operatorStack;
+
+        /**
+         * @brief Iterate through each token in the tokenized expression.
+         * - If the token is a variable, push its value onto the value stack.
+         * - If the token is an operator, process operators with higher or equal precedence
+         *   from the operator stack and then push the current operator onto the stack.
+         * - If the token is a parenthesis, handle '(' by pushing it onto the operator stack,
+         *   and handle ')' by processing until the matching '(' is found and then removing it.
+         * - If an invalid token is encountered, throw a runtime error.
+         */
+        for (const auto& token : tokens) {
+            switch (token.type) {
+            case ExpressionTokenizer::TokenType::VARIABLE:
+                // Push the value of the variable onto the value stack, unset variables are false
+                {
+                    auto found = variableValues.find(token.text);
+                    valueStack.push(found != variableValues.end() && found->second);
+                    peakDepth = std::max(peakDepth, valueStack.size());
+                }
+                break;
+
+            case ExpressionTokenizer::TokenType::OPERATOR:
+                // Process operators with higher or equal precedence
+                while (!operatorStack.empty() && 
+                   operatorStack.top().type == ExpressionTokenizer::TokenType::OPERATOR &&
+                   operatorStack.top().precedence >= token.precedence) {
+                // Evaluate the top operator in the stack
+                processTopOperator(valueStack, operatorStack);
+                ++operatorsApplied;
+                }
+                // Push the current operator onto the operator stack
+                operatorStack.push(token);
+                break;
+
+            case ExpressionTokenizer::TokenType::PARENTHESIS:
+                if (token.value == '(') {
+                // Push '(' onto the operator stack
+                operatorStack.push(token);
+                } else {
+                // Process until matching '(' is found
+                while (!operatorStack.empty() && operatorStack.top().value != '(') {
+                    // Evaluate the top operator in the stack
+                    processTopOperator(valueStack, operatorStack);
+                    ++operatorsApplied;
+                }
+                if (!operatorStack.empty()) {
+                    // Remove '(' from the stack
+                    operatorStack.pop();
+                }
+                }
+                break;
+
+            default:
+                // Throw an error if an invalid token is encountered
+                throw std::runtime_error("Invalid token encountered");
+            }
+        }
+
+        // Process any remaining operators in the stack
+        while (!operatorStack.empty()) {
+            // Evaluate the top operator in the stack
+            processTopOperator(valueStack, operatorStack);
+            ++operatorsApplied;
+        }
+
+        if (Instrumentation::enabled()) {
+            Instrumentation::add(Instrumentation::Counter::ROWS_EVALUATED, 1);
+            Instrumentation::add(Instrumentation::Counter::OPERATORS_APPLIED, operatorsApplied);
+            Instrumentation::peakStackDepth(peakDepth);
+        }
+
+        // Return the final result from the value stack
+        return valueStack.empty() ? false : valueStack.top();
+    }
+
+private:
+    /**
+     * @brief Processes the top operator from the operator stack and applies it to the values in the value stack.
+     *
+     * This function pops the top operator from the operator stack and applies it to the values in the value stack.
+     * If the operator is a unary operator (e.g., '~' for NOT), it pops one value from the value stack, applies the
+     * operator, and pushes the result back onto the value stack.
+     * If the operator is a binary operator (e.g., '&' for AND, '|' for OR), it pops two values from the value stack,
+     * applies the operator, and pushes the result back onto the value stack.
+     *
+     * @param valueStack A stack of boolean values representing the operands.
+     * @param operatorStack A stack of tokens representing the operators.
+     */
+    void processTopOperator(std::stack<bool>& valueStack,
+                           std::stack<ExpressionTokenizer::Token>& operatorStack) {
+        auto op = operatorStack.top();
+        operatorStack.pop();
+
+        if (op.value == '~') {
+            if (valueStack.empty()) throw std::runtime_error("Invalid expression");
+            bool val = valueStack.top();
+            valueStack.pop();
+            valueStack.push(evaluateOperation(op.value, val)); // Evaluate NOT operation
+        } else {
+            if (valueStack.size() < 2) throw std::runtime_error("Invalid expression");
+            bool val2 = valueStack.top();
+            valueStack.pop();
+            bool val1 = valueStack.top();
+            valueStack.pop();
+            valueStack.push(evaluateOperation(op.value, val1, val2)); // Evaluate binary operation
+        }
+    }
+};;
+
+/**
+ * @class SymbolTable
+ * @brief Interns variable names to dense ids.
+ *
+ * Ids are handed out in order of first appearance, so a formula with n distinct variables uses the
+ * ids 0..n-1 whatever its names look like. Names are stored once; the index refers to that storage.
+ */
+class SymbolTable {
+private:
+    std::pmr::deque<std::pmr::string> names; // Name of each id, a deque so the views in the index stay valid
+    std::pmr::unordered_map<std::string_view, uint32_t> ids; // Id of each name
+
+public:
+    /**
+     * @param resource Memory for the names and the index, such as the arena of a batch record
+     */
+    explicit SymbolTable(std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+        : names(resource), ids(resource) {}
+
+    /**
+     * @brief Returns the id of a name, assigning the next free id if it is new
+     */
+    uint32_t intern(std::string_view name) {
+        auto found = ids.find(name);
+        if (found != ids.end()) return found->second;
+        names.emplace_back(name);
+        uint32_t id = static_cast<uint32_t>(names.size() - 1);
+        ids.emplace(names.back(), id);
+        return id;
+    }
+
+    /**
+     * @brief Returns the id of a name, or -1 if it has not been interned
+     */
+    int64_t find(std::string_view name) const {
+        auto found = ids.find(name);
+        return found == ids.end() ? -1 : static_cast<int64_t>(found->second);
+    }
+
+    size_t size() const { return names.size(); }
+    std::string_view name(uint32_t id) const { return names[id]; }
+
+    /**
+     * @brief Forgets the names interned after the first count, such as those of a rejected expression
+     */
+    void truncate(size_t count) {
+        while (names.size() > count) {
+            ids.erase(names.back());
+            names.pop_back();
+        }
+    }
+};
+
+/**
+ * @class CompiledExpression
+ * @brief A logical expression compiled into a flat postfix program over dense variable slots.
+ *
+ * The program is produced once by ExpressionCompiler and can then be executed for any number of
+ * assignments. Execution does no allocation, no map lookups and no validity checks: the compiler
+ * has already rejected malformed expressions and computed the exact stack depth the program needs.
+ */
+class CompiledExpression {
+public:
+    /**
+     * @brief Instructions of the postfix program
+     */
+    enum class OpCode : uint8_t {
+        LOAD,          // Push the value of a variable slot
+        CONSTANT,      // Push false (slot 0) or true (slot 1)
+        NOT,
+        AND,
+        OR,
+        IMPLIES,
+        BICONDITIONAL
+    };
+
+    /**
+     * @brief A single postfix instruction, slot is only used by LOAD and CONSTANT
+     */
+    struct Instruction {
+        OpCode op;
+        uint32_t slot;
+    };
+
+    std::pmr::vector<Instruction> code; // Postfix program
+    size_t maxStackDepth = 0; // Largest number of values live on the stack at once
+
+    explicit CompiledExpression(std::pmr::memory_resource* resource = std::pmr::get_default_resource()) : code(resource) {}
+
+    /**
+     * @brief Executes the program over bit-sliced values.
+     *
+     * Every bit position of a word is an independent assignment, so one pass over the program
+     * evaluates the expression for as many assignments as the word has bits and every operator
+     * is a single bitwise instruction. Word is uint64_t or a SIMD vector of them.
+     *
+     * @param values Value word of each variable slot.
+     * @param stack Scratch space of at least maxStackDepth words; the result is left in stack[0].
+     */
+    template <typename Word>
+    LOGIC_ALWAYS_INLINE void execute(const Word* values, Word* stack) const {
+        size_t top = 0;
+        for (const Instruction& ins : code) {
+            switch (ins.op) {
+            case OpCode::LOAD:          stack[top++] = values[ins.slot]; break;
+            case OpCode::CONSTANT:      stack[top++] = ins.slot ? ~Word{} : Word{}; break;
+            case OpCode::NOT:           stack[top - 1] = ~stack[top - 1]; break;
+            case OpCode::AND:           --top; stack[top - 1] &= stack[top]; break;
+            case OpCode::OR:            --top; stack[top - 1] |= stack[top]; break;
+            case OpCode::IMPLIES:       --top; stack[top - 1] = ~stack[top - 1] | stack[top]; break;
+            case OpCode::BICONDITIONAL: --top; stack[top - 1] = ~(stack[top - 1] ^ stack[top]); break;
+            }
+        }
+    }
+
+    /**
+     * @brief Renumbers the variable slots
+     * @param newSlot New slot of every old slot, any indexable container.
+     */
+    template <typename SlotMap>
+    void remapSlots(const SlotMap& newSlot) {
+        for (Instruction& ins : code) {
+            if (ins.op == OpCode::LOAD) ins.slot = newSlot[ins.slot];
+        }
+    }
+
+    /**
+     * @brief Number of operator instructions, the operators applied by one execution
+     */
+    size_t operatorCount() const {
+        size_t count = 0;
+        for (const Instruction& ins : code) count += ins.op != OpCode::LOAD && ins.op != OpCode::CONSTANT;
+        return count;
+    }
+
+    /**
+     * @brief Returns a program that evaluates to a constant
+     */
+    static CompiledExpression constant(bool value, std::pmr::memory_resource* resource = std::pmr::get_default_resource()) {
+        CompiledExpression program(resource);
+        program.code.push_back({OpCode::CONSTANT, value ? 1u : 0u});
+        program.maxStackDepth = 1;
+        return program;
+    }
+};
+
+/**
+ * @class ExpressionCompiler
+ * @brief Validates a logical expression and compiles it into a CompiledExpression.
+ *
+ * The expression is tokenized once by FastLexer and converted to postfix with the shunting-yard algorithm,
+ * using the same precedences and left associativity as LogicalEvaluator. Unlike the evaluator,
+ * every error (invalid characters, missing operands or operators, unbalanced parentheses) is
+ * reported here, so the compiled program never has to check anything at run time.
+ */
+class ExpressionCompiler {
+private:
+    /**
+     * @brief Maps an operator token to its opcode
+     */
+    static CompiledExpression::OpCode opcodeFor(char op) {
+        switch (op) {
+            case '~': return CompiledExpression::OpCode::NOT;
+            case '&': return CompiledExpression::OpCode::AND;
+            case '|': return CompiledExpression::OpCode::OR;
+            case '-': return CompiledExpression::OpCode::IMPLIES;
+            default:  return CompiledExpression::OpCode::BICONDITIONAL;
+        }
+    }
+
+    /**
+     * @brief Appends an operator to the program while tracking the stack depth
+     */
+    static void emitOperator(CompiledExpression& program, size_t& depth, char op) {
+        program.code.push_back({opcodeFor(op), 0});
+        if (op != '~') --depth; // Binary operators consume two values and produce one
+    }
+
+public:
+    /**
+     * @brief Compiles an expression into a postfix program.
+     *
+     * @param expression The logical expression to compile.
+     * @param symbols The variable names; names not seen before are interned, and the slot of a variable is its id.
+     * @param resource Memory for the program and the parse state, such as the arena of a batch record.
+     * @return The compiled program.
+     * @throws std::runtime_error If the expression is malformed.
+     */
+    CompiledExpression compile(std::string_view expression, SymbolTable& symbols,
+                               std::pmr::memory_resource* resource = std::pmr::get_default_resource()) const {
+        Instrumentation::Scope timer(Instrumentation::Phase::COMPILE);
+        FastLexer::Tokens tokens = FastLexer::lex(expression, resource);
+
+        CompiledExpression program(resource);
+        program.code.reserve(tokens.size());
+        std::pmr::vector<ExpressionTokenizer::Token> operatorStack(resource);
+        size_t depth = 0;
+        bool expectOperand = true; // True when the next token has to start an operand
+
+        for (FastLexer::Token span : tokens) {
+            ExpressionTokenizer::Token token = FastLexer::expand(expression, span);
+            switch (token.type) {
+            case ExpressionTokenizer::TokenType::VARIABLE: {
+                if (!expectOperand) {
+                    throw std::runtime_error("Missing operator before '" + std::string(token.text) + "'");
+                }
+                program.code.push_back({CompiledExpression::OpCode::LOAD, symbols.intern(token.text)});
+                program.maxStackDepth = std::max(program.maxStackDepth, ++depth);
+                expectOperand = false;
+                break;
+            }
+
+            case ExpressionTokenizer::TokenType::OPERATOR:
+                if (token.value == '~') {
+                    // NOT is a prefix operator, it binds to the operand that follows it
+                    if (!expectOperand) {
+                        throw std::runtime_error("Missing operator before '~'");
+                    }
+                    operatorStack.push_back(token);
+                    break;
+                }
+                if (expectOperand) {
+                    throw std::runtime_error(std::string("Missing operand before '") + token.value + "'");
+                }
+                // Process operators with higher or equal precedence
+                while (!operatorStack.empty() &&
+                       operatorStack.back().type == ExpressionTokenizer::TokenType::OPERATOR &&
+                       operatorStack.back().precedence >= token.precedence) {
+                    emitOperator(program, depth, operatorStack.back().value);
+                    operatorStack.pop_back();
+                }
+                operatorStack.push_back(token);
+                expectOperand = true;
+                break;
+
+            case ExpressionTokenizer::TokenType::PARENTHESIS:
+                if (token.value == '(') {
+                    if (!expectOperand) {
+                        throw std::runtime_error("Missing operator before '('");
+                    }
+                    operatorStack.push_back(token);
+                    break;
+                }
+                if (expectOperand) {
+                    throw std::runtime_error("Missing operand before ')'");
+                }
+                // Process until matching '(' is found
+                while (!operatorStack.empty() && operatorStack.back().value != '(') {
+                    emitOperator(program, depth, operatorStack.back().value);
+                    operatorStack.pop_back();
+                }
+                if (operatorStack.empty()) {
+                    throw std::runtime_error("Unmatched ')'");
+                }
+                operatorStack.pop_back(); // Remove '(' from the stack
+                break;
+
+            default:
+                throw std::runtime_error(std::string("Invalid token '") + token.value + "'");
+            }
+        }
+
+        if (expectOperand) {
+            throw std::runtime_error(tokens.empty() ? "Empty expression" : "Missing operand at end of expression");
+        }
+
+        // Process any remaining operators in the stack
+        while (!operatorStack.empty()) {
+            if (operatorStack.back().value == '(') {
+                throw std::runtime_error("Unmatched '('");
+            }
+            emitOperator(program, depth, operatorStack.back().value);
+            operatorStack.pop_back();
+        }
+
+        if (Instrumentation::enabled()) Instrumentation::peakStackDepth(program.maxStackDepth);
+        return program;
+    }
+};
+
+#endif // LOGIC_EXPRESSION_HPP
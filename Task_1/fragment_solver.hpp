@@ -0,0 +1,458 @@
+/**
+ * @file fragment_solver.hpp
+ * @brief Polynomial solvers for Horn, 2-CNF and parity arguments.
+ */
+
+#ifndef LOGIC_FRAGMENT_SOLVER_HPP
+#define LOGIC_FRAGMENT_SOLVER_HPP
+
+#include "common.hpp"
+#include "expression.hpp"
+#include "sat_solver.hpp"
+
+/**
+ * @class FragmentSolver
+ * @brief Polynomial decision procedures for the tractable fragments: Horn clauses, 2-CNF and parity equations.
+ *
+ * Expressions are first rewritten structurally, without new variables: into clauses when they are
+ * made of literals, clauses, conjunctions and implications between them, and into equations over GF(2)
+ * when they are made only of variables, ~ and <->. Horn clause sets are decided by unit propagation
+ * to their least model, 2-CNF by the strongly connected components of the implication graph and
+ * parity systems by Gaussian elimination. Each is linear or close to it in the size of the input, so
+ * arguments with 10^5 variables in these fragments take milliseconds.
+ */
+class FragmentSolver {
+public:
+    typedef SatSolver::Literal Literal;
+    typedef std::vector<std::vector<Literal>> Clauses;
+
+    enum class Fragment {
+        NONE,
+        HORN,    // At most one positive literal per clause
+        TWO_SAT, // At most two literals per clause
+        XOR      // Parity equations
+    };
+
+    static const char* fragmentName(Fragment fragment) {
+        switch (fragment) {
+            case Fragment::HORN:    return "Horn-SAT (unit propagation)";
+            case Fragment::TWO_SAT: return "2-SAT (implication graph components)";
+            case Fragment::XOR:     return "XOR (Gaussian elimination over GF(2))";
+            default:                return "none";
+        }
+    }
+
+    /**
+     * @brief A parity equation: the XOR of the variables equals value
+     */
+    struct Equation {
+        std::vector<uint32_t> variables; // Ascending, no duplicates
+        bool value = false;
+    };
+
+    /**
+     * @class ParitySystem
+     * @brief Incremental Gaussian elimination over GF(2) with sparse rows.
+     *
+     * Each stored row is pivoted on its highest variable, so every other variable of a row is lower than
+     * its pivot and a solution is found by assigning the variables in increasing order.
+     */
+    class ParitySystem {
+    private:
+        static constexpr uint32_t NO_ROW = std::numeric_limits<uint32_t>::max();
+        std::vector<Equation> rows;
+        std::vector<uint32_t> pivotRow; // Row whose pivot is the variable, NO_ROW if it is free
+        bool consistent = true;
+
+        /**
+         * @brief XORs b into a; both are ascending
+         */
+        static void addInto(std::vector<uint32_t>& a, const std::vector<uint32_t>& b, std::vector<uint32_t>& scratch) {
+            scratch.clear();
+            std::set_symmetric_difference(a.begin(), a.end(), b.begin(), b.end(), std::back_inserter(scratch));
+            a.swap(scratch);
+        }
+
+    public:
+        explicit ParitySystem(size_t variableCount) : pivotRow(variableCount, NO_ROW) {}
+
+        /**
+         * @brief Reduces an equation by the rows until its highest variable is not a pivot
+         *
+         * The equation follows from the system exactly when it reduces to 0 = 0, and contradicts it
+         * when it reduces to 0 = 1.
+         */
+        void reduce(Equation& equation) const {
+            std::vector<uint32_t> scratch;
+            while (!equation.variables.empty()) {
+                uint32_t row = pivotRow[equation.variables.back()];
+                if (row == NO_ROW) return;
+                addInto(equation.variables, rows[row].variables, scratch);
+                equation.value ^= rows[row].value;
+            }
+        }
+
+        /**
+         * @brief Adds an equation, reducing it by the rows so far
+         * @return False if the system has become inconsistent.
+         */
+        bool add(Equation equation) {
+            reduce(equation);
+            if (equation.variables.empty()) {
+                if (equation.value) consistent = false; // 0 = 1
+                return consistent;
+            }
+            pivotRow[equation.variables.back()] = static_cast<uint32_t>(rows.size());
+            rows.push_back(std::move(equation));
+            return consistent;
+        }
+
+        bool isConsistent() const { return consistent; }
+        size_t rank() const { return rows.size(); }
+
+        /**
+         * @brief A solution of a consistent system, with every free variable false
+         */
+        std::vector<bool> solution() const {
+            std::vector<bool> values(pivotRow.size());
+            for (size_t v = 0; v < pivotRow.size(); ++v) {
+                if (pivotRow[v] == NO_ROW) continue;
+                const Equation& row = rows[pivotRow[v]];
+                bool value = row.value;
+                for (uint32_t u : row.variables) {
+                    if (u != v) value ^= values[u];
+                }
+                values[v] = value;
+            }
+            return values;
+        }
+
+        /**
+         * @brief The solution of a consistent system that is the lowest truth table row.
+         *
+         * Going from the highest variable down, each variable is fixed to false unless the system
+         * already forces it; that takes a reduction per variable, so it is meant for small systems.
+         */
+        std::vector<bool> lowestSolution() const {
+            ParitySystem fixed(*this);
+            for (size_t v = pivotRow.size(); v-- > 0;) {
+                Equation zero{{static_cast<uint32_t>(v)}, false};
+                fixed.reduce(zero);
+                if (!zero.variables.empty()) fixed.add(std::move(zero));
+            }
+            return fixed.solution();
+        }
+    };
+
+private:
+    /**
+     * @brief Sorts a clause and removes duplicate literals
+     * @return False if the clause is a tautology.
+     */
+    static bool normalize(std::vector<Literal>& clause) {
+        std::sort(clause.begin(), clause.end());
+        clause.erase(std::unique(clause.begin(), clause.end()), clause.end());
+        for (size_t i = 1; i < clause.size(); ++i) {
+            if (clause[i] == SatSolver::negate(clause[i - 1])) return false; // x and ~x are adjacent once sorted
+        }
+        return true;
+    }
+
+    /**
+     * @brief NOT of a clause set, if it is a single clause or all unit clauses
+     */
+    static bool negateClauses(const Clauses& in, Clauses& out) {
+        out.clear();
+        if (in.size() == 1) {
+            for (Literal literal : in[0]) out.push_back({SatSolver::negate(literal)});
+            return true;
+        }
+        std::vector<Literal> clause;
+        for (const auto& unit : in) {
+            if (unit.size() != 1) return false;
+            clause.push_back(SatSolver::negate(unit[0]));
+        }
+        out.push_back(std::move(clause));
+        return true;
+    }
+
+    /**
+     * @brief OR of two clause sets, if one of them is a single clause
+     */
+    static bool orClauses(const Clauses& a, const Clauses& b, Clauses& out) {
+        const Clauses* single = a.size() == 1 ? &a : b.size() == 1 ? &b : nullptr;
+        if (!single) return false;
+        const Clauses& other = single == &a ? b : a;
+        out.clear();
+        for (const auto& clause : other) {
+            out.push_back(clause);
+            out.back().insert(out.back().end(), (*single)[0].begin(), (*single)[0].end());
+        }
+        return true;
+    }
+
+public:
+    /**
+     * @brief Rewrites an expression into clauses without new variables
+     * @param program The expression.
+     * @param out Receives the clauses, without tautologies and duplicate literals.
+     * @return False if the expression is not a combination of clauses that stays small.
+     */
+    static bool toClauses(const CompiledExpression& program, Clauses& out) {
+        using OpCode = CompiledExpression::OpCode;
+        const size_t limit = 4 * program.code.size() + 16; // Literals allowed in total, against blow-up
+        std::vector<Clauses> stack;
+        stack.reserve(program.code.size());
+        Clauses notA, notB, left, right;
+        for (const auto& ins : program.code) {
+            switch (ins.op) {
+            case OpCode::LOAD:
+                stack.push_back({{SatSolver::positive(ins.slot)}});
+                break;
+            case OpCode::CONSTANT:
+                stack.push_back(ins.slot ? Clauses{} : Clauses{{}}); // True has no clauses, false the empty one
+                break;
+            case OpCode::NOT:
+                if (!negateClauses(stack.back(), notA)) return false;
+                stack.back().swap(notA);
+                break;
+            default: {
+                Clauses b = std::move(stack.back());
+                stack.pop_back();
+                Clauses a = std::move(stack.back());
+                Clauses& result = stack.back();
+                if (ins.op == OpCode::AND) {
+                    result = std::move(a);
+                    result.insert(result.end(), b.begin(), b.end());
+                } else if (ins.op == OpCode::OR) {
+                    if (!orClauses(a, b, result)) return false;
+                } else if (ins.op == OpCode::IMPLIES) {
+                    if (!negateClauses(a, notA) || !orClauses(notA, b, result)) return false;
+                } else { // a <-> b is (~a | b) & (a | ~b)
+                    if (!negateClauses(a, notA) || !negateClauses(b, notB) ||
+                        !orClauses(notA, b, left) || !orClauses(a, notB, right)) return false;
+                    result = std::move(left);
+                    result.insert(result.end(), right.begin(), right.end());
+                }
+                size_t literals = 0;
+                for (const auto& clause : result) literals += clause.size();
+                if (literals > limit) return false;
+            }
+            }
+        }
+        out.clear();
+        for (auto& clause : stack.back()) {
+            if (normalize(clause)) out.push_back(std::move(clause));
+        }
+        return true;
+    }
+
+    /**
+     * @brief Rewrites an expression that is true exactly when a set of parity equations holds
+     * @param program The expression.
+     * @param out Receives the equations.
+     * @return False if the expression uses anything but variables, constants, ~, <-> and a top-level &.
+     */
+    static bool toParity(const CompiledExpression& program, std::vector<Equation>& out) {
+        using OpCode = CompiledExpression::OpCode;
+        struct Entry {
+            Equation affine; // The value of the subexpression is XOR(variables) ^ value
+            std::vector<Equation> system; // For a conjunction: equations that all hold
+            bool conjunction = false;
+        };
+        std::vector<Entry> stack;
+        std::vector<uint32_t> scratch;
+        for (const auto& ins : program.code) {
+            switch (ins.op) {
+            case OpCode::LOAD:
+                stack.push_back({{{ins.slot}, false}, {}, false});
+                break;
+            case OpCode::CONSTANT:
+                stack.push_back({{{}, ins.slot != 0}, {}, false});
+                break;
+            case OpCode::NOT:
+                if (stack.back().conjunction) return false;
+                stack.back().affine.value = !stack.back().affine.value;
+                break;
+            case OpCode::BICONDITIONAL: {
+                Entry b = std::move(stack.back());
+                stack.pop_back();
+                Entry& a = stack.back();
+                if (a.conjunction || b.conjunction) return false;
+                scratch.clear();
+                std::set_symmetric_difference(a.affine.variables.begin(), a.affine.variables.end(),
+                                              b.affine.variables.begin(), b.affine.variables.end(),
+                                              std::back_inserter(scratch));
+                a.affine.variables.swap(scratch);
+                a.affine.value = !(a.affine.value ^ b.affine.value); // a <-> b is a ^ b ^ 1
+                break;
+            }
+            case OpCode::AND: {
+                Entry b = std::move(stack.back());
+                stack.pop_back();
+                Entry& a = stack.back();
+                for (Entry* side : {&a, &b}) {
+                    if (!side->conjunction) {
+                        side->affine.value = !side->affine.value; // The expression is true when XOR(vars) = ~value
+                        side->system.push_back(std::move(side->affine));
+                        side->conjunction = true;
+                    }
+                }
+                a.system.insert(a.system.end(), b.system.begin(), b.system.end());
+                break;
+            }
+            default:
+                return false;
+            }
+        }
+        Entry& top = stack.back();
+        if (!top.conjunction) {
+            top.affine.value = !top.affine.value;
+            top.system.push_back(std::move(top.affine));
+        }
+        out = std::move(top.system);
+        return true;
+    }
+
+    static bool isHorn(const Clauses& clauses) {
+        for (const auto& clause : clauses) {
+            size_t positives = 0;
+            for (Literal literal : clause) positives += !(literal & 1);
+            if (positives > 1) return false;
+        }
+        return true;
+    }
+
+    static bool isTwoCnf(const Clauses& clauses) {
+        for (const auto& clause : clauses) {
+            if (clause.size() > 2) return false;
+        }
+        return true;
+    }
+
+    /**
+     * @brief Decides a Horn clause set by unit propagation from all-false.
+     *
+     * Each clause is a rule: once every variable of its negative literals is true, its positive literal
+     * has to be; a rule without one is violated. The propagation visits each literal once.
+     *
+     * @param model Receives the least model if there is one.
+     * @return True if the clauses are satisfiable.
+     */
+    static bool solveHorn(size_t variableCount, const Clauses& clauses, std::vector<bool>& model) {
+        static constexpr uint32_t NO_HEAD = std::numeric_limits<uint32_t>::max();
+        std::vector<uint32_t> pending(clauses.size()); // Negative literals whose variable is not yet true
+        std::vector<uint32_t> head(clauses.size(), NO_HEAD);
+        std::vector<std::vector<uint32_t>> occurrences(variableCount); // Clauses with the variable negated
+        std::vector<uint32_t> queue;
+        model.assign(variableCount, false);
+
+        auto fire = [&](uint32_t c) {
+            if (head[c] == NO_HEAD) return false;
+            if (!model[head[c]]) {
+                model[head[c]] = true;
+                queue.push_back(head[c]);
+            }
+            return true;
+        };
+        for (uint32_t c = 0; c < clauses.size(); ++c) {
+            for (Literal literal : clauses[c]) {
+                if (literal & 1) {
+                    occurrences[SatSolver::variableOf(literal)].push_back(c);
+                    ++pending[c];
+                } else {
+                    head[c] = SatSolver::variableOf(literal);
+                }
+            }
+        }
+        for (uint32_t c = 0; c < clauses.size(); ++c) {
+            if (pending[c] == 0 && !fire(c)) return false;
+        }
+        while (!queue.empty()) {
+            uint32_t variable = queue.back();
+            queue.pop_back();
+            for (uint32_t c : occurrences[variable]) {
+                if (--pending[c] == 0 && !fire(c)) return false;
+            }
+        }
+        return true;
+    }
+
+    /**
+     * @brief Decides a 2-CNF clause set with Tarjan's algorithm on its implication graph.
+     *
+     * Clause (a | b) gives the edges ~a -> b and ~b -> a. The clauses are satisfiable unless a variable
+     * and its negation share a strongly connected component; then a variable is true when its component
+     * comes after its negation's in topological order.
+     *
+     * @param model Receives a model if there is one.
+     * @return True if the clauses are satisfiable.
+     */
+    static bool solveTwoSat(size_t variableCount, const Clauses& clauses, std::vector<bool>& model) {
+        const size_t nodes = 2 * variableCount; // Node of a literal is the literal itself
+        std::vector<uint32_t> edgeStart(nodes + 1, 0);
+        for (const auto& clause : clauses) {
+            if (clause.empty()) return false;
+            Literal a = clause[0], b = clause.size() > 1 ? clause[1] : clause[0];
+            ++edgeStart[SatSolver::negate(a) + 1];
+            ++edgeStart[SatSolver::negate(b) + 1];
+        }
+        for (size_t i = 0; i < nodes; ++i) edgeStart[i + 1] += edgeStart[i];
+        std::vector<uint32_t> edges(edgeStart[nodes]);
+        std::vector<uint32_t> fill(edgeStart.begin(), edgeStart.end() - 1);
+        for (const auto& clause : clauses) {
+            Literal a = clause[0], b = clause.size() > 1 ? clause[1] : clause[0];
+            edges[fill[SatSolver::negate(a)]++] = b;
+            edges[fill[SatSolver::negate(b)]++] = a;
+        }
+
+        // Iterative Tarjan, components are numbered in reverse topological order
+        static constexpr uint32_t UNVISITED = std::numeric_limits<uint32_t>::max();
+        std::vector<uint32_t> index(nodes, UNVISITED), low(nodes), component(nodes, UNVISITED);
+        std::vector<uint32_t> stack, callStack, nextEdge(nodes);
+        uint32_t counter = 0, components = 0;
+        for (uint32_t root = 0; root < nodes; ++root) {
+            if (index[root] != UNVISITED) continue;
+            callStack.push_back(root);
+            index[root] = low[root] = counter++;
+            nextEdge[root] = edgeStart[root];
+            stack.push_back(root);
+            while (!callStack.empty()) {
+                uint32_t node = callStack.back();
+                if (nextEdge[node] < edgeStart[node + 1]) {
+                    uint32_t next = edges[nextEdge[node]++];
+                    if (index[next] == UNVISITED) {
+                        index[next] = low[next] = counter++;
+                        nextEdge[next] = edgeStart[next];
+                        stack.push_back(next);
+                        callStack.push_back(next);
+                    } else if (component[next] == UNVISITED) {
+                        low[node] = std::min(low[node], index[next]);
+                    }
+                    continue;
+                }
+                callStack.pop_back();
+                if (!callStack.empty()) low[callStack.back()] = std::min(low[callStack.back()], low[node]);
+                if (low[node] == index[node]) {
+                    uint32_t member;
+                    do {
+                        member = stack.back();
+                        stack.pop_back();
+                        component[member] = components;
+                    } while (member != node);
+                    ++components;
+                }
+            }
+        }
+
+        model.assign(variableCount, false);
+        for (uint32_t v = 0; v < variableCount; ++v) {
+            uint32_t positive = component[SatSolver::positive(v)], negative = component[SatSolver::negative(v)];
+            if (positive == negative) return false;
+            model[v] = positive < negative;
+        }
+        return true;
+    }
+};
+
+#endif // LOGIC_FRAGMENT_SOLVER_HPP
@@ -0,0 +1,134 @@
+/**
+ * @file generate.cpp
+ * @brief Generator of seeded random arguments for stress tests, benchmarks and differential checks.
+ *
+ * The output is either a Task_1 problem file (one premise per line, then the conclusion after "=>")
+ * or Task_2 expressions (one per line, tokens separated by spaces, AND/OR/NOT only). The same seed
+ * and options give the same bytes on every platform, since the generator does not use the standard
+ * distributions, whose results differ between library implementations.
+ *
+ * Usage:
+ *     logic_generate [--syntax=task1|task2] [--shape=tree|cnf] [--seed=N] [--variables=N]
+ *                    [--premises=N] [--depth=N] [--clause-size=K] [--density=R] [--shared=RATIO]
+ *                    [--no-conclusion] [--output=FILE]
+ *
+ * - tree: every premise is a random formula whose operators nest up to depth levels deep.
+ * - cnf: every premise is a clause of clause-size distinct variables, density clauses per variable
+ *   (4.26 by default, the phase transition of random 3-SAT). In Task_2 syntax every expression is
+ *   the conjunction of all the clauses.
+ * - shared: probability that an operand is a copy of an earlier subformula instead of a new one, so
+ *   that the same subformulas recur within and across premises.
+ *
+ * Text is written as it is generated and flushed in blocks of a megabyte, so memory stays bounded
+ * whatever the size of the output or of a single formula.
+ */
+
+#include <charconv>
+#include <cstring>
+#include <iostream>
+#include <type_traits>
+
+#include "argument_generator.hpp"
+
+namespace {
+
+/**
+ * @brief Parses the whole value of a numeric option
+ * @param option The option, for the error message.
+ * @param text The value after the '='.
+ * @throws std::runtime_error If the value is not a number of type T or has anything after it.
+ */
+template <typename T>
+T parseNumber(const char* option, const char* text) {
+    T number{};
+    const char* end = text + std::strlen(text);
+    auto [stop, error] = std::from_chars(text, end, number);
+    if (error != std::errc() || stop != end) {
+        const char* kind = std::is_integral_v<T> ? " needs a whole number" : " needs a number";
+        throw std::runtime_error(std::string(option) + kind + ", not '" + text + "'");
+    }
+    return number;
+}
+
+GeneratorOptions parseGeneratorOptions(int argc, char* argv[]) {
+    GeneratorOptions options;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto value = [&](const char* prefix) -> const char* {
+            size_t length = std::strlen(prefix);
+            return arg.compare(0, length, prefix) == 0 ? argv[i] + length : nullptr;
+        };
+        if (const char* v = value("--syntax=")) {
+            if (std::strcmp(v, "task1") == 0) {
+                options.syntax = GeneratorOptions::Syntax::TASK1;
+            } else if (std::strcmp(v, "task2") == 0) {
+                options.syntax = GeneratorOptions::Syntax::TASK2;
+            } else {
+                throw std::runtime_error("Unknown syntax '" + std::string(v) + "'");
+            }
+        } else if (const char* v = value("--shape=")) {
+            if (std::strcmp(v, "tree") == 0) {
+                options.shape = GeneratorOptions::Shape::TREE;
+            } else if (std::strcmp(v, "cnf") == 0) {
+                options.shape = GeneratorOptions::Shape::CNF;
+            } else {
+                throw std::runtime_error("Unknown shape '" + std::string(v) + "'");
+            }
+        } else if (const char* v = value("--seed=")) {
+            options.seed = parseNumber<uint64_t>("--seed", v);
+        } else if (const char* v = value("--variables=")) {
+            options.variables = parseNumber<size_t>("--variables", v);
+        } else if (const char* v = value("--premises=")) {
+            options.premises = parseNumber<size_t>("--premises", v);
+        } else if (const char* v = value("--depth=")) {
+            options.depth = parseNumber<size_t>("--depth", v);
+        } else if (const char* v = value("--clause-size=")) {
+            options.clauseSize = parseNumber<size_t>("--clause-size", v);
+        } else if (const char* v = value("--density=")) {
+            options.density = parseNumber<double>("--density", v);
+        } else if (const char* v = value("--shared=")) {
+            options.shared = parseNumber<double>("--shared", v);
+        } else if (arg == "--no-conclusion") {
+            options.conclusion = false;
+        } else if (const char* v = value("--output=")) {
+            options.outputPath = v;
+        } else {
+            throw std::runtime_error("Unknown option '" + arg + "'");
+        }
+    }
+
+    if (options.variables == 0) throw std::runtime_error("At least one variable is needed");
+    if (options.depth > 64) throw std::runtime_error("The depth is at most 64");
+    if (options.shape == GeneratorOptions::Shape::CNF &&
+        (options.clauseSize == 0 || options.clauseSize > 64 || options.clauseSize > options.variables)) {
+        throw std::runtime_error("The clause size must be between 1 and 64 and at most the variable count");
+    }
+    if (!(options.density >= 0)) throw std::runtime_error("The density must not be negative");
+    if (!(options.shared >= 0 && options.shared <= 1)) throw std::runtime_error("The shared ratio must be between 0 and 1");
+    return options;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    try {
+        GeneratorOptions options = parseGeneratorOptions(argc, argv);
+        std::FILE* file = stdout;
+        if (!options.outputPath.empty()) {
+            file = std::fopen(options.outputPath.c_str(), "wb");
+            if (!file) throw std::runtime_error("Cannot open '" + options.outputPath + "' for writing");
+        }
+        {
+            ReadBackBuffer out(file);
+            ArgumentGenerator(options, out).generate();
+            out.flush();
+        }
+        if (file != stdout && std::fclose(file) != 0) {
+            throw std::runtime_error("Cannot write '" + options.outputPath + "'");
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        return 2;
+    }
+    return 0;
+}
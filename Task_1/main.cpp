@@ -2,532 +2,440 @@
  * @file main.cpp
  * @brief logical expression analyzer that generates truth tables and analyzes logical validity and satisfiability.
  * 
- * Checking for valid and satisfiable logical expressions at line 415 :D
+ * Checking for valid and satisfiable logical expressions in TruthTableGenerator::generateAndAnalyze (truth_table_generator.hpp) :D
  * 
  */
 
-#include <iostream>
-#include <vector>
-#include <string>
-#include <map>
-#include <stack>
-#include <bitset> 
-#include <unordered_set> // For unique variables
-#include <algorithm> // For std::sort
-#include <iomanip> // For std::setw
-
-// Constants for terminal colors
-namespace Colors {
-    const std::string RESET = "\033[0m";
-    const std::string RED = "\033[31m";
-    const std::string GREEN = "\033[32m";
-    const std::string YELLOW = "\033[33m";
-    const std::string BLUE = "\033[34m";
-    const std::string MAGENTA = "\033[35m";
-    const std::string BOLD = "\033[1m";
-}
+#include "common.hpp"
+#include "problem.hpp"
+#include "evaluation.hpp"
+#include "table_sink.hpp"
+#include "sat_solver.hpp"
+#include "model_counter.hpp"
+#include "fragment_solver.hpp"
+#include "truth_vector_cache.hpp"
+#include "truth_table_generator.hpp"
+#include "analysis_planner.hpp"
+#include "analysis_session.hpp"
+#include "batch_checker.hpp"
 
 /**
- * @class ExpressionTokenizer
- * @brief Handles the tokenization of logical expressions into their component parts
+ * @brief Command line options of the analyzer
  */
-class ExpressionTokenizer {
-public:
-    /**
-     * @brief Token types for logical expressions
-     */
-    enum class TokenType {
-        VARIABLE,
-        OPERATOR,
-        PARENTHESIS,
-        INVALID
-    };
-
-    /**
-     * @brief Structure to represent a token in the expression
-     */
-    struct Token {
-        TokenType type;
-        char value;
-        int precedence; // Operator precedence, -1 for non-operators
+struct AnalyzerOptions {
+    bool analyzeOnly = false; // Skip the truth table and only print the analysis
+    BitSlicedEvaluator::Isa isa = BitSlicedEvaluator::detectIsa(); // Instruction set of the sweep
+    size_t threads = 0; // Workers of the analysis, 0 for one per hardware thread
+    bool exhaustive = false; // Sweep the whole table even after a counterexample is found
+    enum class Engine {
+        AUTO,      // Let the planner pick; the truth table itself is always enumerated
+        ENUMERATE, // Evaluate every row of the truth table
+        SAT,       // Decide the argument with the SAT solver
+        BDD,       // Decide and count the argument with binary decision diagrams
+        COUNT,     // Decide and count the argument with the #SAT model counter
+        FRAGMENT,  // Decide the argument with the Horn, 2-SAT or parity fast path
+        APPROXIMATE, // Estimate the counts with the hashing-based approximate counter
+        GRAY,      // Count every row in Gray-code order with incremental re-evaluation
+        REFUTE     // Search for a counterexample conclusion first, short-circuiting the premises
     };
+    Engine engine = Engine::AUTO;
+    double budget = 1.0; // Seconds per engine tried by the planner before it falls back
+    ApproximateCounter::Parameters approximation; // Tolerance, confidence and seed of the approximate counter
+    TruthTableGenerator::BddOrder bddOrder = TruthTableGenerator::BddOrder::APPEARANCE; // Initial BDD order
+    bool sift = false; // Reorder the BDD variables by sifting
+    bool validityOnly = false; // Only decide validity, with the refute engine
+    std::string format = "color"; // Truth table format: color, text, csv or binary
+    std::string outputPath; // File to write the truth table to, standard output if empty
+    bool criticalOnly = false; // Only write the critical rows of the truth table
+    std::string inputPath; // Problem file to read instead of prompting, if not empty
+    ProblemReader::Format inputFormat = ProblemReader::Format::AUTO; // Format of the problem file
+    bool batch = false; // Check a stream of arguments, one result line each
+    bool session = false; // Edit an argument interactively with incremental re-evaluation
+    std::string cachePath; // Truth vector cache file for --analyze-only, none if empty
+    uint64_t cacheSize = uint64_t{256} << 20; // Size of a new cache file in bytes
+    BatchChecker::Framing batchFraming = BatchChecker::Framing::LINES; // How batch records are delimited
+    bool stats = false; // Print phase times and counters as JSON at the end
+    std::string statsPath; // File for the statistics, standard error if empty
+    std::string tracePath; // Chrome trace-event file to write, if not empty
+};
 
-private:
-    // Operator precedence map for tokenization
-    const std::map<char, int> operatorPrecedence = {
-        {'~', 4},  // NOT
-        {'&', 3},  // AND
-        {'|', 2},  // OR
-        {'-', 1},  // IMPLIES
-        {'<', 0}   // BICONDITIONAL
-    };
-
-public:
-    /**
-     * @brief Tokenizes an input expression into a vector of tokens
-     * @param expression The logical expression to tokenize
-     * @return Vector of tokens
-     */
-    std::vector<Token> tokenize(const std::string& expression) {
-        std::vector<Token> tokens;
-        
-        for (size_t i = 0; i < expression.length(); ++i) {
-            char c = expression[i];
-            
-            // Skip whitespace
-            if (std::isspace(c)) continue;
-
-            // Handle special operators 
-            if (c == '-' && i + 1 < expression.length() && expression[i + 1] == '>') {
-                // This line adds a new Token to the 'tokens' vector. The Token is created using an initializer list
-                // with three elements: the type of the token (TokenType::OPERATOR), the character representing the 
-                // operator ('-'), and the precedence of the operator (retrieved from the 'operatorPrecedence' map).
-                tokens.push_back({TokenType::OPERATOR, '-', operatorPrecedence.at('-')}); // Implication '->'
-                ++i;
-                continue;
+/**
+ * @brief Parses the command line options
+ * @throws std::runtime_error If an option is unknown or not supported by this CPU.
+ */
+AnalyzerOptions parseOptions(int argc, char* argv[]) {
+    AnalyzerOptions options;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--analyze-only") {
+            options.analyzeOnly = true;
+        } else if (arg == "--engine=sat") {
+            options.engine = AnalyzerOptions::Engine::SAT;
+        } else if (arg == "--engine=bdd") {
+            options.engine = AnalyzerOptions::Engine::BDD;
+        } else if (arg == "--engine=count") {
+            options.engine = AnalyzerOptions::Engine::COUNT;
+        } else if (arg == "--engine=fragment") {
+            options.engine = AnalyzerOptions::Engine::FRAGMENT;
+        } else if (arg == "--engine=approx") {
+            options.engine = AnalyzerOptions::Engine::APPROXIMATE;
+        } else if (arg.rfind("--epsilon=", 0) == 0) {
+            options.approximation.epsilon = std::stod(arg.substr(10));
+        } else if (arg.rfind("--delta=", 0) == 0) {
+            options.approximation.delta = std::stod(arg.substr(8));
+        } else if (arg.rfind("--seed=", 0) == 0) {
+            options.approximation.seed = std::stoull(arg.substr(7));
+        } else if (arg == "--engine=gray") {
+            options.engine = AnalyzerOptions::Engine::GRAY;
+        } else if (arg == "--engine=refute") {
+            options.engine = AnalyzerOptions::Engine::REFUTE;
+        } else if (arg == "--validity-only") {
+            options.validityOnly = true;
+        } else if (arg == "--engine=enumerate") {
+            options.engine = AnalyzerOptions::Engine::ENUMERATE;
+        } else if (arg == "--engine=auto") {
+            options.engine = AnalyzerOptions::Engine::AUTO;
+        } else if (arg.rfind("--budget=", 0) == 0) {
+            options.budget = std::stod(arg.substr(9));
+            if (!(options.budget > 0)) throw std::runtime_error("The budget must be a positive number of seconds");
+        } else if (arg.rfind("--bdd-order=", 0) == 0) {
+            std::string name = arg.substr(12);
+            if (name == "natural") options.bddOrder = TruthTableGenerator::BddOrder::NATURAL;
+            else if (name == "appearance") options.bddOrder = TruthTableGenerator::BddOrder::APPEARANCE;
+            else if (name == "frequency") options.bddOrder = TruthTableGenerator::BddOrder::FREQUENCY;
+            else throw std::runtime_error("Unknown BDD order '" + name + "' (use natural, appearance or frequency)");
+        } else if (arg.rfind("--format=", 0) == 0) {
+            options.format = arg.substr(9);
+            if (options.format != "color" && options.format != "text" && options.format != "csv" &&
+                options.format != "binary") {
+                throw std::runtime_error("Unknown format '" + options.format + "' (use color, text, csv or binary)");
             }
-            if (c == '<' && i + 2 < expression.length() && expression[i + 1] == '-' && expression[i + 2] == '>') {
-                // This line adds a new Token to the 'tokens' vector. The Token is created using an initializer list
-                // with three elements: the type of the token (TokenType::OPERATOR), the character representing the
-                // operator ('<'), and the precedence of the operator (retrieved from the 'operatorPrecedence' map).
-                tokens.push_back({TokenType::OPERATOR, '<', operatorPrecedence.at('<')}); // Biconditional '<->'
-                i += 2;
-                continue;
+        } else if (arg.rfind("--output=", 0) == 0) {
+            options.outputPath = arg.substr(9);
+        } else if (arg.rfind("--input=", 0) == 0) {
+            options.inputPath = arg.substr(8);
+        } else if (arg.rfind("--input-format=", 0) == 0) {
+            std::string name = arg.substr(15);
+            if (name == "auto") options.inputFormat = ProblemReader::Format::AUTO;
+            else if (name == "text") options.inputFormat = ProblemReader::Format::TEXT;
+            else if (name == "dimacs") options.inputFormat = ProblemReader::Format::DIMACS;
+            else throw std::runtime_error("Unknown input format '" + name + "' (use auto, text or dimacs)");
+        } else if (arg.rfind("--cache=", 0) == 0) {
+            options.cachePath = arg.substr(8);
+        } else if (arg.rfind("--cache-size=", 0) == 0) {
+            const std::string value = arg.substr(13);
+            uint64_t megabytes = 0;
+            auto [end, error] = std::from_chars(value.data(), value.data() + value.size(), megabytes);
+            if (error != std::errc() || end != value.data() + value.size() || megabytes == 0 ||
+                megabytes > std::numeric_limits<uint64_t>::max() >> 20) { // The size in bytes has to fit in 64 bits
+                throw std::runtime_error("--cache-size needs a positive whole number of megabytes, not '" + value + "'");
             }
-
-            // Categorize token
-            Token token;
-            if (std::isalpha(c)) {
-                token = {TokenType::VARIABLE, c, -1};
-            } else if (c == '(' || c == ')') {
-                token = {TokenType::PARENTHESIS, c, -1};
-            } else if (operatorPrecedence.count(c)) {
-                token = {TokenType::OPERATOR, c, operatorPrecedence.at(c)};
-            } else {
-                token = {TokenType::INVALID, c, -1};
+            options.cacheSize = megabytes << 20;
+        } else if (arg == "--session") {
+            options.session = true;
+        } else if (arg == "--batch") {
+            options.batch = true;
+        } else if (arg.rfind("--batch-format=", 0) == 0) {
+            std::string name = arg.substr(15);
+            if (name == "lines") options.batchFraming = BatchChecker::Framing::LINES;
+            else if (name == "length") options.batchFraming = BatchChecker::Framing::LENGTH_PREFIX;
+            else throw std::runtime_error("Unknown batch format '" + name + "' (use lines or length)");
+            options.batch = true;
+        } else if (arg == "--stats") {
+            options.stats = true;
+        } else if (arg.rfind("--stats=", 0) == 0) {
+            options.stats = true;
+            options.statsPath = arg.substr(8);
+        } else if (arg.rfind("--trace=", 0) == 0) {
+            options.tracePath = arg.substr(8);
+        } else if (arg == "--critical-only") {
+            options.criticalOnly = true;
+        } else if (arg == "--sift") {
+            options.sift = true;
+        } else if (arg == "--exhaustive") {
+            options.exhaustive = true;
+        } else if (arg.rfind("--threads=", 0) == 0) {
+            options.threads = std::stoul(arg.substr(10));
+        } else if (arg.rfind("--isa=", 0) == 0) {
+            std::string name = arg.substr(6);
+            if (name == "scalar") options.isa = BitSlicedEvaluator::Isa::SCALAR;
+            else if (name == "avx2") options.isa = BitSlicedEvaluator::Isa::AVX2;
+            else if (name == "avx512") options.isa = BitSlicedEvaluator::Isa::AVX512;
+            else throw std::runtime_error("Unknown instruction set '" + name + "' (use scalar, avx2 or avx512)");
+            if (!BitSlicedEvaluator::isSupported(options.isa)) {
+                throw std::runtime_error("This CPU does not support " + name);
             }
-
-            tokens.push_back(token);
+        } else {
+            throw std::runtime_error("Unknown option '" + arg + "'\n"
+                                     "Usage: " + std::string(argv[0]) + " [--engine=auto|enumerate|sat|bdd|count|approx|fragment|gray|refute] [--budget=SECONDS]"
+                                     " [--epsilon=E] [--delta=D] [--seed=N] [--validity-only] [--analyze-only] [--threads=N] [--exhaustive]"
+                                     " [--bdd-order=natural|appearance|frequency] [--sift]"
+                                     " [--input=FILE] [--input-format=auto|text|dimacs] [--batch] [--batch-format=lines|length] [--session] [--cache=FILE] [--cache-size=MB]"
+                                     " [--format=color|text|csv|binary] [--output=FILE] [--critical-only]"
+                                     " [--isa=scalar|avx2|avx512] [--stats[=FILE]] [--trace=FILE]");
         }
-
-        return tokens;
     }
-};
+    return options;
+}
 
 /**
- * @class LogicalEvaluator
- * @brief Handles the evaluation of logical expressions using tokens
+ * @brief Prints the verdicts of a session after a change
  */
-class LogicalEvaluator {
-private:
-    std::map<char, bool> variableValues; // Map to store variable values
-    ExpressionTokenizer tokenizer; // Tokenizer to break down expressions
-
-    /**
-     * @brief Evaluates a single logical operation
-     * @param op The operator character
-     * @param a The first operand
-     * @param b The second operand (optional for unary operators)
-     * @return The result of the logical operation
-     */
-    bool evaluateOperation(char op, bool a, bool b = false) {
-        switch (op) {
-            case '~': return !a;       // NOT operation
-            case '&': return a && b;   // AND operation
-            case '|': return a || b;   // OR operation
-            case '-': return !a || b;  // Implication (a -> b)
-            case '<': return a == b;   // Biconditional (a <-> b)
-            default: return false;     // Invalid operator
+void printSessionAnalysis(const AnalysisSession& session) {
+    AnalysisResult result = session.analyze();
+    std::vector<uint32_t> used = session.usedVariables();
+    std::sort(used.begin(), used.end(), [&](uint32_t a, uint32_t b) { return session.variableName(a) < session.variableName(b); });
+
+    std::cout << "Validity: " << (result.isValid ? Colors::GREEN : Colors::RED) << Colors::BOLD
+              << (result.isValid ? "Valid" : "Falsifiable") << Colors::RESET
+              << "   Satisfiability: " << (result.isSatisfiable ? Colors::GREEN : Colors::RED) << Colors::BOLD
+              << (result.isSatisfiable ? "Satisfiable" : "Not satisfiable") << Colors::RESET << "\n";
+    std::cout << "Critical rows: " << result.criticalRows << " of " << (uint64_t{1} << used.size())
+              << " (" << result.counterexampleRows << " with a false conclusion)\n";
+    if (!result.isValid) {
+        std::cout << "Counterexample:";
+        for (uint32_t id : used) {
+            std::cout << " " << session.variableName(id) << "=" << (result.counterexample[id] ? "T" : "F");
         }
+        std::cout << "\n";
     }
+}
 
-public:
-    /**
-     * @brief Sets the value of a variable
-     * @param var The variable character
-     * @param value The boolean value to set
-     */
-    void setVariable(char var, bool value) {
-        variableValues[var] = value;
-    }
-
-    /**
-     * @brief Evaluates a logical expression using infix notation and operator precedence.
-     * 
-     * This function tokenizes the input logical expression and evaluates it using a stack-based
-     * approach to handle operator precedence and parentheses. It supports variables, logical
-     * operators (NOT, AND, OR, IMPLIES, BICONDITIONAL), and parentheses for grouping.
-     * 
-     * The evaluation process involves:
-     * - Tokenizing the expression into variables, operators, and parentheses.
-     * - Using a value stack to store boolean values of variables.
-     * - Using an operator stack to manage operators and parentheses.
-     * - Processing operators based on their precedence and evaluating sub-expressions.
-     * - Handling parentheses by processing until matching '(' is found.
-     * - Returning the final result of the logical expression.
-     * - Throwing a runtime error for invalid tokens or malformed expressions.
-     * 
-     * @param expression The logical expression to evaluate.
-     * @return The boolean result of the evaluation.
-     * @throws std::runtime_error If an invalid token is encountered or the expression is malformed.
-     */
-    bool evaluate(const std::string& expression) {
-        // Tokenize the expression into a vector of tokens
-        auto tokens = tokenizer.tokenize(expression);
-        
-        // Stack to store operand values (true/false)
-        std::stack<bool> valueStack;
-        
-        // Stack to store operators and parentheses
-        std::stack<ExpressionTokenizer::Token> operatorStack;
-
-        /**
-         * @brief Iterate through each token in the tokenized expression.
-         * - If the token is a variable, push its value onto the value stack.
-         * - If the token is an operator, process operators with higher or equal precedence
-         *   from the operator stack and then push the current operator onto the stack.
-         * - If the token is a parenthesis, handle '(' by pushing it onto the operator stack,
-         *   and handle ')' by processing until the matching '(' is found and then removing it.
-         * - If an invalid token is encountered, throw a runtime error.
-         */
-        for (const auto& token : tokens) {
-            switch (token.type) {
-            case ExpressionTokenizer::TokenType::VARIABLE:
-                // Push the value of the variable onto the value stack
-                valueStack.push(variableValues[token.value]);
-                break;
+/**
+ * @brief Interactive session: edits the argument one command at a time and prints the verdicts after each change
+ */
+void runSession() {
+    AnalysisSession session;
+    std::cout << Colors::BLUE << Colors::BOLD << "\nLogical Expression Analysis Session\n" << Colors::RESET
+              << "Commands: add EXPR, edit N EXPR, remove N, conclusion EXPR, list, help, quit\n";
+
+    // Position of the first non-blank character at or after pos, the size of the text if there is none
+    auto skipBlanks = [](const std::string& text, size_t pos) {
+        size_t found = text.find_first_not_of(" \t", pos);
+        return found == std::string::npos ? text.size() : found;
+    };
 
-            case ExpressionTokenizer::TokenType::OPERATOR:
-                // Process operators with higher or equal precedence
-                while (!operatorStack.empty() && 
-                   operatorStack.top().type == ExpressionTokenizer::TokenType::OPERATOR &&
-                   operatorStack.top().precedence >= token.precedence) {
-                // Evaluate the top operator in the stack
-                processTopOperator(valueStack, operatorStack);
-                }
-                // Push the current operator onto the operator stack
-                operatorStack.push(token);
+    std::string line;
+    while (std::cout << "> " << std::flush, std::getline(std::cin, line)) {
+        size_t start = skipBlanks(line, 0);
+        if (start == line.size()) continue;
+        size_t end = std::min(line.find_first_of(" \t", start), line.size());
+        std::string command = line.substr(start, end - start);
+        std::string rest = line.substr(skipBlanks(line, end));
+
+        // Premise numbers are 1-based, as in list
+        auto premiseNumber = [&](std::string& text) -> size_t {
+            size_t digits = 0;
+            while (digits < text.size() && std::isdigit(static_cast<unsigned char>(text[digits]))) ++digits;
+            if (digits == 0) throw std::runtime_error("Expected a premise number");
+            size_t number = std::stoul(text.substr(0, digits));
+            if (number == 0) throw std::runtime_error("Premises are numbered from 1");
+            text.erase(0, skipBlanks(text, digits));
+            return number - 1;
+        };
+
+        try {
+            if (command == "quit" || command == "exit") {
                 break;
-
-            case ExpressionTokenizer::TokenType::PARENTHESIS:
-                if (token.value == '(') {
-                // Push '(' onto the operator stack
-                operatorStack.push(token);
-                } else {
-                // Process until matching '(' is found
-                while (!operatorStack.empty() && operatorStack.top().value != '(') {
-                    // Evaluate the top operator in the stack
-                    processTopOperator(valueStack, operatorStack);
-                }
-                if (!operatorStack.empty()) {
-                    // Remove '(' from the stack
-                    operatorStack.pop();
-                }
+            } else if (command == "help") {
+                std::cout << "  add EXPR          add a premise\n"
+                          << "  edit N EXPR       replace premise N\n"
+                          << "  remove N          remove premise N\n"
+                          << "  conclusion EXPR   set the conclusion\n"
+                          << "  list              show the argument\n"
+                          << "  quit              leave the session\n";
+                continue;
+            } else if (command == "list") {
+                for (size_t i = 0; i < session.premiseCount(); ++i) {
+                    std::cout << "  " << (i + 1) << ". " << session.premise(i).text << "\n";
                 }
-                break;
-
-            default:
-                // Throw an error if an invalid token is encountered
-                throw std::runtime_error("Invalid token encountered");
+                std::cout << "  => " << session.conclusionEntry().text << "\n";
+                continue;
+            } else if (command == "add") {
+                size_t index = session.addPremise(rest);
+                std::cout << "Premise " << (index + 1) << " added\n";
+            } else if (command == "edit") {
+                size_t index = premiseNumber(rest);
+                session.editPremise(index, rest);
+                std::cout << "Premise " << (index + 1) << " replaced\n";
+            } else if (command == "remove") {
+                size_t index = premiseNumber(rest);
+                session.removePremise(index);
+                std::cout << "Premise " << (index + 1) << " removed\n";
+            } else if (command == "conclusion") {
+                session.setConclusion(rest);
+            } else {
+                throw std::runtime_error("Unknown command '" + command + "', type help");
             }
+            printSessionAnalysis(session);
+        } catch (const std::exception& e) {
+            std::cout << Colors::RED << "Error: " << e.what() << Colors::RESET << "\n";
         }
-
-        // Process any remaining operators in the stack
-        while (!operatorStack.empty()) {
-            // Evaluate the top operator in the stack
-            processTopOperator(valueStack, operatorStack);
-        }
-
-        // Return the final result from the value stack
-        return valueStack.empty() ? false : valueStack.top();
     }
+}
 
-private:
-    /**
-     * @brief Processes the top operator from the operator stack and applies it to the values in the value stack.
-     *
-     * This function pops the top operator from the operator stack and applies it to the values in the value stack.
-     * If the operator is a unary operator (e.g., '~' for NOT), it pops one value from the value stack, applies the
-     * operator, and pushes the result back onto the value stack.
-     * If the operator is a binary operator (e.g., '&' for AND, '|' for OR), it pops two values from the value stack,
-     * applies the operator, and pushes the result back onto the value stack.
-     *
-     * @param valueStack A stack of boolean values representing the operands.
-     * @param operatorStack A stack of tokens representing the operators.
-     */
-    void processTopOperator(std::stack<bool>& valueStack,
-                           std::stack<ExpressionTokenizer::Token>& operatorStack) {
-        auto op = operatorStack.top();
-        operatorStack.pop();
-
-        if (op.value == '~') {
-            if (valueStack.empty()) throw std::runtime_error("Invalid expression");
-            bool val = valueStack.top();
-            valueStack.pop();
-            valueStack.push(evaluateOperation(op.value, val)); // Evaluate NOT operation
+/**
+ * @brief Writes the --stats JSON and the --trace file, if they were asked for
+ */
+void writeInstrumentation(const AnalyzerOptions& options) {
+    if (options.stats) {
+        if (options.statsPath.empty()) {
+            Instrumentation::writeStats(std::cerr); // Standard output may carry the table
         } else {
-            if (valueStack.size() < 2) throw std::runtime_error("Invalid expression");
-            bool val2 = valueStack.top();
-            valueStack.pop();
-            bool val1 = valueStack.top();
-            valueStack.pop();
-            valueStack.push(evaluateOperation(op.value, val1, val2)); // Evaluate binary operation
+            std::ofstream out(options.statsPath);
+            if (!out) throw std::runtime_error("Cannot open '" + options.statsPath + "' for writing");
+            Instrumentation::writeStats(out);
         }
     }
-};;
+    if (!options.tracePath.empty()) Instrumentation::writeTrace(options.tracePath);
+}
 
 /**
- * @class TruthTableGenerator
- * @brief Generates and analyzes truth tables for logical expressions.
- * 
- * This class is responsible for generating truth tables for given logical expressions (premises and conclusion)
- * and analyzing their validity and satisfiability. It uses the LogicalEvaluator class to evaluate the expressions
- * for all possible combinations of variable values.
+ * @brief Main function implementing the user interface
  */
-class TruthTableGenerator {
-private:
-    LogicalEvaluator evaluator; // Object to evaluate logical expressions
-    std::vector<char> variables; // List of unique variables in the expressions
-    std::vector<std::string> premises; // List of premises (logical expressions)
-    std::string conclusion; // Conclusion (logical expression)
-
-    /**
-     * @brief Extracts unique variables from expressions.
-     * 
-     * This function scans through the premises and conclusion to find all unique variables.
-     * It stores these variables in a sorted vector for consistent processing.
-     */
-    void extractVariables() {
-        std::unordered_set<char> variableSet; // Temporary set to store unique variables
-        
-        // Process premises to extract variables
-        for (const auto& premise : premises) {
-            for (char c : premise) {
-                if (std::isalpha(c)) { // Check if the character is a letter
-                    variableSet.insert(c); // Insert the variable into the set
-                }
-            }
-        }
-        
-        // Process conclusion to extract variables
-        for (char c : conclusion) {
-            if (std::isalpha(c)) { // Check if the character is a letter
-                variableSet.insert(c); // Insert the variable into the set
-            }
+int main(int argc, char* argv[]) {
+    try {
+        AnalyzerOptions options = parseOptions(argc, argv);
+        if (options.stats || !options.tracePath.empty()) {
+            Instrumentation::enable(!options.tracePath.empty());
         }
 
-        // Convert the set to a sorted vector
-        variables = std::vector<char>(variableSet.begin(), variableSet.end()); // Copy set to vector for sorting and indexing purposes
-        std::sort(variables.begin(), variables.end()); // Sort the variables for consistent order and indexing
-    }
-
-    /**
-     * @brief Prints the truth table header.
-     * 
-     * This function prints the header of the truth table, including the variable names,
-     * premises, and conclusion. It formats the header for readability.
-     * 
-     */
-    void printHeader() const {
-        // Print variable columns
-        for (char var : variables) {
-            std::cout << Colors::BOLD << std::setw(6) << var << " " << Colors::RESET;
+        if (options.batch) {
+            // Records come from the input file or standard input, results go to standard output
+            FILE* in = stdin;
+            if (!options.inputPath.empty()) {
+                in = std::fopen(options.inputPath.c_str(), "rb");
+                if (!in) throw std::runtime_error("Cannot open '" + options.inputPath + "'");
+            }
+            WorkStealingPool pool(options.threads);
+            BatchChecker(options.batchFraming, pool).run(in, stdout);
+            if (in != stdin) std::fclose(in);
+            writeInstrumentation(options);
+            return 0;
         }
 
-        // Print premises and conclusion
-        for (size_t i = 0; i < premises.size(); ++i) {
-            std::cout << Colors::BOLD << std::setw(12) 
-                     << "P" + std::to_string(i+1) << " " << Colors::RESET;
+        if (options.session) {
+            runSession();
+            writeInstrumentation(options);
+            return 0;
         }
-        std::cout << Colors::BOLD << std::setw(12) << "Conclusion" << Colors::RESET << "\n";
-
-        // Print separator line
-        // Separator line size calculation based on columns and widths of variables, premises, and conclusion
-        std::cout << std::string(12 * (variables.size() + premises.size() + 1), '-') << "\n";
-    }
-
-public:
-    /**
-     * @brief Constructor initializing with premises and conclusion.
-     * 
-     * This constructor initializes the premises and conclusion, and then extracts the variables.
-     * 
-     * @param p The list of premises (logical expressions).
-     * @param c The conclusion (logical expression).
-     */
-    TruthTableGenerator(const std::vector<std::string>& p, const std::string& c)
-        : premises(p), conclusion(c) {
-        extractVariables(); // Extract unique variables from premises and conclusion
-    }
-
-    /**
-     * @brief Generates and analyzes the truth table.
-     * 
-     * This function generates the truth table by evaluating all possible combinations of variable values.
-     * It also analyzes the results to determine the validity and satisfiability of the logical expressions.
-     * 
-     * The process involves:
-     * - Printing the header of the truth table.
-     * - Iterating through all possible combinations of variable values.
-     * - Evaluating each premise and the conclusion for each combination.
-     * - Printing the results in the truth table.
-     * - Analyzing the results to determine validity and satisfiability.
-     */
-    void generateAndAnalyze() {
-        printHeader(); // Print the header of the truth table
 
-        bool isValid = true; // Flag to check if the logical expressions are valid
-        bool isSatisfiable = false; // Flag to check if the logical expressions are satisfiable
-        // 1 << n is equivalent to 2^n, which is the total number of combinations for n variables
-        const size_t combinations = 1 << variables.size(); // Total number of combinations (2^n) 
-
-        // For each possible combination of variable values
-        for (size_t i = 0; i < combinations; ++i) {
-            // Set variable values based on the current combination
-            for (size_t j = 0; j < variables.size(); ++j) {
-                // Set the value of the j-th variable based on the j-th bit of the combination number 'i'
-                // TODO: Explanation:
-                // - 'i' represents the current combination of variable values in binary form.
-                // - '(1 << j)' creates a mask with only the j-th bit set to 1.
-                // - '(i & (1 << j))' checks if the j-th bit of 'i' is set to 1.
-                // - If the j-th bit of 'i' is 1, the variable is set to true; otherwise, it is set to false.
-                // Example:
-                // - For i = 5 (binary 101), the 0th and 2nd bits are set to 1.
-                // - This means variables[0] and variables[2] will be set to true, and variables[1] will be set to false.
-                evaluator.setVariable(variables[j], (i & (1 << j)) != 0);
+        std::unique_ptr<TruthTableGenerator> loaded;
+        if (!options.inputPath.empty()) {
+            loaded = std::make_unique<TruthTableGenerator>(ProblemReader::read(options.inputPath, options.inputFormat));
+        } else {
+            std::cout << Colors::BLUE << Colors::BOLD 
+                     << "\nLogical Expression Truth Table Analyzer\n" << Colors::RESET;
+
+            // Display terms of use
+            std::cout << Colors::MAGENTA << "Terms of Use:\n"
+                      << "1. Ensure logical expressions are correctly formatted.\n"
+                      << "2. The program supports variables (names such as p or door_open_3), logical operators (~, &, |, ->, <->), and parentheses.\n"
+                      << Colors::RESET << "\n";
+
+            // Get premises
+            std::cout << "Number of premises: ";
+            int numPremises;
+            std::cin >> numPremises;
+            std::cin.ignore();
+
+            std::vector<std::string> premises;
+            for (int i = 0; i < numPremises; ++i) {
+                std::cout << "Premise " << (i+1) << ": ";
+                std::string premise;
+                std::getline(std::cin, premise);
+                premises.push_back(premise);
             }
 
-            // Evaluate premises and conclusion
-            bool allPremisesTrue = true; // Flag to check if all premises are true
-            std::vector<bool> premiseResults; // Store results of premise evaluations
+            // Get conclusion
+            std::cout << "Conclusion: ";
+            std::string conclusion;
+            std::getline(std::cin, conclusion);
 
-            for (const auto& premise : premises) {
-                bool result = evaluator.evaluate(premise); // Evaluate the premise
-                premiseResults.push_back(result); // Store the result
-                allPremisesTrue &= result; // Update the flag
+            // Generate and analyze truth table
+            loaded = std::make_unique<TruthTableGenerator>(premises, conclusion);
+        }
+        TruthTableGenerator& generator = *loaded;
+        // Independent parts of the argument are swept separately by the enumerating analysis
+        std::vector<TruthTableGenerator::Component> parts;
+        if (options.analyzeOnly && options.engine == AnalyzerOptions::Engine::ENUMERATE) parts = generator.components();
+
+        if (options.engine == AnalyzerOptions::Engine::SAT) {
+            SatSolver::Statistics stats;
+            generator.printAnalysis(generator.analyzeSat(&stats));
+            generator.printSolverStatistics(stats);
+        } else if (options.engine == AnalyzerOptions::Engine::BDD) {
+            TruthTableGenerator::BddStatistics stats;
+            generator.printAnalysis(generator.analyzeBdd(options.bddOrder, options.sift, &stats));
+            generator.printBddStatistics(stats);
+        } else if (options.engine == AnalyzerOptions::Engine::COUNT) {
+            TruthTableGenerator::ModelCounts counts;
+            generator.printAnalysis(generator.analyzeCount(&counts));
+            generator.printModelCounts(counts);
+        } else if (options.engine == AnalyzerOptions::Engine::APPROXIMATE) {
+            WorkStealingPool pool(options.threads);
+            TruthTableGenerator::ApproximateCounts counts;
+            generator.printAnalysis(generator.analyzeApproximate(pool, options.approximation, &counts));
+            generator.printApproximateCounts(counts);
+        } else if (options.engine == AnalyzerOptions::Engine::FRAGMENT) {
+            AnalysisResult result;
+            FragmentSolver::Fragment fragment;
+            if (!generator.analyzeFragment(result, fragment)) {
+                throw std::runtime_error("The argument is not Horn, 2-CNF or a parity system");
             }
-
-            bool conclusionResult = evaluator.evaluate(conclusion); // Evaluate the conclusion
-
-            // Print the row values in the truth table
-            printTruthTableRow(i, premiseResults, conclusionResult, allPremisesTrue);
-
-            // Update analysis based on the results
-            if (allPremisesTrue) {
-                if (conclusionResult) {
-                    isSatisfiable = true; // If all premises are true and conclusion is true, it's satisfiable
-                } else {
-                    isValid = false; // If all premises are true and conclusion is false, it's invalid
-                }
+            generator.printAnalysis(result);
+            std::cout << Colors::YELLOW << Colors::BOLD << "Fast path:" << Colors::RESET << " "
+                      << FragmentSolver::fragmentName(fragment) << "\n";
+        } else if (options.engine == AnalyzerOptions::Engine::REFUTE) {
+            ShortCircuitEvaluator::Statistics stats;
+            generator.printAnalysis(generator.analyzeShortCircuit(!options.validityOnly, &stats));
+            generator.printShortCircuitStatistics(stats);
+        } else if (options.engine == AnalyzerOptions::Engine::GRAY) {
+            WorkStealingPool pool(options.threads);
+            std::pair<double, size_t> nodesPerWord;
+            generator.printAnalysis(generator.analyzeGray(pool, &nodesPerWord));
+            generator.printDagStatistics();
+            std::cout << Colors::YELLOW << Colors::BOLD << "Gray code:" << Colors::RESET << " "
+                      << std::fixed << std::setprecision(1) << nodesPerWord.first << std::defaultfloat
+                      << " of " << nodesPerWord.second << " nodes re-evaluated per word on average\n";
+        } else if (options.analyzeOnly && !options.cachePath.empty() &&
+                   generator.variableCount() <= TruthVectorCache::MAX_VARIABLES) {
+            TruthVectorCache cache(options.cachePath, options.cacheSize);
+            generator.printAnalysis(generator.analyzeCached(cache));
+            generator.printCacheStatistics(cache.statistics());
+        } else if (options.analyzeOnly && options.engine == AnalyzerOptions::Engine::AUTO) {
+            WorkStealingPool pool(options.threads);
+            AnalysisPlanner planner(generator, pool, options.budget, !options.exhaustive, options.isa);
+            generator.printAnalysis(planner.run());
+            planner.printLog();
+        } else if (parts.size() > 1) {
+            WorkStealingPool pool(options.threads);
+            generator.printAnalysis(generator.analyzeComponents(pool, parts, options.isa));
+            generator.printComponents(parts);
+        } else if (options.analyzeOnly) {
+            WorkStealingPool pool(options.threads);
+            generator.printAnalysis(generator.analyzeParallel(pool, !options.exhaustive, options.isa));
+            generator.printDagStatistics();
+        } else {
+            // Write the truth table to the selected sink
+            FILE* file = stdout;
+            if (!options.outputPath.empty()) {
+                file = std::fopen(options.outputPath.c_str(), options.format == "binary" ? "wb" : "w");
+                if (!file) throw std::runtime_error("Cannot open '" + options.outputPath + "' for writing");
             }
+            std::unique_ptr<TableSink> sink;
+            if (options.format == "color") {
+                sink = std::make_unique<ConsoleTableSink>(file, options.criticalOnly);
+            } else if (options.format == "binary") {
+                sink = std::make_unique<BinaryTableSink>(file, options.criticalOnly);
+            } else {
+                sink = std::make_unique<TextTableSink>(file, options.format == "csv", options.criticalOnly);
+            }
+            generator.generateAndAnalyze(*sink);
+            sink.reset();
+            if (file != stdout) std::fclose(file);
         }
-
-        // Print the analysis results
-        printAnalysis(isValid, isSatisfiable);
-    }
-
-private:
-    /**
-     * @brief Prints a single row of the truth table.
-     * 
-     * This function prints the values of variables, premises, and conclusion for a specific combination.
-     * 
-     * @param combination The current combination of variable values.
-     * @param premiseResults The results of evaluating the premises.
-     * @param conclusionResult The result of evaluating the conclusion.
-     * @param isCriticalRow Flag indicating if this row is critical (all premises true).
-     */
-    void printTruthTableRow(size_t combination, 
-                           const std::vector<bool>& premiseResults,
-                           bool conclusionResult,
-                           bool isCriticalRow) const {
-        // Print variable values
-        for (size_t j = 0; j < variables.size(); ++j) {
-            std::cout << Colors::BOLD << std::setw(6) 
-                     << ((combination & (1 << j)) ? "T" : "F") << " " << Colors::RESET;
-        }
-
-        // Print premise results
-        for (bool result : premiseResults) {
-            std::cout << Colors::BOLD << std::setw(12) 
-                     << (result ? "T" : "F") << " " << Colors::RESET;
-        }
-
-        // Print conclusion with color
-        std::cout << (conclusionResult ? Colors::GREEN : Colors::RED)
-                 << Colors::BOLD << std::setw(12) 
-                 << (conclusionResult ? "T" : "F") << Colors::RESET;
-
-        // Mark critical rows
-        if (isCriticalRow) {
-            std::cout << Colors::BLUE << " <== Critical Row" << Colors::RESET;
-        }
-        
-        std::cout << "\n";
-    }
-
-    /**
-     * @brief Prints the analysis results.
-     * 
-     * This function prints whether the logical expressions are valid and satisfiable.
-     * 
-     * @param isValid Flag indicating if the logical expressions are valid.
-     * @param isSatisfiable Flag indicating if the logical expressions are satisfiable.
-     */
-    void printAnalysis(bool isValid, bool isSatisfiable) const {
-        std::cout << "\n" << Colors::YELLOW << Colors::BOLD 
-                 << "Analysis Results:" << Colors::RESET << "\n";
-        
-        std::cout << "Validity: " 
-                 << (isValid ? Colors::GREEN : Colors::RED)
-                 << Colors::BOLD 
-                 << (isValid ? "Valid" : "Falsifiable")
-                 << Colors::RESET << "\n";
-        
-        std::cout << "Satisfiability: "
-                 << (isSatisfiable ? Colors::GREEN : Colors::RED)
-                 << Colors::BOLD
-                 << (isSatisfiable ? "Satisfiable" : "Not satisfiable")
-                 << Colors::RESET << "\n";
-    }
-};
-
-/**
- * @brief Main function implementing the user interface
- */
-int main() {
-    try {
-        std::cout << Colors::BLUE << Colors::BOLD 
-                 << "\nLogical Expression Truth Table Analyzer\n" << Colors::RESET;
-
-        // Display terms of use
-        std::cout << Colors::MAGENTA << "Terms of Use:\n"
-                  << "1. Ensure logical expressions are correctly formatted.\n"
-                  << "2. The program supports variables (letters), logical operators (~, &, |, ->, <->), and parentheses.\n"
-                  << Colors::RESET << "\n";
-
-        // Get premises
-        std::cout << "Number of premises: ";
-        int numPremises;
-        std::cin >> numPremises;
-        std::cin.ignore();
-
-        std::vector<std::string> premises;
-        for (int i = 0; i < numPremises; ++i) {
-            std::cout << "Premise " << (i+1) << ": ";
-            std::string premise;
-            std::getline(std::cin, premise);
-            premises.push_back(premise);
-        }
-
-        // Get conclusion
-        std::cout << "Conclusion: ";
-        std::string conclusion;
-        std::getline(std::cin, conclusion);
-
-        // Generate and analyze truth table
-        TruthTableGenerator generator(premises, conclusion);
-        generator.generateAndAnalyze();
+        writeInstrumentation(options);
 
     } catch (const std::exception& e) {
         std::cerr << Colors::RED << "Error: " << e.what() << Colors::RESET << "\n";
@@ -535,4 +443,4 @@ int main() {
     }
 
     return 0;
-}
\ No newline at end of file
+}
@@ -0,0 +1,610 @@
+/**
+ * @file model_counter.hpp
+ * @brief Exact (#SAT) and approximate model counters.
+ */
+
+#ifndef LOGIC_MODEL_COUNTER_HPP
+#define LOGIC_MODEL_COUNTER_HPP
+
+#include "common.hpp"
+#include "big_unsigned.hpp"
+#include "evaluation.hpp"
+#include "sat_solver.hpp"
+
+/**
+ * @class ModelCounter
+ * @brief Exact model counter (#SAT) for CNF formulas.
+ *
+ * A DPLL search in the style of component-caching counters: after every decision the clauses are
+ * simplified by unit propagation and split into components that share no variable. Components are
+ * counted independently and the counts multiplied, and the count of every component is cached under
+ * its canonical clause list, so a subformula that reappears on another branch is counted once.
+ * Variables that drop out of all clauses without being assigned are free and double the count.
+ * Counts are exact at any size. The work is exponential only in the width of the components, so
+ * formulas with hundreds of variables and loose structure are counted quickly.
+ */
+class ModelCounter {
+public:
+    typedef SatSolver::Literal Literal;
+    typedef std::vector<std::vector<Literal>> Clauses;
+
+    /**
+     * @brief Search statistics
+     */
+    struct Statistics {
+        uint64_t decisions = 0;
+        uint64_t componentSplits = 0; // Times a formula fell apart into more than one component
+        uint64_t cacheLookups = 0;
+        uint64_t cacheHits = 0;
+        size_t cacheEntries = 0;
+    };
+
+private:
+    std::vector<int8_t> values; // Per variable: 1 true, -1 false, 0 unassigned; scratch of condition()
+    std::vector<std::vector<uint32_t>> occurrences; // Per literal: clauses of the formula being processed
+    std::vector<uint32_t> marks; // Per variable: stamp of the last visit
+    std::vector<uint32_t> scores; // Per variable: occurrences in the component being branched on
+    uint32_t stamp = 0;
+    size_t decisionVariables = 0; // Variables below this are branched on first
+    std::unordered_map<std::string, BigUnsigned> cache; // Canonical component -> model count
+    size_t cacheBytes = 0;
+    size_t cacheLimit;
+    const Budget* timeBudget = &Budget::unlimited();
+    Statistics stats;
+
+    int8_t valueOf(Literal literal) const {
+        int8_t value = values[SatSolver::variableOf(literal)];
+        return (literal & 1) ? static_cast<int8_t>(-value) : value;
+    }
+
+    uint32_t nextStamp() {
+        if (++stamp == 0) { // Wrapped around, forget the old stamps
+            std::fill(marks.begin(), marks.end(), 0);
+            stamp = 1;
+        }
+        return stamp;
+    }
+
+    /**
+     * @brief Number of distinct variables of a clause list
+     */
+    size_t countVariables(const Clauses& clauses) {
+        uint32_t current = nextStamp();
+        size_t count = 0;
+        for (const auto& clause : clauses) {
+            for (Literal literal : clause) {
+                uint32_t variable = SatSolver::variableOf(literal);
+                if (marks[variable] != current) {
+                    marks[variable] = current;
+                    ++count;
+                }
+            }
+        }
+        return count;
+    }
+
+    /**
+     * @brief Assigns literals, propagates units and removes satisfied clauses and false literals.
+     *
+     * Propagation keeps a count of false literals per clause, so it is linear in the size of the clauses.
+     *
+     * @param in Clauses without duplicate literals.
+     * @param decisions Literals to make true.
+     * @param out Receives the remaining clauses, each with at least two unassigned literals.
+     * @param assigned Receives the number of variables assigned by the decisions and propagation.
+     * @return False if the clauses are unsatisfiable under the decisions.
+     */
+    bool condition(const Clauses& in, const std::vector<Literal>& decisions, Clauses& out, size_t& assigned) {
+        std::vector<Literal> touched; // Literals with occurrence lists to clear
+        for (uint32_t c = 0; c < in.size(); ++c) {
+            for (Literal literal : in[c]) {
+                if (occurrences[literal].empty()) touched.push_back(literal);
+                occurrences[literal].push_back(c);
+            }
+        }
+
+        std::vector<uint32_t> falseCount(in.size(), 0);
+        std::vector<uint8_t> satisfied(in.size(), 0);
+        std::vector<Literal> trail; // Assigned literals in order, also the propagation queue
+        auto assign = [&](Literal literal) {
+            int8_t value = valueOf(literal);
+            if (value != 0) return value > 0;
+            values[SatSolver::variableOf(literal)] = (literal & 1) ? -1 : 1;
+            trail.push_back(literal);
+            return true;
+        };
+
+        bool consistent = true;
+        for (Literal literal : decisions) consistent = assign(literal) && consistent;
+        for (const auto& clause : in) {
+            if (clause.empty()) consistent = false;
+            else if (clause.size() == 1) consistent = assign(clause[0]) && consistent;
+        }
+
+        for (size_t head = 0; consistent && head < trail.size(); ++head) {
+            Literal literal = trail[head];
+            for (uint32_t c : occurrences[literal]) satisfied[c] = 1;
+            for (uint32_t c : occurrences[SatSolver::negate(literal)]) {
+                if (satisfied[c]) continue;
+                size_t size = in[c].size();
+                if (++falseCount[c] == size) {
+                    consistent = false;
+                    break;
+                }
+                if (falseCount[c] == size - 1) {
+                    for (Literal other : in[c]) {
+                        if (valueOf(other) == 0) {
+                            assign(other);
+                            break;
+                        }
+                    }
+                }
+            }
+        }
+
+        if (consistent) {
+            out.clear();
+            for (uint32_t c = 0; c < in.size(); ++c) {
+                if (satisfied[c]) continue;
+                std::vector<Literal> clause;
+                clause.reserve(in[c].size() - falseCount[c]);
+                for (Literal literal : in[c]) {
+                    if (valueOf(literal) == 0) clause.push_back(literal);
+                }
+                out.push_back(std::move(clause));
+            }
+        }
+        assigned = trail.size();
+
+        for (Literal literal : trail) values[SatSolver::variableOf(literal)] = 0;
+        for (Literal literal : touched) occurrences[literal].clear();
+        return consistent;
+    }
+
+    /**
+     * @brief Splits clauses into components that share no variable
+     * @return Each component with its number of variables.
+     */
+    std::vector<std::pair<Clauses, size_t>> split(Clauses& clauses) {
+        std::vector<std::pair<Clauses, size_t>> components;
+        if (clauses.size() == 1) { // Clauses have no repeated variable, so the size is the variable count
+            size_t variableCount = clauses[0].size();
+            components.emplace_back(std::move(clauses), variableCount);
+            return components;
+        }
+
+        for (uint32_t c = 0; c < clauses.size(); ++c) {
+            for (Literal literal : clauses[c]) occurrences[literal].push_back(c);
+        }
+        uint32_t current = nextStamp();
+        std::vector<uint8_t> visited(clauses.size(), 0);
+        std::vector<uint32_t> pending;
+        for (uint32_t start = 0; start < clauses.size(); ++start) {
+            if (visited[start]) continue;
+            components.emplace_back();
+            Clauses& component = components.back().first;
+            size_t variableCount = 0;
+            visited[start] = 1;
+            pending.push_back(start);
+            while (!pending.empty()) {
+                uint32_t c = pending.back();
+                pending.pop_back();
+                for (Literal literal : clauses[c]) {
+                    uint32_t variable = SatSolver::variableOf(literal);
+                    if (marks[variable] == current) continue;
+                    marks[variable] = current;
+                    ++variableCount;
+                    for (Literal side : {SatSolver::positive(variable), SatSolver::negative(variable)}) {
+                        for (uint32_t other : occurrences[side]) {
+                            if (!visited[other]) {
+                                visited[other] = 1;
+                                pending.push_back(other);
+                            }
+                        }
+                    }
+                }
+                component.push_back(std::move(clauses[c]));
+            }
+            components.back().second = variableCount;
+        }
+        for (const auto& component : components) {
+            for (const auto& clause : component.first) {
+                for (Literal literal : clause) occurrences[literal].clear();
+            }
+        }
+        if (components.size() > 1) ++stats.componentSplits;
+        return components;
+    }
+
+    /**
+     * @brief Canonical cache key of a component: its sorted clauses, each sorted
+     */
+    static std::string canonicalKey(Clauses& component) {
+        size_t literals = 0;
+        for (auto& clause : component) {
+            std::sort(clause.begin(), clause.end());
+            literals += clause.size() + 1;
+        }
+        std::sort(component.begin(), component.end());
+        std::string key;
+        key.reserve(literals * sizeof(Literal));
+        const Literal separator = std::numeric_limits<Literal>::max();
+        for (const auto& clause : component) {
+            key.append(reinterpret_cast<const char*>(clause.data()), clause.size() * sizeof(Literal));
+            key.append(reinterpret_cast<const char*>(&separator), sizeof(Literal));
+        }
+        return key;
+    }
+
+    /**
+     * @brief Counts the models of clauses over exactly the variables they contain
+     */
+    BigUnsigned countClauses(Clauses& clauses) {
+        if (clauses.empty()) return BigUnsigned(1);
+        BigUnsigned result(1);
+        for (auto& component : split(clauses)) {
+            result *= countComponent(component.first, component.second);
+            if (result.isZero()) break;
+        }
+        return result;
+    }
+
+    /**
+     * @brief Counts the models of a connected component by branching on its most frequent variable
+     */
+    BigUnsigned countComponent(Clauses& component, size_t variableCount) {
+        std::string key = canonicalKey(component);
+        ++stats.cacheLookups;
+        auto found = cache.find(key);
+        if (found != cache.end()) {
+            ++stats.cacheHits;
+            return found->second;
+        }
+
+        // Prefer decision variables, then the variable in the most clauses
+        uint32_t best = 0;
+        uint64_t bestScore = 0;
+        for (const auto& clause : component) {
+            for (Literal literal : clause) ++scores[SatSolver::variableOf(literal)];
+        }
+        for (const auto& clause : component) {
+            for (Literal literal : clause) {
+                uint32_t variable = SatSolver::variableOf(literal);
+                uint64_t score = scores[variable] + (variable < decisionVariables ? uint64_t{1} << 32 : 0);
+                if (score > bestScore) {
+                    bestScore = score;
+                    best = variable;
+                }
+            }
+        }
+        for (const auto& clause : component) {
+            for (Literal literal : clause) scores[SatSolver::variableOf(literal)] = 0;
+        }
+
+        BigUnsigned total;
+        for (Literal decision : {SatSolver::positive(best), SatSolver::negative(best)}) {
+            if ((++stats.decisions & 255) == 0) timeBudget->check();
+            Clauses reduced;
+            size_t assigned = 0;
+            if (!condition(component, {decision}, reduced, assigned)) continue;
+            size_t free = variableCount - assigned - countVariables(reduced);
+            total += countClauses(reduced) << free;
+        }
+
+        size_t bytes = key.size() + 64;
+        if (cacheBytes + bytes > cacheLimit) { // Start over rather than track recency
+            cache.clear();
+            cacheBytes = 0;
+        }
+        cacheBytes += bytes;
+        cache.emplace(std::move(key), total);
+        return total;
+    }
+
+public:
+    /**
+     * @brief Constructor
+     * @param cacheLimitBytes Approximate memory for cached component counts; the cache is cleared when it is full.
+     */
+    explicit ModelCounter(size_t cacheLimitBytes = size_t{256} << 20) : cacheLimit(cacheLimitBytes) {}
+
+    /**
+     * @brief Branches on the variables below a bound before all others, such as the inputs of a Tseitin encoding
+     */
+    void setDecisionVariables(size_t count) { decisionVariables = count; }
+
+    /**
+     * @brief Makes count() throw Budget::Exceeded once the time limit has passed; the budget must outlive the counter
+     */
+    void setBudget(const Budget& limit) { timeBudget = &limit; }
+
+    /**
+     * @brief Counts the models of a formula.
+     *
+     * The cache is kept between calls, so counting several queries over the same clauses reuses the
+     * counts of their common components.
+     *
+     * @param formula The clauses; every variable below formula.variableCount is counted, used or not.
+     * @param assumptions Literals that have to be true.
+     * @return The number of assignments of all formula variables that satisfy every clause and assumption.
+     */
+    BigUnsigned count(const CnfFormula& formula, const std::vector<Literal>& assumptions = {}) {
+        size_t variableCount = formula.variableCount;
+        values.assign(variableCount, 0);
+        occurrences.resize(2 * variableCount);
+        marks.resize(variableCount, 0);
+        scores.assign(variableCount, 0);
+
+        // Remove duplicate literals and tautologies, which the false literal counts do not allow
+        Clauses clauses;
+        clauses.reserve(formula.clauses.size());
+        for (const auto& original : formula.clauses) {
+            std::vector<Literal> clause = original;
+            std::sort(clause.begin(), clause.end());
+            clause.erase(std::unique(clause.begin(), clause.end()), clause.end());
+            bool tautology = false;
+            for (size_t i = 1; i < clause.size(); ++i) {
+                if (clause[i] == SatSolver::negate(clause[i - 1])) tautology = true;
+            }
+            if (!tautology) clauses.push_back(std::move(clause));
+        }
+
+        Clauses reduced;
+        size_t assigned = 0;
+        if (!condition(clauses, assumptions, reduced, assigned)) return BigUnsigned();
+        size_t free = variableCount - assigned - countVariables(reduced);
+        return countClauses(reduced) << free;
+    }
+
+    Statistics statistics() const {
+        Statistics result = stats;
+        result.cacheEntries = cache.size();
+        return result;
+    }
+};
+
+/**
+ * @class ApproximateCounter
+ * @brief Hashing-based approximate model counter with (epsilon, delta) guarantees, in the style of ApproxMC.
+ *
+ * Random XOR constraints over the counted variables split the models into 2^m cells of about equal size.
+ * A cell is counted exactly with the SAT solver, blocking each model found, up to a threshold; m is the
+ * smallest number of constraints that brings the cell below the threshold, and the cell count times 2^m
+ * estimates the total. The median of independent estimates is within a factor 1 + epsilon of the true
+ * count with probability at least 1 - delta. The constraints of an estimate are nested, the cell for m
+ * constraints using the first m, so cell counts fall with m and it is found by galloping and binary
+ * search. Each estimate has its own solver and random stream, so they run on all workers and the result
+ * does not depend on their number. Counts below the threshold are found exactly, without hashing.
+ */
+class ApproximateCounter {
+public:
+    typedef SatSolver::Literal Literal;
+
+    /**
+     * @brief Tolerance, confidence and random seed
+     */
+    struct Parameters {
+        double epsilon = 0.8; // Estimates are within a factor 1 + epsilon of the count
+        double delta = 0.2; // ... with probability at least 1 - delta
+        uint64_t seed = 1;
+    };
+
+    /**
+     * @brief An estimated count and the bounds it comes with
+     */
+    struct Estimate {
+        BigUnsigned count;
+        double log2Count = 0; // log2 of count, -infinity for 0
+        bool exact = false; // The count is below the threshold and was found without hashing
+        double lowerLog2 = 0; // With probability 1 - delta the count is in [2^lowerLog2, 2^upperLog2]
+        double upperLog2 = 0;
+        size_t hashCount = 0; // XOR constraints of the median estimate
+        size_t iterations = 0; // Independent estimates taken
+        uint64_t satCalls = 0;
+        std::vector<bool> model; // A model over the counted variables, empty if there is none
+    };
+
+private:
+    const CnfFormula& formula;
+    size_t projection; // Variables 0 .. projection - 1 are counted, the others are defined by them
+    WorkStealingPool& pool;
+    Parameters parameters;
+    uint64_t threshold; // Cells are counted up to this many models
+    size_t iterations;
+    std::atomic<size_t> hashHint{1}; // Hash count of the last estimate, where the next search starts
+
+    /**
+     * @brief One estimate: a solver with the formula and a nested family of random XOR constraints
+     */
+    class Cell {
+    private:
+        const ApproximateCounter& owner;
+        SatSolver solver;
+        std::mt19937_64 random;
+        std::vector<Literal> selectors; // Literal enabling each XOR constraint added so far
+        std::map<size_t, uint64_t> counts; // Cell count by number of constraints
+        std::vector<Literal> assumptions;
+
+        /**
+         * @brief Adds the next random XOR constraint, enabled by a fresh selector; each counted variable
+         *        is in it with probability 1/2
+         */
+        void addConstraint() {
+            Literal selector = SatSolver::positive(solver.newVariable());
+            std::vector<uint32_t> variables;
+            for (uint32_t v = 0; v < owner.projection; ++v) {
+                if (random() & 1) variables.push_back(v);
+            }
+            solver.addXor(std::move(variables), random() & 1, selector);
+            selectors.push_back(selector);
+        }
+
+    public:
+        uint64_t satCalls = 0;
+        std::vector<bool> firstModel;
+
+        Cell(const ApproximateCounter& counter, uint64_t stream) : owner(counter) {
+            std::seed_seq seeds{owner.parameters.seed, stream};
+            random.seed(seeds);
+            for (size_t v = 0; v < owner.formula.variableCount; ++v) solver.newVariable();
+            for (const auto& clause : owner.formula.clauses) solver.addClause(clause);
+        }
+
+        /**
+         * @brief Counts the models in the cell of the first m constraints, up to the threshold
+         */
+        uint64_t count(size_t m, const std::vector<Literal>& base) {
+            auto found = counts.find(m);
+            if (found != counts.end()) return found->second;
+            while (selectors.size() < m) addConstraint();
+
+            // Blocking clauses of this cell carry a selector of their own and are retired with it
+            Literal blocking = SatSolver::positive(solver.newVariable());
+            assumptions = base;
+            assumptions.insert(assumptions.end(), selectors.begin(), selectors.begin() + m);
+            assumptions.push_back(blocking);
+            uint64_t models = 0;
+            std::vector<Literal> clause;
+            while (models < owner.threshold) {
+                ++satCalls;
+                if (solver.solve(assumptions) != SatSolver::Result::SATISFIABLE) break;
+                ++models;
+                clause.assign(1, SatSolver::negate(blocking));
+                for (uint32_t v = 0; v < owner.projection; ++v) {
+                    clause.push_back(solver.modelValue(v) ? SatSolver::negative(v) : SatSolver::positive(v));
+                }
+                if (firstModel.empty()) {
+                    firstModel.resize(owner.projection);
+                    for (uint32_t v = 0; v < owner.projection; ++v) firstModel[v] = solver.modelValue(v);
+                }
+                solver.addClause(clause);
+            }
+            solver.addClause({SatSolver::negate(blocking)});
+            return counts[m] = models;
+        }
+    };
+
+    /**
+     * @brief Finds the smallest m whose cell is below the threshold, starting at the hint
+     * @return m and the count of its cell.
+     */
+    std::pair<size_t, uint64_t> search(Cell& cell, const std::vector<Literal>& base) {
+        const size_t limit = std::max<size_t>(projection, 1);
+        size_t start = std::min(std::max<size_t>(hashHint.load(std::memory_order_relaxed), 1), limit);
+        size_t low = 0, high = limit; // count(low) >= threshold, count(high) < threshold unless high is the limit
+        if (cell.count(start, base) < threshold) {
+            high = start;
+            for (size_t step = 1; high > 1; step *= 2) {
+                size_t probe = high > step ? high - step : 0;
+                if (probe == 0 || cell.count(probe, base) >= threshold) {
+                    low = probe;
+                    break;
+                }
+                high = probe;
+            }
+        } else {
+            low = start;
+            for (size_t step = 1; low < limit; step *= 2) {
+                size_t probe = std::min(low + step, limit);
+                if (cell.count(probe, base) < threshold || probe == limit) {
+                    high = probe;
+                    break;
+                }
+                low = probe;
+            }
+        }
+        while (high - low > 1) {
+            size_t middle = low + (high - low) / 2;
+            if (cell.count(middle, base) < threshold) {
+                high = middle;
+            } else {
+                low = middle;
+            }
+        }
+        hashHint.store(high, std::memory_order_relaxed);
+        return {high, cell.count(high, base)};
+    }
+
+public:
+    /**
+     * @brief Constructor
+     * @param f The formula; it must outlive the counter.
+     * @param countedVariables Models are counted over variables 0 .. countedVariables - 1, which must
+     *                         determine all other variables of the formula.
+     * @param workers Pool the independent estimates run on.
+     * @param p Tolerance, confidence and seed.
+     * @throws std::runtime_error If epsilon or delta is out of range.
+     */
+    ApproximateCounter(const CnfFormula& f, size_t countedVariables, WorkStealingPool& workers, Parameters p)
+        : formula(f), projection(countedVariables), pool(workers), parameters(p) {
+        if (!(p.epsilon > 0)) throw std::runtime_error("The tolerance must be positive");
+        if (!(p.delta > 0 && p.delta < 1)) throw std::runtime_error("The confidence parameter must be in (0, 1)");
+        // The threshold and repetition count of ApproxMC
+        double slack = 1 + 1 / p.epsilon;
+        threshold = 1 + static_cast<uint64_t>(std::ceil(9.84 * (1 + p.epsilon / (1 + p.epsilon)) * slack * slack));
+        iterations = static_cast<size_t>(std::ceil(17 * std::log2(3 / p.delta)));
+    }
+
+    uint64_t cellThreshold() const { return threshold; }
+    size_t iterationCount() const { return iterations; }
+
+    /**
+     * @brief Estimates the number of models under assumptions
+     * @param base Literals that must hold, over any variables of the formula.
+     */
+    Estimate count(const std::vector<Literal>& base = {}) {
+        Estimate result;
+        // Few models are counted exactly
+        Cell direct(*this, 0);
+        uint64_t all = direct.count(0, base);
+        result.satCalls = direct.satCalls;
+        result.model = direct.firstModel;
+        if (all < threshold) {
+            result.exact = true;
+            result.count = BigUnsigned(all);
+            result.log2Count = all ? std::log2(static_cast<double>(all)) : -std::numeric_limits<double>::infinity();
+            result.lowerLog2 = result.upperLog2 = result.log2Count;
+            return result;
+        }
+
+        std::vector<std::pair<size_t, uint64_t>> estimates(iterations);
+        std::vector<uint64_t> calls(iterations);
+        pool.run(iterations, [&](size_t i, size_t) {
+            Cell cell(*this, i + 1);
+            estimates[i] = search(cell, base);
+            calls[i] = cell.satCalls;
+        });
+        auto log2Of = [](const std::pair<size_t, uint64_t>& e) {
+            return e.second ? std::log2(static_cast<double>(e.second)) + e.first : -std::numeric_limits<double>::infinity();
+        };
+        std::sort(estimates.begin(), estimates.end(), [&](const auto& a, const auto& b) { return log2Of(a) < log2Of(b); });
+        const auto& median = estimates[iterations / 2];
+        for (uint64_t c : calls) result.satCalls += c;
+        result.iterations = iterations;
+        result.hashCount = median.first;
+        result.count = BigUnsigned(median.second) << median.first;
+        result.log2Count = log2Of(median);
+        result.lowerLog2 = result.log2Count - std::log2(1 + parameters.epsilon);
+        result.upperLog2 = result.log2Count + std::log2(1 + parameters.epsilon);
+        return result;
+    }
+
+    /**
+     * @brief Formats 2^log2Value in scientific notation, which works beyond the range of double
+     */
+    static std::string formatPowerOfTwo(double log2Value) {
+        if (std::isinf(log2Value)) return "0";
+        double log10Value = log2Value * std::log10(2.0);
+        double exponent = std::floor(log10Value);
+        double mantissa = std::pow(10.0, log10Value - exponent);
+        if (mantissa >= 9.995) { // Rounds up to 10.00
+            mantissa /= 10;
+            exponent += 1;
+        }
+        std::ostringstream text;
+        text << std::fixed << std::setprecision(2) << mantissa << "e" << static_cast<long long>(exponent);
+        return text.str();
+    }
+};
+
+#endif // LOGIC_MODEL_COUNTER_HPP
@@ -0,0 +1,557 @@
+/**
+ * @file problem.hpp
+ * @brief Problems, their text and DIMACS readers, and the shared expression DAG of an argument.
+ */
+
+#ifndef LOGIC_PROBLEM_HPP
+#define LOGIC_PROBLEM_HPP
+
+#include "common.hpp"
+#include "expression.hpp"
+
+/**
+ * @struct Problem
+ * @brief An argument whose expressions have been compiled over numbered variable slots.
+ */
+struct Problem {
+    std::vector<std::string> variables; // Name of each variable slot, in truth table column order
+    std::vector<CompiledExpression> premises;
+    CompiledExpression conclusion = CompiledExpression::constant(true); // An argument without a conclusion asks for satisfiability only
+};
+
+/**
+ * @class ProblemBuilder
+ * @brief Compiles premises and a conclusion into a Problem, numbering the variables alphabetically.
+ *
+ * The compiler interns names in order of appearance; finish() renumbers the slots so the truth table
+ * columns stay sorted for consistent processing.
+ */
+class ProblemBuilder {
+private:
+    ExpressionCompiler compiler;
+    SymbolTable symbols;
+    Problem problem;
+
+public:
+    /**
+     * @throws std::runtime_error If the expression is malformed.
+     */
+    void addPremise(std::string_view expression) {
+        problem.premises.push_back(compiler.compile(expression, symbols));
+    }
+
+    /**
+     * @throws std::runtime_error If the expression is malformed.
+     */
+    void setConclusion(std::string_view expression) {
+        problem.conclusion = compiler.compile(expression, symbols);
+    }
+
+    /**
+     * @brief Sorts the variables by name and returns the problem
+     */
+    Problem finish() {
+        Instrumentation::Scope timer(Instrumentation::Phase::VARIABLES, "variables");
+        std::vector<uint32_t> sorted(symbols.size());
+        for (uint32_t id = 0; id < sorted.size(); ++id) sorted[id] = id;
+        std::sort(sorted.begin(), sorted.end(), [&](uint32_t a, uint32_t b) { return symbols.name(a) < symbols.name(b); });
+
+        std::vector<uint32_t> newSlot(sorted.size());
+        problem.variables.clear();
+        for (uint32_t slot = 0; slot < sorted.size(); ++slot) {
+            newSlot[sorted[slot]] = slot;
+            problem.variables.emplace_back(symbols.name(sorted[slot]));
+        }
+        for (auto& premise : problem.premises) premise.remapSlots(newSlot);
+        problem.conclusion.remapSlots(newSlot);
+        return std::move(problem);
+    }
+};
+
+/**
+ * @class MappedFile
+ * @brief Read-only view of a whole file, memory-mapped where the platform allows it.
+ */
+class MappedFile {
+private:
+    const char* bytes = nullptr;
+    size_t length = 0;
+    std::string contents; // Fallback for files that cannot be mapped: the file read into memory
+#ifndef _WIN32
+    void* mapping = nullptr;
+#endif
+
+    void readAll(std::istream& in) {
+        contents.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+        bytes = contents.data();
+        length = contents.size();
+    }
+
+public:
+    /**
+     * @throws std::runtime_error If the file cannot be opened or mapped.
+     */
+    explicit MappedFile(const std::string& path) {
+#ifndef _WIN32
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) throw std::runtime_error("Cannot open '" + path + "'");
+        struct stat info;
+        if (::fstat(fd, &info) != 0) {
+            ::close(fd);
+            throw std::runtime_error("Cannot read '" + path + "'");
+        }
+        if (S_ISREG(info.st_mode)) { // Pipes and terminals are read below
+            length = static_cast<size_t>(info.st_size);
+            if (length > 0) { // Empty files cannot be mapped
+                mapping = ::mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+                if (mapping == MAP_FAILED) {
+                    ::close(fd);
+                    throw std::runtime_error("Cannot map '" + path + "'");
+                }
+                ::madvise(mapping, length, MADV_SEQUENTIAL); // The parsers make a single forward pass
+                bytes = static_cast<const char*>(mapping);
+            }
+            ::close(fd); // The mapping keeps the file alive
+            return;
+        }
+        ::close(fd);
+#endif
+        std::ifstream in(path, std::ios::binary);
+        if (!in) throw std::runtime_error("Cannot open '" + path + "'");
+        readAll(in);
+    }
+
+    ~MappedFile() {
+#ifndef _WIN32
+        if (mapping) ::munmap(mapping, length);
+#endif
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    std::string_view view() const { return std::string_view(bytes, length); }
+};
+
+/**
+ * @class ProblemReader
+ * @brief Parses problem files in a single linear pass.
+ *
+ * Two formats are understood:
+ * - text: one premise per line and the conclusion on a line starting with "=>". Everything after
+ *   '#' is a comment and blank lines are skipped. Without a conclusion the argument only asks
+ *   whether the premises are satisfiable, and is valid exactly when they are not.
+ * - dimacs: a CNF in DIMACS format, every clause is a premise and the conclusion is true. Variable
+ *   k is named xk and uses slot k-1. A header declaring more variables than the file could mention,
+ *   beyond an allowance of 2^20 unused ones, is rejected before the name table is built.
+ */
+class ProblemReader {
+private:
+    static constexpr uint64_t MAX_UNUSED_VARIABLES = uint64_t{1} << 20; ///< Declared DIMACS variables a file need not mention
+
+    /**
+     * @brief Reads an unsigned decimal number, advancing the position past it
+     */
+    static uint64_t parseNumber(std::string_view text, size_t& pos, size_t line) {
+        if (pos >= text.size() || text[pos] < '0' || text[pos] > '9') {
+            throw std::runtime_error("line " + std::to_string(line) + ": Expected a number");
+        }
+        uint64_t value = 0;
+        while (pos < text.size() && text[pos] >= '0' && text[pos] <= '9') {
+            if (value > (std::numeric_limits<uint32_t>::max() - 9) / 10) {
+                throw std::runtime_error("line " + std::to_string(line) + ": Number too large");
+            }
+            value = value * 10 + static_cast<uint64_t>(text[pos++] - '0');
+        }
+        return value;
+    }
+
+    static bool isBlank(char c) {
+        return c == ' ' || c == '\t' || c == '\r' || c == '\f' || c == '\v';
+    }
+
+public:
+    enum class Format {
+        AUTO,  // DIMACS for .cnf and .dimacs files, text otherwise
+        TEXT,
+        DIMACS
+    };
+
+    /**
+     * @brief Parses a text problem
+     * @throws std::runtime_error If a line is malformed or there is more than one conclusion.
+     */
+    static Problem readText(std::string_view text) {
+        ProblemBuilder builder;
+        bool hasConclusion = false;
+        size_t lineNumber = 0;
+        size_t pos = 0;
+        while (pos < text.size()) {
+            size_t end = text.find('\n', pos);
+            if (end == std::string_view::npos) end = text.size();
+            std::string_view line = text.substr(pos, end - pos);
+            pos = end + 1;
+            ++lineNumber;
+
+            size_t comment = line.find('#');
+            if (comment != std::string_view::npos) line = line.substr(0, comment);
+            size_t first = 0;
+            while (first < line.size() && isBlank(line[first])) ++first;
+            line = line.substr(first);
+            if (line.empty()) continue;
+
+            try {
+                if (line.size() >= 2 && line[0] == '=' && line[1] == '>') {
+                    if (hasConclusion) throw std::runtime_error("More than one conclusion");
+                    builder.setConclusion(line.substr(2));
+                    hasConclusion = true;
+                } else {
+                    builder.addPremise(line);
+                }
+            } catch (const std::runtime_error& e) {
+                throw std::runtime_error("line " + std::to_string(lineNumber) + ": " + e.what());
+            }
+        }
+        return builder.finish();
+    }
+
+    /**
+     * @brief Parses a DIMACS CNF problem
+     * @throws std::runtime_error If the header is missing or a literal is out of range.
+     */
+    static Problem readDimacs(std::string_view text) {
+        Problem problem;
+        bool hasHeader = false;
+        uint64_t variableCount = 0;
+        uint64_t declaredClauses = 0;
+        CompiledExpression clause;
+        size_t depth = 0; // Stack depth of the clause so far, 0 or 1
+        size_t line = 1;
+        size_t pos = 0;
+        bool lineStart = true;
+
+        while (pos < text.size()) {
+            char c = text[pos];
+            if (c == '\n') {
+                ++line;
+                ++pos;
+                lineStart = true;
+                continue;
+            }
+            if (isBlank(c)) {
+                ++pos;
+                continue;
+            }
+            if (lineStart && (c == 'c' || c == '%')) { // Comment, '%' ends some benchmark files
+                if (c == '%') break;
+                size_t end = text.find('\n', pos);
+                pos = end == std::string_view::npos ? text.size() : end;
+                continue;
+            }
+            lineStart = false;
+
+            if (c == 'p') {
+                if (hasHeader) throw std::runtime_error("line " + std::to_string(line) + ": Duplicate problem line");
+                ++pos;
+                while (pos < text.size() && isBlank(text[pos])) ++pos;
+                if (text.substr(pos, 3) != "cnf") {
+                    throw std::runtime_error("line " + std::to_string(line) + ": Expected 'p cnf <variables> <clauses>'");
+                }
+                pos += 3;
+                while (pos < text.size() && isBlank(text[pos])) ++pos;
+                variableCount = parseNumber(text, pos, line);
+                while (pos < text.size() && isBlank(text[pos])) ++pos;
+                declaredClauses = parseNumber(text, pos, line);
+                // The counts are untrusted. A variable that occurs takes at least two bytes of the file, so
+                // beyond a fixed allowance of unused ones the file size bounds the name table
+                if (variableCount > std::max<uint64_t>(MAX_UNUSED_VARIABLES, text.size())) {
+                    throw std::runtime_error("line " + std::to_string(line) + ": " + std::to_string(variableCount) +
+                                             " variables declared in a file of " + std::to_string(text.size()) + " bytes");
+                }
+                hasHeader = true;
+                problem.variables.reserve(variableCount);
+                for (uint64_t k = 1; k <= variableCount; ++k) problem.variables.push_back("x" + std::to_string(k));
+                problem.premises.reserve(std::min<uint64_t>(declaredClauses, text.size() / 2));
+                continue;
+            }
+            if (!hasHeader) {
+                throw std::runtime_error("line " + std::to_string(line) + ": Missing 'p cnf' problem line");
+            }
+
+            bool negative = c == '-';
+            if (negative) ++pos;
+            uint64_t k = parseNumber(text, pos, line);
+            if (k == 0) { // End of clause
+                if (clause.code.empty()) clause = CompiledExpression::constant(false);
+                clause.maxStackDepth = std::max<size_t>(clause.maxStackDepth, 1);
+                problem.premises.push_back(std::move(clause));
+                clause = CompiledExpression();
+                depth = 0;
+                continue;
+            }
+            if (k > variableCount) {
+                throw std::runtime_error("line " + std::to_string(line) + ": Variable " + std::to_string(k) +
+                                         " out of range (" + std::to_string(variableCount) + " declared)");
+            }
+            clause.code.push_back({CompiledExpression::OpCode::LOAD, static_cast<uint32_t>(k - 1)});
+            if (negative) clause.code.push_back({CompiledExpression::OpCode::NOT, 0});
+            if (depth == 1) {
+                clause.code.push_back({CompiledExpression::OpCode::OR, 0});
+                clause.maxStackDepth = 2;
+            } else {
+                depth = 1;
+            }
+        }
+
+        if (!hasHeader) throw std::runtime_error("Missing 'p cnf' problem line");
+        if (!clause.code.empty()) throw std::runtime_error("Last clause is not terminated by 0");
+        return problem;
+    }
+
+    /**
+     * @brief Maps a file and parses it
+     * @param path The problem file.
+     * @param format The format, AUTO chooses by file extension.
+     * @throws std::runtime_error If the file cannot be read or is malformed.
+     */
+    static Problem read(const std::string& path, Format format = Format::AUTO) {
+        if (format == Format::AUTO) {
+            auto endsWith = [&](const std::string& suffix) {
+                return path.size() >= suffix.size() && path.compare(path.size() - suffix.size(), suffix.size(), suffix) == 0;
+            };
+            format = endsWith(".cnf") || endsWith(".dimacs") ? Format::DIMACS : Format::TEXT;
+        }
+        Instrumentation::Scope timer(Instrumentation::Phase::READ, "read");
+        MappedFile file(path);
+        try {
+            return format == Format::DIMACS ? readDimacs(file.view()) : readText(file.view());
+        } catch (const std::runtime_error& e) {
+            throw std::runtime_error(path + ": " + e.what());
+        }
+    }
+};
+
+/**
+ * @class ExpressionDag
+ * @brief The subexpressions of several compiled expressions, hash-consed into one shared DAG.
+ *
+ * Nodes are canonicalized before they are looked up: the operands of the commutative operators
+ * (AND, OR, BICONDITIONAL) are ordered, double negations are removed and x & x, x | x become x.
+ * A subformula repeated anywhere in the premises or the conclusion, such as (p & q) -> r in many
+ * premises or q & p next to p & q, is therefore a single node and is evaluated once.
+ */
+class ExpressionDag {
+public:
+    typedef CompiledExpression::OpCode OpCode;
+
+    /**
+     * @brief A node; LOAD keeps the variable slot and CONSTANT the value in left
+     */
+    struct Node {
+        OpCode op;
+        uint32_t left;
+        uint32_t right;
+
+        bool operator==(const Node& other) const {
+            return op == other.op && left == other.left && right == other.right;
+        }
+    };
+
+private:
+    struct NodeHash {
+        size_t operator()(const Node& node) const {
+            uint64_t key = (uint64_t{node.left} << 32 | node.right) * 0x9E3779B97F4A7C15ull;
+            return static_cast<size_t>(key ^ (key >> 29) ^ static_cast<uint64_t>(node.op));
+        }
+    };
+
+    std::vector<Node> nodes; // Children always come before their parents
+    std::unordered_map<Node, uint32_t, NodeHash> unique; // Canonical node -> index
+    size_t subexpressions = 0; // Instructions of all added expressions
+    size_t shared = 0; // Nodes found in the table instead of created
+
+    /**
+     * @brief Returns the node of a canonicalized operation, creating it only if it is new
+     */
+    uint32_t make(OpCode op, uint32_t left, uint32_t right) {
+        switch (op) {
+        case OpCode::NOT:
+            if (nodes[left].op == OpCode::NOT) return nodes[left].left; // ~~x is x
+            right = 0;
+            break;
+        case OpCode::AND:
+        case OpCode::OR:
+            if (left == right) return left; // x & x and x | x are x
+            if (left > right) std::swap(left, right);
+            break;
+        case OpCode::BICONDITIONAL:
+            if (left > right) std::swap(left, right);
+            break;
+        default:
+            break;
+        }
+        Node node = {op, left, right};
+        auto found = unique.find(node);
+        if (found != unique.end()) {
+            ++shared;
+            return found->second;
+        }
+        nodes.push_back(node);
+        unique.emplace(node, static_cast<uint32_t>(nodes.size() - 1));
+        return static_cast<uint32_t>(nodes.size() - 1);
+    }
+
+public:
+    /**
+     * @brief Adds an expression and returns its root node
+     */
+    uint32_t add(const CompiledExpression& expression) {
+        std::vector<uint32_t> stack;
+        stack.reserve(expression.maxStackDepth);
+        for (const auto& ins : expression.code) {
+            ++subexpressions;
+            if (ins.op == OpCode::LOAD || ins.op == OpCode::CONSTANT) {
+                stack.push_back(make(ins.op, ins.slot, 0));
+            } else if (ins.op == OpCode::NOT) {
+                stack.back() = make(OpCode::NOT, stack.back(), 0);
+            } else {
+                uint32_t right = stack.back();
+                stack.pop_back();
+                stack.back() = make(ins.op, stack.back(), right);
+            }
+        }
+        return stack.back();
+    }
+
+    const std::vector<Node>& nodeList() const { return nodes; }
+    size_t size() const { return nodes.size(); }
+
+    /**
+     * @brief Number of subexpressions in the added expressions, before sharing
+     */
+    size_t subexpressionCount() const { return subexpressions; }
+
+    /**
+     * @brief Number of subexpressions that reused an existing node
+     */
+    size_t deduplicatedCount() const { return shared; }
+};
+
+/**
+ * @class DagProgram
+ * @brief A register program that evaluates every node of an ExpressionDag once.
+ *
+ * Registers 0 .. n-1 hold the variables and the next two the constants false and true, so LOAD and
+ * CONSTANT nodes cost nothing. Every other node is one instruction writing a temporary register;
+ * a temporary is reused once its last reader has run, so the register file stays about as small
+ * as the evaluation stack of the separate expressions. The registers of the roots are kept.
+ */
+class DagProgram {
+public:
+    struct Instruction {
+        CompiledExpression::OpCode op;
+        uint32_t target;
+        uint32_t left;
+        uint32_t right;
+    };
+
+    std::vector<Instruction> code;
+    size_t registerCount = 0;
+    std::vector<uint32_t> premiseRegisters; // Register of each premise after execution
+    uint32_t conclusionRegister = 0;
+
+    DagProgram() = default;
+
+    /**
+     * @brief Compiles the premises and conclusion of a DAG
+     * @param dag The shared nodes.
+     * @param premiseRoots Root node of each premise.
+     * @param conclusionRoot Root node of the conclusion.
+     * @param variableCount Number of variable slots.
+     */
+    DagProgram(const ExpressionDag& dag, const std::vector<uint32_t>& premiseRoots, uint32_t conclusionRoot,
+               size_t variableCount) {
+        typedef CompiledExpression::OpCode OpCode;
+        const auto& nodes = dag.nodeList();
+        const uint32_t pinned = std::numeric_limits<uint32_t>::max();
+
+        // Nodes reachable from the roots; removing a double negation can leave the inner NOT unused
+        std::vector<uint8_t> live(nodes.size(), 0);
+        for (uint32_t root : premiseRoots) live[root] = 1;
+        live[conclusionRoot] = 1;
+        for (uint32_t i = static_cast<uint32_t>(nodes.size()); i-- > 0;) {
+            if (!live[i] || nodes[i].op == OpCode::LOAD || nodes[i].op == OpCode::CONSTANT) continue;
+            live[nodes[i].left] = 1;
+            if (nodes[i].op != OpCode::NOT) live[nodes[i].right] = 1;
+        }
+
+        // Last instruction that reads each node; roots are read after the program
+        std::vector<uint32_t> lastUse(nodes.size(), 0);
+        for (uint32_t i = 0; i < nodes.size(); ++i) {
+            if (!live[i] || nodes[i].op == OpCode::LOAD || nodes[i].op == OpCode::CONSTANT) continue;
+            lastUse[nodes[i].left] = i;
+            if (nodes[i].op != OpCode::NOT) lastUse[nodes[i].right] = i;
+        }
+        for (uint32_t root : premiseRoots) lastUse[root] = pinned;
+        lastUse[conclusionRoot] = pinned;
+
+        const uint32_t constants = static_cast<uint32_t>(variableCount); // False, then true
+        registerCount = variableCount + 2;
+        std::vector<uint32_t> registerOf(nodes.size());
+        std::vector<uint32_t> freeRegisters;
+        for (uint32_t i = 0; i < nodes.size(); ++i) {
+            const auto& node = nodes[i];
+            if (!live[i]) continue;
+            if (node.op == OpCode::LOAD) {
+                registerOf[i] = node.left;
+                continue;
+            }
+            if (node.op == OpCode::CONSTANT) {
+                registerOf[i] = constants + (node.left ? 1 : 0);
+                continue;
+            }
+            // Operands read for the last time free their registers before the result is placed
+            auto release = [&](uint32_t operand) {
+                const auto& op = nodes[operand].op;
+                if (lastUse[operand] == i && op != OpCode::LOAD && op != OpCode::CONSTANT) {
+                    freeRegisters.push_back(registerOf[operand]);
+                }
+            };
+            release(node.left);
+            if (node.op != OpCode::NOT && node.right != node.left) release(node.right);
+
+            uint32_t target;
+            if (!freeRegisters.empty()) {
+                target = freeRegisters.back();
+                freeRegisters.pop_back();
+            } else {
+                target = static_cast<uint32_t>(registerCount++);
+            }
+            registerOf[i] = target;
+            code.push_back({node.op, target, registerOf[node.left], node.op == OpCode::NOT ? 0 : registerOf[node.right]});
+        }
+
+        for (uint32_t root : premiseRoots) premiseRegisters.push_back(registerOf[root]);
+        conclusionRegister = registerOf[conclusionRoot];
+    }
+
+    /**
+     * @brief Executes the program over bit-sliced values
+     * @param registers At least registerCount words, starting with the variables and the constants 0 and ~0.
+     */
+    template <typename Word>
+    LOGIC_ALWAYS_INLINE void execute(Word* registers) const {
+        typedef CompiledExpression::OpCode OpCode;
+        for (const Instruction& ins : code) {
+            switch (ins.op) {
+            case OpCode::NOT:     registers[ins.target] = ~registers[ins.left]; break;
+            case OpCode::AND:     registers[ins.target] = registers[ins.left] & registers[ins.right]; break;
+            case OpCode::OR:      registers[ins.target] = registers[ins.left] | registers[ins.right]; break;
+            case OpCode::IMPLIES: registers[ins.target] = ~registers[ins.left] | registers[ins.right]; break;
+            default:              registers[ins.target] = ~(registers[ins.left] ^ registers[ins.right]); break;
+            }
+        }
+    }
+};
+
+#endif // LOGIC_PROBLEM_HPP
@@ -0,0 +1,1080 @@
+/**
+ * @file sat_solver.hpp
+ * @brief CDCL SAT solver with native XOR constraints, and the Tseitin encoding of compiled expressions.
+ */
+
+#ifndef LOGIC_SAT_SOLVER_HPP
+#define LOGIC_SAT_SOLVER_HPP
+
+#include "common.hpp"
+#include "expression.hpp"
+#include "evaluation.hpp"
+
+/**
+ * @class SatSolver
+ * @brief A conflict-driven clause-learning (CDCL) SAT solver.
+ *
+ * Clauses are watched on two literals with a blocking literal. Branching uses VSIDS activities kept in
+ * a binary heap with phase saving. Conflicts are analyzed to the first unique implication point, the
+ * learnt clause is minimized locally and the solver backjumps. Searches restart on the Luby sequence
+ * and learnt clauses are periodically deleted by literal block distance (LBD) and activity.
+ *
+ * Clauses can be added between calls to solve(), and solve() accepts assumption literals that only
+ * hold for that call, so one encoding can answer several related questions.
+ */
+class SatSolver {
+public:
+    typedef uint32_t Literal; // 2 * variable, plus 1 if the literal is negated
+
+    static Literal positive(uint32_t variable) { return variable * 2; }
+    static Literal negative(uint32_t variable) { return variable * 2 + 1; }
+    static Literal negate(Literal literal) { return literal ^ 1; }
+    static uint32_t variableOf(Literal literal) { return literal >> 1; }
+
+    /**
+     * @brief Outcome of solve()
+     */
+    enum class Result {
+        SATISFIABLE,
+        UNSATISFIABLE,
+        UNKNOWN // The conflict limit was reached
+    };
+
+    /**
+     * @brief Search counters, accumulated over all calls to solve()
+     */
+    struct Statistics {
+        uint64_t decisions = 0;
+        uint64_t propagations = 0;
+        uint64_t conflicts = 0;
+        uint64_t restarts = 0;
+        uint64_t learntClauses = 0;
+        uint64_t deletedClauses = 0;
+    };
+
+private:
+    static constexpr uint8_t FALSE_VALUE = 0;
+    static constexpr uint8_t TRUE_VALUE = 1;
+    static constexpr uint8_t UNASSIGNED = 2;
+    static constexpr uint32_t NO_CLAUSE = std::numeric_limits<uint32_t>::max();
+
+    struct Clause {
+        std::vector<Literal> literals; // literals[0] is the implied literal when the clause is a reason
+        bool learnt = false;
+        bool deleted = false;
+        bool temporary = false; // Unwatched reason derived from XOR constraints, released on backtracking
+        std::vector<uint64_t> xorSnapshot; // Assigned columns and sources of an XOR reason not yet expanded
+        uint32_t lbd = 0; // Number of decision levels in the clause when it was learnt
+        double activity = 0;
+    };
+
+    /**
+     * @brief Entry of a watch list; the clause is skipped without being read while blocker is true
+     */
+    struct Watcher {
+        uint32_t clause;
+        Literal blocker;
+    };
+
+    std::vector<Clause> clauses;
+    std::vector<uint32_t> freeClauses; // Slots of deleted clauses, reused by new ones
+    std::vector<std::vector<Watcher>> watches; // Clauses watching a literal, visited when it becomes false
+    std::vector<uint8_t> values; // Per variable
+    std::vector<uint32_t> levels; // Decision level of each assigned variable
+    std::vector<uint32_t> reasons; // Clause that implied each variable, NO_CLAUSE for decisions
+    std::vector<uint8_t> savedPhases; // Last value of each variable, reused when branching on it
+    std::vector<double> activities; // VSIDS activity of each variable
+    std::vector<uint8_t> seen; // Scratch marks of conflict analysis
+    std::vector<uint8_t> model; // Values of the last satisfying assignment
+
+    std::vector<Literal> trail; // Assigned literals in assignment order
+    std::vector<size_t> trailLimits; // Trail size at the start of each decision level
+    size_t propagateHead = 0; // Next trail literal to propagate
+
+    std::vector<uint32_t> heap; // Unassigned variables ordered by activity (max-heap)
+    std::vector<int> heapIndex; // Position of each variable in the heap, -1 if absent
+
+    double variableIncrement = 1;
+    double clauseIncrement = 1;
+    size_t learntCount = 0;
+    double maxLearnts = 0;
+    bool inconsistent = false; // The clauses are unsatisfiable without any assumption
+    uint64_t conflictLimit = std::numeric_limits<uint64_t>::max(); // Per call to solve()
+    const Budget* timeBudget = &Budget::unlimited();
+    Statistics stats;
+
+    uint8_t valueOf(Literal literal) const {
+        uint8_t value = values[variableOf(literal)];
+        return value == UNASSIGNED ? UNASSIGNED : static_cast<uint8_t>(value ^ (literal & 1));
+    }
+
+    uint32_t decisionLevel() const {
+        return static_cast<uint32_t>(trailLimits.size());
+    }
+
+    // --- Variable order heap ---
+
+    bool heapBefore(uint32_t a, uint32_t b) const {
+        return activities[a] > activities[b];
+    }
+
+    void heapUp(size_t i) {
+        uint32_t variable = heap[i];
+        while (i > 0 && heapBefore(variable, heap[(i - 1) / 2])) {
+            heap[i] = heap[(i - 1) / 2];
+            heapIndex[heap[i]] = static_cast<int>(i);
+            i = (i - 1) / 2;
+        }
+        heap[i] = variable;
+        heapIndex[variable] = static_cast<int>(i);
+    }
+
+    void heapDown(size_t i) {
+        uint32_t variable = heap[i];
+        while (2 * i + 1 < heap.size()) {
+            size_t child = 2 * i + 1;
+            if (child + 1 < heap.size() && heapBefore(heap[child + 1], heap[child])) ++child;
+            if (!heapBefore(heap[child], variable)) break;
+            heap[i] = heap[child];
+            heapIndex[heap[i]] = static_cast<int>(i);
+            i = child;
+        }
+        heap[i] = variable;
+        heapIndex[variable] = static_cast<int>(i);
+    }
+
+    void heapInsert(uint32_t variable) {
+        if (heapIndex[variable] >= 0) return;
+        heap.push_back(variable);
+        heapUp(heap.size() - 1);
+    }
+
+    uint32_t heapPop() {
+        uint32_t top = heap[0];
+        heapIndex[top] = -1;
+        heap[0] = heap.back();
+        heap.pop_back();
+        if (!heap.empty()) {
+            heapIndex[heap[0]] = 0;
+            heapDown(0);
+        }
+        return top;
+    }
+
+    // --- Activities ---
+
+    void bumpVariable(uint32_t variable) {
+        if ((activities[variable] += variableIncrement) > 1e100) {
+            for (double& activity : activities) activity *= 1e-100;
+            variableIncrement *= 1e-100;
+        }
+        if (heapIndex[variable] >= 0) heapUp(static_cast<size_t>(heapIndex[variable]));
+    }
+
+    void bumpClause(Clause& clause) {
+        if ((clause.activity += clauseIncrement) > 1e20) {
+            for (Clause& c : clauses) {
+                if (c.learnt) c.activity *= 1e-20;
+            }
+            clauseIncrement *= 1e-20;
+        }
+    }
+
+    // --- Assignment ---
+
+    void assign(Literal literal, uint32_t reason) {
+        uint32_t variable = variableOf(literal);
+        values[variable] = static_cast<uint8_t>((literal & 1) ^ 1);
+        levels[variable] = decisionLevel();
+        reasons[variable] = reason;
+        trail.push_back(literal);
+        if (variable < xorColumnOf.size() && xorColumnOf[variable] >= 0) {
+            updateXorColumn(static_cast<size_t>(xorColumnOf[variable]), true, !(literal & 1));
+        }
+    }
+
+    void backtrack(uint32_t level) {
+        if (decisionLevel() <= level) return;
+        for (size_t i = trail.size(); i-- > trailLimits[level];) {
+            uint32_t variable = variableOf(trail[i]);
+            if (reasons[variable] != NO_CLAUSE && clauses[reasons[variable]].temporary) releaseClause(reasons[variable]);
+            if (variable < xorColumnOf.size() && xorColumnOf[variable] >= 0) {
+                updateXorColumn(static_cast<size_t>(xorColumnOf[variable]), false, values[variable] == TRUE_VALUE);
+            }
+            savedPhases[variable] = values[variable];
+            values[variable] = UNASSIGNED;
+            reasons[variable] = NO_CLAUSE;
+            heapInsert(variable);
+        }
+        trail.resize(trailLimits[level]);
+        trailLimits.resize(level);
+        propagateHead = trail.size();
+    }
+
+    uint32_t allocateClause(std::vector<Literal> literals, bool learnt) {
+        uint32_t index;
+        if (!freeClauses.empty()) {
+            index = freeClauses.back();
+            freeClauses.pop_back();
+        } else {
+            index = static_cast<uint32_t>(clauses.size());
+            clauses.emplace_back();
+        }
+        Clause& clause = clauses[index];
+        clause.literals = std::move(literals);
+        clause.learnt = learnt;
+        clause.deleted = false;
+        clause.temporary = false;
+        clause.lbd = 0;
+        clause.activity = 0;
+        return index;
+    }
+
+    void releaseClause(uint32_t index) {
+        clauses[index].literals.clear();
+        clauses[index].xorSnapshot.clear();
+        clauses[index].temporary = false;
+        clauses[index].deleted = true;
+        freeClauses.push_back(index);
+    }
+
+    uint32_t storeClause(std::vector<Literal> literals, bool learnt) {
+        uint32_t index = allocateClause(std::move(literals), learnt);
+        Clause& clause = clauses[index];
+        watches[clause.literals[0]].push_back({index, clause.literals[1]});
+        watches[clause.literals[1]].push_back({index, clause.literals[0]});
+        return index;
+    }
+
+    /**
+     * @brief Propagates all pending assignments through the watch lists
+     * @return The conflicting clause, or NO_CLAUSE.
+     */
+    uint32_t propagate() {
+        while (propagateHead < trail.size()) {
+            Literal falseLiteral = negate(trail[propagateHead++]);
+            std::vector<Watcher>& list = watches[falseLiteral];
+            ++stats.propagations;
+
+            size_t keep = 0;
+            for (size_t i = 0; i < list.size(); ++i) {
+                Watcher watcher = list[i];
+                if (valueOf(watcher.blocker) == TRUE_VALUE) {
+                    list[keep++] = watcher;
+                    continue;
+                }
+
+                std::vector<Literal>& literals = clauses[watcher.clause].literals;
+                if (literals[0] == falseLiteral) std::swap(literals[0], literals[1]);
+                Literal first = literals[0];
+                if (first != watcher.blocker && valueOf(first) == TRUE_VALUE) {
+                    list[keep++] = {watcher.clause, first};
+                    continue;
+                }
+
+                // Look for a new literal to watch
+                bool moved = false;
+                for (size_t k = 2; k < literals.size(); ++k) {
+                    if (valueOf(literals[k]) != FALSE_VALUE) {
+                        std::swap(literals[1], literals[k]);
+                        watches[literals[1]].push_back({watcher.clause, first});
+                        moved = true;
+                        break;
+                    }
+                }
+                if (moved) continue;
+
+                // The clause is unit or conflicting
+                list[keep++] = {watcher.clause, first};
+                if (valueOf(first) == FALSE_VALUE) {
+                    for (++i; i < list.size(); ++i) list[keep++] = list[i];
+                    list.resize(keep);
+                    propagateHead = trail.size();
+                    return watcher.clause;
+                }
+                assign(first, watcher.clause);
+            }
+            list.resize(keep);
+        }
+        return NO_CLAUSE;
+    }
+
+    /**
+     * @brief Derives the first-UIP clause of a conflict
+     * @param conflict The conflicting clause.
+     * @param learnt Receives the clause; learnt[0] is the asserting literal, learnt[1] has the backjump level.
+     * @return The decision level to backjump to.
+     */
+    uint32_t analyze(uint32_t conflict, std::vector<Literal>& learnt) {
+        learnt.assign(1, 0); // Placeholder for the asserting literal
+        int pathCount = 0;
+        Literal implied = 0;
+        bool haveImplied = false;
+        size_t index = trail.size();
+
+        do {
+            expandXorReason(conflict);
+            Clause& clause = clauses[conflict];
+            if (clause.learnt) bumpClause(clause);
+            for (size_t k = haveImplied ? 1 : 0; k < clause.literals.size(); ++k) {
+                Literal q = clause.literals[k];
+                uint32_t variable = variableOf(q);
+                if (!seen[variable] && levels[variable] > 0) {
+                    seen[variable] = 1;
+                    bumpVariable(variable);
+                    if (levels[variable] >= decisionLevel()) {
+                        ++pathCount;
+                    } else {
+                        learnt.push_back(q);
+                    }
+                }
+            }
+            // Walk back to the next marked literal of the current level
+            while (!seen[variableOf(trail[--index])]) {
+            }
+            implied = trail[index];
+            haveImplied = true;
+            conflict = reasons[variableOf(implied)];
+            seen[variableOf(implied)] = 0;
+            --pathCount;
+        } while (pathCount > 0);
+        learnt[0] = negate(implied);
+
+        // Drop literals implied by the rest of the clause
+        std::vector<Literal> marked(learnt.begin() + 1, learnt.end());
+        size_t keep = 1;
+        for (size_t i = 1; i < learnt.size(); ++i) {
+            uint32_t reason = reasons[variableOf(learnt[i])];
+            bool redundant = reason != NO_CLAUSE;
+            if (redundant) {
+                expandXorReason(reason);
+                for (Literal r : clauses[reason].literals) {
+                    uint32_t variable = variableOf(r);
+                    if (variable != variableOf(learnt[i]) && !seen[variable] && levels[variable] > 0) {
+                        redundant = false;
+                        break;
+                    }
+                }
+            }
+            if (!redundant) learnt[keep++] = learnt[i];
+        }
+        learnt.resize(keep);
+        for (Literal literal : marked) seen[variableOf(literal)] = 0;
+
+        if (learnt.size() == 1) return 0;
+        size_t highest = 1;
+        for (size_t i = 2; i < learnt.size(); ++i) {
+            if (levels[variableOf(learnt[i])] > levels[variableOf(learnt[highest])]) highest = i;
+        }
+        std::swap(learnt[1], learnt[highest]);
+        return levels[variableOf(learnt[1])];
+    }
+
+    uint32_t computeLbd(const std::vector<Literal>& literals) {
+        std::vector<uint32_t> distinct;
+        for (Literal literal : literals) distinct.push_back(levels[variableOf(literal)]);
+        std::sort(distinct.begin(), distinct.end());
+        return static_cast<uint32_t>(std::unique(distinct.begin(), distinct.end()) - distinct.begin());
+    }
+
+    /**
+     * @brief Deletes about half of the learnt clauses, keeping reasons and low-LBD clauses
+     */
+    void reduceLearnts() {
+        std::vector<uint32_t> candidates;
+        for (uint32_t i = 0; i < clauses.size(); ++i) {
+            const Clause& clause = clauses[i];
+            if (!clause.learnt || clause.deleted || clause.lbd <= 2) continue;
+            Literal first = clause.literals[0];
+            bool locked = reasons[variableOf(first)] == i && valueOf(first) == TRUE_VALUE;
+            if (!locked) candidates.push_back(i);
+        }
+        std::sort(candidates.begin(), candidates.end(), [&](uint32_t a, uint32_t b) {
+            if (clauses[a].lbd != clauses[b].lbd) return clauses[a].lbd > clauses[b].lbd;
+            return clauses[a].activity < clauses[b].activity;
+        });
+        candidates.resize(candidates.size() / 2);
+        for (uint32_t i : candidates) {
+            clauses[i].deleted = true;
+        }
+
+        // Remove watchers of deleted clauses before their slots are reused
+        for (auto& list : watches) {
+            list.erase(std::remove_if(list.begin(), list.end(),
+                                      [&](const Watcher& w) { return clauses[w.clause].deleted; }),
+                       list.end());
+        }
+        for (uint32_t i : candidates) {
+            std::vector<Literal>().swap(clauses[i].literals);
+            freeClauses.push_back(i);
+        }
+        learntCount -= candidates.size();
+        stats.deletedClauses += candidates.size();
+    }
+
+    static double luby(double y, uint64_t x) {
+        uint64_t size = 1;
+        int seq = 0;
+        while (size < x + 1) {
+            ++seq;
+            size = 2 * size + 1;
+        }
+        while (size - 1 != x) {
+            size = (size - 1) >> 1;
+            --seq;
+            x = x % size;
+        }
+        return std::pow(y, seq);
+    }
+
+    // --- XOR constraints ---
+
+    /**
+     * @brief An XOR constraint: the variables sum to parity whenever guard is assumed
+     */
+    struct XorConstraint {
+        std::vector<uint32_t> variables;
+        bool parity;
+        Literal guard;
+    };
+
+    std::vector<XorConstraint> xors;
+    // Matrix of the constraints enabled in the current call to solve(). Rows are sums of constraints and
+    // are only ever added to each other, so the matrix stays equivalent to the constraints through
+    // backtracking. Each row has an unassigned pivot column where one exists, found in no other row.
+    std::vector<uint32_t> xorColumns; // Variable of each column
+    size_t columnWords = 0;
+    size_t sourceWords = 0;
+    std::vector<uint64_t> xorRows; // Column bits, columnWords per row
+    std::vector<uint64_t> xorSources; // Enabled constraints summed into the row, sourceWords per row
+    std::vector<uint8_t> xorParities;
+    std::vector<int64_t> xorPivots; // Pivot column of each row, -1 if it has none
+    std::vector<Literal> xorGuards; // Guard of each enabled constraint
+    std::vector<int64_t> xorColumnOf; // Column of each variable, -1 if it is in no enabled constraint
+    std::vector<uint64_t> assignedColumns; // Kept up to date by assign() and backtrack()
+    std::vector<uint64_t> trueColumns;
+    std::vector<uint32_t> xorOpen; // Unassigned columns of each row
+    std::vector<uint8_t> xorAssignedParity; // Sum of the assigned columns of each row
+    bool xorDirty = false; // A column was assigned or unassigned since the matrix was last propagated
+
+    /**
+     * @brief Builds the matrix of the constraints whose guard is among the assumptions
+     */
+    void buildXorMatrix(const std::vector<Literal>& assumptions) {
+        xorColumns.clear();
+        xorGuards.clear();
+        xorPivots.clear();
+        xorColumnOf.clear();
+        if (xors.empty()) return;
+        std::vector<uint8_t> assumed(2 * values.size(), 0);
+        for (Literal literal : assumptions) assumed[literal] = 1;
+        std::vector<int64_t>& columnOf = xorColumnOf;
+        columnOf.assign(values.size(), -1);
+        std::vector<const XorConstraint*> enabled;
+        for (const XorConstraint& constraint : xors) {
+            if (!assumed[constraint.guard]) continue;
+            enabled.push_back(&constraint);
+            xorGuards.push_back(constraint.guard);
+            for (uint32_t variable : constraint.variables) {
+                if (columnOf[variable] >= 0) continue;
+                columnOf[variable] = static_cast<int64_t>(xorColumns.size());
+                xorColumns.push_back(variable);
+            }
+        }
+        columnWords = (xorColumns.size() + 63) / 64;
+        sourceWords = (enabled.size() + 63) / 64;
+        xorRows.assign(enabled.size() * columnWords, 0);
+        xorSources.assign(enabled.size() * sourceWords, 0);
+        xorParities.assign(enabled.size(), 0);
+        xorPivots.assign(enabled.size(), -1);
+        for (size_t r = 0; r < enabled.size(); ++r) {
+            for (uint32_t variable : enabled[r]->variables) {
+                size_t column = static_cast<size_t>(columnOf[variable]);
+                xorRows[r * columnWords + column / 64] ^= uint64_t{1} << (column % 64); // x ^ x cancels
+            }
+            xorParities[r] = enabled[r]->parity;
+            xorSources[r * sourceWords + r / 64] |= uint64_t{1} << (r % 64);
+        }
+        assignedColumns.assign(columnWords, 0);
+        trueColumns.assign(columnWords, 0);
+        for (size_t column = 0; column < xorColumns.size(); ++column) {
+            uint8_t value = values[xorColumns[column]];
+            if (value == UNASSIGNED) continue;
+            assignedColumns[column / 64] |= uint64_t{1} << (column % 64);
+            if (value == TRUE_VALUE) trueColumns[column / 64] |= uint64_t{1} << (column % 64);
+        }
+        xorOpen.assign(enabled.size(), 0);
+        xorAssignedParity.assign(enabled.size(), 0);
+        for (size_t r = 0; r < enabled.size(); ++r) recountXorRow(r);
+        xorDirty = true;
+    }
+
+    /**
+     * @brief Records that a column was assigned or unassigned, in the masks and the rows containing it
+     */
+    void updateXorColumn(size_t column, bool assigned, bool value) {
+        const size_t word = column / 64;
+        const uint64_t bit = uint64_t{1} << (column % 64);
+        if (assigned) {
+            assignedColumns[word] |= bit;
+            if (value) trueColumns[word] |= bit;
+        } else {
+            assignedColumns[word] &= ~bit;
+            trueColumns[word] &= ~bit;
+        }
+        for (size_t r = 0; r < xorPivots.size(); ++r) {
+            if (!(xorRows[r * columnWords + word] & bit)) continue;
+            xorOpen[r] += assigned ? -1 : 1;
+            xorAssignedParity[r] ^= value;
+        }
+        xorDirty = true; // Unassigning can make a satisfied row unit
+    }
+
+    void recountXorRow(size_t row) {
+        uint32_t open = 0;
+        uint8_t parity = 0;
+        for (size_t w = 0; w < columnWords; ++w) {
+            uint64_t bits = xorRows[row * columnWords + w];
+            open += static_cast<uint32_t>(__builtin_popcountll(bits & ~assignedColumns[w]));
+            parity ^= static_cast<uint8_t>(__builtin_popcountll(bits & trueColumns[w]) & 1);
+        }
+        xorOpen[row] = open;
+        xorAssignedParity[row] = parity;
+    }
+
+    bool xorBit(size_t row, size_t column) const {
+        return (xorRows[row * columnWords + column / 64] >> (column % 64)) & 1;
+    }
+
+    void addXorRow(size_t from, size_t to) {
+        for (size_t w = 0; w < columnWords; ++w) xorRows[to * columnWords + w] ^= xorRows[from * columnWords + w];
+        for (size_t w = 0; w < sourceWords; ++w) xorSources[to * sourceWords + w] ^= xorSources[from * sourceWords + w];
+        xorParities[to] ^= xorParities[from];
+        recountXorRow(to);
+    }
+
+    /**
+     * @brief The clause a row implies under the current assignment
+     *
+     * It holds the false literal of every assigned variable of the row and the negated guards of the
+     * constraints summed into it, preceded by implied if the row implies a literal. The two literals
+     * of the highest levels, the implied one first, come first so that they can be watched.
+     */
+    std::vector<Literal> xorReason(size_t row, bool hasImplied, Literal implied) const {
+        std::vector<Literal> literals;
+        if (hasImplied) literals.push_back(implied);
+        for (size_t w = 0; w < columnWords; ++w) {
+            for (uint64_t bits = xorRows[row * columnWords + w] & assignedColumns[w]; bits; bits &= bits - 1) {
+                uint32_t variable = xorColumns[w * 64 + static_cast<size_t>(__builtin_ctzll(bits))];
+                literals.push_back(values[variable] == TRUE_VALUE ? negative(variable) : positive(variable));
+            }
+        }
+        for (size_t w = 0; w < sourceWords; ++w) {
+            for (uint64_t bits = xorSources[row * sourceWords + w]; bits; bits &= bits - 1) {
+                literals.push_back(negate(xorGuards[w * 64 + static_cast<size_t>(__builtin_ctzll(bits))]));
+            }
+        }
+        for (size_t i = hasImplied ? 1 : 0; i < std::min<size_t>(literals.size(), 2); ++i) {
+            size_t highest = i;
+            for (size_t k = i + 1; k < literals.size(); ++k) {
+                if (levels[variableOf(literals[k])] > levels[variableOf(literals[highest])]) highest = k;
+            }
+            std::swap(literals[i], literals[highest]);
+        }
+        return literals;
+    }
+
+    /**
+     * @brief Stores a clause implied by the XOR constraints for conflict analysis.
+     *
+     * It is not watched, since the matrix propagates it, and it is released once its variable is
+     * unassigned, or after analysis if it is the conflict, so reasons do not pile up in the database.
+     */
+    uint32_t storeXorReason(std::vector<Literal> literals) {
+        uint32_t index = allocateClause(std::move(literals), false);
+        clauses[index].temporary = true;
+        return index;
+    }
+
+    /**
+     * @brief Stores the reason of a literal implied by a row without expanding it.
+     *
+     * Most implied literals never take part in conflict analysis, so only the assigned columns and
+     * the sources of the row are copied; expandXorReason() turns them into the clause when needed.
+     */
+    uint32_t storeLazyXorReason(size_t row, Literal implied) {
+        uint32_t index = storeXorReason({implied});
+        std::vector<uint64_t>& snapshot = clauses[index].xorSnapshot;
+        snapshot.resize(columnWords + sourceWords);
+        for (size_t w = 0; w < columnWords; ++w) snapshot[w] = xorRows[row * columnWords + w] & assignedColumns[w];
+        std::copy_n(xorSources.begin() + static_cast<std::ptrdiff_t>(row * sourceWords), sourceWords,
+                    snapshot.begin() + static_cast<std::ptrdiff_t>(columnWords));
+        return index;
+    }
+
+    /**
+     * @brief Expands a reason stored by storeLazyXorReason() into its clause; other clauses are left as they are
+     */
+    void expandXorReason(uint32_t index) {
+        Clause& clause = clauses[index];
+        if (clause.xorSnapshot.empty()) return;
+        // The columns were assigned before the implied literal, so they still hold the same values
+        for (size_t w = 0; w < clause.xorSnapshot.size(); ++w) {
+            for (uint64_t bits = clause.xorSnapshot[w]; bits; bits &= bits - 1) {
+                size_t bit = static_cast<size_t>(__builtin_ctzll(bits));
+                if (w < columnWords) {
+                    uint32_t variable = xorColumns[w * 64 + bit];
+                    clause.literals.push_back(values[variable] == TRUE_VALUE ? negative(variable) : positive(variable));
+                } else {
+                    clause.literals.push_back(negate(xorGuards[(w - columnWords) * 64 + bit]));
+                }
+            }
+        }
+        clause.xorSnapshot.clear();
+    }
+
+    /**
+     * @brief Propagates the enabled XOR constraints by Gauss-Jordan elimination.
+     *
+     * Rows whose pivot has been assigned first move it to an unassigned column of theirs and eliminate
+     * that column from every other row. Then a row with no unassigned column is checked and a row with
+     * one implies it. With every pivot unassigned, no sum of rows can cancel a pivot, so every unit and
+     * conflict that follows from the constraints shows up in a single row.
+     *
+     * @param progress Set if a literal was implied.
+     * @return A conflicting clause, or NO_CLAUSE. The search may have backtracked to the highest level of
+     *         the conflict, or to level 0 to learn a unit; inconsistent is set if the constraints cannot hold.
+     */
+    uint32_t propagateXors(bool& progress) {
+        const size_t rows = xorPivots.size();
+        xorDirty = false;
+        auto firstUnassigned = [&](size_t row, size_t& column) {
+            for (size_t w = 0; w < columnWords; ++w) {
+                uint64_t open = xorRows[row * columnWords + w] & ~assignedColumns[w];
+                if (open) {
+                    column = w * 64 + static_cast<size_t>(__builtin_ctzll(open));
+                    return true;
+                }
+            }
+            return false;
+        };
+
+        for (size_t r = 0; r < rows; ++r) {
+            int64_t pivot = xorPivots[r];
+            if (xorOpen[r] == 0 || (pivot >= 0 && !((assignedColumns[pivot / 64] >> (pivot % 64)) & 1))) continue;
+            size_t column;
+            if (!firstUnassigned(r, column)) continue;
+            xorPivots[r] = static_cast<int64_t>(column);
+            for (size_t s = 0; s < rows; ++s) {
+                if (s != r && xorBit(s, column)) addXorRow(r, s);
+            }
+        }
+
+        for (size_t r = 0; r < rows; ++r) {
+            if (xorOpen[r] > 1) continue;
+            uint8_t sum = xorParities[r] ^ xorAssignedParity[r]; // Required sum of the unassigned columns
+            size_t column;
+            if (firstUnassigned(r, column)) {
+                uint32_t variable = xorColumns[column];
+                Literal implied = sum ? positive(variable) : negative(variable);
+                progress = true;
+                bool alone = true; // The row forces the literal on its own
+                for (size_t w = 0; w < columnWords && alone; ++w) alone = !(xorRows[r * columnWords + w] & assignedColumns[w]);
+                for (size_t w = 0; w < sourceWords && alone; ++w) alone = !xorSources[r * sourceWords + w];
+                if (alone) {
+                    backtrack(0);
+                    assign(implied, NO_CLAUSE);
+                    return NO_CLAUSE;
+                }
+                assign(implied, storeLazyXorReason(r, implied));
+                continue;
+            }
+            if (sum == 0) continue;
+            std::vector<Literal> conflict = xorReason(r, false, 0);
+            if (conflict.empty()) {
+                inconsistent = true;
+                return NO_CLAUSE;
+            }
+            if (conflict.size() == 1) {
+                backtrack(0);
+                assign(conflict[0], NO_CLAUSE);
+                progress = true;
+                return NO_CLAUSE;
+            }
+            uint32_t level = levels[variableOf(conflict[0])];
+            if (level < decisionLevel()) backtrack(level);
+            return storeXorReason(std::move(conflict));
+        }
+        return NO_CLAUSE;
+    }
+
+    /**
+     * @brief Runs CDCL search until a result or the conflict budget of this restart is reached
+     */
+    Result search(uint64_t budget, const std::vector<Literal>& assumptions, uint64_t& conflictsLeft) {
+        std::vector<Literal> learnt;
+        uint64_t conflicts = 0;
+        while (true) {
+            uint32_t conflict = propagate();
+            if (conflict == NO_CLAUSE && xorDirty && !xorPivots.empty() && decisionLevel() >= assumptions.size()) {
+                // The guards of the XOR constraints are assumptions, so their reasons hold once all are made
+                bool progress = false;
+                conflict = propagateXors(progress);
+                if (inconsistent) return Result::UNSATISFIABLE;
+                if (conflict == NO_CLAUSE && progress) continue;
+            }
+            if (conflict != NO_CLAUSE) {
+                if ((++stats.conflicts & 255) == 0) timeBudget->check();
+                ++conflicts;
+                if (conflictsLeft > 0) --conflictsLeft;
+                if (decisionLevel() == 0) {
+                    inconsistent = true;
+                    return Result::UNSATISFIABLE;
+                }
+                uint32_t level = analyze(conflict, learnt);
+                backtrack(level);
+                if (clauses[conflict].temporary) releaseClause(conflict);
+                if (learnt.size() == 1) {
+                    assign(learnt[0], NO_CLAUSE);
+                } else {
+                    uint32_t lbd = computeLbd(learnt);
+                    uint32_t index = storeClause(learnt, true);
+                    clauses[index].lbd = lbd;
+                    bumpClause(clauses[index]);
+                    ++learntCount;
+                    ++stats.learntClauses;
+                    assign(clauses[index].literals[0], index);
+                }
+                variableIncrement /= 0.95;
+                clauseIncrement /= 0.999;
+                continue;
+            }
+
+            if (conflicts >= budget || conflictsLeft == 0) {
+                backtrack(0);
+                return Result::UNKNOWN;
+            }
+            if (learntCount >= maxLearnts + trail.size()) {
+                reduceLearnts();
+                maxLearnts *= 1.1;
+            }
+
+            // Assumptions are decided first, one per decision level
+            bool decided = false;
+            while (decisionLevel() < assumptions.size()) {
+                Literal assumption = assumptions[decisionLevel()];
+                uint8_t value = valueOf(assumption);
+                if (value == TRUE_VALUE) {
+                    trailLimits.push_back(trail.size()); // Already holds, keep levels aligned
+                } else if (value == FALSE_VALUE) {
+                    return Result::UNSATISFIABLE;
+                } else {
+                    trailLimits.push_back(trail.size());
+                    assign(assumption, NO_CLAUSE);
+                    decided = true;
+                    break;
+                }
+            }
+            if (decided) continue;
+
+            // Branch on the most active unassigned variable
+            uint32_t next = NO_CLAUSE;
+            while (!heap.empty()) {
+                uint32_t variable = heapPop();
+                if (values[variable] == UNASSIGNED) {
+                    next = variable;
+                    break;
+                }
+            }
+            if (next == NO_CLAUSE) {
+                model = values;
+                return Result::SATISFIABLE;
+            }
+            if ((++stats.decisions & 1023) == 0) timeBudget->check();
+            trailLimits.push_back(trail.size());
+            assign(savedPhases[next] == TRUE_VALUE ? positive(next) : negative(next), NO_CLAUSE);
+        }
+    }
+
+public:
+    /**
+     * @brief Adds a new variable and returns its index
+     */
+    uint32_t newVariable() {
+        uint32_t variable = static_cast<uint32_t>(values.size());
+        values.push_back(UNASSIGNED);
+        levels.push_back(0);
+        reasons.push_back(NO_CLAUSE);
+        savedPhases.push_back(FALSE_VALUE);
+        activities.push_back(0);
+        seen.push_back(0);
+        heapIndex.push_back(-1);
+        watches.emplace_back();
+        watches.emplace_back();
+        heapInsert(variable);
+        return variable;
+    }
+
+    size_t variableCount() const {
+        return values.size();
+    }
+
+    size_t clauseCount() const {
+        return clauses.size() - freeClauses.size() - learntCount;
+    }
+
+    /**
+     * @brief Adds a clause to the problem
+     * @return False if the problem became unsatisfiable.
+     */
+    bool addClause(std::vector<Literal> literals) {
+        if (inconsistent) return false;
+        backtrack(0);
+
+        // Remove duplicates and literals false at level 0; skip tautologies and satisfied clauses
+        std::sort(literals.begin(), literals.end());
+        size_t keep = 0;
+        for (size_t i = 0; i < literals.size(); ++i) {
+            Literal literal = literals[i];
+            if (i + 1 < literals.size() && literals[i + 1] == negate(literal)) return true;
+            if (valueOf(literal) == TRUE_VALUE) return true;
+            if (valueOf(literal) == FALSE_VALUE || (keep > 0 && literals[keep - 1] == literal)) continue;
+            literals[keep++] = literal;
+        }
+        literals.resize(keep);
+
+        if (literals.empty()) {
+            inconsistent = true;
+            return false;
+        }
+        if (literals.size() == 1) {
+            assign(literals[0], NO_CLAUSE);
+            if (propagate() != NO_CLAUSE) inconsistent = true;
+            return !inconsistent;
+        }
+        storeClause(std::move(literals), false);
+        return true;
+    }
+
+    /**
+     * @brief Adds an XOR constraint that holds in the calls to solve() assuming its guard.
+     *
+     * The constraints of a call are propagated together by Gauss-Jordan elimination, which decides
+     * systems of them that defeat clause learning. Every clause derived from them includes the negated
+     * guards, so it stays valid in calls without them.
+     *
+     * @param variables Variables whose values must sum to parity; a repeated variable cancels.
+     * @param parity The required sum modulo 2.
+     * @param guard Assumption literal enabling the constraint.
+     */
+    void addXor(std::vector<uint32_t> variables, bool parity, Literal guard) {
+        xors.push_back({std::move(variables), parity, guard});
+    }
+
+    /**
+     * @brief Limits the number of conflicts of each call to solve(); it then returns UNKNOWN
+     */
+    void setConflictLimit(uint64_t limit) {
+        conflictLimit = limit;
+    }
+
+    /**
+     * @brief Makes solve() throw Budget::Exceeded once the time limit has passed; the budget must outlive the solver
+     */
+    void setBudget(const Budget& limit) {
+        timeBudget = &limit;
+    }
+
+    /**
+     * @brief Searches for an assignment satisfying all clauses and assumptions
+     * @param assumptions Literals that must hold in this call only.
+     */
+    Result solve(const std::vector<Literal>& assumptions = {}) {
+        if (inconsistent) return Result::UNSATISFIABLE;
+        model.clear();
+        buildXorMatrix(assumptions);
+        maxLearnts = std::max(clauseCount() / 3.0, 2000.0);
+        uint64_t conflictsLeft = conflictLimit;
+
+        Result result = Result::UNKNOWN;
+        for (uint64_t restart = 0; result == Result::UNKNOWN; ++restart) {
+            result = search(static_cast<uint64_t>(luby(2, restart) * 100), assumptions, conflictsLeft);
+            if (result == Result::UNKNOWN) {
+                ++stats.restarts;
+                if (conflictsLeft == 0) break;
+            }
+        }
+        backtrack(0);
+        return result;
+    }
+
+    /**
+     * @brief Value of a variable in the model found by the last successful solve()
+     */
+    bool modelValue(uint32_t variable) const {
+        return model[variable] == TRUE_VALUE;
+    }
+
+    const Statistics& statistics() const {
+        return stats;
+    }
+};
+
+/**
+ * @struct CnfFormula
+ * @brief A plain clause list, for consumers of CNF that are not the SAT solver.
+ *
+ * It has the newVariable/addClause interface of SatSolver, so TseitinEncoder can write into either.
+ */
+struct CnfFormula {
+    typedef SatSolver::Literal Literal;
+
+    size_t variableCount = 0;
+    std::vector<std::vector<Literal>> clauses;
+
+    uint32_t newVariable() { return static_cast<uint32_t>(variableCount++); }
+
+    bool addClause(std::vector<Literal> literals) {
+        clauses.push_back(std::move(literals));
+        return true;
+    }
+};
+
+/**
+ * @class TseitinEncoder
+ * @brief Encodes compiled expressions into CNF clauses of a SatSolver or a CnfFormula.
+ *
+ * Variable slot j of the expressions is solver variable j. Every AND, OR, IMPLIES and BICONDITIONAL
+ * node gets a fresh variable constrained to be equivalent to the node, so each assignment of the
+ * slots extends to exactly one model of the definitions. NOT is folded into the literal and identical
+ * nodes are encoded only once.
+ */
+template <typename Target = SatSolver>
+class TseitinEncoder {
+private:
+    typedef SatSolver::Literal Literal;
+
+    Target& solver;
+    std::unordered_map<uint64_t, Literal> andNodes; // (a, b) -> literal of a & b
+    std::unordered_map<uint64_t, Literal> orNodes; // (a, b) -> literal of a | b
+    std::unordered_map<uint64_t, Literal> iffNodes; // (a, b) -> literal of a <-> b
+    Literal trueLiteral = 0; // Literal fixed to true for constants, created on first use
+    bool hasTrueLiteral = false;
+
+    Literal encodeConstant(bool value) {
+        if (!hasTrueLiteral) {
+            trueLiteral = SatSolver::positive(solver.newVariable());
+            solver.addClause({trueLiteral});
+            hasTrueLiteral = true;
+        }
+        return value ? trueLiteral : SatSolver::negate(trueLiteral);
+    }
+
+    static uint64_t key(Literal a, Literal b) {
+        if (a > b) std::swap(a, b); // All three operators are commutative
+        return (uint64_t{a} << 32) | b;
+    }
+
+    Literal encodeAnd(Literal a, Literal b) {
+        auto found = andNodes.find(key(a, b));
+        if (found != andNodes.end()) return found->second;
+        Literal x = SatSolver::positive(solver.newVariable());
+        solver.addClause({SatSolver::negate(x), a});
+        solver.addClause({SatSolver::negate(x), b});
+        solver.addClause({x, SatSolver::negate(a), SatSolver::negate(b)});
+        return andNodes[key(a, b)] = x;
+    }
+
+    Literal encodeOr(Literal a, Literal b) {
+        auto found = orNodes.find(key(a, b));
+        if (found != orNodes.end()) return found->second;
+        Literal x = SatSolver::positive(solver.newVariable());
+        solver.addClause({x, SatSolver::negate(a)});
+        solver.addClause({x, SatSolver::negate(b)});
+        solver.addClause({SatSolver::negate(x), a, b});
+        return orNodes[key(a, b)] = x;
+    }
+
+    Literal encodeIff(Literal a, Literal b) {
+        auto found = iffNodes.find(key(a, b));
+        if (found != iffNodes.end()) return found->second;
+        Literal x = SatSolver::positive(solver.newVariable());
+        solver.addClause({SatSolver::negate(x), SatSolver::negate(a), b});
+        solver.addClause({SatSolver::negate(x), a, SatSolver::negate(b)});
+        solver.addClause({x, a, b});
+        solver.addClause({x, SatSolver::negate(a), SatSolver::negate(b)});
+        return iffNodes[key(a, b)] = x;
+    }
+
+public:
+    /**
+     * @brief Constructor, creates one solver variable per variable slot
+     * @param s The solver or formula to add the clauses to; it must not have any variables yet.
+     * @param variableCount Number of variable slots of the expressions.
+     */
+    TseitinEncoder(Target& s, size_t variableCount) : solver(s) {
+        for (size_t i = 0; i < variableCount; ++i) {
+            solver.newVariable();
+        }
+    }
+
+    /**
+     * @brief Adds the clauses that make an expression true.
+     *
+     * A disjunction of literals, such as a clause read from a DIMACS file, is added as it is. Anything
+     * else is encoded and its literal asserted.
+     */
+    void assertExpression(const CompiledExpression& expression) {
+        std::vector<Literal> clause;
+        bool lastWasLiteral = false; // NOT is only part of a clause when it negates a variable
+        for (const auto& ins : expression.code) {
+            if (ins.op == CompiledExpression::OpCode::LOAD) {
+                clause.push_back(SatSolver::positive(ins.slot));
+                lastWasLiteral = true;
+            } else if (ins.op == CompiledExpression::OpCode::NOT && lastWasLiteral) {
+                clause.back() = SatSolver::negate(clause.back());
+            } else if (ins.op == CompiledExpression::OpCode::OR) {
+                lastWasLiteral = false;
+            } else {
+                solver.addClause({encode(expression)});
+                return;
+            }
+        }
+        solver.addClause(clause);
+    }
+
+    /**
+     * @brief Encodes an expression
+     * @return A literal that is true exactly when the expression is true.
+     */
+    Literal encode(const CompiledExpression& expression) {
+        std::vector<Literal> stack;
+        stack.reserve(expression.maxStackDepth);
+        for (const auto& ins : expression.code) {
+            if (ins.op == CompiledExpression::OpCode::LOAD) {
+                stack.push_back(SatSolver::positive(ins.slot));
+                continue;
+            }
+            if (ins.op == CompiledExpression::OpCode::CONSTANT) {
+                stack.push_back(encodeConstant(ins.slot != 0));
+                continue;
+            }
+            if (ins.op == CompiledExpression::OpCode::NOT) {
+                stack.back() = SatSolver::negate(stack.back());
+                continue;
+            }
+            Literal b = stack.back();
+            stack.pop_back();
+            Literal a = stack.back();
+            switch (ins.op) {
+            case CompiledExpression::OpCode::AND:     stack.back() = encodeAnd(a, b); break;
+            case CompiledExpression::OpCode::OR:      stack.back() = encodeOr(a, b); break;
+            case CompiledExpression::OpCode::IMPLIES: stack.back() = encodeOr(SatSolver::negate(a), b); break;
+            default:                                  stack.back() = encodeIff(a, b); break;
+            }
+        }
+        return stack.back();
+    }
+};
+
+#endif // LOGIC_SAT_SOLVER_HPP
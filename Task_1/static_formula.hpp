@@ -0,0 +1,363 @@
+/**
+ * @file static_formula.hpp
+ * @brief Header-only evaluator for logical formulas that are fixed at compile time.
+ *
+ * The formula string is parsed by a constexpr parser while the program is compiled, with the same
+ * syntax, precedences and left associativity as ExpressionCompiler in expression.hpp (~, &, |, ->, <-> and
+ * parentheses; variables are identifiers such as p or door_open_3). The parsed tree is expanded by
+ * templates into straight-line code, so evaluating a hard-coded formula costs no parsing, no
+ * allocation and no branches. A malformed formula is a compile error.
+ *
+ * C++20:
+ *     using Policy = logic::Formula<"(admin | owner) & ~locked">;
+ *     bool allowed = Policy::evaluate({true, false, false});          // admin, locked, owner
+ *
+ * C++17:
+ *     LOGIC_STATIC_FORMULA(Policy, "(admin | owner) & ~locked");
+ *     uint64_t allowed64 = Policy::evaluate64({adminMask, lockedMask, ownerMask});
+ *
+ * Variables are numbered alphabetically, like the truth table columns of the analyzer.
+ */
+
+#ifndef LOGIC_STATIC_FORMULA_HPP
+#define LOGIC_STATIC_FORMULA_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string_view>
+#include <type_traits>
+
+#ifndef LOGIC_ALWAYS_INLINE
+#if defined(__GNUC__)
+#define LOGIC_ALWAYS_INLINE inline __attribute__((always_inline))
+#elif defined(_MSC_VER)
+#define LOGIC_ALWAYS_INLINE __forceinline
+#else
+#define LOGIC_ALWAYS_INLINE inline
+#endif
+#endif
+
+namespace logic {
+
+namespace detail {
+
+enum class Op : uint8_t {
+    VARIABLE,
+    NOT,
+    AND,
+    OR,
+    IMPLIES,
+    BICONDITIONAL
+};
+
+/**
+ * @brief A node of the parsed formula; VARIABLE keeps the variable index in left
+ */
+struct Node {
+    Op op = Op::VARIABLE;
+    size_t left = 0;
+    size_t right = 0;
+};
+
+/**
+ * @brief Reports a malformed formula.
+ *
+ * Throwing during constant evaluation is not a constant expression, so the compiler stops with an
+ * error whose notes point at the failing call and its message.
+ */
+[[noreturn]] inline void fail(const char* message) {
+    throw std::invalid_argument(message);
+}
+
+constexpr bool isSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f' || c == '\v';
+}
+
+constexpr bool isIdentifierStart(char c) {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_';
+}
+
+constexpr bool isIdentifierChar(char c) {
+    return isIdentifierStart(c) || (c >= '0' && c <= '9');
+}
+
+/**
+ * @brief A parsed formula with room for Capacity nodes and variables
+ */
+template <size_t Capacity>
+struct ParsedFormula {
+    std::array<Node, Capacity> nodes{};
+    size_t nodeCount = 0;
+    size_t root = 0;
+    std::array<std::string_view, Capacity> variables{}; // Sorted by name
+    size_t variableCount = 0;
+};
+
+/**
+ * @brief Constexpr recursive-descent parser.
+ *
+ * One level per binary operator, from <-> (lowest) to & (highest), each left associative, and a
+ * prefix ~ binding tighter than all of them, which is what the shunting-yard compiler of the
+ * analyzer produces.
+ */
+template <size_t Capacity>
+class Parser {
+private:
+    std::string_view text;
+    size_t pos = 0;
+    ParsedFormula<Capacity> result;
+
+    constexpr void skipSpace() {
+        while (pos < text.size() && isSpace(text[pos])) ++pos;
+    }
+
+    constexpr std::string_view identifierAt(size_t start) const {
+        size_t end = start;
+        while (end < text.size() && isIdentifierChar(text[end])) ++end;
+        return text.substr(start, end - start);
+    }
+
+    /**
+     * @brief Collects the distinct variable names and sorts them
+     */
+    constexpr void collectVariables() {
+        for (size_t i = 0; i < text.size();) {
+            if (!isIdentifierStart(text[i])) {
+                ++i;
+                continue;
+            }
+            std::string_view name = identifierAt(i);
+            i += name.size();
+            bool seen = false;
+            for (size_t v = 0; v < result.variableCount; ++v) seen = seen || result.variables[v] == name;
+            if (!seen) result.variables[result.variableCount++] = name;
+        }
+        for (size_t i = 1; i < result.variableCount; ++i) { // Insertion sort, formulas have few variables
+            std::string_view name = result.variables[i];
+            size_t j = i;
+            for (; j > 0 && name < result.variables[j - 1]; --j) result.variables[j] = result.variables[j - 1];
+            result.variables[j] = name;
+        }
+    }
+
+    constexpr size_t addNode(Op op, size_t left, size_t right) {
+        result.nodes[result.nodeCount] = Node{op, left, right};
+        return result.nodeCount++;
+    }
+
+    /**
+     * @brief Matches the operator of a precedence level, 0 is <-> and 3 is &
+     */
+    constexpr bool matchOperator(int level) {
+        skipSpace();
+        std::string_view rest = text.substr(pos);
+        constexpr std::string_view symbols[] = {"<->", "->", "|", "&"};
+        if (rest.substr(0, symbols[level].size()) != symbols[level]) return false;
+        pos += symbols[level].size();
+        return true;
+    }
+
+    constexpr size_t parseBinary(int level) {
+        if (level == 4) return parseUnary();
+        constexpr Op ops[] = {Op::BICONDITIONAL, Op::IMPLIES, Op::OR, Op::AND};
+        size_t left = parseBinary(level + 1);
+        while (matchOperator(level)) {
+            size_t right = parseBinary(level + 1);
+            left = addNode(ops[level], left, right);
+        }
+        return left;
+    }
+
+    constexpr size_t parseUnary() {
+        skipSpace();
+        if (pos >= text.size()) fail("Missing operand");
+        char c = text[pos];
+        if (c == '~') {
+            ++pos;
+            size_t operand = parseUnary();
+            return addNode(Op::NOT, operand, 0);
+        }
+        if (c == '(') {
+            ++pos;
+            size_t inner = parseBinary(0);
+            skipSpace();
+            if (pos >= text.size() || text[pos] != ')') fail("Unmatched '('");
+            ++pos;
+            return inner;
+        }
+        if (isIdentifierStart(c)) {
+            std::string_view name = identifierAt(pos);
+            pos += name.size();
+            size_t index = 0;
+            while (result.variables[index] != name) ++index;
+            return addNode(Op::VARIABLE, index, 0);
+        }
+        if (c == ')') fail("Missing operand before ')'");
+        if (c == '&' || c == '|' || c == '-' || c == '<') fail("Missing operand before operator");
+        fail("Invalid token");
+    }
+
+public:
+    constexpr explicit Parser(std::string_view formula) : text(formula) {}
+
+    constexpr ParsedFormula<Capacity> parse() {
+        collectVariables();
+        result.root = parseBinary(0);
+        skipSpace();
+        if (pos < text.size()) {
+            if (text[pos] == ')') fail("Unmatched ')'");
+            fail("Missing operator");
+        }
+        return result;
+    }
+};
+
+/**
+ * @brief Bitwise NOT for words, logical NOT for bool
+ */
+template <typename Word>
+constexpr LOGIC_ALWAYS_INLINE Word negate(Word value) {
+    if constexpr (std::is_same_v<Word, bool>) {
+        return !value;
+    } else {
+        return static_cast<Word>(~value);
+    }
+}
+
+} // namespace detail
+
+/**
+ * @class StaticFormula
+ * @brief A formula parsed at compile time and evaluated by generated straight-line code.
+ *
+ * @tparam Source A type with a member `static constexpr std::string_view text` holding the formula.
+ */
+template <typename Source>
+class StaticFormula {
+private:
+    static constexpr auto parsed = detail::Parser<Source::text.size() + 1>(Source::text).parse();
+
+    /**
+     * @brief Evaluates node Index; every operator is a bitwise operation, so bool evaluation has no branches
+     */
+    template <size_t Index, typename Word>
+    static constexpr LOGIC_ALWAYS_INLINE Word evaluateNode(const Word* values) {
+        constexpr detail::Node node = parsed.nodes[Index];
+        if constexpr (node.op == detail::Op::VARIABLE) {
+            return values[node.left];
+        } else if constexpr (node.op == detail::Op::NOT) {
+            return detail::negate<Word>(evaluateNode<node.left>(values));
+        } else {
+            Word a = evaluateNode<node.left>(values);
+            Word b = evaluateNode<node.right>(values);
+            if constexpr (node.op == detail::Op::AND) {
+                return static_cast<Word>(a & b);
+            } else if constexpr (node.op == detail::Op::OR) {
+                return static_cast<Word>(a | b);
+            } else if constexpr (node.op == detail::Op::IMPLIES) {
+                return static_cast<Word>(detail::negate<Word>(a) | b);
+            } else {
+                return detail::negate<Word>(static_cast<Word>(a ^ b));
+            }
+        }
+    }
+
+public:
+    /**
+     * @brief Always true; naming it in a constant expression forces the formula to be parsed
+     */
+    static constexpr bool wellFormed = parsed.nodeCount > 0;
+
+    static constexpr size_t variableCount = parsed.variableCount;
+
+    /**
+     * @brief Variable names in evaluation order, sorted alphabetically
+     */
+    static constexpr std::array<std::string_view, variableCount> variables = [] {
+        std::array<std::string_view, variableCount> names{};
+        for (size_t i = 0; i < variableCount; ++i) names[i] = parsed.variables[i];
+        return names;
+    }();
+
+    /**
+     * @brief Index of a variable in the evaluation order, or -1 if the formula does not use it
+     */
+    static constexpr int variableIndex(std::string_view name) {
+        for (size_t i = 0; i < variableCount; ++i) {
+            if (variables[i] == name) return static_cast<int>(i);
+        }
+        return -1;
+    }
+
+    /**
+     * @brief Evaluates one assignment
+     * @param values Value of each variable, in the order of variables.
+     */
+    static constexpr bool evaluate(const std::array<bool, variableCount>& values) {
+        return evaluateNode<parsed.root, bool>(values.data());
+    }
+
+    /**
+     * @brief Evaluates one assignment given as a truth table row: bit j is the value of variable j
+     */
+    static constexpr bool evaluate(uint64_t row) {
+        std::array<bool, variableCount> values{};
+        for (size_t j = 0; j < variableCount; ++j) values[j] = ((row >> j) & 1) != 0;
+        return evaluate(values);
+    }
+
+    /**
+     * @brief Evaluates 64 assignments at once
+     * @param masks Per variable, bit k is its value in assignment k.
+     * @return Bit k is the value of the formula for assignment k.
+     */
+    static constexpr uint64_t evaluate64(const std::array<uint64_t, variableCount>& masks) {
+        return evaluateNode<parsed.root, uint64_t>(masks.data());
+    }
+};
+
+#if __cplusplus >= 202002L
+/**
+ * @brief A string literal usable as a template argument
+ */
+template <size_t N>
+struct FixedString {
+    char data[N] = {};
+
+    constexpr FixedString(const char (&text)[N]) {
+        for (size_t i = 0; i < N; ++i) data[i] = text[i];
+    }
+
+    constexpr std::string_view view() const { return std::string_view(data, N - 1); }
+};
+
+template <FixedString Text>
+struct LiteralSource {
+    static constexpr std::string_view text = Text.view();
+};
+
+/**
+ * @brief A formula given directly as a template argument, e.g. logic::Formula<"p -> q">
+ */
+template <FixedString Text>
+using Formula = StaticFormula<LiteralSource<Text>>;
+#endif
+
+} // namespace logic
+
+/**
+ * @brief Declares Name as the StaticFormula of a string literal, for C++17
+ *
+ * The formula is parsed at the declaration, so a malformed one fails the build even if it is never used.
+ */
+#define LOGIC_STATIC_FORMULA(Name, formula)                                    \
+    struct Name##Source {                                                      \
+        static constexpr std::string_view text = formula;                      \
+    };                                                                         \
+    static_assert(::logic::StaticFormula<Name##Source>::wellFormed,            \
+                  "LOGIC_STATIC_FORMULA: malformed formula " formula);         \
+    using Name = ::logic::StaticFormula<Name##Source>
+
+#endif // LOGIC_STATIC_FORMULA_HPP
@@ -0,0 +1,319 @@
+/**
+ * @file table_sink.hpp
+ * @brief Buffered output and the sinks that write truth table rows as color, text, CSV or binary.
+ */
+
+#ifndef LOGIC_TABLE_SINK_HPP
+#define LOGIC_TABLE_SINK_HPP
+
+#include "common.hpp"
+
+/**
+ * @class OutputBuffer
+ * @brief Writes to a FILE through a large reusable buffer, so rows cost a memcpy rather than a stream call.
+ */
+class OutputBuffer {
+private:
+    FILE* file;
+    std::vector<char> buffer;
+    size_t used = 0;
+
+public:
+    explicit OutputBuffer(FILE* f, size_t capacity = size_t{1} << 20) : file(f), buffer(capacity) {}
+
+    ~OutputBuffer() {
+        flush();
+    }
+
+    OutputBuffer(const OutputBuffer&) = delete;
+    OutputBuffer& operator=(const OutputBuffer&) = delete;
+
+    void write(const char* data, size_t size) {
+        if (used + size > buffer.size()) {
+            flush();
+            if (size > buffer.size()) {
+                std::fwrite(data, 1, size, file);
+                return;
+            }
+        }
+        std::memcpy(buffer.data() + used, data, size);
+        used += size;
+    }
+
+    void write(const std::string& text) {
+        write(text.data(), text.size());
+    }
+
+    void put(char c) {
+        if (used == buffer.size()) flush();
+        buffer[used++] = c;
+    }
+
+    /**
+     * @brief Writes text right-aligned in a field of the given width, like std::setw
+     */
+    void padded(const std::string& text, size_t width) {
+        for (size_t i = text.size(); i < width; ++i) put(' ');
+        write(text);
+    }
+
+    void flush() {
+        if (used) {
+            std::fwrite(buffer.data(), 1, used, file);
+            used = 0;
+        }
+        std::fflush(file);
+    }
+};
+
+/**
+ * @class TableSink
+ * @brief Destination of the rows of a truth table.
+ *
+ * Rows arrive one word at a time: bit r of every word belongs to row word * 64 + r, and variable j of
+ * that row is bit j of the row number. Sinks that only want critical rows skip the others themselves.
+ */
+class TableSink {
+public:
+    virtual ~TableSink() = default;
+
+    /**
+     * @brief Called once before the first word
+     * @param variableNames Names of the variable columns.
+     * @param premiseCount Number of premise columns.
+     * @param rowCount Number of rows in the table.
+     */
+    virtual void begin(const std::vector<std::string>& variableNames, size_t premiseCount, uint64_t rowCount) = 0;
+
+    /**
+     * @brief Receives 64 rows
+     * @param word Index of the word.
+     * @param rowMask Bits of the word that are rows of the table.
+     * @param premiseWords One result word per premise.
+     * @param conclusionWord Result word of the conclusion.
+     * @param criticalWord Rows where all premises are true.
+     */
+    virtual void writeWord(uint64_t word, uint64_t rowMask, const uint64_t* premiseWords,
+                           uint64_t conclusionWord, uint64_t criticalWord) = 0;
+
+    /**
+     * @brief Called once after the last word
+     */
+    virtual void end() = 0;
+};
+
+/**
+ * @class ConsoleTableSink
+ * @brief The interactive colored table, the default sink.
+ */
+class ConsoleTableSink : public TableSink {
+private:
+    OutputBuffer out;
+    size_t variableCount = 0;
+    size_t premiseCount = 0;
+    bool criticalOnly;
+
+    // Formatted cells for false [0] and true [1], built once
+    std::string variableCells[2];
+    std::string premiseCells[2];
+    std::string conclusionCells[2];
+    const std::string criticalMarker = Colors::BLUE + " <== Critical Row" + Colors::RESET;
+
+public:
+    explicit ConsoleTableSink(FILE* file = stdout, bool onlyCriticalRows = false)
+        : out(file), criticalOnly(onlyCriticalRows) {
+        for (int value = 0; value < 2; ++value) {
+            const char* letter = value ? "T" : "F";
+            variableCells[value] = Colors::BOLD + std::string(5, ' ') + letter + " " + Colors::RESET;
+            premiseCells[value] = Colors::BOLD + std::string(11, ' ') + letter + " " + Colors::RESET;
+            conclusionCells[value] = (value ? Colors::GREEN : Colors::RED) + Colors::BOLD +
+                                     std::string(11, ' ') + letter + Colors::RESET;
+        }
+    }
+
+    void begin(const std::vector<std::string>& variableNames, size_t premises, uint64_t) override {
+        variableCount = variableNames.size();
+        premiseCount = premises;
+        std::cout.flush(); // Keep the table after anything already printed
+
+        // Print variable columns
+        for (const auto& name : variableNames) {
+            out.write(Colors::BOLD);
+            out.padded(name, 6);
+            out.put(' ');
+            out.write(Colors::RESET);
+        }
+
+        // Print premises and conclusion
+        for (size_t i = 0; i < premiseCount; ++i) {
+            out.write(Colors::BOLD);
+            out.padded("P" + std::to_string(i + 1), 12);
+            out.put(' ');
+            out.write(Colors::RESET);
+        }
+        out.write(Colors::BOLD);
+        out.padded("Conclusion", 12);
+        out.write(Colors::RESET);
+        out.put('\n');
+
+        // Separator line size calculation based on columns and widths of variables, premises, and conclusion
+        out.write(std::string(12 * (variableCount + premiseCount + 1), '-'));
+        out.put('\n');
+    }
+
+    void writeWord(uint64_t word, uint64_t rowMask, const uint64_t* premiseWords,
+                   uint64_t conclusionWord, uint64_t criticalWord) override {
+        uint64_t rows = criticalOnly ? rowMask & criticalWord : rowMask;
+        for (; rows; rows &= rows - 1) {
+            int r = BitOps::countTrailingZeros(rows);
+            uint64_t row = word * 64 + r;
+
+            // Print variable values
+            for (size_t j = 0; j < variableCount; ++j) {
+                out.write(variableCells[(row >> j) & 1]);
+            }
+
+            // Print premise results
+            for (size_t p = 0; p < premiseCount; ++p) {
+                out.write(premiseCells[(premiseWords[p] >> r) & 1]);
+            }
+
+            // Print conclusion with color
+            out.write(conclusionCells[(conclusionWord >> r) & 1]);
+
+            // Mark critical rows
+            if ((criticalWord >> r) & 1) {
+                out.write(criticalMarker);
+            }
+            out.put('\n');
+        }
+    }
+
+    void end() override {
+        out.flush();
+    }
+};
+
+/**
+ * @class TextTableSink
+ * @brief Plain text or CSV rows without colors or padding.
+ *
+ * Text rows are T/F letters separated by spaces, with a trailing '*' on critical rows.
+ * CSV rows are 0/1 values with a final Critical column.
+ */
+class TextTableSink : public TableSink {
+private:
+    OutputBuffer out;
+    size_t variableCount = 0;
+    size_t premiseCount = 0;
+    bool criticalOnly;
+    bool csv;
+    std::string line; // Row being formatted, reused for every row
+
+public:
+    TextTableSink(FILE* file, bool commaSeparated, bool onlyCriticalRows = false)
+        : out(file), criticalOnly(onlyCriticalRows), csv(commaSeparated) {}
+
+    void begin(const std::vector<std::string>& variableNames, size_t premises, uint64_t) override {
+        variableCount = variableNames.size();
+        premiseCount = premises;
+        const char separator = csv ? ',' : ' ';
+        std::string header;
+        for (const auto& name : variableNames) {
+            header += name;
+            header += separator;
+        }
+        for (size_t i = 0; i < premiseCount; ++i) {
+            header += "P" + std::to_string(i + 1);
+            header += separator;
+        }
+        header += csv ? "Conclusion,Critical\n" : "Conclusion\n";
+        out.write(header);
+        line.assign(2 * (variableCount + premiseCount + 2), separator);
+    }
+
+    void writeWord(uint64_t word, uint64_t rowMask, const uint64_t* premiseWords,
+                   uint64_t conclusionWord, uint64_t criticalWord) override {
+        const char isTrue = csv ? '1' : 'T';
+        const char isFalse = csv ? '0' : 'F';
+        uint64_t rows = criticalOnly ? rowMask & criticalWord : rowMask;
+        for (; rows; rows &= rows - 1) {
+            int r = BitOps::countTrailingZeros(rows);
+            uint64_t row = word * 64 + r;
+            size_t at = 0;
+            for (size_t j = 0; j < variableCount; ++j, at += 2) {
+                line[at] = ((row >> j) & 1) ? isTrue : isFalse;
+            }
+            for (size_t p = 0; p < premiseCount; ++p, at += 2) {
+                line[at] = ((premiseWords[p] >> r) & 1) ? isTrue : isFalse;
+            }
+            line[at] = ((conclusionWord >> r) & 1) ? isTrue : isFalse;
+            bool critical = (criticalWord >> r) & 1;
+            if (csv) {
+                line[at + 2] = critical ? '1' : '0';
+                out.write(line.data(), at + 3);
+            } else if (critical) {
+                line[at + 2] = '*';
+                out.write(line.data(), at + 3);
+            } else {
+                out.write(line.data(), at + 1);
+            }
+            out.put('\n');
+        }
+    }
+
+    void end() override {
+        out.flush();
+    }
+};
+
+/**
+ * @class BinaryTableSink
+ * @brief Packed bitset rows, one bit per premise and conclusion per row.
+ *
+ * The file starts with a header: the magic "TTBIN1\0\0", then little-endian uint32 variable count,
+ * uint32 premise count, uint64 row count and uint32 flags (bit 0: critical rows only). It is followed
+ * by one record per 64-row word: the premise words, then the conclusion word, as little-endian uint64s
+ * where bit r is row word * 64 + r and bits past the end of the table are 0. With critical rows only,
+ * each record starts with the word index, only words with a critical row are written and every word is
+ * masked to the critical rows.
+ */
+class BinaryTableSink : public TableSink {
+private:
+    OutputBuffer out;
+    size_t premiseCount = 0;
+    bool criticalOnly;
+
+    void writeLittleEndian(uint64_t value, size_t bytes) {
+        for (size_t i = 0; i < bytes; ++i) out.put(static_cast<char>((value >> (8 * i)) & 0xFF));
+    }
+
+public:
+    BinaryTableSink(FILE* file, bool onlyCriticalRows = false) : out(file), criticalOnly(onlyCriticalRows) {}
+
+    void begin(const std::vector<std::string>& variableNames, size_t premises, uint64_t rowCount) override {
+        premiseCount = premises;
+        out.write("TTBIN1\0\0", 8);
+        writeLittleEndian(variableNames.size(), 4);
+        writeLittleEndian(premiseCount, 4);
+        writeLittleEndian(rowCount, 8);
+        writeLittleEndian(criticalOnly ? 1 : 0, 4);
+    }
+
+    void writeWord(uint64_t word, uint64_t rowMask, const uint64_t* premiseWords,
+                   uint64_t conclusionWord, uint64_t criticalWord) override {
+        uint64_t mask = criticalOnly ? rowMask & criticalWord : rowMask;
+        if (criticalOnly) {
+            if (!mask) return;
+            writeLittleEndian(word, 8);
+        }
+        for (size_t p = 0; p < premiseCount; ++p) writeLittleEndian(premiseWords[p] & mask, 8);
+        writeLittleEndian(conclusionWord & mask, 8);
+    }
+
+    void end() override {
+        out.flush();
+    }
+};
+
+#endif // LOGIC_TABLE_SINK_HPP
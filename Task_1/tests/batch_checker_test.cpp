@@ -0,0 +1,221 @@
+/**
+ * @file batch_checker_test.cpp
+ * @brief Tests of the batch checker: framing, result order, error lines, limits and arena reuse.
+ *
+ * Input is written to a temporary file and checked on a pool of several workers, so results are
+ * produced out of order and have to be put back in input order, also across read blocks. The
+ * allocation count of the whole run must not grow with the number of records.
+ */
+
+#include <cstdio>
+
+#include "allocation_counter.hpp"
+#include "batch_checker.hpp"
+
+namespace {
+
+/**
+ * @brief A record and the result line it has to get, without its number
+ */
+struct Case {
+    std::string record;
+    std::string result;
+};
+
+const std::vector<Case> CASES = {
+    {"p -> q; p => q", "valid satisfiable 1"},
+    {"p | q => p", "invalid satisfiable 3 counterexample=p:0,q:1"},
+    {"a & ~a => b", "valid unsatisfiable 0"},
+    {"x | y", "valid satisfiable 3"},
+    {"door_open -> Light; ~Light => ~door_open", "valid satisfiable 1"},
+    {"  (r <-> s) ; s | t  =>  r  ", "invalid satisfiable 3 counterexample=r:0,s:0,t:1"},
+};
+
+int failures = 0;
+
+void fail(const std::string& test, const std::string& message) {
+    std::cerr << test << ": " << message << "\n";
+    ++failures;
+}
+
+/**
+ * @brief Runs the checker on the input and returns its output lines
+ * @param runAllocations If given, receives the number of allocations made while the checker ran.
+ */
+std::vector<std::string> check(const std::string& input, BatchChecker::Framing framing, WorkStealingPool& pool,
+                               uint64_t* runAllocations = nullptr) {
+    std::FILE* in = std::tmpfile();
+    std::FILE* out = std::tmpfile();
+    if (!in || !out) throw std::runtime_error("Cannot create a temporary file");
+    std::fwrite(input.data(), 1, input.size(), in);
+    std::rewind(in);
+    try {
+        uint64_t before = allocationCount;
+        BatchChecker(framing, pool).run(in, out);
+        if (runAllocations) *runAllocations = allocationCount - before;
+    } catch (...) {
+        std::fclose(in);
+        std::fclose(out);
+        throw;
+    }
+
+    std::string bytes(static_cast<size_t>(std::ftell(out)), '\0');
+    std::rewind(out);
+    bytes.resize(std::fread(&bytes[0], 1, bytes.size(), out));
+    std::fclose(in);
+    std::fclose(out);
+
+    std::vector<std::string> lines;
+    for (size_t pos = 0; pos < bytes.size();) {
+        size_t end = bytes.find('\n', pos);
+        if (end == std::string::npos) {
+            lines.push_back(bytes.substr(pos) + " (unterminated)");
+            break;
+        }
+        lines.push_back(bytes.substr(pos, end - pos));
+        pos = end + 1;
+    }
+    return lines;
+}
+
+/**
+ * @brief Compares output lines with the expected results, numbered from 1
+ */
+void expectLines(const std::string& test, const std::vector<std::string>& lines, const std::vector<std::string>& results) {
+    if (lines.size() != results.size()) {
+        fail(test, std::to_string(lines.size()) + " lines, expected " + std::to_string(results.size()));
+        return;
+    }
+    for (size_t i = 0; i < lines.size(); ++i) {
+        std::string expected = std::to_string(i + 1) + " " + results[i];
+        if (lines[i].compare(0, expected.size(), expected) != 0) {
+            fail(test, "line " + std::to_string(i + 1) + " is '" + lines[i] + "', expected '" + expected + "'");
+            return;
+        }
+    }
+}
+
+/**
+ * @brief Runs a check that has to fail, and checks that the message mentions what it should
+ */
+void expectError(const std::string& test, const std::string& expected, const std::string& input,
+                 BatchChecker::Framing framing, WorkStealingPool& pool) {
+    try {
+        check(input, framing, pool);
+        fail(test, "no error, expected '" + expected + "'");
+    } catch (const std::runtime_error& e) {
+        if (std::string(e.what()).find(expected) == std::string::npos) {
+            fail(test, std::string("error '") + e.what() + "', expected '" + expected + "'");
+        }
+    }
+}
+
+std::string lengthPrefixed(const std::string& record) {
+    std::string framed;
+    for (int i = 0; i < 4; ++i) framed += static_cast<char>((record.size() >> (8 * i)) & 0xff);
+    return framed + record;
+}
+
+/**
+ * @brief Records padded to varying lengths, so block boundaries fall anywhere in them
+ */
+std::string manyRecords(size_t count, BatchChecker::Framing framing, std::vector<std::string>& results) {
+    std::string input;
+    for (size_t i = 0; i < count; ++i) {
+        const Case& c = CASES[i % CASES.size()];
+        std::string record = std::string(i % 17, ' ') + c.record;
+        input += framing == BatchChecker::Framing::LINES ? record + (i % 3 ? "\n" : "\r\n") : lengthPrefixed(record);
+        results.push_back(c.result);
+    }
+    return input;
+}
+
+void testLines(WorkStealingPool& pool) {
+    std::vector<std::string> results;
+    std::string input;
+    for (const Case& c : CASES) {
+        input += c.record + "\n\n \t\n"; // Blank lines are not records
+        results.push_back(c.result);
+    }
+    expectLines("lines", check(input, BatchChecker::Framing::LINES, pool), results);
+    expectLines("lines, unterminated last line", check("p => p\nq => p", BatchChecker::Framing::LINES, pool),
+                {"valid satisfiable 1", "invalid satisfiable 2 counterexample=p:0,q:1"});
+    expectLines("lines, empty input", check("", BatchChecker::Framing::LINES, pool), {});
+}
+
+void testLengthPrefix(WorkStealingPool& pool) {
+    std::string input = lengthPrefixed("p\nq => p & q") + lengthPrefixed("") + lengthPrefixed("a;b;\n=> a -> b");
+    expectLines("length prefix", check(input, BatchChecker::Framing::LENGTH_PREFIX, pool),
+                {"valid satisfiable 1", "valid satisfiable 1", "valid satisfiable 1"});
+
+    expectError("length prefix, truncated record", "Truncated length-prefixed record",
+                lengthPrefixed("p => p") + lengthPrefixed("q => q").substr(0, 7), BatchChecker::Framing::LENGTH_PREFIX, pool);
+    expectError("length prefix, truncated length", "Truncated length-prefixed record",
+                lengthPrefixed("p => p") + std::string(2, '\0'), BatchChecker::Framing::LENGTH_PREFIX, pool);
+    expectError("length prefix, forged length", "Length-prefixed record of 4294967295 bytes",
+                std::string(4, '\xff') + "p => p", BatchChecker::Framing::LENGTH_PREFIX, pool);
+}
+
+void testErrors(WorkStealingPool& pool) {
+    std::string wide;
+    for (int i = 0; i < 31; ++i) wide += (i ? " & v" : "v") + std::to_string(i);
+    std::string input = "p => p\np & => q\n(a | b => a\n" + wide + "\nq => q\n";
+    std::vector<std::string> lines = check(input, BatchChecker::Framing::LINES, pool);
+    expectLines("errors", lines, {"valid satisfiable 1", "error ", "error ", "error Too many variables for batch mode", "valid satisfiable 1"});
+
+    // A line that never ends may not grow the read buffer without limit
+    expectError("lines, endless record", "Record longer than 16777216 bytes",
+                "p => p\n" + std::string((size_t{17} << 20), 'p'), BatchChecker::Framing::LINES, pool);
+}
+
+/**
+ * @brief Many records over several read blocks come back in order, in both framings
+ */
+void testOrder(WorkStealingPool& pool) {
+    for (auto framing : {BatchChecker::Framing::LINES, BatchChecker::Framing::LENGTH_PREFIX}) {
+        const std::string test = framing == BatchChecker::Framing::LINES ? "order, lines" : "order, length prefix";
+        std::vector<std::string> results;
+        std::string input = manyRecords(100000, framing, results);
+        if (input.size() < size_t{2} << 20) fail(test, "the input fits in too few read blocks");
+        expectLines(test, check(input, framing, pool), results);
+    }
+}
+
+/**
+ * @brief Records are checked in the worker arenas: ten times more records cost no more allocations
+ *        than the buffers that keep their capacity need to grow
+ */
+void testArenaReuse(WorkStealingPool& pool) {
+    uint64_t counts[2];
+    for (int run = 0; run < 2; ++run) {
+        std::vector<std::string> results;
+        std::string input = manyRecords(run ? 20000 : 2000, BatchChecker::Framing::LINES, results);
+        expectLines("arena reuse", check(input, BatchChecker::Framing::LINES, pool, &counts[run]), results);
+    }
+    if (counts[1] > counts[0] + 100) {
+        fail("arena reuse", std::to_string(counts[0]) + " allocations for 2000 records, " + std::to_string(counts[1]) +
+                            " for 20000");
+    }
+}
+
+} // namespace
+
+int main() {
+    WorkStealingPool pool(4);
+    if (pool.size() < 2) {
+        std::cerr << "The pool has a single worker, results would come in order anyway\n";
+        return 1;
+    }
+    testLines(pool);
+    testLengthPrefix(pool);
+    testErrors(pool);
+    testOrder(pool);
+    testArenaReuse(pool);
+
+    if (failures) {
+        std::cerr << failures << " failures\n";
+        return 1;
+    }
+    std::cout << "Batch records are framed, checked and answered in order\n";
+    return 0;
+}
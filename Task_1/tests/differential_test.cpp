@@ -0,0 +1,824 @@
+/**
+ * @file differential_test.cpp
+ * @brief Differential test of every analysis engine against the sweep and the reference evaluator.
+ *
+ * Seeded random arguments, some of them written by the ArgumentGenerator of logic_generate, are
+ * compiled by ExpressionCompiler, and every premise and the conclusion
+ * are evaluated both by their compiled program and by LogicalEvaluator, the interpreter the analyzer
+ * started with, on every row of small tables and on sampled rows of larger ones. The two have to
+ * agree on every row they are given, and where every row was given, the analysis counted from
+ * LogicalEvaluator has to be that of the scalar bit-sliced sweep.
+ *
+ * Every other engine analyzes the same TruthTableGenerator and has to agree with that sweep.
+ * Satisfiability is compared where an engine checked it, row counts where it reports them complete,
+ * the lowest counterexample where it numbers rows, and any other counterexample is checked by
+ * evaluating the premises and the conclusion on it.
+ *
+ * Usage: differential_test [--seeds=N], N random arguments (200 by default).
+ */
+
+#include <cstring>
+#include <map>
+#include <memory>
+#include <thread>
+
+#include "analysis_planner.hpp"
+#include "analysis_session.hpp"
+#include "argument_generator.hpp"
+#include "truth_table_generator.hpp"
+#include "truth_vector_cache.hpp"
+
+namespace {
+
+const size_t REFERENCE_ROWS = 256; // Rows given to LogicalEvaluator, all of them up to 8 variables
+const char* const CACHE_PATH = "differential_test.cache";
+
+/**
+ * @brief A generated argument
+ */
+struct Argument {
+    std::string name; // How to reproduce a failure
+    uint64_t seed = 0;
+    std::vector<std::string> premises;
+    std::string conclusion;
+    std::vector<std::string> variables; // In the order of the truth table columns
+    std::vector<CompiledExpression> programs; // The premises, then the conclusion
+    std::unique_ptr<TruthTableGenerator> generator;
+};
+
+int failures = 0;
+
+void fail(const Argument& argument, const std::string& engine, const std::string& message) {
+    std::cerr << argument.name << ": " << engine << ": " << message << "\n";
+    ++failures;
+}
+
+/**
+ * @brief A random expression over the given variables
+ *
+ * Half of the binary operators are written without parentheses around their operands, so the
+ * precedences and the associativity of both parsers are exercised as well.
+ */
+std::string randomExpression(Random& random, const std::vector<std::string>& variables, size_t depth) {
+    if (depth == 0 || random.chance(0.2)) {
+        const std::string& leaf = variables[random.below(variables.size())];
+        return random.chance(0.3) ? "~" + leaf : leaf;
+    }
+    if (random.chance(0.15)) return "~(" + randomExpression(random, variables, depth - 1) + ")";
+    static const char* const operators[] = {" & ", " | ", " -> ", " <-> "};
+    const char* op = operators[random.below(4)];
+    std::string left = randomExpression(random, variables, depth - 1);
+    std::string right = randomExpression(random, variables, depth - 1);
+    if (random.chance(0.5)) return left + op + right;
+    auto group = [](const std::string& operand) { return operand.find(' ') == std::string::npos ? operand : "(" + operand + ")"; };
+    return group(left) + op + group(right);
+}
+
+/**
+ * @brief Compiles the expressions of an argument and builds its generator
+ */
+void finish(Argument& argument) {
+    ProblemBuilder builder;
+    for (const auto& premise : argument.premises) builder.addPremise(premise);
+    builder.setConclusion(argument.conclusion);
+    Problem problem = builder.finish();
+    argument.variables = problem.variables;
+    argument.programs = problem.premises;
+    argument.programs.push_back(problem.conclusion);
+    argument.generator = std::make_unique<TruthTableGenerator>(std::move(problem));
+}
+
+Argument randomArgument(uint64_t seed) {
+    static const std::vector<std::string> names = {"p", "q", "r", "s", "t", "u", "v", "x1", "x2", "door_open", "Light", "z_9", "a"};
+    Random random(seed);
+    const std::vector<std::string> variables(names.begin(), names.begin() + 1 + random.below(names.size()));
+
+    Argument argument;
+    argument.name = "argument --seed=" + std::to_string(seed);
+    argument.seed = seed;
+    for (uint64_t i = 0, premises = 1 + random.below(5); i < premises; ++i) {
+        argument.premises.push_back(randomExpression(random, variables, 1 + random.below(4)));
+    }
+    argument.conclusion = randomExpression(random, variables, 1 + random.below(4));
+    finish(argument);
+    return argument;
+}
+
+/**
+ * @brief An argument written by the generator of logic_generate, read back line by line
+ */
+Argument generatedArgument(const GeneratorOptions& options) {
+    std::FILE* file = std::tmpfile();
+    if (!file) throw std::runtime_error("Cannot create a temporary file");
+    {
+        ReadBackBuffer out(file);
+        ArgumentGenerator(options, out).generate();
+        out.flush();
+    }
+    std::string text(static_cast<size_t>(std::ftell(file)), '\0');
+    std::rewind(file);
+    text.resize(std::fread(&text[0], 1, text.size(), file));
+    std::fclose(file);
+
+    Argument argument;
+    const bool cnf = options.shape == GeneratorOptions::Shape::CNF;
+    argument.name = "logic_generate --shape=" + std::string(cnf ? "cnf" : "tree") + " --seed=" + std::to_string(options.seed) +
+                    " --variables=" + std::to_string(options.variables) +
+                    (cnf ? " --density=" + std::to_string(options.density)
+                         : " --premises=" + std::to_string(options.premises) + " --depth=" + std::to_string(options.depth) +
+                               " --shared=" + std::to_string(options.shared));
+    argument.seed = options.seed;
+    for (size_t pos = 0; pos < text.size();) {
+        size_t end = std::min(text.find('\n', pos), text.size());
+        std::string line = text.substr(pos, end - pos);
+        pos = end + 1;
+        if (line.compare(0, 3, "=> ") == 0) {
+            argument.conclusion = line.substr(3);
+        } else if (!line.empty()) {
+            argument.premises.push_back(line);
+        }
+    }
+    finish(argument);
+    return argument;
+}
+
+/**
+ * @brief An argument built from a few shared subformulas, repeated commuted, doubly negated and duplicated
+ *
+ * The first two premises are the same conjunction with its operands swapped, so the expression DAG of
+ * the sweep has to merge them into one node.
+ */
+Argument sharedArgument(uint64_t seed) {
+    static const std::vector<std::string> names = {"p", "q", "r", "s", "t", "u", "v", "w"};
+    Random random(seed);
+    const std::vector<std::string> variables(names.begin(), names.begin() + 3 + random.below(names.size() - 2));
+    std::vector<std::string> shared;
+    for (int i = 0; i < 4; ++i) shared.push_back("(" + randomExpression(random, variables, 2) + ")");
+    auto pick = [&] { return shared[random.below(shared.size())]; };
+    auto piece = [&] {
+        std::string a = pick(), b = pick();
+        switch (random.below(4)) {
+        case 0: return b + " & " + a;
+        case 1: return "~(~" + a + ") | " + b; // LogicalEvaluator does not take ~~ without parentheses
+        case 2: return "(" + a + " | " + a + ") <-> " + b;
+        default: return "~(" + a + " -> " + b + ")";
+        }
+    };
+
+    Argument argument;
+    argument.name = "shared --seed=" + std::to_string(seed);
+    argument.seed = seed;
+    argument.premises.push_back(shared[0] + " & " + shared[1]);
+    argument.premises.push_back(shared[1] + " & " + shared[0]);
+    for (uint64_t i = 0, premises = random.below(3); i < premises; ++i) argument.premises.push_back(piece());
+    argument.conclusion = piece();
+    finish(argument);
+    return argument;
+}
+
+/**
+ * @brief An argument over several groups of variables, each premise within one group, so that it
+ *        usually falls apart into independent components
+ */
+Argument sparseArgument(uint64_t seed) {
+    Random random(seed);
+    std::vector<std::vector<std::string>> groups(2 + random.below(3));
+    for (size_t g = 0; g < groups.size(); ++g) {
+        for (uint64_t j = 0, size = 1 + random.below(4); j < size; ++j) {
+            groups[g].push_back("g" + std::to_string(g) + "_" + std::to_string(j));
+        }
+    }
+
+    Argument argument;
+    argument.name = "sparse --seed=" + std::to_string(seed);
+    argument.seed = seed;
+    for (const auto& group : groups) {
+        for (uint64_t i = 0, premises = 1 + random.below(2); i < premises; ++i) {
+            argument.premises.push_back(randomExpression(random, group, 1 + random.below(3)));
+        }
+    }
+    argument.conclusion = randomExpression(random, groups[random.below(groups.size())], 1 + random.below(3));
+    finish(argument);
+    return argument;
+}
+
+/**
+ * @brief A random Horn argument: clauses with at most one positive literal, half of them written as rules
+ */
+Argument hornArgument(uint64_t seed) {
+    Random random(seed);
+    const uint64_t variables = 4 + seed % 10;
+    auto variable = [&] { return "x" + std::to_string(random.below(variables)); };
+
+    Argument argument;
+    argument.name = "horn --seed=" + std::to_string(seed);
+    argument.seed = seed;
+    for (uint64_t c = 0, clauses = variables + random.below(variables); c < clauses; ++c) {
+        size_t negatives = random.below(3);
+        bool positive = negatives == 0 || random.chance(0.7);
+        std::string clause;
+        if (positive && negatives > 0 && random.chance(0.5)) { // a & b -> c
+            for (size_t i = 0; i < negatives; ++i) clause += (i ? " & " : "") + variable();
+            clause += " -> " + variable();
+        } else {
+            for (size_t i = 0; i < negatives; ++i) clause += (i ? " | ~" : "~") + variable();
+            if (positive) clause += (negatives ? " | " : "") + variable();
+        }
+        argument.premises.push_back(clause);
+    }
+    argument.conclusion = random.chance(0.5) ? variable() + " & " + variable() + " -> " + variable()
+                                             : variable() + " | ~" + variable();
+    finish(argument);
+    return argument;
+}
+
+/**
+ * @brief A random parity argument: equations of two or three literals joined by <->
+ */
+Argument parityArgument(uint64_t seed) {
+    Random random(seed);
+    const uint64_t variables = 4 + seed % 10;
+    auto literal = [&] { return (random.chance(0.3) ? "~x" : "x") + std::to_string(random.below(variables)); };
+    auto equation = [&](size_t size) {
+        std::string text = literal();
+        for (size_t i = 1; i < size; ++i) text += " <-> " + literal();
+        return text;
+    };
+
+    Argument argument;
+    argument.name = "parity --seed=" + std::to_string(seed);
+    argument.seed = seed;
+    for (uint64_t e = 0, equations = variables / 2 + random.below(variables / 2 + 1); e < equations; ++e) {
+        argument.premises.push_back(equation(2 + random.below(2)));
+    }
+    argument.conclusion = equation(2);
+    finish(argument);
+    return argument;
+}
+
+/**
+ * @brief Random clauses of the given width, 3-CNF near its phase transition or 2-CNF near its own
+ */
+Argument randomCnf(uint64_t seed, int width = 3) {
+    Random random(seed);
+    const uint64_t variables = 8 + seed % 6;
+    auto clause = [&] {
+        std::string text;
+        for (int i = 0; i < width; ++i) {
+            text += std::string(i ? " | " : "") + (random.chance(0.5) ? "~" : "") + static_cast<char>('a' + random.below(variables));
+        }
+        return text;
+    };
+
+    Argument argument;
+    argument.name = (width == 3 ? "cnf --seed=" : "2-cnf --seed=") + std::to_string(seed);
+    argument.seed = seed;
+    const uint64_t clauses = width == 3 ? variables * (14 + seed % 5) / 4 : variables * (3 + seed % 3) / 4;
+    for (uint64_t c = 0; c < clauses; ++c) argument.premises.push_back(clause());
+    argument.conclusion = clause();
+    finish(argument);
+    return argument;
+}
+
+/**
+ * @brief Evaluates an expression on one row, bit j of which is the value of variable j
+ */
+bool holds(const CompiledExpression& program, uint64_t row, size_t variables) {
+    std::vector<uint64_t> values(variables), stack(program.maxStackDepth);
+    for (size_t j = 0; j < variables; ++j) values[j] = ((row >> j) & 1) ? ~uint64_t{0} : 0;
+    program.execute(values.data(), stack.data());
+    return stack[0] & 1;
+}
+
+bool isCounterexample(const Argument& argument, uint64_t row) {
+    const size_t n = argument.variables.size();
+    for (size_t i = 0; i + 1 < argument.programs.size(); ++i) {
+        if (!holds(argument.programs[i], row, n)) return false;
+    }
+    return !holds(argument.programs.back(), row, n);
+}
+
+/**
+ * @brief Compares the analysis of an engine with the expected one
+ */
+void compare(const Argument& argument, const std::string& engine, const AnalysisResult& expected,
+             const AnalysisResult& actual) {
+    if (actual.isValid != expected.isValid) {
+        fail(argument, engine, std::string("valid is ") + (actual.isValid ? "true" : "false"));
+    }
+    if (actual.satisfiabilityChecked && actual.isSatisfiable != expected.isSatisfiable) {
+        fail(argument, engine, std::string("satisfiable is ") + (actual.isSatisfiable ? "true" : "false"));
+    }
+    if (actual.hasRowCounts && actual.isComplete &&
+        (actual.criticalRows != expected.criticalRows || actual.counterexampleRows != expected.counterexampleRows)) {
+        fail(argument, engine, std::to_string(actual.criticalRows) + " critical rows, " +
+                               std::to_string(actual.counterexampleRows) + " counterexamples, expected " +
+                               std::to_string(expected.criticalRows) + " and " +
+                               std::to_string(expected.counterexampleRows));
+    }
+
+    if (actual.firstCounterexample != AnalysisResult::NO_ROW) {
+        if (actual.firstCounterexample != expected.firstCounterexample) {
+            fail(argument, engine, "counterexample row " + std::to_string(actual.firstCounterexample) +
+                                   ", the lowest is " + std::to_string(expected.firstCounterexample));
+        }
+    } else if (!actual.counterexample.empty()) {
+        uint64_t row = 0;
+        for (size_t j = 0; j < actual.counterexample.size(); ++j) row |= uint64_t{actual.counterexample[j]} << j;
+        if (!isCounterexample(argument, row)) {
+            fail(argument, engine, "row " + std::to_string(row) + " is not a counterexample");
+        }
+    } else if (!expected.isValid) {
+        fail(argument, engine, "no counterexample");
+    }
+}
+
+/**
+ * @brief Every premise and the conclusion by their compiled program and by LogicalEvaluator
+ *
+ * When every row of the table was evaluated, the analysis counted row by row from LogicalEvaluator
+ * is also compared with the sweep.
+ */
+void checkReference(const Argument& argument, const AnalysisResult& expected) {
+    const std::vector<std::string>& variables = argument.variables;
+    const size_t n = variables.size();
+    std::vector<std::string> expressions = argument.premises;
+    expressions.push_back(argument.conclusion);
+
+    const uint64_t rows = uint64_t{1} << n;
+    const bool everyRow = rows <= REFERENCE_ROWS;
+    Random random(argument.seed);
+    LogicalEvaluator evaluator;
+    AnalysisResult reference;
+    for (uint64_t k = 0; k < (everyRow ? rows : REFERENCE_ROWS); ++k) {
+        const uint64_t row = everyRow ? k : random.below(rows);
+        for (size_t j = 0; j < n; ++j) evaluator.setVariable(variables[j], (row >> j) & 1);
+        bool critical = true, concluded = false;
+        for (size_t i = 0; i < expressions.size(); ++i) {
+            bool value = evaluator.evaluate(expressions[i]);
+            if (holds(argument.programs[i], row, n) != value) {
+                fail(argument, "compiled", "'" + expressions[i] + "' is " + (value ? "false" : "true") +
+                                           " on row " + std::to_string(row) + ", LogicalEvaluator disagrees");
+                return;
+            }
+            if (i + 1 < expressions.size()) critical &= value;
+            else concluded = value;
+        }
+        if (!critical) continue;
+        ++reference.criticalRows;
+        if (concluded) {
+            reference.isSatisfiable = true;
+        } else {
+            reference.isValid = false;
+            ++reference.counterexampleRows;
+            reference.firstCounterexample = std::min(reference.firstCounterexample, row);
+        }
+    }
+    if (everyRow) compare(argument, "sweep", reference, expected);
+}
+
+/**
+ * @brief The expression DAG of an argument from sharedArgument, whose first two premises are one node
+ */
+void checkDag(const Argument& argument) {
+    ExpressionDag dag;
+    std::vector<uint32_t> roots;
+    for (const auto& program : argument.programs) roots.push_back(dag.add(program));
+    if (roots[0] != roots[1]) fail(argument, "dag", "the commuted premises are different nodes");
+    if (dag.deduplicatedCount() == 0) fail(argument, "dag", "no subexpression was shared");
+}
+
+/**
+ * @brief The sweep of every instruction set the CPU supports, the parallel and Gray-code sweeps, the SAT
+ * solver, the BDDs in every variable order and the model counter
+ */
+void checkEngines(const Argument& argument, const AnalysisResult& expected, WorkStealingPool& pool) {
+    const TruthTableGenerator& generator = *argument.generator;
+    for (auto isa : {BitSlicedEvaluator::Isa::SCALAR, BitSlicedEvaluator::Isa::AVX2, BitSlicedEvaluator::Isa::AVX512}) {
+        if (BitSlicedEvaluator::isSupported(isa)) {
+            compare(argument, BitSlicedEvaluator::isaName(isa), expected, generator.analyze(isa));
+        }
+    }
+    AnalysisResult parallel = generator.analyzeParallel(pool, false);
+    if (!parallel.isComplete) fail(argument, "parallel", "the exhaustive sweep stopped early");
+    compare(argument, "parallel", expected, parallel);
+    compare(argument, "parallel, stopping early", expected, generator.analyzeParallel(pool, true));
+    compare(argument, "gray", expected, generator.analyzeGray(pool));
+    compare(argument, "sat", expected, generator.analyzeSat());
+    compare(argument, "bdd", expected, generator.analyzeBdd(TruthTableGenerator::BddOrder::APPEARANCE));
+    compare(argument, "bdd, natural order, sifting", expected,
+            generator.analyzeBdd(TruthTableGenerator::BddOrder::NATURAL, true));
+    compare(argument, "bdd, frequency order", expected, generator.analyzeBdd(TruthTableGenerator::BddOrder::FREQUENCY));
+    compare(argument, "count", expected, generator.analyzeCount());
+}
+
+/**
+ * @brief The counterexample-first sweep, with and without satisfiability
+ */
+void checkShortCircuit(const Argument& argument, const AnalysisResult& expected) {
+    const TruthTableGenerator& generator = *argument.generator;
+    compare(argument, "refute", expected, generator.analyzeShortCircuit(true));
+    AnalysisResult validity = generator.analyzeShortCircuit(false);
+    if (validity.satisfiabilityChecked) fail(argument, "refute, validity only", "satisfiability was checked");
+    compare(argument, "refute, validity only", expected, validity);
+}
+
+/**
+ * @brief Compares a session with a fresh analysis of the premises and conclusion it should hold
+ *
+ * The session numbers variables in order of appearance, so its counterexample is mapped back by name
+ * and checked by evaluation rather than compared as a row number.
+ */
+void compareSession(const Argument& argument, const std::string& step, const AnalysisSession& session,
+                    const std::vector<std::string>& premises, const std::string& conclusion) {
+    Argument state;
+    state.name = argument.name;
+    state.premises = premises;
+    state.conclusion = conclusion;
+    finish(state);
+
+    AnalysisResult actual = session.analyze();
+    if (!actual.counterexample.empty()) {
+        std::map<std::string_view, bool> values;
+        for (uint32_t id : session.usedVariables()) values[session.variableName(id)] = actual.counterexample[id];
+        actual.counterexample.assign(state.variables.size(), false);
+        for (size_t j = 0; j < state.variables.size(); ++j) actual.counterexample[j] = values[state.variables[j]];
+        actual.firstCounterexample = AnalysisResult::NO_ROW;
+    }
+    compare(state, "session, " + step, state.generator->analyze(BitSlicedEvaluator::Isa::SCALAR), actual);
+}
+
+/**
+ * @brief An incremental session through additions, a removal and edits of the premises and conclusion
+ */
+void checkSession(const Argument& argument) {
+    AnalysisSession session;
+    std::vector<std::string> premises = argument.premises;
+    std::string conclusion = argument.conclusion;
+    for (const auto& premise : premises) session.addPremise(premise);
+    session.setConclusion(conclusion);
+    compareSession(argument, "built", session, premises, conclusion);
+
+    std::string first = premises.front();
+    session.removePremise(0);
+    premises.erase(premises.begin());
+    compareSession(argument, "first premise removed", session, premises, conclusion);
+
+    session.addPremise(first);
+    premises.push_back(first);
+    compareSession(argument, "first premise added last", session, premises, conclusion);
+
+    size_t middle = premises.size() / 2;
+    session.editPremise(middle, conclusion);
+    premises[middle] = conclusion;
+    compareSession(argument, "premise edited to the conclusion", session, premises, conclusion);
+
+    session.setConclusion(premises.back());
+    conclusion = premises.back();
+    session.editPremise(premises.size() - 1, "~(" + conclusion + ")");
+    premises.back() = "~(" + conclusion + ")";
+    compareSession(argument, "conclusion replaced, last premise negated", session, premises, conclusion);
+}
+
+/**
+ * @brief Compares the tokens of FastLexer with those of ExpressionTokenizer under every instruction set
+ */
+void compareTokens(const Argument& argument, const std::string& what, std::string_view text) {
+    std::pmr::vector<ExpressionTokenizer::Token> expected = ExpressionTokenizer().tokenize(text);
+    const int widest = static_cast<int>(FastLexer::detectIsa());
+    for (int isa = 0; isa <= widest; ++isa) {
+        std::string engine = std::string("lexer ") + (isa == 0 ? "scalar" : isa == 1 ? "avx2" : "avx512") + ", " + what;
+        FastLexer::Tokens tokens = FastLexer::lex(text, std::pmr::get_default_resource(), static_cast<FastLexer::Isa>(isa));
+        if (tokens.size() != expected.size()) {
+            fail(argument, engine, std::to_string(tokens.size()) + " tokens, expected " + std::to_string(expected.size()));
+            continue;
+        }
+        for (size_t i = 0; i < tokens.size(); ++i) {
+            ExpressionTokenizer::Token token = FastLexer::expand(text, tokens[i]);
+            if (token.type != expected[i].type || token.value != expected[i].value ||
+                token.precedence != expected[i].precedence || token.text.data() != expected[i].text.data() ||
+                token.text.size() != expected[i].text.size()) {
+                fail(argument, engine, "token " + std::to_string(i) + " is '" + std::string(token.text) +
+                                       "', expected '" + std::string(expected[i].text) + "'");
+                break;
+            }
+        }
+    }
+}
+
+/**
+ * @brief The SIMD lexer on every expression, on their conjunction grown past a chunk, and on a noisy copy
+ */
+void checkLexer(const Argument& argument, uint64_t seed) {
+    std::string all;
+    for (const auto& premise : argument.premises) {
+        compareTokens(argument, "premise", premise);
+        all += (all.empty() ? "(" : " & (") + premise + ")";
+    }
+    if (!argument.conclusion.empty()) compareTokens(argument, "conclusion", argument.conclusion);
+    std::string conjunction = all;
+    while (conjunction.size() < 3 * 4096) conjunction += "\n& " + all; // Spans several blocks and chunks
+    compareTokens(argument, "long conjunction", conjunction);
+
+    // Every kind of whitespace between the tokens; noise below usually starts an identifier with a
+    // digit somewhere, which sends the whole text to the reference tokenizer
+    static const char spaces[] = " \t\n\v\f\r";
+    Random random(seed);
+    std::string spaced = conjunction;
+    for (char& c : spaced) {
+        if (c == ' ') c = spaces[random.below(sizeof(spaces) - 1)];
+    }
+    compareTokens(argument, "conjunction with every whitespace", spaced);
+
+    // Stray characters, partial operators and other whitespace, where the lexers must still agree
+    static const char noise[] = " \t\n\r~&|-<>()_x9#$\xe9";
+    for (char& c : conjunction) {
+        if (random.chance(0.05)) c = noise[random.below(sizeof(noise) - 1)];
+    }
+    compareTokens(argument, "noisy conjunction", conjunction);
+}
+
+/**
+ * @brief The persistent cache: a cold lookup that stores the vectors, then a warm one that finds them all
+ *
+ * The file is reopened for every argument, so vectors also come back from earlier arguments. At 8 MiB
+ * it keeps every vector of one argument through an eviction but not those of the whole run, so old
+ * ones are evicted as the test goes on.
+ */
+void checkCache(const Argument& argument, const AnalysisResult& expected) {
+#ifndef _WIN32
+    const TruthTableGenerator& generator = *argument.generator;
+    TruthVectorCache cache(CACHE_PATH, 8 << 20);
+    compare(argument, "cache, cold", expected, generator.analyzeCached(cache));
+    TruthVectorCache::Statistics cold = cache.statistics();
+    compare(argument, "cache, warm", expected, generator.analyzeCached(cache));
+    TruthVectorCache::Statistics warm = cache.statistics();
+    if (warm.misses != cold.misses) {
+        fail(argument, "cache, warm", std::to_string(warm.misses - cold.misses) + " misses after storing every vector");
+    }
+#else
+    (void)argument;
+    (void)expected;
+#endif
+}
+
+/**
+ * @brief The independent parts of an argument swept separately
+ * @return Whether the argument split into more than one part.
+ */
+bool checkComponents(const Argument& argument, const AnalysisResult& expected, WorkStealingPool& pool) {
+    const TruthTableGenerator& generator = *argument.generator;
+    std::vector<TruthTableGenerator::Component> parts = generator.components();
+
+    // Every variable and premise in exactly one part, and the conclusion in one
+    std::vector<int> variableParts(argument.variables.size()), premiseParts(argument.premises.size());
+    size_t conclusionParts = 0;
+    for (const auto& part : parts) {
+        for (uint32_t slot : part.slots) ++variableParts[slot];
+        for (size_t premise : part.premises) ++premiseParts[premise];
+        conclusionParts += part.hasConclusion;
+    }
+    bool partition = conclusionParts == 1;
+    for (int count : variableParts) partition &= count == 1;
+    for (int count : premiseParts) partition &= count == 1;
+    if (!partition) fail(argument, "components", "the parts do not partition the argument");
+
+    compare(argument, "components", expected, generator.analyzeComponents(pool, parts));
+    compare(argument, "components, scalar", expected,
+            generator.analyzeComponents(pool, parts, BitSlicedEvaluator::Isa::SCALAR));
+    return parts.size() > 1;
+}
+
+/**
+ * @brief Analyzes the batches of a row generator the way the sweep does
+ * @param checkRows Also evaluate every premise and the conclusion on each row and compare them with the batch.
+ */
+AnalysisResult pullRows(const Argument& argument, RowGenerator& rows, bool checkRows) {
+    const size_t n = argument.variables.size();
+    AnalysisResult result;
+    for (const RowGenerator::Batch& batch : rows) {
+        result.addWord(batch.word, batch.critical, batch.counterexamples());
+        for (unsigned bit = 0; checkRows && bit < 64; ++bit) {
+            if (!((batch.rowMask >> bit) & 1)) continue;
+            bool same = ((batch.conclusion >> bit) & 1) == holds(argument.programs.back(), batch.row(bit), n);
+            for (size_t i = 0; i < batch.premiseCount; ++i) {
+                same &= batch.premise(i, bit) == holds(argument.programs[i], batch.row(bit), n);
+            }
+            if (!same) {
+                fail(argument, "rows", "row " + std::to_string(batch.row(bit)) + " has the wrong values");
+                return result;
+            }
+        }
+    }
+    return result;
+}
+
+/**
+ * @brief The lazy row generator: whole, split in two with seek, and outliving its TruthTableGenerator
+ */
+void checkRowGenerator(const Argument& argument, const AnalysisResult& expected) {
+    const TruthTableGenerator& generator = *argument.generator;
+    RowGenerator rows = generator.rows();
+    const bool small = argument.variables.size() <= 12; // Evaluate every row one by one up to 4096 rows
+    compare(argument, "rows", expected, pullRows(argument, rows, small));
+
+    uint64_t middle = rows.wordCount() / 2;
+    RowGenerator low = generator.rows(), high = generator.rows();
+    low.seek(0, middle);
+    high.seek(middle);
+    AnalysisResult halves = pullRows(argument, low, false);
+    halves.merge(pullRows(argument, high, false));
+    compare(argument, "rows, two halves", expected, halves);
+
+    RowGenerator detached = [&] {
+        Argument copy;
+        copy.premises = argument.premises;
+        copy.conclusion = argument.conclusion;
+        finish(copy);
+        return copy.generator->rows();
+    }();
+    compare(argument, "rows, detached", expected, pullRows(argument, detached, false));
+}
+
+/**
+ * @brief Estimates of the approximate counter and how many of them missed the tolerance
+ */
+struct EstimateTally {
+    size_t hashed = 0; // Estimates above the cell threshold, found with XOR constraints
+    size_t outside = 0; // Of those, the ones further than a factor 1 + epsilon from the count
+};
+
+/**
+ * @brief The approximate counter: exact verdicts, exact counts below the cell threshold, estimates otherwise
+ *
+ * An estimate is only within a factor 1 + epsilon with probability 1 - delta, so those are tallied and
+ * the share that misses is checked over the whole run.
+ */
+void checkApproximate(const Argument& argument, const AnalysisResult& expected, WorkStealingPool& pool,
+                      EstimateTally& tally) {
+    ApproximateCounter::Parameters parameters;
+    parameters.seed = argument.seed;
+    TruthTableGenerator::ApproximateCounts counts;
+    compare(argument, "approx", expected, argument.generator->analyzeApproximate(pool, parameters, &counts));
+
+    auto check = [&](const char* what, const ApproximateCounter::Estimate& estimate, uint64_t exact) {
+        if (estimate.exact) {
+            if (estimate.count.toUint64() != exact) {
+                fail(argument, std::string("approx ") + what, estimate.count.toString() + " exact, expected " +
+                                                                  std::to_string(exact));
+            }
+            return;
+        }
+        ++tally.hashed;
+        double count = static_cast<double>(estimate.count.toUint64());
+        double factor = 1 + parameters.epsilon;
+        tally.outside += !(count <= static_cast<double>(exact) * factor && static_cast<double>(exact) <= count * factor);
+    };
+    check("critical rows", counts.premises, expected.criticalRows);
+    check("counterexample rows", counts.counterexamples, expected.counterexampleRows);
+}
+
+/**
+ * @brief The planner with room for a sweep, with no budget at all, and with a sweep that may not stop early
+ *
+ * A sweep that fits the budget has to be the engine that answers, since only it counts rows and finds
+ * the lowest counterexample for every argument. Without a budget the fast paths, BDDs and SAT answer.
+ * The planner without a budget runs on another thread and pool at the same time, and must not cut the
+ * budget of the first one short.
+ */
+void checkPlanner(const Argument& argument, const AnalysisResult& expected, WorkStealingPool& pool,
+                  WorkStealingPool& besidePool) {
+    const TruthTableGenerator& generator = *argument.generator;
+    AnalysisResult unbudgetedResult;
+    std::string unbudgetedError;
+    std::thread beside([&] {
+        try {
+            AnalysisPlanner unbudgeted(generator, besidePool, 0.0);
+            unbudgetedResult = unbudgeted.run();
+        } catch (const std::exception& e) {
+            unbudgetedError = e.what();
+        }
+    });
+    AnalysisPlanner planner(generator, pool, 1.0);
+    compare(argument, "planner", expected, planner.run());
+    beside.join();
+    AnalysisPlanner::Engine answered = AnalysisPlanner::Engine::SAT; // The last engine that ran is the one that answered
+    for (const AnalysisPlanner::Step& step : planner.log()) {
+        if (step.ran) answered = step.engine;
+    }
+    if (answered != AnalysisPlanner::Engine::SWEEP && answered != AnalysisPlanner::Engine::COMPONENTS) {
+        fail(argument, "planner", std::string("answered by ") + AnalysisPlanner::engineName(answered) +
+                                  " although the sweep fits the budget");
+    }
+
+    if (unbudgetedError.empty()) {
+        compare(argument, "planner, no budget", expected, unbudgetedResult);
+    } else {
+        fail(argument, "planner, no budget", unbudgetedError);
+    }
+    AnalysisPlanner exhaustive(generator, pool, 1.0, false);
+    compare(argument, "planner, exhaustive", expected, exhaustive.run());
+}
+
+/**
+ * @brief The Horn, 2-SAT and parity fast paths, where they apply
+ * @return The fragment that decided the argument, NONE if it is in none of them.
+ */
+FragmentSolver::Fragment checkFragment(const Argument& argument, const AnalysisResult& expected) {
+    AnalysisResult result;
+    FragmentSolver::Fragment fragment = FragmentSolver::Fragment::NONE;
+    if (!argument.generator->analyzeFragment(result, fragment)) return FragmentSolver::Fragment::NONE;
+    compare(argument, std::string("fragment ") + FragmentSolver::fragmentName(fragment), expected, result);
+    return fragment;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    uint64_t seeds = 200;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strncmp(argv[i], "--seeds=", 8) == 0) {
+            seeds = std::stoull(argv[i] + 8);
+        } else {
+            std::cerr << "Unknown option '" << argv[i] << "'\n";
+            return 2;
+        }
+    }
+
+    std::vector<Argument> arguments;
+    for (uint64_t seed = 1; seed <= seeds; ++seed) {
+        arguments.push_back(randomArgument(seed));
+
+        GeneratorOptions tree; // Formulas whose operands often repeat earlier subformulas
+        tree.seed = seed;
+        tree.variables = 3 + seed % 10;
+        tree.premises = 1 + seed % 5;
+        tree.depth = 2 + seed % 4;
+        tree.shared = seed % 2 ? 0.3 : 0;
+        arguments.push_back(generatedArgument(tree));
+        if (seed % 4 == 1) {
+            GeneratorOptions cnf; // 3-CNF of distinct variables around the phase transition
+            cnf.shape = GeneratorOptions::Shape::CNF;
+            cnf.seed = seed;
+            cnf.variables = 8 + seed % 8;
+            cnf.density = 3.5 + 0.25 * static_cast<double>(seed % 5);
+            arguments.push_back(generatedArgument(cnf));
+        }
+        if (seed % 4 == 0) arguments.push_back(randomCnf(seed));
+        if (seed % 4 == 2) arguments.push_back(sparseArgument(seed));
+        if (seed % 4 == 3) arguments.push_back(randomCnf(seed, 2));
+        if (seed % 2 == 0) arguments.push_back(hornArgument(seed));
+        if (seed % 2 == 1) arguments.push_back(parityArgument(seed));
+        if (seed % 4 == 1) {
+            arguments.push_back(sharedArgument(seed));
+            checkDag(arguments.back());
+        }
+    }
+
+    std::remove(CACHE_PATH);
+    WorkStealingPool pool(2);
+    WorkStealingPool besidePool(2); // For a second planner at the same time
+    size_t valid = 0, satisfiable = 0, split = 0;
+    size_t fragments[4] = {}; // Arguments decided by each FragmentSolver::Fragment
+    EstimateTally estimates;
+    for (const Argument& argument : arguments) {
+        AnalysisResult expected = argument.generator->analyze(BitSlicedEvaluator::Isa::SCALAR);
+        checkReference(argument, expected);
+        checkEngines(argument, expected, pool);
+        checkShortCircuit(argument, expected);
+        checkSession(argument);
+        checkCache(argument, expected);
+        checkLexer(argument, argument.seed);
+        split += checkComponents(argument, expected, pool);
+        checkRowGenerator(argument, expected);
+        checkPlanner(argument, expected, pool, besidePool);
+        ++fragments[static_cast<size_t>(checkFragment(argument, expected))];
+        checkApproximate(argument, expected, pool, estimates);
+        valid += expected.isValid;
+        satisfiable += expected.isSatisfiable;
+    }
+
+    std::remove(CACHE_PATH);
+    if (split == 0) {
+        std::cerr << "No argument split into components\n";
+        ++failures;
+    }
+    for (auto fragment : {FragmentSolver::Fragment::HORN, FragmentSolver::Fragment::TWO_SAT, FragmentSolver::Fragment::XOR}) {
+        if (fragments[static_cast<size_t>(fragment)] == 0) {
+            std::cerr << "No argument was decided by " << FragmentSolver::fragmentName(fragment) << "\n";
+            ++failures;
+        }
+    }
+    // The seeds are fixed, so this only fails if estimates miss far more often than delta allows
+    if (estimates.hashed == 0 || estimates.outside > ApproximateCounter::Parameters().delta * estimates.hashed) {
+        std::cerr << estimates.outside << " of " << estimates.hashed << " approximate counts are outside the tolerance\n";
+        ++failures;
+    }
+    if (failures) {
+        std::cerr << failures << " mismatches\n";
+        return 1;
+    }
+    std::cout << arguments.size() << " arguments (" << valid << " valid, " << satisfiable << " satisfiable, "
+              << estimates.hashed << " hashed estimates) agree with LogicalEvaluator and across all engines\n";
+    return 0;
+}
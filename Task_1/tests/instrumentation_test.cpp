@@ -0,0 +1,206 @@
+/**
+ * @file instrumentation_test.cpp
+ * @brief Tests that the --stats and --trace output is valid JSON, with and without events.
+ *
+ * Instrumentation is process-wide, so the steps run in order: nothing enabled, enabled with no events,
+ * a batch run over empty input (the trace of `--batch --trace` on an empty stream), and a batch run
+ * whose records are traced on the pool threads.
+ */
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+#include "batch_checker.hpp"
+
+namespace {
+
+int failures = 0;
+
+void fail(const std::string& test, const std::string& message) {
+    std::cerr << test << ": " << message << "\n";
+    ++failures;
+}
+
+/**
+ * @class JsonChecker
+ * @brief Minimal recursive-descent JSON validator, enough for the stats and trace files
+ */
+class JsonChecker {
+private:
+    const std::string& text;
+    size_t pos = 0;
+
+    void skipSpace() {
+        while (pos < text.size() && std::isspace(static_cast<unsigned char>(text[pos]))) ++pos;
+    }
+
+    [[noreturn]] void error(const std::string& message) const {
+        throw std::runtime_error(message + " at offset " + std::to_string(pos));
+    }
+
+    void expect(char c) {
+        skipSpace();
+        if (pos >= text.size() || text[pos] != c) error(std::string("Expected '") + c + "'");
+        ++pos;
+    }
+
+    void string() {
+        expect('"');
+        while (pos < text.size() && text[pos] != '"') {
+            if (static_cast<unsigned char>(text[pos]) < 0x20) error("Control character in a string");
+            pos += text[pos] == '\\' ? 2 : 1;
+        }
+        expect('"');
+    }
+
+    void number() {
+        size_t start = pos;
+        if (text[pos] == '-') ++pos;
+        while (pos < text.size() && (std::isdigit(static_cast<unsigned char>(text[pos])) ||
+                                     text[pos] == '.' || text[pos] == 'e' || text[pos] == 'E' || text[pos] == '+' || text[pos] == '-')) {
+            ++pos;
+        }
+        if (pos == start || !std::isdigit(static_cast<unsigned char>(text[pos - 1]))) error("Malformed number");
+    }
+
+    template <typename Element>
+    void sequence(char close, Element element) {
+        skipSpace();
+        if (pos < text.size() && text[pos] == close) {
+            ++pos;
+            return;
+        }
+        for (;;) {
+            element();
+            skipSpace();
+            if (pos < text.size() && text[pos] == ',') {
+                ++pos;
+                continue;
+            }
+            expect(close);
+            return;
+        }
+    }
+
+    void value() {
+        skipSpace();
+        if (pos >= text.size()) error("Missing value");
+        char c = text[pos];
+        if (c == '{') {
+            ++pos;
+            sequence('}', [&] {
+                string();
+                expect(':');
+                value();
+            });
+        } else if (c == '[') {
+            ++pos;
+            sequence(']', [&] { value(); });
+        } else if (c == '"') {
+            string();
+        } else if (text.compare(pos, 4, "true") == 0 || text.compare(pos, 4, "null") == 0) {
+            pos += 4;
+        } else if (text.compare(pos, 5, "false") == 0) {
+            pos += 5;
+        } else {
+            number();
+        }
+    }
+
+public:
+    explicit JsonChecker(const std::string& t) : text(t) {}
+
+    /**
+     * @throws std::runtime_error At the first syntax error.
+     */
+    void check() {
+        value();
+        skipSpace();
+        if (pos != text.size()) error("Text after the value");
+    }
+};
+
+size_t occurrences(const std::string& text, const std::string& pattern) {
+    size_t count = 0;
+    for (size_t pos = text.find(pattern); pos != std::string::npos; pos = text.find(pattern, pos + 1)) ++count;
+    return count;
+}
+
+/**
+ * @brief Writes the trace and checks that it is valid JSON with the expected events
+ * @param threads Expected thread_name entries.
+ * @param minimumRecords Least number of "record" events.
+ */
+void checkTrace(const std::string& test, size_t threads, size_t minimumRecords) {
+    const std::string path = "instrumentation_test.json";
+    Instrumentation::writeTrace(path);
+    std::ifstream in(path);
+    std::stringstream trace;
+    trace << in.rdbuf();
+    in.close();
+    std::remove(path.c_str());
+
+    try {
+        JsonChecker(trace.str()).check();
+    } catch (const std::runtime_error& e) {
+        fail(test, std::string("invalid JSON: ") + e.what() + "\n" + trace.str());
+        return;
+    }
+    if (occurrences(trace.str(), "\"thread_name\"") != threads) {
+        fail(test, std::to_string(occurrences(trace.str(), "\"thread_name\"")) + " threads, expected " + std::to_string(threads));
+    }
+    size_t records = occurrences(trace.str(), "{\"name\": \"record\"");
+    if (records < minimumRecords || (minimumRecords == 0 && records != 0)) {
+        fail(test, std::to_string(records) + " record events, expected " + (minimumRecords ? "at least " : "") +
+                   std::to_string(minimumRecords));
+    }
+}
+
+void runBatch(const std::string& input, WorkStealingPool& pool) {
+    std::FILE* in = std::tmpfile();
+    std::FILE* out = std::tmpfile();
+    if (!in || !out) throw std::runtime_error("Cannot create a temporary file");
+    std::fwrite(input.data(), 1, input.size(), in);
+    std::rewind(in);
+    BatchChecker(BatchChecker::Framing::LINES, pool).run(in, out);
+    std::fclose(in);
+    std::fclose(out);
+}
+
+} // namespace
+
+int main() {
+    checkTrace("never enabled", 0, 0);
+
+    Instrumentation::enable(true);
+    checkTrace("enabled, no events", 1, 0);
+
+    WorkStealingPool pool(3);
+    runBatch("", pool);
+    checkTrace("batch, empty input", 1, 0);
+
+    runBatch("p -> q; p => q\np | q => p\na & ~a\nx\ny <-> z => y\n", pool);
+    std::ostringstream stats;
+    Instrumentation::writeStats(stats);
+    // Every thread that has recorded anything gets a thread_name entry
+    size_t threads = 0;
+    const std::string threadsField = "\"threads\": ";
+    size_t field = stats.str().find(threadsField);
+    if (field != std::string::npos) threads = std::stoul(stats.str().substr(field + threadsField.size()));
+    checkTrace("batch", threads, 5);
+
+    try {
+        JsonChecker(stats.str()).check();
+    } catch (const std::runtime_error& e) {
+        fail("stats", std::string("invalid JSON: ") + e.what() + "\n" + stats.str());
+    }
+    if (stats.str().find("\"rows_evaluated\": 0,") != std::string::npos) fail("stats", "no rows evaluated");
+
+    if (failures) {
+        std::cerr << failures << " failures\n";
+        return 1;
+    }
+    std::cout << "Stats and traces are valid JSON, with and without events\n";
+    return 0;
+}
@@ -0,0 +1,186 @@
+/**
+ * @file problem_reader_test.cpp
+ * @brief Tests of the text and DIMACS problem readers.
+ *
+ * Well-formed problems have to come back with the expected variable columns and with programs that
+ * agree with LogicalEvaluator (text) or with the clauses as written (DIMACS) on every row. Malformed
+ * ones have to be rejected with the line of the error, and a DIMACS header may not make the reader
+ * allocate more than the file could use.
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+
+#include "problem.hpp"
+
+namespace {
+
+int failures = 0;
+
+void fail(const std::string& test, const std::string& message) {
+    std::cerr << test << ": " << message << "\n";
+    ++failures;
+}
+
+bool holds(const CompiledExpression& program, uint64_t row, size_t variables) {
+    std::vector<uint64_t> values(variables), stack(std::max<size_t>(program.maxStackDepth, 1));
+    for (size_t j = 0; j < variables; ++j) values[j] = ((row >> j) & 1) ? ~uint64_t{0} : 0;
+    program.execute(values.data(), stack.data());
+    return stack[0] & 1;
+}
+
+/**
+ * @brief Runs a reader that has to fail, and checks that the message mentions what it should
+ */
+template <typename Read>
+void expectError(const std::string& test, const std::string& expected, Read read) {
+    try {
+        read();
+        fail(test, "no error, expected '" + expected + "'");
+    } catch (const std::runtime_error& e) {
+        if (std::string(e.what()).find(expected) == std::string::npos) {
+            fail(test, std::string("error '") + e.what() + "', expected '" + expected + "'");
+        }
+    }
+}
+
+/**
+ * @brief A text problem against the same expressions evaluated by LogicalEvaluator
+ */
+void checkText(const std::string& test, const std::string& text, const std::vector<std::string>& variables,
+               const std::vector<std::string>& premises, const std::string& conclusion) {
+    Problem problem = ProblemReader::readText(text);
+    if (problem.variables != variables) {
+        fail(test, std::to_string(problem.variables.size()) + " variables, not the expected ones");
+        return;
+    }
+    if (problem.premises.size() != premises.size()) {
+        fail(test, std::to_string(problem.premises.size()) + " premises, expected " + std::to_string(premises.size()));
+        return;
+    }
+    LogicalEvaluator evaluator;
+    for (uint64_t row = 0; row < uint64_t{1} << variables.size(); ++row) {
+        for (size_t j = 0; j < variables.size(); ++j) evaluator.setVariable(variables[j], (row >> j) & 1);
+        for (size_t i = 0; i < premises.size(); ++i) {
+            if (holds(problem.premises[i], row, variables.size()) != evaluator.evaluate(premises[i])) {
+                fail(test, "premise " + std::to_string(i + 1) + " differs on row " + std::to_string(row));
+                return;
+            }
+        }
+        bool expected = conclusion.empty() || evaluator.evaluate(conclusion);
+        if (holds(problem.conclusion, row, variables.size()) != expected) {
+            fail(test, "the conclusion differs on row " + std::to_string(row));
+            return;
+        }
+    }
+}
+
+/**
+ * @brief A DIMACS problem against its clauses, given as lists of signed variable numbers
+ */
+void checkDimacs(const std::string& test, const std::string& text, size_t variables,
+                 const std::vector<std::vector<int>>& clauses) {
+    Problem problem = ProblemReader::readDimacs(text);
+    if (problem.variables.size() != variables) {
+        fail(test, std::to_string(problem.variables.size()) + " variables, expected " + std::to_string(variables));
+        return;
+    }
+    for (size_t j = 0; j < variables; ++j) {
+        if (problem.variables[j] != "x" + std::to_string(j + 1)) fail(test, "variable " + std::to_string(j + 1) + " is named " + problem.variables[j]);
+    }
+    if (problem.premises.size() != clauses.size()) {
+        fail(test, std::to_string(problem.premises.size()) + " clauses, expected " + std::to_string(clauses.size()));
+        return;
+    }
+    for (uint64_t row = 0; row < uint64_t{1} << variables; ++row) {
+        for (size_t i = 0; i < clauses.size(); ++i) {
+            bool expected = false;
+            for (int literal : clauses[i]) expected |= (((row >> (std::abs(literal) - 1)) & 1) != 0) == (literal > 0);
+            if (holds(problem.premises[i], row, variables) != expected) {
+                fail(test, "clause " + std::to_string(i + 1) + " differs on row " + std::to_string(row));
+                return;
+            }
+        }
+        if (!holds(problem.conclusion, row, variables)) {
+            fail(test, "the conclusion is not true");
+            return;
+        }
+    }
+}
+
+void testText() {
+    checkText("text", "p -> q\np\n=> q\n", {"p", "q"}, {"p -> q", "p"}, "q");
+    checkText("text, names, comments and blank lines",
+              "# Door and light\n\n  door_open -> Light_2   # a rule\n\t~Light_2 | alarm\n\n=> door_open -> alarm\n",
+              {"Light_2", "alarm", "door_open"}, {"door_open -> Light_2", "~Light_2 | alarm"}, "door_open -> alarm");
+    checkText("text, no conclusion", "a & b\r\nb <-> ~c\r\n", {"a", "b", "c"}, {"a & b", "b <-> ~c"}, "");
+    checkText("text, conclusion first", "=> x\nx | y\n", {"x", "y"}, {"x | y"}, "x");
+    checkText("text, empty", "", {}, {}, "");
+
+    expectError("text, two conclusions", "line 3: More than one conclusion",
+                [] { ProblemReader::readText("p\n=> p\n=> q\n"); });
+    expectError("text, malformed premise", "line 2:", [] { ProblemReader::readText("p\np & \n=> p\n"); });
+    expectError("text, malformed conclusion", "line 1:", [] { ProblemReader::readText("=> (p\n"); });
+}
+
+void testDimacs() {
+    checkDimacs("dimacs", "p cnf 3 2\n1 -2 0\n2 3 0\n", 3, {{1, -2}, {2, 3}});
+    checkDimacs("dimacs, comments and clauses across lines",
+                "c a comment\nc another\np cnf 4 3\n1 -4\n 2 0 -3 0\n4 0\n", 4, {{1, -4, 2}, {-3}, {4}});
+    checkDimacs("dimacs, unused variables and '%' terminator", "p cnf 5 1\n-5 0\n%\n0\n", 5, {{-5}});
+    checkDimacs("dimacs, empty clause", "p cnf 1 1\n0\n", 1, {{}});
+    // The clause count only reserves memory, it is not trusted either
+    checkDimacs("dimacs, huge clause count", "p cnf 2 3000000000\n1 2 0\n", 2, {{1, 2}});
+
+    expectError("dimacs, no header", "Missing 'p cnf' problem line", [] { ProblemReader::readDimacs("1 2 0\n"); });
+    expectError("dimacs, two headers", "line 2: Duplicate problem line",
+                [] { ProblemReader::readDimacs("p cnf 1 1\np cnf 1 1\n"); });
+    expectError("dimacs, not cnf", "line 1: Expected 'p cnf", [] { ProblemReader::readDimacs("p dnf 1 1\n"); });
+    expectError("dimacs, out of range", "line 3: Variable 3 out of range (2 declared)",
+                [] { ProblemReader::readDimacs("p cnf 2 1\n1 0\n-3 0\n"); });
+    expectError("dimacs, unterminated clause", "Last clause is not terminated by 0",
+                [] { ProblemReader::readDimacs("p cnf 2 1\n1 2\n"); });
+    expectError("dimacs, number too large", "line 1: Number too large",
+                [] { ProblemReader::readDimacs("p cnf 99999999999 1\n"); });
+    expectError("dimacs, more variables than the file can use", "line 1: 3000000000 variables declared",
+                [] { ProblemReader::readDimacs("p cnf 3000000000 1\n1 0\n"); });
+}
+
+/**
+ * @brief Files are read by extension, and errors name the file
+ */
+void testFiles() {
+    const std::string textPath = "problem_reader_test.txt", dimacsPath = "problem_reader_test.cnf";
+    std::ofstream(textPath) << "p\n=> p | q\n";
+    std::ofstream(dimacsPath) << "p cnf 2 1\n1 -2 0\n";
+
+    Problem text = ProblemReader::read(textPath);
+    if (text.variables != std::vector<std::string>{"p", "q"} || text.premises.size() != 1) fail("file, text", "wrong problem");
+    Problem dimacs = ProblemReader::read(dimacsPath);
+    if (dimacs.variables != std::vector<std::string>{"x1", "x2"} || dimacs.premises.size() != 1) fail("file, dimacs", "wrong problem");
+    Problem forced = ProblemReader::read(textPath, ProblemReader::Format::TEXT);
+    if (forced.variables.size() != 2) fail("file, forced text", "wrong problem");
+    expectError("file, dimacs read as text", dimacsPath + ": line 1:",
+                [&] { ProblemReader::read(dimacsPath, ProblemReader::Format::TEXT); });
+    expectError("file, missing", "Cannot open 'problem_reader_test.missing'",
+                [] { ProblemReader::read("problem_reader_test.missing"); });
+
+    std::remove(textPath.c_str());
+    std::remove(dimacsPath.c_str());
+}
+
+} // namespace
+
+int main() {
+    testText();
+    testDimacs();
+    testFiles();
+
+    if (failures) {
+        std::cerr << failures << " failures\n";
+        return 1;
+    }
+    std::cout << "Text and DIMACS problems are read as expected\n";
+    return 0;
+}
@@ -0,0 +1,19 @@
+/**
+ * @file static_formula_malformed.cpp
+ * @brief Must not compile: a malformed formula declared with LOGIC_STATIC_FORMULA and never used.
+ *
+ * Built with LOGIC_WELL_FORMED it declares a correct formula instead and has to compile, which shows
+ * that the failure comes from the formula and not from the build setup.
+ */
+
+#include "static_formula.hpp"
+
+#ifdef LOGIC_WELL_FORMED
+LOGIC_STATIC_FORMULA(Unused, "p & q");
+#else
+LOGIC_STATIC_FORMULA(Unused, "p & & q");
+#endif
+
+int main() {
+    return 0;
+}
@@ -0,0 +1,122 @@
+/**
+ * @file static_formula_test.cpp
+ * @brief Checks the compile-time formulas of static_formula.hpp against ExpressionCompiler.
+ *
+ * The precedence and associativity rules are checked by static_assert, so a regression there fails
+ * the build. Every formula is then evaluated on all of its assignments through evaluate (rows and
+ * arrays) and evaluate64 and compared with the program ExpressionCompiler makes of the same text.
+ * Built as C++17 this covers LOGIC_STATIC_FORMULA; built as C++20 it also covers logic::Formula.
+ */
+
+#include "expression.hpp"
+#include "static_formula.hpp"
+
+namespace {
+
+LOGIC_STATIC_FORMULA(ImpliesChain, "a -> b -> c");
+LOGIC_STATIC_FORMULA(OrAnd, "a | b & c");
+LOGIC_STATIC_FORMULA(NotAnd, "~a & b");
+LOGIC_STATIC_FORMULA(AndImplies, "a & b -> c");
+LOGIC_STATIC_FORMULA(ImpliesBiconditional, "a -> b <-> c");
+LOGIC_STATIC_FORMULA(BiconditionalChain, "a <-> b <-> c");
+LOGIC_STATIC_FORMULA(Policy, "(admin | owner) & ~locked");
+LOGIC_STATIC_FORMULA(Nested, "~(p_1 & ~(q | r)) <-> (s -> ~~p_1 | t) & (q <-> ~s)");
+LOGIC_STATIC_FORMULA(Wide, "(x0 | x1) & (x2 -> x3) & (x4 <-> ~x5) | x6 & ~x7");
+
+// -> is left associative: (a -> b) -> c is false for a = b = c = false, a -> (b -> c) is true
+static_assert(!ImpliesChain::evaluate({false, false, false}));
+// & binds tighter than |: a | (b & c) is true for a alone, (a | b) & c is not
+static_assert(OrAnd::evaluate({true, false, false}));
+// ~ binds tighter than &: (~a) & b is false when both are false, ~(a & b) is true
+static_assert(!NotAnd::evaluate({false, false}));
+// & binds tighter than ->: (a & b) -> c holds when a is false, a & (b -> c) does not
+static_assert(AndImplies::evaluate({false, false, false}));
+// -> binds tighter than <->: (a -> b) <-> c is false for all false, a -> (b <-> c) is true
+static_assert(!ImpliesBiconditional::evaluate({false, false, false}));
+
+// Variables are numbered alphabetically, whatever the order they appear in
+static_assert(Policy::variableCount == 3);
+static_assert(Policy::variableIndex("admin") == 0 && Policy::variableIndex("locked") == 1 &&
+              Policy::variableIndex("owner") == 2 && Policy::variableIndex("root") == -1);
+static_assert(Policy::evaluate({false, false, true}) && !Policy::evaluate({true, true, false}));
+static_assert(Policy::evaluate(uint64_t{0b100}) && !Policy::evaluate(uint64_t{0b011}));
+static_assert(Policy::evaluate64({0b0101, 0b0011, 0b1000}) == 0b1100);
+
+#if __cplusplus >= 202002L
+using Literal = logic::Formula<"a -> b -> c">;
+static_assert(Literal::variableCount == 3 && !Literal::evaluate({false, false, false}));
+static_assert(std::is_same_v<logic::Formula<"p & q">, logic::Formula<"p & q">>);
+#endif
+
+int failures = 0;
+
+/**
+ * @brief Compares every evaluation path of Formula with the compiled program of its text
+ */
+template <typename Formula>
+void checkAgainstCompiler(std::string_view text) {
+    constexpr size_t n = Formula::variableCount;
+    SymbolTable symbols;
+    CompiledExpression program = ExpressionCompiler().compile(text, symbols);
+    if (symbols.size() != n) {
+        std::cerr << text << ": " << symbols.size() << " variables compiled, " << n << " parsed\n";
+        ++failures;
+        return;
+    }
+
+    std::array<uint32_t, n> slot{}; // Compiler slot of every variable in alphabetical order
+    for (size_t j = 0; j < n; ++j) slot[j] = static_cast<uint32_t>(symbols.find(Formula::variables[j]));
+
+    std::vector<uint64_t> values(n), stack(program.maxStackDepth);
+    uint64_t rows = uint64_t{1} << n;
+    for (uint64_t base = 0; base < rows; base += 64) {
+        std::array<uint64_t, n> masks{};
+        for (uint64_t r = 0; r < 64 && base + r < rows; ++r) {
+            for (size_t j = 0; j < n; ++j) masks[j] |= (((base + r) >> j) & 1) << r;
+        }
+        for (size_t j = 0; j < n; ++j) values[slot[j]] = masks[j];
+        program.execute(values.data(), stack.data());
+
+        uint64_t valid = rows - base >= 64 ? ~uint64_t{0} : (uint64_t{1} << (rows - base)) - 1;
+        uint64_t expected = stack[0] & valid;
+        uint64_t sliced = Formula::evaluate64(masks) & valid;
+        if (sliced != expected) {
+            std::cerr << text << ": evaluate64 differs from the compiler at rows " << base << "+\n";
+            ++failures;
+        }
+        for (uint64_t r = 0; r < 64 && base + r < rows; ++r) {
+            std::array<bool, n> assignment{};
+            for (size_t j = 0; j < n; ++j) assignment[j] = ((base + r) >> j) & 1;
+            bool want = (expected >> r) & 1;
+            if (Formula::evaluate(base + r) != want || Formula::evaluate(assignment) != want) {
+                std::cerr << text << ": evaluate differs from the compiler at row " << base + r << "\n";
+                ++failures;
+            }
+        }
+    }
+}
+
+} // namespace
+
+int main() {
+    checkAgainstCompiler<ImpliesChain>("a -> b -> c");
+    checkAgainstCompiler<OrAnd>("a | b & c");
+    checkAgainstCompiler<NotAnd>("~a & b");
+    checkAgainstCompiler<AndImplies>("a & b -> c");
+    checkAgainstCompiler<ImpliesBiconditional>("a -> b <-> c");
+    checkAgainstCompiler<BiconditionalChain>("a <-> b <-> c");
+    checkAgainstCompiler<Policy>("(admin | owner) & ~locked");
+    checkAgainstCompiler<Nested>("~(p_1 & ~(q | r)) <-> (s -> ~~p_1 | t) & (q <-> ~s)");
+    checkAgainstCompiler<Wide>("(x0 | x1) & (x2 -> x3) & (x4 <-> ~x5) | x6 & ~x7");
+#if __cplusplus >= 202002L
+    checkAgainstCompiler<Literal>("a -> b -> c");
+    checkAgainstCompiler<logic::Formula<"~(a | b) <-> ~a & ~b">>("~(a | b) <-> ~a & ~b");
+#endif
+
+    if (failures) {
+        std::cerr << failures << " mismatches\n";
+        return 1;
+    }
+    std::cout << "static formulas agree with the compiler\n";
+    return 0;
+}
@@ -0,0 +1,268 @@
+/**
+ * @file table_sink_test.cpp
+ * @brief Round trip of small truth tables through the text, CSV and TTBIN1 sinks.
+ *
+ * Each table is written by TruthTableGenerator::generateAndAnalyze into a temporary file, with every
+ * row and with critical rows only, and read back. The rows that come back have to be the expected
+ * ones in ascending order, with the premise, conclusion and critical values LogicalEvaluator gives.
+ */
+
+#include <cstring>
+#include <sstream>
+
+#include "truth_table_generator.hpp"
+
+namespace {
+
+/**
+ * @brief One row of a truth table as a sink writes it
+ */
+struct Row {
+    uint64_t row = 0;
+    std::vector<bool> premises;
+    bool conclusion = false;
+    bool critical = false;
+};
+
+/**
+ * @brief A table, its expected rows and the way it is written
+ */
+struct Table {
+    std::string name;
+    std::vector<std::string> premises;
+    std::string conclusion;
+    std::vector<char> variables;
+    std::vector<Row> rows; // Every row, from LogicalEvaluator
+};
+
+int failures = 0;
+
+void fail(const std::string& what, const std::string& message) {
+    std::cerr << what << ": " << message << "\n";
+    ++failures;
+}
+
+Table makeTable(const std::string& name, const std::vector<std::string>& premises, const std::string& conclusion) {
+    Table table;
+    table.name = name;
+    table.premises = premises;
+    table.conclusion = conclusion;
+    for (const std::string& expression : premises) table.variables.insert(table.variables.end(), expression.begin(), expression.end());
+    table.variables.insert(table.variables.end(), conclusion.begin(), conclusion.end());
+    table.variables.erase(std::remove_if(table.variables.begin(), table.variables.end(),
+                                         [](char c) { return !std::isalpha(static_cast<unsigned char>(c)); }),
+                          table.variables.end());
+    std::sort(table.variables.begin(), table.variables.end());
+    table.variables.erase(std::unique(table.variables.begin(), table.variables.end()), table.variables.end());
+
+    LogicalEvaluator evaluator;
+    for (uint64_t row = 0; row < uint64_t{1} << table.variables.size(); ++row) {
+        for (size_t j = 0; j < table.variables.size(); ++j) evaluator.setVariable(table.variables[j], (row >> j) & 1);
+        Row expected;
+        expected.row = row;
+        expected.critical = true;
+        for (const std::string& premise : premises) {
+            expected.premises.push_back(evaluator.evaluate(premise));
+            expected.critical = expected.critical && expected.premises.back();
+        }
+        expected.conclusion = evaluator.evaluate(conclusion);
+        table.rows.push_back(expected);
+    }
+    return table;
+}
+
+/**
+ * @brief Writes the table through a sink into a temporary file and returns the bytes written
+ */
+template <typename MakeSink>
+std::string writeTable(const Table& table, MakeSink makeSink) {
+    std::FILE* file = std::tmpfile();
+    if (!file) throw std::runtime_error("Cannot create a temporary file");
+    {
+        auto sink = makeSink(file);
+        std::ostringstream analysis; // The analysis is printed after the table, keep it off the test output
+        std::streambuf* saved = std::cout.rdbuf(analysis.rdbuf());
+        TruthTableGenerator(table.premises, table.conclusion).generateAndAnalyze(*sink);
+        std::cout.rdbuf(saved);
+    }
+    std::string bytes(static_cast<size_t>(std::ftell(file)), '\0');
+    std::rewind(file);
+    bytes.resize(std::fread(&bytes[0], 1, bytes.size(), file));
+    std::fclose(file);
+    return bytes;
+}
+
+/**
+ * @brief Compares the rows read back with the rows the sink had to write
+ */
+void compareRows(const Table& table, const std::string& format, bool criticalOnly, const std::vector<Row>& rows) {
+    const std::string what = table.name + ", " + format + (criticalOnly ? ", critical only" : "");
+    std::vector<Row> expected;
+    for (const Row& row : table.rows) {
+        if (!criticalOnly || row.critical) expected.push_back(row);
+    }
+    if (rows.size() != expected.size()) {
+        fail(what, std::to_string(rows.size()) + " rows, expected " + std::to_string(expected.size()));
+        return;
+    }
+    for (size_t i = 0; i < rows.size(); ++i) {
+        if (rows[i].row != expected[i].row || rows[i].premises != expected[i].premises ||
+            rows[i].conclusion != expected[i].conclusion || rows[i].critical != expected[i].critical) {
+            fail(what, "row " + std::to_string(i) + " is row " + std::to_string(rows[i].row) +
+                       " or has the wrong values, expected row " + std::to_string(expected[i].row));
+            return;
+        }
+    }
+}
+
+/**
+ * @brief Splits text into lines and each line into fields
+ */
+std::vector<std::vector<std::string>> fields(const std::string& text, char separator) {
+    std::vector<std::vector<std::string>> lines;
+    std::istringstream in(text);
+    for (std::string line; std::getline(in, line);) {
+        std::vector<std::string> cells;
+        std::istringstream cellStream(line);
+        for (std::string cell; std::getline(cellStream, cell, separator);) cells.push_back(cell);
+        lines.push_back(cells);
+    }
+    return lines;
+}
+
+/**
+ * @brief The header a text or CSV table must start with
+ */
+std::vector<std::string> header(const Table& table, bool csv) {
+    std::vector<std::string> names;
+    for (char variable : table.variables) names.push_back(std::string(1, variable));
+    for (size_t i = 0; i < table.premises.size(); ++i) names.push_back("P" + std::to_string(i + 1));
+    names.push_back("Conclusion");
+    if (csv) names.push_back("Critical");
+    return names;
+}
+
+/**
+ * @brief Text rows are T/F separated by spaces with a trailing '*' on critical rows, CSV rows are 0/1
+ */
+void checkText(const Table& table, bool csv, bool criticalOnly) {
+    const std::string format = csv ? "csv" : "text";
+    std::vector<std::vector<std::string>> lines = fields(writeTable(table, [&](std::FILE* file) {
+        return std::make_unique<TextTableSink>(file, csv, criticalOnly);
+    }), csv ? ',' : ' ');
+    if (lines.empty() || lines[0] != header(table, csv)) {
+        fail(table.name + ", " + format, "wrong header");
+        return;
+    }
+
+    const size_t n = table.variables.size(), premises = table.premises.size();
+    const std::string isTrue = csv ? "1" : "T", isFalse = csv ? "0" : "F";
+    std::vector<Row> rows;
+    for (size_t i = 1; i < lines.size(); ++i) {
+        const std::vector<std::string>& cells = lines[i];
+        Row row;
+        bool wellFormed = cells.size() == n + premises + 1 + csv || (!csv && cells.size() == n + premises + 2 && cells.back() == "*");
+        for (size_t c = 0; wellFormed && c < n + premises + 1 + csv; ++c) wellFormed = cells[c] == isTrue || cells[c] == isFalse;
+        if (!wellFormed) {
+            fail(table.name + ", " + format, "malformed line " + std::to_string(i + 1));
+            return;
+        }
+        for (size_t j = 0; j < n; ++j) row.row |= uint64_t{cells[j] == isTrue} << j;
+        for (size_t p = 0; p < premises; ++p) row.premises.push_back(cells[n + p] == isTrue);
+        row.conclusion = cells[n + premises] == isTrue;
+        row.critical = csv ? cells[n + premises + 1] == "1" : cells.size() == n + premises + 2;
+        rows.push_back(row);
+    }
+    compareRows(table, format, criticalOnly, rows);
+}
+
+/**
+ * @brief Reads a little-endian number and advances past it
+ */
+uint64_t readLittleEndian(const std::string& bytes, size_t& pos, size_t size) {
+    uint64_t value = 0;
+    for (size_t i = 0; i < size; ++i) value |= uint64_t{static_cast<unsigned char>(bytes[pos + i])} << (8 * i);
+    pos += size;
+    return value;
+}
+
+/**
+ * @brief TTBIN1: the header, then one record of premise and conclusion words per word of the table
+ */
+void checkBinary(const Table& table, bool criticalOnly) {
+    const std::string what = table.name + ", binary" + (criticalOnly ? ", critical only" : "");
+    std::string bytes = writeTable(table, [&](std::FILE* file) {
+        return std::make_unique<BinaryTableSink>(file, criticalOnly);
+    });
+    const size_t n = table.variables.size(), premises = table.premises.size();
+    const uint64_t rowCount = uint64_t{1} << n;
+    size_t pos = 8;
+    if (bytes.size() < 28 || bytes.compare(0, 8, std::string("TTBIN1\0\0", 8)) != 0 ||
+        readLittleEndian(bytes, pos, 4) != n || readLittleEndian(bytes, pos, 4) != premises ||
+        readLittleEndian(bytes, pos, 8) != rowCount || readLittleEndian(bytes, pos, 4) != (criticalOnly ? 1u : 0u)) {
+        fail(what, "wrong header");
+        return;
+    }
+
+    const size_t recordSize = 8 * (premises + 1 + criticalOnly);
+    if ((bytes.size() - pos) % recordSize != 0) {
+        fail(what, std::to_string(bytes.size() - pos) + " bytes of records, not a multiple of " + std::to_string(recordSize));
+        return;
+    }
+    std::vector<Row> rows;
+    for (uint64_t record = 0; pos < bytes.size(); ++record) {
+        uint64_t word = criticalOnly ? readLittleEndian(bytes, pos, 8) : record;
+        std::vector<uint64_t> premiseWords(premises);
+        uint64_t critical = ~uint64_t{0};
+        for (size_t p = 0; p < premises; ++p) {
+            premiseWords[p] = readLittleEndian(bytes, pos, 8);
+            critical &= premiseWords[p];
+        }
+        uint64_t conclusionWord = readLittleEndian(bytes, pos, 8);
+        uint64_t mask = rowCount - word * 64 >= 64 ? ~uint64_t{0} : (uint64_t{1} << (rowCount - word * 64)) - 1;
+        uint64_t written = conclusionWord;
+        for (uint64_t premiseWord : premiseWords) written |= premiseWord;
+        if (written & ~mask) fail(what, "bits past the end of the table in word " + std::to_string(word));
+        critical &= mask;
+        if (criticalOnly) {
+            // Only words with a critical row are written, masked to those rows
+            if (!critical) fail(what, "word " + std::to_string(word) + " has no critical row");
+            mask = critical;
+        }
+        for (unsigned bit = 0; bit < 64; ++bit) {
+            if (!((mask >> bit) & 1)) continue;
+            Row row;
+            row.row = word * 64 + bit;
+            for (uint64_t premiseWord : premiseWords) row.premises.push_back((premiseWord >> bit) & 1);
+            row.conclusion = (conclusionWord >> bit) & 1;
+            row.critical = (critical >> bit) & 1;
+            rows.push_back(row);
+        }
+    }
+    compareRows(table, "binary", criticalOnly, rows);
+}
+
+} // namespace
+
+int main() {
+    std::vector<Table> tables;
+    tables.push_back(makeTable("modus ponens", {"p -> q", "p"}, "q"));
+    tables.push_back(makeTable("three variables", {"p | q", "~q <-> r"}, "p & ~r"));
+    // Two words, the second with critical rows and the first without
+    tables.push_back(makeTable("seven variables", {"g", "a | b -> c", "d <-> ~e"}, "f | a"));
+
+    for (const Table& table : tables) {
+        for (bool criticalOnly : {false, true}) {
+            checkText(table, false, criticalOnly);
+            checkText(table, true, criticalOnly);
+            checkBinary(table, criticalOnly);
+        }
+    }
+
+    if (failures) {
+        std::cerr << failures << " mismatches\n";
+        return 1;
+    }
+    std::cout << tables.size() << " tables round-trip through every sink\n";
+    return 0;
+}
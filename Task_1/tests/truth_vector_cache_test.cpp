@@ -0,0 +1,200 @@
+/**
+ * @file truth_vector_cache_test.cpp
+ * @brief Tests of the persistent truth vector cache: file handling, canonical keys and eviction.
+ *
+ * Files that are not caches, or too small to hold one, have to be refused and left as they were.
+ * Expressions that differ only in operand order, double negation, duplicated operands or variable
+ * names have to share an entry, while the same expression over tables of different sizes, or
+ * different expressions, must not. Every answer read from the cache has to be that of the sweep,
+ * also when the index of the file points outside the data or at the wrong bytes.
+ */
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+#include "truth_table_generator.hpp"
+#include "truth_vector_cache.hpp"
+
+namespace {
+
+const char* const CACHE_PATH = "truth_vector_cache_test.cache";
+
+int failures = 0;
+
+void fail(const std::string& test, const std::string& message) {
+    std::cerr << test << ": " << message << "\n";
+    ++failures;
+}
+
+std::string readFile(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    std::stringstream bytes;
+    bytes << in.rdbuf();
+    return bytes.str();
+}
+
+TruthTableGenerator generator(const std::vector<std::string>& premises, const std::string& conclusion) {
+    ProblemBuilder builder;
+    for (const auto& premise : premises) builder.addPremise(premise);
+    builder.setConclusion(conclusion);
+    return TruthTableGenerator(builder.finish());
+}
+
+/**
+ * @brief Analyzes an argument through the cache and checks the answer and the lookups
+ * @param hits Lookups that have to hit, the others have to miss.
+ */
+void expectLookups(const std::string& test, TruthVectorCache& cache, const std::vector<std::string>& premises,
+                   const std::string& conclusion, size_t hits) {
+    TruthTableGenerator table = generator(premises, conclusion);
+    const TruthVectorCache::Statistics before = cache.statistics();
+    AnalysisResult cached = table.analyzeCached(cache);
+    const TruthVectorCache::Statistics after = cache.statistics();
+
+    AnalysisResult expected = table.analyze(BitSlicedEvaluator::Isa::SCALAR);
+    if (cached.isValid != expected.isValid || cached.isSatisfiable != expected.isSatisfiable ||
+        cached.criticalRows != expected.criticalRows || cached.counterexampleRows != expected.counterexampleRows) {
+        fail(test, "the cached analysis differs from the sweep");
+    }
+    const size_t lookups = premises.size() + 1;
+    if (after.hits - before.hits != hits || after.misses - before.misses != lookups - hits) {
+        fail(test, std::to_string(after.hits - before.hits) + " hits and " + std::to_string(after.misses - before.misses) +
+                   " misses, expected " + std::to_string(hits) + " and " + std::to_string(lookups - hits));
+    }
+}
+
+/**
+ * @brief Opening a file that must be refused, and left byte for byte as it was
+ */
+void expectRefused(const std::string& test, const std::string& contents, const std::string& expected) {
+    std::ofstream(CACHE_PATH, std::ios::binary) << contents;
+    try {
+        TruthVectorCache cache(CACHE_PATH, 1 << 20);
+        fail(test, "the file was opened as a cache");
+    } catch (const std::runtime_error& e) {
+        if (std::string(e.what()).find(expected) == std::string::npos) {
+            fail(test, std::string("error '") + e.what() + "', expected '" + expected + "'");
+        }
+    }
+    if (readFile(CACHE_PATH) != contents) fail(test, "the file was changed");
+    std::remove(CACHE_PATH);
+}
+
+void testFiles() {
+    expectRefused("foreign file", "p -> q\np\n=> q\n", "is not a cache file, refusing to overwrite it");
+    expectRefused("foreign file with a cache size", std::string(2 << 20, 'x'), "is not a cache file");
+    std::string small = "LOGICCH1";
+    small.resize(4000, '\0');
+    expectRefused("cache file too small for its index", small, "is too small");
+    expectRefused("cache file too small for its header", "LOGICCH1", "is too small");
+}
+
+/**
+ * @brief Equivalent forms share an entry, different expressions or tables do not
+ */
+void testKeys() {
+    std::remove(CACHE_PATH);
+    TruthVectorCache cache(CACHE_PATH, 1 << 20);
+    expectLookups("cold", cache, {"p & q", "p -> q"}, "p", 0);
+    expectLookups("commuted and doubly negated", cache, {"q & p", "(p -> q)"}, "~~p", 3);
+    expectLookups("duplicated operand", cache, {"(q & q) & p", "p -> (q | q)"}, "~(~p)", 3);
+    expectLookups("renamed variables", cache, {"b & a", "a -> b"}, "a", 3);
+    expectLookups("implication is not commutative", cache, {"q -> p"}, "~~~~q", 0);
+    expectLookups("other operators", cache, {"p | q", "q -> p", "p <-> q"}, "q", 2);
+
+    // One expression over tables of two sizes: different vectors, so different entries
+    expectLookups("wider table", cache, {"p & q", "r"}, "p", 0);
+    expectLookups("wider table, again", cache, {"q & p", "r"}, "p", 3);
+    expectLookups("narrower table, again", cache, {"p & q"}, "p", 2);
+}
+
+/**
+ * @brief Entries survive reopening, and a full cache evicts without changing any answer
+ */
+void testReopenAndEviction() {
+    {
+        TruthVectorCache cache(CACHE_PATH, 1 << 20);
+        expectLookups("reopened", cache, {"p & q", "p -> q"}, "p", 3);
+    }
+
+    // 20 variables take 128 KiB a vector, more than a 1 MiB cache holds at once
+    std::vector<std::string> variables;
+    for (int j = 0; j < 20; ++j) variables.push_back("v" + std::to_string(j));
+    std::vector<std::string> premises;
+    for (int i = 0; i < 12; ++i) {
+        premises.push_back(variables[i] + " | " + variables[(i + 7) % 20] + " -> ~" + variables[(i + 13) % 20]);
+    }
+    std::string all = variables[0];
+    for (int j = 1; j < 20; ++j) all += " | " + variables[j];
+    premises.push_back(all);
+
+    TruthVectorCache cache(CACHE_PATH, 1 << 20);
+    expectLookups("eviction", cache, premises, "v3 -> v4", 0);
+    if (cache.statistics().evicted == 0) fail("eviction", "nothing was evicted");
+    for (size_t i = 0; i < 4; ++i) {
+        TruthTableGenerator table = generator({premises[i], premises[i + 4]}, premises[i + 8]);
+        AnalysisResult cached = table.analyzeCached(cache), expected = table.analyze(BitSlicedEvaluator::Isa::SCALAR);
+        if (cached.criticalRows != expected.criticalRows || cached.counterexampleRows != expected.counterexampleRows) {
+            fail("after eviction", "the cached analysis differs from the sweep");
+        }
+    }
+    std::remove(CACHE_PATH);
+}
+
+/**
+ * @brief Index slots pointing outside the data area, past its end or into the middle of an entry are
+ *        misses, and the next insertion replaces them
+ */
+void testDamagedIndex() {
+    const std::vector<std::string> premises = {"p & q", "p -> q", "q | r"};
+    std::remove(CACHE_PATH);
+    {
+        TruthVectorCache cache(CACHE_PATH, 1 << 20);
+        expectLookups("before the damage", cache, premises, "p <-> r", 0);
+    }
+
+    // Layout of truth_vector_cache.hpp: a 4096-byte header, whose third word is the slot count, then
+    // slots of {key, offset, length, last use}
+    std::string bytes = readFile(CACHE_PATH);
+    auto get = [&](size_t pos) {
+        uint64_t value;
+        std::memcpy(&value, &bytes[pos], sizeof(value));
+        return value;
+    };
+    auto set = [&](size_t pos, uint64_t value) { std::memcpy(&bytes[pos], &value, sizeof(value)); };
+    size_t damaged = 0;
+    for (uint64_t i = 0, slots = get(16); i < slots; ++i) {
+        const size_t slot = 4096 + 32 * i;
+        if (get(slot) == 0) continue;
+        switch (damaged++ % 3) {
+            case 0: set(slot + 8, uint64_t{1} << 40); break; // Far outside the mapping
+            case 1: set(slot + 16, uint64_t{1} << 40); break; // Runs past the end of the data
+            default: set(slot + 8, get(slot + 8) + 8); break; // Into the middle of the entry
+        }
+    }
+    if (damaged != premises.size() + 1) fail("damaged index", std::to_string(damaged) + " slots, expected 4");
+    std::ofstream(CACHE_PATH, std::ios::binary) << bytes;
+
+    TruthVectorCache cache(CACHE_PATH, 1 << 20);
+    expectLookups("damaged index", cache, premises, "p <-> r", 0);
+    expectLookups("damaged entries replaced", cache, premises, "p <-> r", 4);
+    std::remove(CACHE_PATH);
+}
+
+} // namespace
+
+int main() {
+    testFiles();
+    testKeys();
+    testReopenAndEviction();
+    testDamagedIndex();
+
+    if (failures) {
+        std::cerr << failures << " failures\n";
+        return 1;
+    }
+    std::cout << "The cache refuses foreign files, shares entries between equivalent forms and evicts safely\n";
+    return 0;
+}
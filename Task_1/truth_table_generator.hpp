@@ -0,0 +1,1145 @@
+/**
+ * @file truth_table_generator.hpp
+ * @brief The truth table generator and every analysis engine of an argument.
+ */
+
+#ifndef LOGIC_TRUTH_TABLE_GENERATOR_HPP
+#define LOGIC_TRUTH_TABLE_GENERATOR_HPP
+
+#include "common.hpp"
+#include "expression.hpp"
+#include "problem.hpp"
+#include "evaluation.hpp"
+#include "table_sink.hpp"
+#include "sat_solver.hpp"
+#include "big_unsigned.hpp"
+#include "model_counter.hpp"
+#include "fragment_solver.hpp"
+#include "bdd.hpp"
+#include "truth_vector_cache.hpp"
+
+/**
+ * @class TruthTableGenerator
+ * @brief Generates and analyzes truth tables for logical expressions.
+ * 
+ * This class is responsible for generating truth tables for given logical expressions (premises and conclusion)
+ * and analyzing their validity and satisfiability. Every expression is compiled once by ExpressionCompiler and
+ * the compiled programs are then executed for all possible combinations of variable values.
+ */
+class TruthTableGenerator {
+public:
+    /**
+     * @brief Static variable orders for the BDD engine
+     */
+    enum class BddOrder {
+        NATURAL,    // Alphabetical, the order of the truth table columns
+        APPEARANCE, // Order of first appearance, reading the premises and then the conclusion
+        FREQUENCY   // Most frequently used variables first
+    };
+
+private:
+    std::vector<std::string> variables; // Names of the variables, the name of slot j is variables[j]
+    std::vector<CompiledExpression> compiledPremises; // Premises compiled over the variable slots
+    CompiledExpression compiledConclusion; // Conclusion compiled over the variable slots
+
+    /**
+     * @brief Takes over the variables and programs of a compiled problem
+     */
+    void load(Problem problem) {
+        variables = std::move(problem.variables);
+        compiledPremises = std::move(problem.premises);
+        compiledConclusion = std::move(problem.conclusion);
+    }
+
+    /**
+     * @brief Computes a static BDD variable order, root first
+     */
+    std::vector<uint32_t> staticOrder(BddOrder order) const {
+        std::vector<uint32_t> result;
+        if (order == BddOrder::APPEARANCE) {
+            std::vector<bool> placed(variables.size(), false);
+            auto visit = [&](const CompiledExpression& expression) {
+                for (const auto& ins : expression.code) {
+                    if (ins.op == CompiledExpression::OpCode::LOAD && !placed[ins.slot]) {
+                        placed[ins.slot] = true;
+                        result.push_back(ins.slot);
+                    }
+                }
+            };
+            for (const auto& premise : compiledPremises) visit(premise);
+            visit(compiledConclusion);
+            return result;
+        }
+
+        for (uint32_t slot = 0; slot < variables.size(); ++slot) result.push_back(slot);
+        if (order == BddOrder::FREQUENCY) {
+            std::vector<size_t> uses(variables.size(), 0);
+            for (const auto& premise : compiledPremises) {
+                for (const auto& ins : premise.code) {
+                    if (ins.op == CompiledExpression::OpCode::LOAD) ++uses[ins.slot];
+                }
+            }
+            for (const auto& ins : compiledConclusion.code) {
+                if (ins.op == CompiledExpression::OpCode::LOAD) ++uses[ins.slot];
+            }
+            std::stable_sort(result.begin(), result.end(), [&](uint32_t a, uint32_t b) { return uses[a] > uses[b]; });
+        }
+        return result;
+    }
+
+    /**
+     * @brief Decides Horn or 2-CNF premises and conclusion, see analyzeFragment
+     * @return False if satisfiability cannot be decided within the fragment.
+     */
+    bool analyzeClauses(FragmentSolver::Fragment fragment, const FragmentSolver::Clauses& premises,
+                        const FragmentSolver::Clauses& conclusion, AnalysisResult& result) const {
+        const bool horn = fragment == FragmentSolver::Fragment::HORN;
+        auto solve = [&](const FragmentSolver::Clauses& clauses, std::vector<bool>& model) {
+            return horn ? FragmentSolver::solveHorn(variables.size(), clauses, model)
+                        : FragmentSolver::solveTwoSat(variables.size(), clauses, model);
+        };
+        FragmentSolver::Clauses combined = premises;
+        combined.insert(combined.end(), conclusion.begin(), conclusion.end());
+        const bool combinedFits = horn ? FragmentSolver::isHorn(combined) : FragmentSolver::isTwoCnf(combined);
+
+        AnalysisResult analysis;
+        analysis.hasRowCounts = false;
+        // The lowest row over all queries is the first counterexample. The least model of a Horn query is
+        // its lowest row; a 2-CNF query has no least model, so its variables are fixed from the highest
+        // bit down, each to false unless that leaves the query unsatisfiable.
+        const bool lowest = variables.size() <= BitSlicedEvaluator::MAX_VARIABLES;
+        auto lowestTwoSatModel = [&](FragmentSolver::Clauses& clauses, std::vector<bool>& model) {
+            const size_t size = clauses.size();
+            std::vector<bool> trial;
+            for (size_t j = variables.size(); j-- > 0;) {
+                const uint32_t variable = static_cast<uint32_t>(j);
+                clauses.push_back({SatSolver::negative(variable)});
+                if (!model[j]) continue; // The current model already has it false
+                if (FragmentSolver::solveTwoSat(variables.size(), clauses, trial)) {
+                    model.swap(trial);
+                } else {
+                    clauses.back() = {SatSolver::positive(variable)};
+                }
+            }
+            clauses.resize(size);
+        };
+        FragmentSolver::Clauses query = premises;
+        std::vector<bool> model;
+        for (const auto& clause : conclusion) {
+            query.resize(premises.size());
+            for (SatSolver::Literal literal : clause) query.push_back({SatSolver::negate(literal)});
+            if (!solve(query, model)) continue;
+            analysis.isValid = false;
+            if (lowest && !horn) lowestTwoSatModel(query, model);
+            if (!lowest) {
+                analysis.counterexample = model;
+                break;
+            }
+            uint64_t row = 0;
+            for (size_t j = 0; j < model.size(); ++j) {
+                if (model[j]) row |= uint64_t{1} << j;
+            }
+            analysis.firstCounterexample = std::min(analysis.firstCounterexample, row);
+        }
+
+        if (combinedFits) {
+            analysis.isSatisfiable = solve(combined, model);
+        } else if (conclusion.size() == 1) { // Satisfiable with one of the literals of the clause
+            for (SatSolver::Literal literal : conclusion[0]) {
+                query.resize(premises.size());
+                query.push_back({literal});
+                if (solve(query, model)) {
+                    analysis.isSatisfiable = true;
+                    break;
+                }
+            }
+        } else if (analysis.isValid) { // Satisfiable exactly when the premises are
+            analysis.isSatisfiable = solve(premises, model);
+        } else {
+            return false;
+        }
+        result = std::move(analysis);
+        return true;
+    }
+
+    /**
+     * @brief Decides and counts parity premises and conclusion, see analyzeFragment
+     */
+    void analyzeParity(const std::vector<FragmentSolver::Equation>& premises,
+                       const std::vector<FragmentSolver::Equation>& conclusion, AnalysisResult& result) const {
+        const size_t n = variables.size();
+        FragmentSolver::ParitySystem system(n);
+        for (const auto& equation : premises) system.add(equation);
+
+        AnalysisResult analysis;
+        analysis.hasRowCounts = n <= BitSlicedEvaluator::MAX_VARIABLES;
+        for (const auto& equation : conclusion) {
+            FragmentSolver::ParitySystem failing(system);
+            FragmentSolver::Equation negated = equation;
+            negated.value = !negated.value;
+            if (!failing.add(std::move(negated))) continue;
+            analysis.isValid = false;
+            if (!analysis.hasRowCounts) {
+                analysis.counterexample = failing.solution();
+                break;
+            }
+            std::vector<bool> model = failing.lowestSolution();
+            uint64_t row = 0;
+            for (size_t j = 0; j < n; ++j) {
+                if (model[j]) row |= uint64_t{1} << j;
+            }
+            analysis.firstCounterexample = std::min(analysis.firstCounterexample, row);
+        }
+
+        FragmentSolver::ParitySystem holding(system);
+        for (const auto& equation : conclusion) holding.add(equation);
+        analysis.isSatisfiable = holding.isConsistent();
+        if (analysis.hasRowCounts) {
+            // A consistent system of rank r over n variables has 2^(n - r) solutions
+            analysis.criticalRows = system.isConsistent() ? uint64_t{1} << (n - system.rank()) : 0;
+            uint64_t holdingRows = holding.isConsistent() ? uint64_t{1} << (n - holding.rank()) : 0;
+            analysis.counterexampleRows = analysis.criticalRows - holdingRows;
+        }
+        result = std::move(analysis);
+    }
+
+public:
+    /**
+     * @brief Constructor initializing with premises and conclusion.
+     * 
+     * This constructor initializes the premises and conclusion, extracts the variables and
+     * compiles every expression, so malformed input is reported before any row is printed.
+     * 
+     * @param p The list of premises (logical expressions).
+     * @param c The conclusion (logical expression).
+     * @throws std::runtime_error If any expression is malformed.
+     */
+    TruthTableGenerator(const std::vector<std::string>& p, const std::string& c) {
+        ProblemBuilder builder; // Parse every expression once
+        for (const auto& premise : p) builder.addPremise(premise);
+        builder.setConclusion(c);
+        load(builder.finish());
+    }
+
+    /**
+     * @brief Constructor for a problem that has already been compiled, such as a problem file.
+     */
+    explicit TruthTableGenerator(Problem problem) {
+        load(std::move(problem));
+    }
+
+    /**
+     * @brief Returns the number of distinct variables, the columns of the table
+     */
+    size_t variableCount() const {
+        return variables.size();
+    }
+
+    const std::vector<CompiledExpression>& premisePrograms() const {
+        return compiledPremises;
+    }
+
+    const CompiledExpression& conclusionProgram() const {
+        return compiledConclusion;
+    }
+
+    /**
+     * @brief Names of the variables; variable j is bit j of a row number
+     */
+    const std::vector<std::string>& variableNames() const {
+        return variables;
+    }
+
+    /**
+     * @brief Returns a lazy generator of the rows of the truth table, for use as a library.
+     *
+     * Nothing is printed and no more than one batch of 64 rows is held at a time. The generator can
+     * outlive this object.
+     *
+     * @throws std::runtime_error If there are too many variables to enumerate.
+     */
+    RowGenerator rows() const {
+        return RowGenerator(compiledPremises, compiledConclusion, variables.size());
+    }
+
+    /**
+     * @brief Generates and analyzes the truth table.
+     * 
+     * This function generates the truth table by evaluating all possible combinations of variable values.
+     * It also analyzes the results to determine the validity and satisfiability of the logical expressions.
+     * 
+     * The process involves:
+     * - Printing the header of the truth table.
+     * - Iterating through all possible combinations of variable values.
+     * - Evaluating each premise and the conclusion for each combination.
+     * - Printing the results in the truth table.
+     * - Analyzing the results to determine validity and satisfiability.
+     */
+    void generateAndAnalyze() {
+        ConsoleTableSink sink; // The interactive colored table
+        generateAndAnalyze(sink);
+    }
+
+    /**
+     * @brief Generates the truth table into a sink and prints the analysis.
+     *
+     * Rows are evaluated 64 at a time and handed to the sink word by word, so memory use does not
+     * depend on the size of the table.
+     *
+     * @param sink Destination of the rows.
+     */
+    void generateAndAnalyze(TableSink& sink) {
+        Instrumentation::Scope timer(Instrumentation::Phase::NONE, "truth table");
+        RowGenerator rows = this->rows();
+        AnalysisResult result; // Validity and satisfiability of the rows seen so far
+        // 1 << n is equivalent to 2^n, which is the total number of combinations for n variables
+        const uint64_t combinations = uint64_t{1} << variables.size(); // Total number of combinations (2^n)
+
+        sink.begin(variables, compiledPremises.size(), combinations); // Print the header of the truth table
+
+        // With instrumentation, every word is split into evaluation and output time
+        const bool timed = Instrumentation::enabled();
+        uint64_t evaluateTime = 0;
+        uint64_t outputTime = 0;
+
+        // Evaluate 64 combinations at a time; bit r of each result word belongs to combination word * 64 + r
+        RowGenerator::Batch batch;
+        uint64_t start = timed ? Instrumentation::now() : 0;
+        while (rows.next(batch)) {
+            uint64_t evaluated = timed ? Instrumentation::now() : 0;
+            sink.writeWord(batch.word, batch.rowMask, batch.premises, batch.conclusion, batch.critical);
+            if (timed) {
+                evaluateTime += evaluated - start;
+                start = Instrumentation::now();
+                outputTime += start - evaluated;
+            }
+
+            // A critical row (all premises true) with a false conclusion makes the argument invalid
+            result.addWord(batch.word, batch.critical, batch.counterexamples());
+        }
+        uint64_t ending = timed ? Instrumentation::now() : 0;
+        sink.end();
+        if (timed) {
+            outputTime += Instrumentation::now() - ending;
+            Instrumentation::addTime(Instrumentation::Phase::EVALUATE, evaluateTime);
+            Instrumentation::addTime(Instrumentation::Phase::OUTPUT, outputTime);
+        }
+
+        // Print the analysis results
+        printAnalysis(result);
+    }
+
+    /**
+     * @brief Analyzes validity and satisfiability without printing the truth table.
+     *
+     * Rows are evaluated 64 (scalar), 256 (AVX2) or 512 (AVX-512) at a time.
+     *
+     * @param isa Instruction set of the sweep, defaults to the widest one the CPU supports.
+     * @return The analysis of the whole truth table.
+     */
+    AnalysisResult analyze(BitSlicedEvaluator::Isa isa = BitSlicedEvaluator::detectIsa()) const {
+        Instrumentation::Scope timer(Instrumentation::Phase::EVALUATE, "sweep");
+        return BitSlicedEvaluator(compiledPremises, compiledConclusion, variables.size(), isa).sweep();
+    }
+
+    /**
+     * @brief Analyzes validity and satisfiability on all workers of a pool.
+     *
+     * The table is split into chunks of words that the workers sweep in parallel. With stopEarly, once a
+     * counterexample has been found and satisfiability is settled, chunks that start after the lowest
+     * counterexample found so far are skipped. Every chunk before the final lowest counterexample is still
+     * swept, so the reported counterexample is always the lowest one, whatever the scheduling.
+     *
+     * @param pool The workers to run on.
+     * @param stopEarly Skip the rest of the table once the verdicts are known (the row counts are then incomplete).
+     * @param isa Instruction set of the sweep, defaults to the widest one the CPU supports.
+     * @param budget Time limit, checked per chunk by the workers.
+     * @return The analysis of the truth table.
+     * @throws Budget::Exceeded If the time limit passes.
+     */
+    AnalysisResult analyzeParallel(WorkStealingPool& pool, bool stopEarly = true,
+                                   BitSlicedEvaluator::Isa isa = BitSlicedEvaluator::detectIsa(),
+                                   const Budget& budget = Budget::unlimited()) const {
+        Instrumentation::Scope timer(Instrumentation::Phase::EVALUATE, "parallel sweep");
+        BitSlicedEvaluator evaluator(compiledPremises, compiledConclusion, variables.size(), isa);
+        const uint64_t words = evaluator.wordCount();
+
+        // Several chunks per worker for balance, but small enough for a quick stop; always a multiple of 8 words
+        uint64_t chunkWords = 8;
+        while (chunkWords < (uint64_t{1} << 14) && chunkWords * pool.size() * 16 < words) {
+            chunkWords *= 2;
+        }
+        const uint64_t chunks = (words + chunkWords - 1) / chunkWords;
+
+        std::vector<AnalysisResult> results(chunks);
+        std::atomic<uint64_t> lowestCounterexample(AnalysisResult::NO_ROW);
+        std::atomic<bool> satisfiable(false);
+
+        pool.run(chunks, [&](size_t chunk, size_t) {
+            uint64_t firstWord = chunk * chunkWords;
+            if (stopEarly && satisfiable.load(std::memory_order_relaxed) &&
+                firstWord * 64 > lowestCounterexample.load(std::memory_order_relaxed)) {
+                results[chunk].isComplete = false; // Nothing in this chunk can change the verdicts
+                return;
+            }
+
+            budget.check();
+            Instrumentation::Scope chunkTimer(Instrumentation::Phase::NONE, "sweep chunk");
+            AnalysisResult& result = results[chunk];
+            result = evaluator.sweep(firstWord, std::min(chunkWords, words - firstWord));
+            if (result.isSatisfiable) {
+                satisfiable.store(true, std::memory_order_relaxed);
+            }
+            uint64_t lowest = lowestCounterexample.load(std::memory_order_relaxed);
+            while (result.firstCounterexample < lowest &&
+                   !lowestCounterexample.compare_exchange_weak(lowest, result.firstCounterexample)) {
+            }
+        });
+
+        AnalysisResult merged;
+        for (const auto& result : results) {
+            merged.merge(result);
+        }
+        return merged;
+    }
+
+    /**
+     * @brief Analyzes the whole truth table in Gray-code order with incremental re-evaluation.
+     *
+     * The Gray sequence is split into chunks that the workers of the pool sweep in parallel; each chunk
+     * evaluates its first word completely and then only the subexpressions each flip reaches. The row
+     * counts and the lowest counterexample are always exact.
+     *
+     * @param pool The workers to run on.
+     * @param nodesPerWord Receives the average number of nodes re-evaluated per word and the node count, if not null.
+     * @param budget Time limit, checked per chunk by the workers.
+     * @return The analysis of the truth table.
+     * @throws Budget::Exceeded If the time limit passes.
+     */
+    AnalysisResult analyzeGray(WorkStealingPool& pool, std::pair<double, size_t>* nodesPerWord = nullptr,
+                               const Budget& budget = Budget::unlimited()) const {
+        Instrumentation::Scope timer(Instrumentation::Phase::EVALUATE, "gray sweep");
+        GrayCodeEvaluator evaluator(compiledPremises, compiledConclusion, variables.size());
+        const uint64_t words = evaluator.wordCount();
+        uint64_t chunkWords = 64;
+        while (chunkWords < (uint64_t{1} << 16) && chunkWords * pool.size() * 16 < words) {
+            chunkWords *= 2;
+        }
+        const uint64_t chunks = (words + chunkWords - 1) / chunkWords;
+
+        std::vector<AnalysisResult> results(chunks);
+        pool.run(chunks, [&](size_t chunk, size_t) {
+            budget.check();
+            Instrumentation::Scope chunkTimer(Instrumentation::Phase::NONE, "gray chunk");
+            uint64_t first = chunk * chunkWords;
+            results[chunk] = evaluator.sweep(first, std::min(chunkWords, words - first));
+        });
+
+        AnalysisResult merged;
+        for (const auto& result : results) {
+            merged.merge(result);
+        }
+        if (nodesPerWord) *nodesPerWord = {evaluator.averageNodesPerWord(), evaluator.nodeCount()};
+        return merged;
+    }
+
+    /**
+     * @brief Premises and variables that share no variable with the rest of the argument
+     */
+    struct Component {
+        std::vector<uint32_t> slots; // Variable slots, ascending
+        std::vector<size_t> premises; // Indices of the premises
+        bool hasConclusion = false;
+    };
+
+    /**
+     * @brief Splits the argument into the connected components of its variable-sharing graph.
+     *
+     * Two variables are connected if some premise or the conclusion uses both. An expression without
+     * variables joins the component of the conclusion.
+     *
+     * @return The components in order of their lowest variable slot; the argument itself if it does not split.
+     */
+    std::vector<Component> components() const {
+        std::vector<uint32_t> parent(variables.size());
+        for (uint32_t j = 0; j < parent.size(); ++j) parent[j] = j;
+        auto find = [&](uint32_t j) {
+            while (parent[j] != j) j = parent[j] = parent[parent[j]];
+            return j;
+        };
+        // First variable of an expression, or -1 for an expression without variables
+        auto join = [&](const CompiledExpression& expression) {
+            int64_t first = -1;
+            for (const auto& ins : expression.code) {
+                if (ins.op != CompiledExpression::OpCode::LOAD) continue;
+                if (first < 0) first = ins.slot;
+                else parent[find(ins.slot)] = find(static_cast<uint32_t>(first));
+            }
+            return first;
+        };
+        std::vector<int64_t> firstSlot;
+        for (const auto& premise : compiledPremises) firstSlot.push_back(join(premise));
+        int64_t conclusionSlot = join(compiledConclusion);
+
+        std::vector<Component> parts;
+        std::vector<size_t> partOfRoot(variables.size(), SIZE_MAX);
+        for (uint32_t j = 0; j < variables.size(); ++j) {
+            size_t& part = partOfRoot[find(j)];
+            if (part == SIZE_MAX) {
+                part = parts.size();
+                parts.emplace_back();
+            }
+            parts[part].slots.push_back(j);
+        }
+        if (parts.empty()) parts.emplace_back();
+        size_t conclusionPart = conclusionSlot < 0 ? 0 : partOfRoot[find(static_cast<uint32_t>(conclusionSlot))];
+        parts[conclusionPart].hasConclusion = true;
+        for (size_t i = 0; i < firstSlot.size(); ++i) {
+            size_t part = firstSlot[i] < 0 ? conclusionPart : partOfRoot[find(static_cast<uint32_t>(firstSlot[i]))];
+            parts[part].premises.push_back(i);
+        }
+        return parts;
+    }
+
+    /**
+     * @brief Analyzes every component on its own and combines the results exactly.
+     *
+     * A table over independent components is the product of their tables, so instead of 2^n rows only
+     * the sum of 2^(size of each component) rows is swept. A component without the conclusion is swept
+     * with a false conclusion, which makes its counterexamples its critical rows. The argument has a
+     * counterexample if every such component has a critical row and the conclusion's component has a
+     * counterexample, and the row counts multiply. The lowest counterexample is the lowest row of each
+     * component put together, since the components set disjoint bits of the row index. The chunks of
+     * all components are swept on the pool together.
+     *
+     * With more than 63 variables in total the rows cannot be numbered, so the counts are left out and
+     * the counterexample is reported as an assignment.
+     *
+     * @param pool The workers to run on.
+     * @param parts The components, as returned by components().
+     * @param isa Instruction set of the sweep, defaults to the widest one the CPU supports.
+     * @param budget Time limit, checked per chunk by the workers.
+     * @return The analysis of the whole truth table.
+     * @throws std::runtime_error If a single component has too many variables to enumerate.
+     * @throws Budget::Exceeded If the time limit passes.
+     */
+    AnalysisResult analyzeComponents(WorkStealingPool& pool, const std::vector<Component>& parts,
+                                     BitSlicedEvaluator::Isa isa = BitSlicedEvaluator::detectIsa(),
+                                     const Budget& budget = Budget::unlimited()) const {
+        Instrumentation::Scope timer(Instrumentation::Phase::EVALUATE, "component sweep");
+        std::vector<uint32_t> localSlot(variables.size());
+        std::vector<BitSlicedEvaluator> evaluators;
+        uint64_t totalWords = 0;
+        for (const Component& part : parts) {
+            for (uint32_t k = 0; k < part.slots.size(); ++k) localSlot[part.slots[k]] = k;
+            std::vector<CompiledExpression> premises;
+            for (size_t i : part.premises) {
+                premises.push_back(compiledPremises[i]);
+                premises.back().remapSlots(localSlot);
+            }
+            CompiledExpression conclusion = part.hasConclusion ? compiledConclusion : CompiledExpression::constant(false);
+            conclusion.remapSlots(localSlot);
+            evaluators.emplace_back(premises, conclusion, part.slots.size(), isa);
+            totalWords += evaluators.back().wordCount();
+        }
+
+        // Chunks of every component in one job, sized as in analyzeParallel by the total work
+        uint64_t chunkWords = 8;
+        while (chunkWords < (uint64_t{1} << 14) && chunkWords * pool.size() * 16 < totalWords) {
+            chunkWords *= 2;
+        }
+        std::vector<std::pair<size_t, uint64_t>> chunks; // Component and first word
+        for (size_t p = 0; p < parts.size(); ++p) {
+            for (uint64_t w = 0; w < evaluators[p].wordCount(); w += chunkWords) chunks.push_back({p, w});
+        }
+        std::vector<AnalysisResult> chunkResults(chunks.size());
+        pool.run(chunks.size(), [&](size_t chunk, size_t) {
+            budget.check();
+            Instrumentation::Scope chunkTimer(Instrumentation::Phase::NONE, "component chunk");
+            const BitSlicedEvaluator& evaluator = evaluators[chunks[chunk].first];
+            uint64_t first = chunks[chunk].second;
+            chunkResults[chunk] = evaluator.sweep(first, std::min(chunkWords, evaluator.wordCount() - first));
+        });
+        std::vector<AnalysisResult> results(parts.size());
+        for (size_t chunk = 0; chunk < chunks.size(); ++chunk) {
+            results[chunks[chunk].first].merge(chunkResults[chunk]);
+        }
+
+        const bool numbered = variables.size() <= BitSlicedEvaluator::MAX_VARIABLES;
+        size_t conclusionPart = 0;
+        bool premisesHold = true; // Every component without the conclusion has a critical row
+        uint64_t otherRows = 1;
+        for (size_t p = 0; p < parts.size(); ++p) {
+            if (parts[p].hasConclusion) {
+                conclusionPart = p;
+                continue;
+            }
+            premisesHold = premisesHold && results[p].criticalRows > 0;
+            otherRows *= results[p].criticalRows;
+        }
+        const AnalysisResult& withConclusion = results[conclusionPart];
+
+        AnalysisResult result;
+        result.isValid = !premisesHold || withConclusion.isValid;
+        result.isSatisfiable = premisesHold && withConclusion.isSatisfiable;
+        if (numbered) {
+            result.criticalRows = otherRows * withConclusion.criticalRows;
+            result.counterexampleRows = otherRows * withConclusion.counterexampleRows;
+        } else {
+            result.hasRowCounts = false;
+        }
+        if (!result.isValid) {
+            // The lowest counterexample of the conclusion's component with the lowest critical row of every other
+            std::vector<bool> assignment(variables.size());
+            uint64_t row = 0;
+            for (size_t p = 0; p < parts.size(); ++p) {
+                for (size_t k = 0; k < parts[p].slots.size(); ++k) {
+                    bool value = (results[p].firstCounterexample >> k) & 1;
+                    assignment[parts[p].slots[k]] = value;
+                    if (numbered && value) row |= uint64_t{1} << parts[p].slots[k];
+                }
+            }
+            if (numbered) {
+                result.firstCounterexample = row;
+            } else {
+                result.counterexample = std::move(assignment);
+            }
+        }
+        return result;
+    }
+
+    /**
+     * @brief Prints how the argument was split
+     */
+    void printComponents(const std::vector<Component>& parts) const {
+        std::cout << Colors::YELLOW << Colors::BOLD << "Components:" << Colors::RESET << " " << parts.size()
+                  << " independent (";
+        for (size_t p = 0; p < parts.size(); ++p) {
+            std::cout << (p ? " + " : "") << parts[p].slots.size();
+        }
+        std::cout << " variables)\n";
+    }
+
+    /**
+     * @brief Analyzes the whole table from cached truth vectors, evaluating only the expressions the cache misses.
+     *
+     * Every premise and the conclusion is looked up by its normalized program; hits are used in place in
+     * the cache mapping, misses are evaluated together on one shared DAG and stored afterwards. The
+     * analysis is then a bitwise pass over the vectors.
+     *
+     * @param cache The cache to read and fill.
+     * @return The analysis of the whole truth table, with exact row counts.
+     * @throws std::runtime_error If there are more variables than the cache holds vectors for.
+     */
+    AnalysisResult analyzeCached(TruthVectorCache& cache) const {
+        Instrumentation::Scope timer(Instrumentation::Phase::EVALUATE, "cached analysis");
+        if (variables.size() > TruthVectorCache::MAX_VARIABLES) {
+            throw std::runtime_error("Too many variables for the cache (at most " +
+                                     std::to_string(TruthVectorCache::MAX_VARIABLES) + ")");
+        }
+        const size_t n = variables.size();
+        std::vector<const CompiledExpression*> expressions; // The premises, then the conclusion
+        for (const auto& premise : compiledPremises) expressions.push_back(&premise);
+        expressions.push_back(&compiledConclusion);
+
+        AnalysisResult result;
+        std::vector<size_t> missed;
+        std::vector<std::vector<uint64_t>> computed;
+        {
+            TruthVectorCache::Lock shared(cache, false); // Keeps the hits in place until the sweep is done
+            std::vector<const uint64_t*> truth(expressions.size());
+            for (size_t i = 0; i < expressions.size(); ++i) {
+                truth[i] = cache.find(*expressions[i], n);
+                if (!truth[i]) missed.push_back(i);
+            }
+
+            if (!missed.empty()) {
+                // Evaluate the misses as the premises of one evaluator, so they share subexpressions
+                std::vector<CompiledExpression> programs;
+                for (size_t i : missed) programs.push_back(*expressions[i]);
+                BitSlicedEvaluator evaluator(programs, CompiledExpression::constant(true), n);
+                computed.assign(missed.size(), std::vector<uint64_t>(evaluator.wordCount()));
+                std::vector<uint64_t> words(missed.size());
+                std::vector<uint64_t> scratch;
+                uint64_t unused;
+                for (uint64_t w = 0; w < evaluator.wordCount(); ++w) {
+                    evaluator.evaluateWord(w, words.data(), unused, scratch);
+                    for (size_t m = 0; m < missed.size(); ++m) computed[m][w] = words[m];
+                }
+                if (Instrumentation::enabled()) evaluator.countWords(evaluator.wordCount());
+                for (size_t m = 0; m < missed.size(); ++m) truth[missed[m]] = computed[m].data();
+            }
+
+            const uint64_t words = n <= 6 ? 1 : uint64_t{1} << (n - 6);
+            const uint64_t mask = n >= 6 ? ~0ull : (uint64_t{1} << (uint64_t{1} << n)) - 1;
+            const uint64_t* conclusion = truth.back();
+            for (uint64_t w = 0; w < words; ++w) {
+                uint64_t critical = mask;
+                for (size_t i = 0; i + 1 < truth.size(); ++i) critical &= truth[i][w];
+                result.addWord(w, critical, critical & ~conclusion[w]);
+            }
+        }
+
+        if (!missed.empty()) {
+            TruthVectorCache::Lock exclusive(cache, true);
+            for (size_t m = 0; m < missed.size(); ++m) cache.insert(*expressions[missed[m]], n, computed[m]);
+        }
+        return result;
+    }
+
+    /**
+     * @brief Prints the cache lookups and changes of an analysis
+     */
+    void printCacheStatistics(const TruthVectorCache::Statistics& stats) const {
+        std::cout << Colors::YELLOW << Colors::BOLD << "Cache:" << Colors::RESET
+                  << " " << stats.hits << " hits, " << stats.misses << " misses, " << stats.stored << " stored, "
+                  << stats.evicted << " evicted\n";
+    }
+
+    /**
+     * @brief Searches for a counterexample conclusion first, skipping premises once a word has no candidate row.
+     *
+     * @param needSatisfiable Also decide satisfiability; otherwise the sweep ends at the first counterexample.
+     * @param stats Receives what the sweep did, if not null.
+     * @return The verdicts and the lowest counterexample; rows are not counted.
+     */
+    AnalysisResult analyzeShortCircuit(bool needSatisfiable = true, ShortCircuitEvaluator::Statistics* stats = nullptr) const {
+        Instrumentation::Scope timer(Instrumentation::Phase::EVALUATE, "short circuit");
+        return ShortCircuitEvaluator(compiledPremises, compiledConclusion, variables.size()).sweep(needSatisfiable, stats);
+    }
+
+    /**
+     * @brief Decides validity and satisfiability with the CDCL SAT solver instead of enumerating rows.
+     *
+     * The premises and conclusion are Tseitin-encoded once and every premise is asserted. The argument
+     * is valid if the clauses are unsatisfiable under the assumption that the conclusion is false, and
+     * satisfiable if they are satisfiable under the assumption that it is true.
+     *
+     * @param stats Receives the solver statistics, if not null.
+     * @param budget Time limit of the search.
+     * @return The verdicts, with a counterexample if the argument is not valid; rows are not counted.
+     * @throws Budget::Exceeded If the time limit passes.
+     */
+    AnalysisResult analyzeSat(SatSolver::Statistics* stats = nullptr, const Budget& budget = Budget::unlimited()) const {
+        Instrumentation::Scope timer(Instrumentation::Phase::EVALUATE, "sat");
+        SatSolver solver;
+        solver.setBudget(budget);
+        TseitinEncoder encoder(solver, variables.size());
+        for (const auto& premise : compiledPremises) {
+            encoder.assertExpression(premise);
+        }
+        SatSolver::Literal conclusionLiteral = encoder.encode(compiledConclusion);
+
+        AnalysisResult result;
+        result.hasRowCounts = false;
+        if (solver.solve({SatSolver::negate(conclusionLiteral)}) == SatSolver::Result::SATISFIABLE) {
+            result.isValid = false;
+            result.counterexample.resize(variables.size());
+            for (size_t j = 0; j < variables.size(); ++j) {
+                result.counterexample[j] = solver.modelValue(static_cast<uint32_t>(j));
+            }
+        }
+        result.isSatisfiable = solver.solve({conclusionLiteral}) == SatSolver::Result::SATISFIABLE;
+
+        if (stats) *stats = solver.statistics();
+        return result;
+    }
+
+    /**
+     * @brief Decides the argument in polynomial time if it lies in a tractable fragment.
+     *
+     * The premises and conclusion are rewritten as Horn clauses, 2-CNF or parity equations, in that
+     * order of preference. The argument is valid if the premises together with the negation of each
+     * conclusion clause (a set of unit clauses, which stays in the fragment) or of each conclusion
+     * equation have no model. For parity systems the rows are also counted, from the ranks of the
+     * premises alone and of the premises with the conclusion.
+     *
+     * @param result Receives the verdicts; the row counts and the lowest counterexample only from parity
+     *               systems and Horn clauses of at most 63 variables.
+     * @param fragment Receives the fragment that was used.
+     * @return False if the argument is not in a fragment, result is then unchanged.
+     */
+    bool analyzeFragment(AnalysisResult& result, FragmentSolver::Fragment& fragment) const {
+        Instrumentation::Scope timer(Instrumentation::Phase::EVALUATE, "fragment");
+        FragmentSolver::Clauses premises, conclusion, clauses;
+        bool clausal = FragmentSolver::toClauses(compiledConclusion, conclusion);
+        for (const auto& premise : compiledPremises) {
+            if (!clausal || !FragmentSolver::toClauses(premise, clauses)) {
+                clausal = false;
+                break;
+            }
+            premises.insert(premises.end(), clauses.begin(), clauses.end());
+        }
+        if (clausal && FragmentSolver::isHorn(premises)) {
+            fragment = FragmentSolver::Fragment::HORN;
+            if (analyzeClauses(fragment, premises, conclusion, result)) return true;
+        }
+        if (clausal && FragmentSolver::isTwoCnf(premises)) {
+            fragment = FragmentSolver::Fragment::TWO_SAT;
+            if (analyzeClauses(fragment, premises, conclusion, result)) return true;
+        }
+
+        std::vector<FragmentSolver::Equation> premiseEquations, conclusionEquations, equations;
+        if (!FragmentSolver::toParity(compiledConclusion, conclusionEquations)) return false;
+        for (const auto& premise : compiledPremises) {
+            if (!FragmentSolver::toParity(premise, equations)) return false;
+            premiseEquations.insert(premiseEquations.end(), equations.begin(), equations.end());
+        }
+        fragment = FragmentSolver::Fragment::XOR;
+        analyzeParity(premiseEquations, conclusionEquations, result);
+        return true;
+    }
+
+    /**
+     * @brief Statistics and exact counts of a BDD analysis
+     */
+    struct BddStatistics {
+        size_t peakNodes = 0;
+        size_t finalNodes = 0; // Nodes of the premises, conclusion and critical diagrams
+        uint64_t cacheLookups = 0;
+        uint64_t cacheHits = 0;
+        BigUnsigned criticalRows; // Rows where all premises are true
+        BigUnsigned counterexampleRows; // Critical rows where the conclusion is false
+        std::vector<uint32_t> order; // Final variable order, root first
+    };
+
+    /**
+     * @brief Decides and counts the argument with reduced ordered binary decision diagrams.
+     *
+     * The conjunction P of the premises and the conclusion C are built as BDDs. The argument is valid if
+     * P & ~C is the false node and satisfiable if P & C is not; the critical and counterexample rows are
+     * counted exactly from the diagrams, without enumerating them.
+     *
+     * @param order Static variable order to start from.
+     * @param sift Reorder the variables by sifting while the diagrams grow and once they are built.
+     * @param stats Receives the statistics and exact counts, if not null.
+     * @param budget Time limit of building the diagrams.
+     * @return The verdicts, the lowest counterexample and, for at most 63 variables, the row counts.
+     * @throws Budget::Exceeded If the time limit passes.
+     */
+    AnalysisResult analyzeBdd(BddOrder order = BddOrder::APPEARANCE, bool sift = false,
+                              BddStatistics* stats = nullptr, const Budget& budget = Budget::unlimited()) const {
+        Instrumentation::Scope timer(Instrumentation::Phase::EVALUATE, "bdd");
+        BddManager manager(variables.size(), staticOrder(order));
+        manager.setAutoSift(sift);
+        manager.setBudget(budget);
+
+        uint32_t premisesNode = BddManager::TRUE_NODE;
+        for (const auto& premise : compiledPremises) {
+            uint32_t node = manager.build(premise);
+            manager.ref(node);
+            uint32_t conjunction = manager.conjoin(premisesNode, node);
+            manager.ref(conjunction);
+            manager.deref(node);
+            manager.deref(premisesNode);
+            premisesNode = conjunction;
+            manager.maybeCollect();
+        }
+        uint32_t conclusionNode = manager.build(compiledConclusion);
+        manager.ref(conclusionNode);
+        if (sift) manager.sift();
+
+        uint32_t failing = manager.conjoin(premisesNode, manager.negate(conclusionNode));
+        manager.ref(failing);
+        uint32_t holding = manager.conjoin(premisesNode, conclusionNode);
+
+        AnalysisResult result;
+        result.isValid = failing == BddManager::FALSE_NODE;
+        result.isSatisfiable = holding != BddManager::FALSE_NODE;
+        BigUnsigned criticalRows = manager.satCount(premisesNode);
+        BigUnsigned counterexampleRows = manager.satCount(failing);
+        result.hasRowCounts = variables.size() <= BitSlicedEvaluator::MAX_VARIABLES;
+        if (result.hasRowCounts) {
+            result.criticalRows = criticalRows.toUint64();
+            result.counterexampleRows = counterexampleRows.toUint64();
+        }
+        if (manager.lowestAssignment(failing, result.counterexample) && result.hasRowCounts) {
+            result.firstCounterexample = 0;
+            for (size_t j = 0; j < variables.size(); ++j) {
+                if (result.counterexample[j]) result.firstCounterexample |= uint64_t{1} << j;
+            }
+        }
+
+        if (stats) {
+            stats->peakNodes = manager.peakNodeCount();
+            stats->finalNodes = manager.reachableNodes();
+            stats->cacheLookups = manager.cacheLookupCount();
+            stats->cacheHits = manager.cacheHitCount();
+            stats->criticalRows = criticalRows;
+            stats->counterexampleRows = counterexampleRows;
+            stats->order = manager.order();
+        }
+        return result;
+    }
+
+    /**
+     * @brief Prints the statistics and exact counts of a BDD analysis
+     */
+    void printBddStatistics(const BddStatistics& stats) const {
+        double hitRate = stats.cacheLookups ? 100.0 * stats.cacheHits / stats.cacheLookups : 0.0;
+        std::cout << Colors::YELLOW << Colors::BOLD << "BDD:" << Colors::RESET
+                  << " peak " << stats.peakNodes << " nodes, " << stats.finalNodes << " nodes at the end, "
+                  << "cache hit rate " << std::fixed << std::setprecision(1) << hitRate << "%"
+                  << std::defaultfloat << " (" << stats.cacheLookups << " lookups)\n";
+        std::cout << "Exact critical rows: " << stats.criticalRows.toString()
+                  << " (" << stats.counterexampleRows.toString() << " with a false conclusion)\n";
+        std::cout << "Variable order:";
+        for (uint32_t slot : stats.order) std::cout << " " << variables[slot];
+        std::cout << "\n";
+    }
+
+    /**
+     * @brief Exact model counts of a counting analysis
+     */
+    struct ModelCounts {
+        BigUnsigned premises; // Assignments satisfying every premise, the critical rows
+        BigUnsigned conclusion; // Assignments satisfying the conclusion
+        BigUnsigned conjunction; // Assignments satisfying the premises and the conclusion
+        BigUnsigned counterexamples; // Assignments satisfying the premises but not the conclusion
+        ModelCounter::Statistics counter;
+    };
+
+    /**
+     * @brief Decides and counts the argument with the #SAT model counter, without enumerating rows.
+     *
+     * Each query is Tseitin-encoded separately, with only the expressions it asserts, and counted under
+     * assumptions. Every assignment of the variables extends to exactly one model of an encoding, so
+     * the model counts are the row counts; leaving out the definitions a query does not constrain keeps
+     * them from tying its components together. A counterexample is taken from the SAT solver.
+     *
+     * @param counts Receives the counts and counter statistics, if not null.
+     */
+    AnalysisResult analyzeCount(ModelCounts* counts = nullptr) const {
+        Instrumentation::Scope timer(Instrumentation::Phase::EVALUATE, "count");
+        typedef SatSolver::Literal Literal;
+        ModelCounter counter;
+        counter.setDecisionVariables(variables.size());
+
+        CnfFormula formula; // Premises asserted, then the conclusion defined
+        TseitinEncoder encoder(formula, variables.size());
+        for (const auto& premise : compiledPremises) encoder.assertExpression(premise);
+        CnfFormula premisesFormula = formula; // Before the conclusion is encoded
+        Literal conclusionLiteral = encoder.encode(compiledConclusion);
+        CnfFormula conclusionFormula; // The conclusion alone
+        Literal conclusionOnly = TseitinEncoder(conclusionFormula, variables.size()).encode(compiledConclusion);
+
+        ModelCounts result;
+        result.premises = counter.count(premisesFormula);
+        result.conclusion = counter.count(conclusionFormula, {conclusionOnly});
+        result.conjunction = counter.count(formula, {conclusionLiteral});
+        result.counterexamples = counter.count(formula, {SatSolver::negate(conclusionLiteral)});
+        result.counter = counter.statistics();
+
+        AnalysisResult analysis;
+        analysis.isValid = result.counterexamples.isZero();
+        analysis.isSatisfiable = !result.conjunction.isZero();
+        analysis.hasRowCounts = variables.size() <= BitSlicedEvaluator::MAX_VARIABLES;
+        if (analysis.hasRowCounts) {
+            analysis.criticalRows = result.premises.toUint64();
+            analysis.counterexampleRows = result.counterexamples.toUint64();
+        }
+        if (!analysis.isValid) {
+            SatSolver solver;
+            for (uint32_t v = 0; v < formula.variableCount; ++v) solver.newVariable();
+            for (const auto& clause : formula.clauses) solver.addClause(clause);
+            if (solver.solve({SatSolver::negate(conclusionLiteral)}) == SatSolver::Result::SATISFIABLE) {
+                analysis.counterexample.resize(variables.size());
+                for (size_t j = 0; j < variables.size(); ++j) {
+                    analysis.counterexample[j] = solver.modelValue(static_cast<uint32_t>(j));
+                }
+            }
+        }
+
+        if (counts) *counts = result;
+        return analysis;
+    }
+
+    /**
+     * @brief Prints the exact counts and counter statistics of a counting analysis
+     */
+    void printModelCounts(const ModelCounts& counts) const {
+        double hitRate = counts.counter.cacheLookups ? 100.0 * counts.counter.cacheHits / counts.counter.cacheLookups : 0.0;
+        std::cout << Colors::YELLOW << Colors::BOLD << "Model counts:" << Colors::RESET
+                  << " over " << variables.size() << " variables\n"
+                  << "Premises: " << counts.premises.toString() << "\n"
+                  << "Conclusion: " << counts.conclusion.toString() << "\n"
+                  << "Premises and conclusion: " << counts.conjunction.toString() << "\n"
+                  << "Premises without conclusion: " << counts.counterexamples.toString() << "\n";
+        std::cout << Colors::YELLOW << Colors::BOLD << "Counter:" << Colors::RESET
+                  << " " << counts.counter.decisions << " decisions, " << counts.counter.componentSplits
+                  << " component splits, cache hit rate " << std::fixed << std::setprecision(1) << hitRate << "%"
+                  << std::defaultfloat << " (" << counts.counter.cacheLookups << " lookups, "
+                  << counts.counter.cacheEntries << " entries)\n";
+    }
+
+    /**
+     * @brief Approximate counts of a hashing-based counting analysis
+     */
+    struct ApproximateCounts {
+        ApproximateCounter::Estimate premises; // Critical rows
+        ApproximateCounter::Estimate counterexamples; // Critical rows where the conclusion is false
+        ApproximateCounter::Parameters parameters;
+        uint64_t threshold = 0;
+    };
+
+    /**
+     * @brief Decides the argument and estimates its row counts with the approximate model counter.
+     *
+     * The premises are asserted and the conclusion defined in one Tseitin encoding, whose definitions
+     * are determined by the variables, so its models over the variables are the rows. The critical rows
+     * are its models and the counterexample rows its models where the conclusion is false. Validity is
+     * exact, since counts below the cell threshold are exact and zero is below it.
+     *
+     * @param pool Workers for the independent estimates.
+     * @param parameters Tolerance, confidence and seed.
+     * @param counts Receives the estimates, if not null.
+     * @return The verdicts and a counterexample; rows are not counted exactly.
+     */
+    AnalysisResult analyzeApproximate(WorkStealingPool& pool, const ApproximateCounter::Parameters& parameters,
+                                      ApproximateCounts* counts = nullptr) const {
+        Instrumentation::Scope timer(Instrumentation::Phase::EVALUATE, "approximate count");
+        CnfFormula formula;
+        TseitinEncoder encoder(formula, variables.size());
+        for (const auto& premise : compiledPremises) encoder.assertExpression(premise);
+        SatSolver::Literal conclusionLiteral = encoder.encode(compiledConclusion);
+
+        ApproximateCounter counter(formula, variables.size(), pool, parameters);
+        ApproximateCounts result;
+        result.parameters = parameters;
+        result.threshold = counter.cellThreshold();
+        result.premises = counter.count();
+        result.counterexamples = counter.count({SatSolver::negate(conclusionLiteral)});
+
+        AnalysisResult analysis;
+        analysis.hasRowCounts = false;
+        analysis.isValid = result.counterexamples.count.isZero();
+        analysis.counterexample = result.counterexamples.model;
+        SatSolver solver;
+        for (uint32_t v = 0; v < formula.variableCount; ++v) solver.newVariable();
+        for (const auto& clause : formula.clauses) solver.addClause(clause);
+        analysis.isSatisfiable = solver.solve({conclusionLiteral}) == SatSolver::Result::SATISFIABLE;
+
+        if (counts) *counts = std::move(result);
+        return analysis;
+    }
+
+    /**
+     * @brief Prints the estimates of an approximate counting analysis and the bounds they hold with
+     */
+    void printApproximateCounts(const ApproximateCounts& counts) const {
+        auto print = [](const char* label, const ApproximateCounter::Estimate& estimate) {
+            std::cout << label << ": ";
+            if (estimate.exact) {
+                std::cout << estimate.count.toString() << " (exact)\n";
+                return;
+            }
+            std::cout << (estimate.count.fitsUint64() ? estimate.count.toString()
+                                                      : ApproximateCounter::formatPowerOfTwo(estimate.log2Count))
+                      << " (between " << ApproximateCounter::formatPowerOfTwo(estimate.lowerLog2) << " and "
+                      << ApproximateCounter::formatPowerOfTwo(estimate.upperLog2) << ", median of "
+                      << estimate.iterations << " estimates with " << estimate.hashCount << " XOR constraints, "
+                      << estimate.satCalls << " SAT calls)\n";
+        };
+        std::cout << Colors::YELLOW << Colors::BOLD << "Approximate counts:" << Colors::RESET
+                  << " over " << variables.size() << " variables, within a factor " << 1 + counts.parameters.epsilon
+                  << " with probability " << 1 - counts.parameters.delta << ", cells of up to "
+                  << counts.threshold << " models\n";
+        print("Premises", counts.premises);
+        print("Premises without conclusion", counts.counterexamples);
+    }
+
+    /**
+     * @brief Prints how far the shared expression DAG deduplicated the subexpressions
+     */
+    void printDagStatistics() const {
+        ExpressionDag dag;
+        for (const auto& premise : compiledPremises) dag.add(premise);
+        dag.add(compiledConclusion);
+        std::cout << Colors::YELLOW << Colors::BOLD << "Expression DAG:" << Colors::RESET
+                  << " " << dag.size() << " nodes for " << dag.subexpressionCount() << " subexpressions ("
+                  << dag.deduplicatedCount() << " deduplicated)\n";
+    }
+
+    /**
+     * @brief Prints what a short-circuit sweep did and the premise order it ended with
+     */
+    void printShortCircuitStatistics(const ShortCircuitEvaluator::Statistics& stats) const {
+        double perWord = stats.wordsVisited ? static_cast<double>(stats.premiseEvaluations) / stats.wordsVisited : 0;
+        std::cout << Colors::YELLOW << Colors::BOLD << "Short circuit:" << Colors::RESET
+                  << " " << stats.wordsVisited << " words visited, " << stats.wordsSkipped << " skipped by the conclusion, "
+                  << std::fixed << std::setprecision(2) << perWord << std::defaultfloat
+                  << " premises evaluated per word, " << stats.instructions << " word operations\n";
+        if (!stats.order.empty()) {
+            std::cout << "Premise order:";
+            for (uint32_t index : stats.order) std::cout << " " << (index + 1);
+            std::cout << "\n";
+        }
+    }
+
+    /**
+     * @brief Prints the SAT solver statistics of an analysis
+     */
+    void printSolverStatistics(const SatSolver::Statistics& stats) const {
+        std::cout << Colors::YELLOW << Colors::BOLD << "SAT solver:" << Colors::RESET
+                  << " " << stats.decisions << " decisions, " << stats.propagations << " propagations, "
+                  << stats.conflicts << " conflicts, " << stats.restarts << " restarts, "
+                  << stats.learntClauses << " learnt clauses (" << stats.deletedClauses << " deleted)\n";
+    }
+
+    /**
+     * @brief Prints the analysis results.
+     * 
+     * This function prints whether the logical expressions are valid and satisfiable, how many rows
+     * are critical and the first counterexample if there is one.
+     * 
+     * @param result The analysis of the truth table.
+     */
+    void printAnalysis(const AnalysisResult& result) const {
+        Instrumentation::Scope timer(Instrumentation::Phase::OUTPUT, "analysis");
+        std::cout << "\n" << Colors::YELLOW << Colors::BOLD 
+                 << "Analysis Results:" << Colors::RESET << "\n";
+        
+        std::cout << "Validity: " 
+                 << (result.isValid ? Colors::GREEN : Colors::RED)
+                 << Colors::BOLD 
+                 << (result.isValid ? "Valid" : "Falsifiable")
+                 << Colors::RESET << "\n";
+        
+        if (!result.satisfiabilityChecked) {
+            std::cout << "Satisfiability: not checked\n";
+        } else {
+            std::cout << "Satisfiability: "
+                     << (result.isSatisfiable ? Colors::GREEN : Colors::RED)
+                     << Colors::BOLD
+                     << (result.isSatisfiable ? "Satisfiable" : "Not satisfiable")
+                     << Colors::RESET << "\n";
+        }
+
+        if (!result.hasRowCounts) {
+            // The engine did not enumerate rows
+        } else if (result.isComplete) {
+            std::cout << "Critical rows: " << result.criticalRows
+                      << " (" << result.counterexampleRows << " with a false conclusion)\n";
+        } else {
+            std::cout << "Critical rows: at least " << result.criticalRows
+                      << " (stopped at the first counterexample)\n";
+        }
+
+        // Print the assignment of the counterexample
+        if (!result.counterexample.empty()) {
+            std::cout << "Counterexample:";
+            for (size_t j = 0; j < variables.size(); ++j) {
+                std::cout << " " << variables[j] << "=" << (result.counterexample[j] ? "T" : "F");
+            }
+            std::cout << "\n";
+        } else if (result.firstCounterexample != AnalysisResult::NO_ROW) {
+            std::cout << "Counterexample:";
+            for (size_t j = 0; j < variables.size(); ++j) {
+                std::cout << " " << variables[j] << "=" << (((result.firstCounterexample >> j) & 1) ? "T" : "F");
+            }
+            std::cout << "\n";
+        }
+    }
+};
+
+#endif // LOGIC_TRUTH_TABLE_GENERATOR_HPP
@@ -0,0 +1,419 @@
+/**
+ * @file truth_vector_cache.hpp
+ * @brief Persistent memory-mapped cache of truth vectors keyed by canonical hash.
+ */
+
+#ifndef LOGIC_TRUTH_VECTOR_CACHE_HPP
+#define LOGIC_TRUTH_VECTOR_CACHE_HPP
+
+#include "common.hpp"
+#include "expression.hpp"
+#include "problem.hpp"
+
+/**
+ * @class TruthVectorCache
+ * @brief Persistent cache of compiled expressions and their truth vectors, in one memory-mapped file.
+ *
+ * An entry is keyed by a hash of the canonical form of the expression and the number of variables of
+ * the table. The compiled program is hash-consed through an ExpressionDag, which removes double
+ * negations and x & x, and written back in postfix with the operands of &, | and <-> ordered by a
+ * structural hash. Whitespace, parentheses, variable names and operand order are gone, so p & q and
+ * q & p, or ~~p and p, share an entry; slots are the alphabetical columns of the table. The entry
+ * holds the canonical program, checked on every lookup so a hash collision is a miss, and the packed
+ * truth vector over all the variables of the table, which a lookup returns as a pointer into the mapping.
+ *
+ * File layout, all little-endian and 8-byte aligned:
+ *
+ *     header    magic, file size, index size, data area, clock
+ *     index     open-addressing table of {key, offset, length, last use}
+ *     data      entries {key, variable count, code length, truth words, code, truth vector}
+ *
+ * The file has a fixed size, set when it is created. Entries are appended to the data area; when the
+ * area or the index is full, the least recently used entries are evicted until half of it is free and
+ * the survivors are compacted. Processes share the file through flock: lookups and the use of the
+ * returned vectors happen under a shared lock, insertion and eviction under an exclusive one, so a
+ * reader never sees an entry move. An existing file that does not start with "LOGICCH" is refused
+ * rather than overwritten; a damaged cache file, or one of another version, is started over, and an
+ * index slot that does not point at a whole entry is a miss.
+ */
+class TruthVectorCache {
+public:
+    static constexpr size_t MAX_VARIABLES = 26; // Truth vectors of up to 8 MiB
+
+    /**
+     * @brief Lookups and changes of one run
+     */
+    struct Statistics {
+        size_t hits = 0;
+        size_t misses = 0;
+        size_t stored = 0;
+        size_t evicted = 0;
+    };
+
+private:
+    static constexpr uint64_t MAGIC = 0x3148434349474f4cull; // "LOGICCH1"
+    static constexpr char MAGIC_PREFIX[] = "LOGICCH"; // Shared by every version of the format
+    static constexpr uint64_t HEADER_BYTES = 4096;
+    static constexpr uint64_t BYTES_PER_INDEX_SLOT = 16384; // One index slot for this much data
+
+    struct Header {
+        uint64_t magic;
+        uint64_t fileSize;
+        uint64_t indexSlots;
+        uint64_t dataOffset; // Start of the data area
+        uint64_t dataEnd; // First free byte of the data area
+        uint64_t entries;
+        uint64_t clock; // Incremented on every use, for the LRU order
+    };
+
+    struct IndexSlot {
+        uint64_t key; // 0 for an empty slot
+        uint64_t offset;
+        uint64_t length;
+        uint64_t lastUse;
+    };
+
+    struct EntryHeader {
+        uint64_t key;
+        uint32_t variableCount;
+        uint32_t codeLength;
+        uint64_t truthWords;
+    };
+
+    std::string path;
+    int fd = -1;
+    char* base = nullptr;
+    uint64_t size = 0;
+    Statistics stats;
+
+    Header& header() const { return *reinterpret_cast<Header*>(base); }
+    IndexSlot* index() const { return reinterpret_cast<IndexSlot*>(base + HEADER_BYTES); }
+
+    static uint64_t align8(uint64_t bytes) { return (bytes + 7) & ~uint64_t{7}; }
+
+    static uint64_t entryBytes(size_t codeLength, uint64_t truthWords) {
+        return sizeof(EntryHeader) + align8(codeLength * sizeof(uint32_t)) + truthWords * sizeof(uint64_t);
+    }
+
+    static uint32_t encode(CompiledExpression::OpCode op, uint32_t operand) {
+        return static_cast<uint32_t>(op) << 24 | operand;
+    }
+
+    static uint64_t mix(uint64_t hash, uint64_t value) {
+        hash = (hash ^ value) * 0x9e3779b97f4a7c15ull;
+        return hash ^ (hash >> 32);
+    }
+
+    /**
+     * @brief The canonical program of an expression, as encoded instructions, and its key
+     */
+    struct Canonical {
+        uint64_t key;
+        std::vector<uint32_t> code;
+    };
+
+    static Canonical canonicalize(const CompiledExpression& program, size_t variableCount) {
+        typedef CompiledExpression::OpCode OpCode;
+        ExpressionDag dag;
+        const uint32_t root = dag.add(program);
+        const auto& nodes = dag.nodeList();
+        auto commutative = [](OpCode op) { return op == OpCode::AND || op == OpCode::OR || op == OpCode::BICONDITIONAL; };
+
+        // Structural hash of every node, children first; DAG indexes depend on the order operands
+        // appear in, so commutative operands are combined in the order of their hashes instead
+        std::vector<uint64_t> hashes(nodes.size());
+        for (size_t i = 0; i < nodes.size(); ++i) {
+            const auto& node = nodes[i];
+            uint64_t hash = mix(0x243f6a8885a308d3ull, static_cast<uint64_t>(node.op));
+            if (node.op == OpCode::LOAD || node.op == OpCode::CONSTANT) {
+                hash = mix(hash, node.left);
+            } else if (node.op == OpCode::NOT) {
+                hash = mix(hash, hashes[node.left]);
+            } else {
+                uint64_t a = hashes[node.left], b = hashes[node.right];
+                if (commutative(node.op) && a > b) std::swap(a, b);
+                hash = mix(mix(hash, a), b);
+            }
+            hashes[i] = hash;
+        }
+
+        // Postfix walk from the root, the operand with the smaller hash first
+        Canonical canonical;
+        canonical.code.reserve(program.code.size());
+        std::vector<std::pair<uint32_t, bool>> stack = {{root, false}}; // Node, operands already written
+        while (!stack.empty()) {
+            const auto [index, written] = stack.back();
+            stack.pop_back();
+            const auto& node = nodes[index];
+            if (node.op == OpCode::LOAD || node.op == OpCode::CONSTANT) {
+                canonical.code.push_back(encode(node.op, node.left));
+            } else if (written) {
+                canonical.code.push_back(encode(node.op, 0));
+            } else {
+                stack.push_back({index, true});
+                uint32_t first = node.left, second = node.right;
+                if (node.op != OpCode::NOT) {
+                    if (commutative(node.op) && hashes[second] < hashes[first]) std::swap(first, second);
+                    stack.push_back({second, false});
+                }
+                stack.push_back({first, false});
+            }
+        }
+        const uint64_t key = mix(mix(0xcbf29ce484222325ull, variableCount), hashes[root]);
+        canonical.key = key ? key : 1;
+        return canonical;
+    }
+
+    /**
+     * @brief Checks whether an existing file starts with the magic of some version of the cache
+     */
+    bool hasMagicPrefix() const {
+#ifndef _WIN32
+        char prefix[sizeof(MAGIC_PREFIX) - 1];
+        return ::pread(fd, prefix, sizeof(prefix), 0) == static_cast<ssize_t>(sizeof(prefix)) &&
+               std::memcmp(prefix, MAGIC_PREFIX, sizeof(prefix)) == 0;
+#else
+        return false;
+#endif
+    }
+
+    /**
+     * @brief Lays out an empty cache in the mapping
+     * @throws std::runtime_error If the file is too small, before anything is written.
+     */
+    void format() {
+        const uint64_t indexSlots = std::max<uint64_t>(64, (size - HEADER_BYTES) / BYTES_PER_INDEX_SLOT);
+        const uint64_t dataOffset = HEADER_BYTES + align8(indexSlots * sizeof(IndexSlot));
+        if (size <= HEADER_BYTES || dataOffset >= size) throw std::runtime_error("Cache file '" + path + "' is too small");
+        Header& h = header();
+        h.fileSize = size;
+        h.indexSlots = indexSlots;
+        h.dataOffset = dataOffset;
+        h.dataEnd = h.dataOffset;
+        h.entries = 0;
+        h.clock = 0;
+        std::memset(index(), 0, h.indexSlots * sizeof(IndexSlot));
+        h.magic = MAGIC;
+    }
+
+    bool valid() const {
+        const Header& h = header();
+        return h.magic == MAGIC && h.fileSize == size && h.indexSlots > 0 && h.indexSlots <= size / sizeof(IndexSlot) &&
+               HEADER_BYTES + h.indexSlots * sizeof(IndexSlot) <= h.dataOffset && h.dataOffset % 8 == 0 &&
+               h.dataOffset <= h.dataEnd && h.dataEnd <= size;
+    }
+
+    /**
+     * @brief Whether a slot points at a whole entry in the used data area, whose size matches its header
+     *
+     * The index comes from a file that other processes write, so a slot is checked before it is followed.
+     */
+    bool intact(const IndexSlot& slot) const {
+        const Header& h = header();
+        if (slot.offset < h.dataOffset || slot.offset > h.dataEnd || slot.offset % 8 != 0 ||
+            slot.length < sizeof(EntryHeader) || slot.length > h.dataEnd - slot.offset) {
+            return false;
+        }
+        const auto* entry = reinterpret_cast<const EntryHeader*>(base + slot.offset);
+        return entry->truthWords <= slot.length / sizeof(uint64_t) &&
+               entryBytes(entry->codeLength, entry->truthWords) == slot.length;
+    }
+
+    /**
+     * @brief Index slot of a key, or the empty slot where it would go
+     *
+     * A damaged index may have no empty slot; then the home slot of the key is returned, so a lookup
+     * misses and an insertion replaces whatever is there.
+     */
+    IndexSlot& probe(uint64_t key) const {
+        const uint64_t slots = header().indexSlots;
+        for (uint64_t n = 0, i = key % slots; n < slots; ++n, i = (i + 1) % slots) {
+            IndexSlot& slot = index()[i];
+            if (slot.key == key || slot.key == 0) return slot;
+        }
+        return index()[key % slots];
+    }
+
+    uint64_t tick() const {
+        return __atomic_add_fetch(&header().clock, 1, __ATOMIC_RELAXED); // Readers bump it under a shared lock
+    }
+
+    /**
+     * @brief Evicts least recently used entries until the data area and the index are at most half full
+     */
+    void evict() {
+        Header& h = header();
+        std::vector<IndexSlot> live;
+        for (uint64_t i = 0; i < h.indexSlots; ++i) {
+            if (index()[i].key != 0 && intact(index()[i])) live.push_back(index()[i]); // Damaged slots are dropped
+        }
+        std::sort(live.begin(), live.end(), [](const IndexSlot& a, const IndexSlot& b) { return a.lastUse > b.lastUse; });
+
+        // Keep the most recently used entries that fit in half of the area
+        const uint64_t budget = (size - h.dataOffset) / 2;
+        uint64_t kept = 0;
+        size_t keep = 0;
+        while (keep < live.size() && keep < h.indexSlots / 2 && kept + live[keep].length <= budget) {
+            kept += live[keep++].length;
+        }
+        stats.evicted += live.size() - keep;
+        live.resize(keep);
+
+        // Compact the survivors in address order, then rebuild the index
+        std::sort(live.begin(), live.end(), [](const IndexSlot& a, const IndexSlot& b) { return a.offset < b.offset; });
+        uint64_t end = h.dataOffset;
+        for (IndexSlot& slot : live) {
+            if (slot.offset != end) std::memmove(base + end, base + slot.offset, slot.length);
+            slot.offset = end;
+            end += slot.length;
+        }
+        std::memset(index(), 0, h.indexSlots * sizeof(IndexSlot));
+        for (const IndexSlot& slot : live) probe(slot.key) = slot;
+        h.dataEnd = end;
+        h.entries = live.size();
+    }
+
+public:
+    /**
+     * @brief Opens the cache file, creating it with the given size if it does not exist
+     * @param file Path of the cache file.
+     * @param sizeLimit Size of a new cache file in bytes; an existing file keeps its size.
+     * @throws std::runtime_error If the file cannot be created or mapped, or is not a cache file.
+     */
+    TruthVectorCache(const std::string& file, uint64_t sizeLimit) : path(file) {
+#ifndef _WIN32
+        fd = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+        if (fd < 0) throw std::runtime_error("Cannot open cache file '" + path + "'");
+        try {
+            Lock lock(*this, true); // One process creates or repairs the file
+            struct stat info;
+            if (::fstat(fd, &info) != 0) throw std::runtime_error("Cannot read cache file '" + path + "'");
+            bool fresh = info.st_size == 0;
+            if (!fresh && !hasMagicPrefix()) {
+                throw std::runtime_error("'" + path + "' is not a cache file, refusing to overwrite it");
+            }
+            size = fresh ? std::max<uint64_t>(sizeLimit, 1 << 20) : static_cast<uint64_t>(info.st_size);
+            if (fresh && ::ftruncate(fd, static_cast<off_t>(size)) != 0) {
+                throw std::runtime_error("Cannot size cache file '" + path + "'");
+            }
+            void* mapping = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            if (mapping == MAP_FAILED) throw std::runtime_error("Cannot map cache file '" + path + "'");
+            base = static_cast<char*>(mapping);
+            if (fresh || !valid()) format(); // A damaged file or one of another version is started over
+        } catch (...) {
+            if (base) ::munmap(base, size);
+            ::close(fd);
+            throw;
+        }
+#else
+        (void)sizeLimit;
+        throw std::runtime_error("The cache file needs a POSIX system");
+#endif
+    }
+
+    ~TruthVectorCache() {
+#ifndef _WIN32
+        if (base) ::munmap(base, size);
+        if (fd >= 0) ::close(fd);
+#endif
+    }
+
+    TruthVectorCache(const TruthVectorCache&) = delete;
+    TruthVectorCache& operator=(const TruthVectorCache&) = delete;
+
+    /**
+     * @class Lock
+     * @brief Holds the file lock: shared for lookups and the use of their vectors, exclusive for changes
+     */
+    class Lock {
+    private:
+        int fd;
+
+    public:
+        Lock(const TruthVectorCache& cache, bool exclusive) : fd(cache.fd) {
+#ifndef _WIN32
+            while (::flock(fd, exclusive ? LOCK_EX : LOCK_SH) != 0) {
+                if (errno != EINTR) throw std::runtime_error("Cannot lock the cache file");
+            }
+#else
+            (void)exclusive;
+#endif
+        }
+
+        ~Lock() {
+#ifndef _WIN32
+            ::flock(fd, LOCK_UN);
+#endif
+        }
+
+        Lock(const Lock&) = delete;
+        Lock& operator=(const Lock&) = delete;
+    };
+
+    /**
+     * @brief Hash of the canonical program and the table size, never 0
+     */
+    static uint64_t keyOf(const CompiledExpression& program, size_t variableCount) {
+        return canonicalize(program, variableCount).key;
+    }
+
+    /**
+     * @brief Looks up the truth vector of a program; call under a shared or exclusive Lock
+     * @return The vector of 2^(n-6) words (one word below six variables) in the mapping, or null on a miss.
+     *         It stays valid while the lock is held.
+     */
+    const uint64_t* find(const CompiledExpression& program, size_t variableCount) {
+        const Canonical canonical = canonicalize(program, variableCount);
+        const uint64_t key = canonical.key;
+        const IndexSlot& slot = probe(key);
+        if (slot.key == key && intact(slot)) { // A damaged entry is a miss, and the next insertion replaces it
+            const auto* entry = reinterpret_cast<const EntryHeader*>(base + slot.offset);
+            const auto* code = reinterpret_cast<const uint32_t*>(entry + 1);
+            const uint64_t truthWords = variableCount > 6 ? uint64_t{1} << (variableCount - 6) : 1;
+            bool same = entry->key == key && entry->variableCount == variableCount &&
+                        entry->truthWords == truthWords && entry->codeLength == canonical.code.size() &&
+                        std::equal(canonical.code.begin(), canonical.code.end(), code);
+            if (same) {
+                __atomic_store_n(&const_cast<IndexSlot&>(slot).lastUse, tick(), __ATOMIC_RELAXED);
+                ++stats.hits;
+                return reinterpret_cast<const uint64_t*>(base + slot.offset + sizeof(EntryHeader) +
+                                                         align8(entry->codeLength * sizeof(uint32_t)));
+            }
+        }
+        ++stats.misses;
+        return nullptr;
+    }
+
+    /**
+     * @brief Stores the truth vector of a program; call under an exclusive Lock
+     *
+     * An entry that is already present (stored by another process meanwhile) is kept, and one larger
+     * than half of the data area is not stored.
+     */
+    void insert(const CompiledExpression& program, size_t variableCount, const std::vector<uint64_t>& truth) {
+        const Canonical canonical = canonicalize(program, variableCount);
+        const uint64_t key = canonical.key;
+        const size_t codeLength = canonical.code.size();
+        const uint64_t length = entryBytes(codeLength, truth.size());
+        Header& h = header();
+        const IndexSlot& existing = probe(key);
+        if (length > (size - h.dataOffset) / 2 || (existing.key == key && intact(existing))) return;
+        if (h.dataEnd + length > size || (h.entries + 1) * 4 > h.indexSlots * 3) evict();
+
+        auto* entry = reinterpret_cast<EntryHeader*>(base + h.dataEnd);
+        *entry = {key, static_cast<uint32_t>(variableCount), static_cast<uint32_t>(codeLength), truth.size()};
+        std::memcpy(entry + 1, canonical.code.data(), codeLength * sizeof(uint32_t));
+        std::memcpy(base + h.dataEnd + sizeof(EntryHeader) + align8(codeLength * sizeof(uint32_t)),
+                    truth.data(), truth.size() * sizeof(uint64_t));
+
+        IndexSlot& slot = probe(key);
+        if (slot.key == 0) ++h.entries; // Otherwise a damaged entry is replaced
+        slot = {key, h.dataEnd, length, tick()};
+        h.dataEnd += length;
+        ++stats.stored;
+    }
+
+    const Statistics& statistics() const { return stats; }
+};
+
+#endif // LOGIC_TRUTH_VECTOR_CACHE_HPP
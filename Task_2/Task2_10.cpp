@@ -3,170 +3,266 @@
 #include <string>
 #include <stack>
 #include <vector>
+#include <algorithm>
+#include <bitset>
+#include <cstdint>
+#include <set>
 using namespace std;
 
-/*The evaluateExpression function parses and evaluates a logical expression containing T, F, AND, OR, NOT, and parentheses.
-It uses two stacks, one for boolean values (T/F) and another for operators, to process the expression. Tokens are read sequentially,
-and operators are applied following precedence rules, with parentheses handled explicitly.
-After all tokens are processed and remaining operators applied, the function returns the final boolean result of the evaluated expression.*/
+/*The truth table of an expression is packed 64 rows to a uint64_t word: bit (row % 64) of word (row / 64).
+In row i, variable j (in sorted order) has the value of bit j of i, so with variables A, B, C the rows run
+A = F, T, F, T, ... as before. Bits past the last row of a table with fewer than 64 rows are always 0.*/
 
+const size_t MAX_VARIABLES = 30;         // 2^30 rows take 128 MB per table
+const size_t MAX_PRINTED_VARIABLES = 8;  // Larger tables are summarized instead of printed
 
-// Function to evaluate the logical expression
-bool evaluateExpression(const string& expr) {
+struct TruthTable {
+    size_t variableCount = 0;
+    vector<uint64_t> words;
+};
+
+// One step of an expression compiled to postfix form
+struct Instruction {
+    enum Kind { VALUE, VARIABLE, NOT, AND, OR } kind;
+    size_t variable;  // Index of the variable for VARIABLE, 1/0 for a T/F VALUE
+};
+
+bool isOperatorToken(const string& token) {
+    return token == "AND" || token == "OR" || token == "NOT" || token == "(" || token == ")";
+}
+
+/*Every token that is not an operator, a parenthesis, T or F is a variable name.
+The variables of all the expressions are collected, sorted, so that their tables have the same rows.*/
+vector<string> collectVariables(const vector<string>& expressions) {
+    set<string> names;
+    for (const string& expr : expressions) {
+        istringstream iss(expr);
+        string token;
+        while (iss >> token) {
+            if (!isOperatorToken(token) && token != "T" && token != "F")
+                names.insert(token);
+        }
+    }
+    return vector<string>(names.begin(), names.end());
+}
+
+/*The compileExpression function parses a logical expression containing variables, T, F, AND, OR, NOT, and parentheses
+once, into postfix form. It uses the same rules as the evaluation with two stacks it replaces: NOT applies to
+the operand that follows it, and AND and OR have the same precedence and group from the left.
+It returns false if the expression is malformed, including a token where the other kind was due:
+an operand, NOT or '(' after an operand, or AND, OR or ')' where an operand was due.*/
+bool compileExpression(const string& expr, const vector<string>& variables, vector<Instruction>& program) {
     istringstream iss(expr);
     string token;
-    stack<bool> values;  // Stack to hold boolean values (T/F)
-    stack<string> ops;   // Stack to hold operators (AND, OR, NOT)
-
-    auto applyOperator = [&]() {
-        if (ops.top() == "NOT") {  // Handle NOT operator
-            ops.pop();
-            bool value = values.top();
-            values.pop();
-            values.push(!value);
+    stack<string> ops;   // Stack to hold operators (AND, OR, NOT) and open parentheses
+    size_t depth = 0;    // Values the program leaves on the stack so far
+    bool expectOperand = true; // False right after an operand, when only AND, OR or ')' may follow
+    program.clear();
+
+    auto emit = [&](const string& op) {
+        if (op == "NOT") {
+            if (depth < 1) return false;
+            program.push_back({ Instruction::NOT, 0 });
         }
-        else {  // Handle AND/OR operators
-            string op = ops.top();
-            ops.pop();
-            bool right = values.top();
-            values.pop();
-            bool left = values.top();
-            values.pop();
-
-            if (op == "AND") {
-                values.push(left && right);
-            }
-            else if (op == "OR") {
-                values.push(left || right);
-            }
+        else {
+            if (depth < 2) return false;
+            program.push_back({ op == "AND" ? Instruction::AND : Instruction::OR, 0 });
+            depth--;
         }
+        return true;
         };
-    while (iss >> token) {  // Tokenize and evaluate the expression
-        if (token == "T" || token == "F") {    
-            values.push(token == "T"); //push 1 ->"T"   0->"F"
+    while (iss >> token) {
+        const bool operatorToken = token == "AND" || token == "OR" || token == ")";
+        if (operatorToken == expectOperand) return false;
+        if (token == "T" || token == "F") {
+            program.push_back({ Instruction::VALUE, token == "T" ? 1u : 0u });
+            depth++;
+            expectOperand = false;
         }
-        else if (token == "AND" || token == "OR") { 
-            while (!ops.empty() && ops.top() != "(" &&
-                (ops.top() == "NOT" || ops.top() == "AND" || ops.top() == "OR")) {
-                applyOperator();
+        else if (token == "AND" || token == "OR") {
+            while (!ops.empty() && ops.top() != "(") {
+                if (!emit(ops.top())) return false;
+                ops.pop();
             }
             ops.push(token);
+            expectOperand = true;
         }
-        else if (token == "NOT") {
-            ops.push(token);
-        }
-        else if (token == "(") { // Handle opening parenthesis
+        else if (token == "NOT" || token == "(") {
             ops.push(token);
         }
         else if (token == ")") { // Handle closing parenthesis
             while (!ops.empty() && ops.top() != "(") {
-                applyOperator();
+                if (!emit(ops.top())) return false;
+                ops.pop();
             }
+            if (ops.empty()) return false;
             ops.pop(); // Remove the '('
         }
+        else {
+            size_t index = lower_bound(variables.begin(), variables.end(), token) - variables.begin();
+            if (index == variables.size() || variables[index] != token) return false;
+            program.push_back({ Instruction::VARIABLE, index });
+            depth++;
+            expectOperand = false;
+        }
     }
+    if (expectOperand) return false;
     while (!ops.empty()) {
-        applyOperator();
+        if (ops.top() == "(" || !emit(ops.top())) return false;
+        ops.pop();
+    }
+    return depth == 1;
+}
+
+/*Evaluates a compiled expression on the 64 rows of one word of the table.
+Variables 0 to 5 alternate within a word; the value of a higher variable is the same for all 64 rows.*/
+uint64_t evaluateWord(const vector<Instruction>& program, uint64_t word, vector<uint64_t>& values) {
+    static const uint64_t patterns[6] = {
+        0xAAAAAAAAAAAAAAAAULL, 0xCCCCCCCCCCCCCCCCULL, 0xF0F0F0F0F0F0F0F0ULL,
+        0xFF00FF00FF00FF00ULL, 0xFFFF0000FFFF0000ULL, 0xFFFFFFFF00000000ULL
+    };
+    values.clear();
+    for (const Instruction& step : program) {
+        switch (step.kind) {
+        case Instruction::VALUE:
+            values.push_back(step.variable ? ~uint64_t{ 0 } : 0);
+            break;
+        case Instruction::VARIABLE:
+            if (step.variable < 6)
+                values.push_back(patterns[step.variable]);
+            else
+                values.push_back(((word >> (step.variable - 6)) & 1) ? ~uint64_t{ 0 } : 0);
+            break;
+        case Instruction::NOT:
+            values.back() = ~values.back();
+            break;
+        default: {
+            uint64_t right = values.back();
+            values.pop_back();
+            values.back() = step.kind == Instruction::AND ? (values.back() & right) : (values.back() | right);
+        }
+        }
     }
-    return values.top();
+    return values.back();
 }
 
+uint64_t rowCount(const TruthTable& table) {
+    return uint64_t{ 1 } << table.variableCount;
+}
+
+// Mask of the rows that exist in the last word of a table
+uint64_t lastWordMask(const TruthTable& table) {
+    return table.variableCount >= 6 ? ~uint64_t{ 0 } : (uint64_t{ 1 } << rowCount(table)) - 1;
+}
 
+bool rowValue(const TruthTable& table, uint64_t row) {
+    return (table.words[row / 64] >> (row % 64)) & 1;
+}
 
 /*
 The printTruthTable function loops through all combinations and prints the input variables along with their corresponding outputs.
+Tables with more than MAX_PRINTED_VARIABLES variables only print how many rows are true.
 */
 
-void printTruthTable(vector<char> A, vector<char> B, vector<char> C, vector<bool> RE, string expression) {
+void printTruthTable(const TruthTable& table, const vector<string>& variables, string expression) {
+    if (table.variableCount > MAX_PRINTED_VARIABLES) {
+        uint64_t trueRows = 0;
+        for (uint64_t word : table.words)
+            trueRows += bitset<64>(word).count();
+        cout << expression << "\n" << trueRows << " of " << rowCount(table) << " rows are true (" << variables.size()
+            << " variables, too many rows to print)\n";
+        return;
+    }
     // Print truth table
-    cout << "A  B  C  " << expression << "\n";
-    for (int i = 0; i < 8; i++) {   
-        cout << A[i] << "  " << B[i] << "  " << C[i] << "  " << (RE[i] ? "T" : "F") << "\n";
+    for (const string& name : variables)
+        cout << name << "  ";
+    cout << expression << "\n";
+    for (uint64_t i = 0; i < rowCount(table); i++) {
+        for (size_t j = 0; j < variables.size(); j++)
+            cout << (((i >> j) & 1) ? 'T' : 'F') << string(variables[j].size() + 1, ' ');
+        cout << (rowValue(table, i) ? "T" : "F") << "\n";
     }
 }
 
 /*
-The calc_truth_table function loops through all combinations. In each loop,
-it replaces the values of the inputs in the string, calls the evaluateExpression function,
-and saves the output in an array named results. After processing all combinations, it returns the results array.
+The calc_truth_table function parses the expression once, then evaluates it 64 rows at a time,
+one machine word per step, and saves the output in a packed truth table. It returns false if the expression is
+malformed or has too many variables.
 */
 
 // Iterate through all combinations of truth values
-vector<bool> calc_truth_table(vector<char> A, vector<char> B, vector<char> C, vector<char> T, vector<char> F, string expression) {
-    string modifiedExpression;
-    vector<bool> results = { 0,0,0,0,0,0,0,0 };
-    for (int i = 0; i < 8; i++) {
-        modifiedExpression = expression;
-        for (size_t x = 0; x < modifiedExpression.size(); x++) {
-            if (modifiedExpression[x] == 'A') {
-                if (modifiedExpression[x + 1] == ' ')
-                    modifiedExpression[x] = A[i];
-            }
-            else if (modifiedExpression[x] == 'T') {
-                modifiedExpression[x] = T[i];
-            }
-            else if (modifiedExpression[x] == 'F') {
-                modifiedExpression[x] = F[i];
-            }
-            else if (modifiedExpression[x] == 'B') {
-                modifiedExpression[x] = B[i];
-            }
-            else if (modifiedExpression[x] == 'C') {
-                modifiedExpression[x] = C[i];
-            }
-        }
-        // Print the modified expression
-        results[i] = evaluateExpression(modifiedExpression);
-    }
-    return results;
+bool calc_truth_table(const vector<string>& variables, const string& expression, TruthTable& table) {
+    vector<Instruction> program;
+    if (variables.size() > MAX_VARIABLES || !compileExpression(expression, variables, program))
+        return false;
+    table.variableCount = variables.size();
+    table.words.assign((rowCount(table) + 63) / 64, 0);
+    vector<uint64_t> values;
+    for (size_t w = 0; w < table.words.size(); w++)
+        table.words[w] = evaluateWord(program, w, values);
+    table.words.back() &= lastWordMask(table);
+    return true;
 }
 
 
 
 // Function to check if two truth tables are equivalent
-bool areEquivalent(const vector<bool>& table1, const vector<bool>& table2) {
-    return table1 == table2; // Verify whether all elements in two arrays are identical.
+bool areEquivalent(const TruthTable& table1, const TruthTable& table2) {
+    if (table1.variableCount != table2.variableCount)
+        return false;
+    for (size_t w = 0; w < table1.words.size(); w++) {
+        if (table1.words[w] ^ table2.words[w])  // Any bit set in the XOR is a row where they differ
+            return false;
+    }
+    return true;
 }
 
 
 
 // Function to find satisfiable inputs
-bool findSatisfiableInputs(const vector<bool>& results1, const vector<bool>& results2, const vector<char>& A, const vector<char>& B, const vector<char>& C) {
-    int flag = 0;    //change if find satisfiable 
-    for (int i = 0; i < 8; i++) {
-        if (results1[i] && results2[i]) {
-            flag = 1;
-            cout << "Satisfiable inputs: A = " << A[i] << ", B = " << B[i] << ", C = " << C[i] << "\n";
-           
+bool findSatisfiableInputs(const TruthTable& results1, const TruthTable& results2, const vector<string>& variables) {
+    const uint64_t MAX_PRINTED_ROWS = 16;
+    uint64_t found = 0;    //count rows where both are true, only the first ones are printed
+    uint64_t printed = 0;
+    for (size_t w = 0; w < results1.words.size(); w++) {
+        uint64_t both = results1.words[w] & results2.words[w];
+        for (uint64_t bit = 0; both != 0 && bit < 64 && printed < MAX_PRINTED_ROWS; bit++) {
+            if (!((both >> bit) & 1))
+                continue;
+            uint64_t row = w * 64 + bit;
+            cout << "Satisfiable inputs:";
+            for (size_t j = 0; j < variables.size(); j++)
+                cout << (j ? ", " : " ") << variables[j] << " = " << (((row >> j) & 1) ? 'T' : 'F');
+            cout << "\n";
+            printed++;
         }
-    }if (flag == 1) {
-        cout << "2 Expressions are satisfiable\n";
-        return 1;
-    }else
-    return 0;
+        found += bitset<64>(both).count();
+    }
+    if (found == 0)
+        return 0;
+    if (found > printed)
+        cout << "... and " << found - printed << " more satisfiable inputs\n";
+    cout << "2 Expressions are satisfiable\n";
+    return 1;
 }
 
 
-//A tautology occurs when all elements in the array are 1.
+//A tautology occurs when all rows are 1.
 
-bool IsTautology(const vector<bool>& table1) {
-    int tautology = 0;
-    for (int i = 0; i < 8;i++) {
-        if (table1[i] == 1) {
-            tautology++;
-        }
-        else
-            return 0;  // Return 0 and consider it not a tautology if any element is not 1.
-    }return 1;         // Return 1 after finishing the loop if all elements are 1.
+bool IsTautology(const TruthTable& table1) {
+    for (size_t w = 0; w + 1 < table1.words.size(); w++) {
+        if (table1.words[w] != ~uint64_t{ 0 })
+            return 0;  // Return 0 and consider it not a tautology if any row is not 1.
+    }
+    return table1.words.back() == lastWordMask(table1);  // Return 1 if all rows are 1.
 }
-bool IsUnsatisfiable(const vector<bool>& table1) {
-    int Unsatisfiable = 0;
-    for (int i = 0; i < 8;i++) {
-        if (table1[i] == 1) {
-            return 0;    // Return 0 and consider it not a Unsatisfiable if any element is 1.
+bool IsUnsatisfiable(const TruthTable& table1) {
+    for (uint64_t word : table1.words) {
+        if (word != 0) {
+            return 0;    // Return 0 and consider it not a Unsatisfiable if any row is 1.
         }
 
-    }return 1;          // Return 1 after finishing the loop if all elements are 0.
+    }return 1;          // Return 1 after finishing the loop if all rows are 0.
 
 }
 
@@ -177,84 +273,66 @@ Once all 'AND' and 'OR' combinations are processed, iterate through the expressi
 If not, undo the change and continue removing additional 'NOT' gates.
 */
 
-// Modify the logical expression to make it satisfiable
-string modifyExpression(vector<bool>& results1, const vector<char>& A, const vector<char>& B, const vector<char>& C, const vector<char>& T, const vector<char>& F, string expr) {
-    string mod = expr;
-    string OR = "OR";
-    string AND = "AND";
-    int flag ;
-    int no_gate_and_or = 0;
-    int no_not_gate = 0;
-    // Count the number of AND and OR gates in the expression and track the number of transitions between AND and OR gates.
-    //cout number of NOT gate in the expression and track the number of transitions between NOT and BUFFER gates.
-    for (int i = 0; i < expr.size();i++) {
-        if ((expr[i] == 'A' && expr[i + 1] == 'N') || (expr[i] == 'O' && expr[i + 1] == 'R'))
-            no_gate_and_or++;
-        else if (expr[i] == 'N' && expr[i + 1] == 'O' && expr[i+2] == 'T') {
-            no_not_gate++;
-        }
-    }
-
-    int i = 0;
-    flag = 0;
-    for (int y = 0;y < no_gate_and_or;y++) {     //track the number of transitions between AND and OR gates
-        for (i;i < mod.size();i++) {             // I avoided initializing i to 0 in the loop because the next iteration does not begin at the first index of the string.
-            if (expr[i] == 'A' && expr[i + 1] == 'N')  // "Change 'AND' to 'OR'.
-            {
-                mod.replace(i, 3, OR);
-                i = i + 1;
-                flag = 1;     //update flag
-            }
-            else if (expr[i] == 'O' && expr[i + 1] == 'R' ) {  // "Change 'OR' to 'AND' .
-                mod.replace(i, 2 , AND);
-                i = i + 2;
-                flag = 1;     //update flag
-            }
+// Split an expression into its space separated tokens
+vector<string> splitTokens(const string& expr) {
+    istringstream iss(expr);
+    vector<string> tokens;
+    string token;
+    while (iss >> token)
+        tokens.push_back(token);
+    return tokens;
+}
 
-            if (flag == 1) {  //If the flag is set, verify Tautology and Unsatisfiable conditions. If either is true, return.
-                results1 = calc_truth_table(A, B, C, T, F, mod);
-                if (IsTautology(results1) == 0 && IsUnsatisfiable(results1) == 0)
-                    return mod;
-            }
-            else mod = expr;  //make the mod equal expr
-        }
+// Join tokens back into an expression, one space between them
+string joinTokens(const vector<string>& tokens, size_t skip = string::npos) {
+    string joined;
+    for (size_t i = 0; i < tokens.size(); i++) {
+        if (i == skip)
+            continue;
+        if (!joined.empty())
+            joined += " ";
+        joined += tokens[i];
     }
+    return joined;
+}
 
+// Modify the logical expression to make it satisfiable
+string modifyExpression(const vector<string>& variables, const string& expr) {
+    // Gates are whole tokens, so variable names such as ORX or NOTE are never taken for one
+    vector<string> tokens = splitTokens(expr);
+    TruthTable results1;  // Table of the modified expression being tried
+
+    for (size_t i = 0; i < tokens.size(); i++) {     // Change one AND to OR, or one OR to AND, at a time
+        if (tokens[i] != "AND" && tokens[i] != "OR")
+            continue;
+        string gate = tokens[i];
+        tokens[i] = gate == "AND" ? "OR" : "AND";
+        string mod = joinTokens(tokens);
+        tokens[i] = gate;  // Undo the change before trying the next gate
+        if (calc_truth_table(variables, mod, results1) && IsTautology(results1) == 0 && IsUnsatisfiable(results1) == 0)
+            return mod;
+    }
 
-    i = 0;
-    flag = 0;
-    for (int y = 0;y < no_not_gate;y++) {
-        for (i;i < mod.size();i++) {
-            if (expr[i] == 'N' && expr[i + 1] == 'O' && expr[i + 2] == 'T') {
-                mod.erase(i, 4);   //remove NOT
-                i = i + 3;
-                flag = 1;
-            }
-            if (flag == 1) {
-                results1 = calc_truth_table(A, B, C, T, F, mod);
-
-                if (IsTautology(results1) == 0 && IsUnsatisfiable(results1) == 0) {
-                    cout << "TO  Modify Expression ,Should Remove NOT gate : " << mod;
-                    return mod;
-                }
-            }
-            else {
-                flag = 0;
-                mod = expr;
-            }
+    for (size_t i = 0; i < tokens.size(); i++) {     // Remove one NOT at a time
+        if (tokens[i] != "NOT")
+            continue;
+        string mod = joinTokens(tokens, i);
+        if (calc_truth_table(variables, mod, results1) && IsTautology(results1) == 0 && IsUnsatisfiable(results1) == 0) {
+            cout << "TO  Modify Expression ,Should Remove NOT gate : " << mod;
+            return mod;
         }
     }
 
-    return mod;
+    return expr;  // No single change works, the expression stays as it is
 }
 
 //Checking Tautology and Unsatisfiable for logical expression
-string check(vector<bool> results1, const vector<char>& A, const vector<char>& B, const vector<char>& C, const vector<char>& T, const vector<char>& F, string OriginalExpr, string& modifiedExpression) {
+string check(const TruthTable& results1, const vector<string>& variables, string OriginalExpr, string& modifiedExpression) {
 
     cout << "Checking Tautology and Unsatisfiable for logical expression\n";
     if (IsTautology(results1)) {
         cout << "Expression is tautology.\n";
-        modifiedExpression = modifyExpression(results1, A, B, C, T, F, OriginalExpr);
+        modifiedExpression = modifyExpression(variables, OriginalExpr);
       
     }
     else {
@@ -264,7 +342,7 @@ string check(vector<bool> results1, const vector<char>& A, const vector<char>& B
     if (IsUnsatisfiable(results1))
     {
         cout << "Expression is Unsatisfiable.\n";
-        modifiedExpression = modifyExpression(results1, A, B, C, T, F, OriginalExpr);
+        modifiedExpression = modifyExpression(variables, OriginalExpr);
 
     }
     else cout << "Expression is satisfiable";
@@ -275,36 +353,31 @@ string check(vector<bool> results1, const vector<char>& A, const vector<char>& B
 
 int main() {
 
-    // Define truth values for P, Q, S
-    vector<char> A = { 'F', 'T', 'F', 'T', 'F', 'T', 'F', 'T' };
-    vector<char> B = { 'F', 'F', 'T', 'T', 'F', 'F', 'T', 'T' };
-    vector<char> C = { 'F', 'F', 'F', 'F', 'T', 'T', 'T', 'T' };
-    vector<char> T = { 'T', 'T', 'T', 'T', 'T', 'T', 'T', 'T' };
-    vector<char> F = { 'F', 'F', 'F', 'F', 'F', 'F', 'F', 'F' };
-    vector<bool> results1 = { 0, 0, 0, 0, 0, 0, 0, 0 };
-    vector<bool> results2 = { 0, 0, 0, 0, 0, 0, 0, 0 };
+    TruthTable results1;
+    TruthTable results2;
     string OriginalExpr;
     string simplifiedExpr;
     string modifiedExpression = "";
     string simplifiedModifiedexpr;
     // Get the expression input
-    cout << "Hello, when entering an expression,\nuse capital letters {A,B,C} and ensure spaces between characters and brackets.\nMake sure to add a space between any of these elements: 'A', 'B', 'C', '(', ')', 'AND', 'OR', 'NOT'.\nUse 'T' if all combinations are true  \nUse 'F' if all combinations are false.\nFor example : '( ( A AND B ) OR NOT C )' ";
+    cout << "Hello, when entering an expression,\nuse variable names such as A, B, C or x1, x2, ... (up to " << MAX_VARIABLES << " variables) and ensure spaces between characters and brackets.\nMake sure to add a space between any of these elements: variables, '(', ')', 'AND', 'OR', 'NOT'.\nUse 'T' if all combinations are true  \nUse 'F' if all combinations are false.\nFor example : '( ( A AND B ) OR NOT C )' ";
     cout << "\n----------------------------------------" << "\n";
     cout << "Enter the Original logical expression : ";
     getline(cin, OriginalExpr);
     cout << "Enter the simplified logical expression : ";
     getline(cin, simplifiedExpr);
-    OriginalExpr = OriginalExpr.append(" ");   //If the last character of variable A in this code is 'A ', I handle it as such to distinguish it from 'AND' 
-    simplifiedExpr = simplifiedExpr.append(" ");
 
-    // Evaluate truth tables
-    results1 = calc_truth_table(A, B, C, T, F, OriginalExpr);
-    results2 = calc_truth_table(A, B, C, T, F, simplifiedExpr);
+    // Evaluate truth tables over the variables of both expressions
+    vector<string> variables = collectVariables({ OriginalExpr, simplifiedExpr });
+    if (!calc_truth_table(variables, OriginalExpr, results1) || !calc_truth_table(variables, simplifiedExpr, results2)) {
+        cout << "Invalid expression, or more than " << MAX_VARIABLES << " variables\n";
+        return 1;
+    }
 
     // Print truth tables
-    printTruthTable(A, B, C, results1, OriginalExpr);
+    printTruthTable(results1, variables, OriginalExpr);
     cout << "----------------------------------------" << "\n";
-    printTruthTable(A, B, C, results2, simplifiedExpr);
+    printTruthTable(results2, variables, simplifiedExpr);
 
     // Check equivalence
     if (areEquivalent(results1, results2))
@@ -316,30 +389,36 @@ int main() {
     cout << "----------------------------------------" << "\n";
 
     cout << "Checking satisfiability for both expressions\n";
-    if (!findSatisfiableInputs(results1, results2, A, B, C)) {
+    if (!findSatisfiableInputs(results1, results2, variables)) {
         cout << "2 Expression is unsatisfiable. \n";
     }
 
     cout << "----------------------------------------\n";
     cout << "Original Expression : " << OriginalExpr << "\n";
-    modifiedExpression = check(results1, A, B, C, T, F, OriginalExpr, modifiedExpression);
+    modifiedExpression = check(results1, variables, OriginalExpr, modifiedExpression);
 
     if (modifiedExpression != "") {
         cout << "\n-----------------------------------------\n";
         cout << "modified Expression : " << modifiedExpression << "\n";
-        results1 = calc_truth_table(A, B, C, T, F, modifiedExpression);
-        check(results1, A, B, C, T, F, modifiedExpression, modifiedExpression);
+        if (!calc_truth_table(variables, modifiedExpression, results1)) {
+            cout << "Invalid modified expression : " << modifiedExpression << "\n";
+            return 1;
+        }
+        check(results1, variables, modifiedExpression, modifiedExpression);
         cout << "\n----------------------------------------" << "\n";
         cout << "Enter the simplified modified logical expression : ";
         getline(cin, simplifiedModifiedexpr);
-        simplifiedModifiedexpr = simplifiedModifiedexpr.append(" ");  //If the last character of variable A in this code is 'A ', I handle it as such to distinguish it from 'AND'
         // Evaluate truth tables
-        results2 = calc_truth_table(A, B, C, T, F, simplifiedModifiedexpr);
+        variables = collectVariables({ modifiedExpression, simplifiedModifiedexpr });
+        if (!calc_truth_table(variables, modifiedExpression, results1) || !calc_truth_table(variables, simplifiedModifiedexpr, results2)) {
+            cout << "Invalid expression, or more than " << MAX_VARIABLES << " variables\n";
+            return 1;
+        }
 
         // Print truth tables
-        printTruthTable(A, B, C, results1, modifiedExpression);
+        printTruthTable(results1, variables, modifiedExpression);
         cout << "----------------------------------------" << "\n";
-        printTruthTable(A, B, C, results2, simplifiedModifiedexpr);
+        printTruthTable(results2, variables, simplifiedModifiedexpr);
 
         // Check equivalence
         if (areEquivalent(results1, results2))
@@ -349,7 +428,7 @@ int main() {
         cout << "----------------------------------------" << "\n";
 
         cout << "Checking satisfiability for both expressions\n";
-        if (!findSatisfiableInputs(results1, results2, A, B, C)) {
+        if (!findSatisfiableInputs(results1, results2, variables)) {
             cout << "2 Expression is unsatisfiable. \n";
     }
 
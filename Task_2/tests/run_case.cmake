@@ -0,0 +1,29 @@
+# Runs PROGRAM with CASE.in as its input and checks that every line of CASE.expected appears in the
+# output, in that order, except lines starting with "! ", whose text must not appear anywhere.
+# The program has to exit with EXIT_CODE, 0 unless given
+if(NOT DEFINED EXIT_CODE)
+    set(EXIT_CODE 0)
+endif()
+execute_process(COMMAND ${PROGRAM} INPUT_FILE ${CASE}.in OUTPUT_VARIABLE output RESULT_VARIABLE result)
+if(NOT result EQUAL EXIT_CODE)
+    message(FATAL_ERROR "Exit code ${result}\n${output}")
+endif()
+
+set(rest "${output}")
+file(STRINGS ${CASE}.expected expectedLines)
+foreach(line IN LISTS expectedLines)
+    if(line MATCHES "^! (.*)")
+        string(FIND "${output}" "${CMAKE_MATCH_1}" position)
+        if(NOT position EQUAL -1)
+            message(FATAL_ERROR "Unexpected: '${CMAKE_MATCH_1}'\n${output}")
+        endif()
+        continue()
+    endif()
+    string(FIND "${rest}" "${line}" position)
+    if(position EQUAL -1)
+        message(FATAL_ERROR "Missing, or out of order: '${line}'\n${output}")
+    endif()
+    string(LENGTH "${line}" length)
+    math(EXPR position "${position} + ${length}")
+    string(SUBSTRING "${rest}" ${position} -1 rest)
+endforeach()